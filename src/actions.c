@@ -0,0 +1,131 @@
+#include "actions.h"
+
+// Command dispatch table: open-addressing index keyed by command id. Records, strings and the
+// index itself are carved from the menu session arena, so the table grows without per-entry heap calls.
+#define ACTIONS_MIN_SLOTS 256 // power of two
+
+static Arena* g_arena = NULL;
+static MenuAction** g_slots = NULL;
+static UINT g_slotCount = 0;
+static UINT g_actionCount = 0;
+
+// Changes made since actions_mark, newest last. On the heap, so the log outlives the arena memory
+// it points into until the rollback is done.
+typedef struct ActionUndo {
+    MenuAction** slots;  // index the record was added to (added only)
+    UINT slot;
+    MenuAction* record;  // replaced record and its previous contents (replaced only)
+    MenuAction before;
+} ActionUndo;
+static BOOL g_marked = FALSE;
+static MenuAction** g_markSlots = NULL;
+static UINT g_markSlotCount = 0, g_markActionCount = 0;
+static ActionUndo* g_undo = NULL;
+static UINT g_undoCount = 0, g_undoCap = 0;
+
+static ActionUndo* push_undo(void) {
+    if (g_undoCount == g_undoCap) {
+        UINT cap = g_undoCap ? g_undoCap * 2 : 64;
+        ActionUndo* grown = (ActionUndo*)LocalAlloc(LMEM_FIXED, cap * sizeof(ActionUndo));
+        if (!grown) return NULL;
+        if (g_undo) {
+            CopyMemory(grown, g_undo, g_undoCount * sizeof(ActionUndo));
+            LocalFree(g_undo);
+        }
+        g_undo = grown;
+        g_undoCap = cap;
+    }
+    ActionUndo* u = &g_undo[g_undoCount++];
+    ZeroMemory(u, sizeof(*u));
+    return u;
+}
+
+static UINT slot_of(UINT id, UINT slotCount) {
+    return (id * 2654435761u) & (slotCount - 1);
+}
+
+void actions_reset(Arena* arena) {
+    g_arena = arena;
+    g_slots = NULL;
+    g_slotCount = 0;
+    g_actionCount = 0;
+    g_marked = FALSE;
+    if (g_undo) LocalFree(g_undo);
+    g_undo = NULL;
+    g_undoCount = g_undoCap = 0;
+}
+
+// Doubles the index (keeps load factor <= 1/2); the old index is simply abandoned in the arena
+static BOOL grow_index(void) {
+    UINT count = g_slotCount ? g_slotCount * 2 : ACTIONS_MIN_SLOTS;
+    MenuAction** slots = (MenuAction**)arena_alloc(g_arena, count * sizeof(MenuAction*));
+    if (!slots) return FALSE;
+    for (UINT i = 0; i < g_slotCount; ++i) {
+        MenuAction* a = g_slots[i];
+        if (!a) continue;
+        UINT s = slot_of(a->id, count);
+        while (slots[s]) s = (s + 1) & (count - 1);
+        slots[s] = a;
+    }
+    g_slots = slots;
+    g_slotCount = count;
+    return TRUE;
+}
+
+MenuAction* actions_add(UINT id, MenuActionKind kind, const WCHAR* path) {
+    if (!g_arena) return NULL;
+    if ((g_actionCount + 1) * 2 > g_slotCount && !grow_index()) return NULL;
+    UINT s = slot_of(id, g_slotCount);
+    while (g_slots[s] && g_slots[s]->id != id) s = (s + 1) & (g_slotCount - 1);
+    MenuAction* a = g_slots[s];
+    ActionUndo* u = NULL;
+    if (g_marked && !(u = push_undo())) return NULL; // could not be undone
+    if (!a) {
+        a = (MenuAction*)arena_alloc(g_arena, sizeof(MenuAction));
+        if (!a) { if (u) g_undoCount--; return NULL; }
+        g_slots[s] = a;
+        g_actionCount++;
+        if (u) { u->slots = g_slots; u->slot = s; }
+    } else if (u) {
+        u->record = a;
+        u->before = *a;
+    }
+    a->id = id;
+    a->kind = kind;
+    a->arg = 0;
+    a->hwnd = NULL;
+    a->params = NULL;
+    a->path = arena_wcsdup(g_arena, path);
+    if (!a->path) a->path = L"";
+    return a;
+}
+
+void actions_mark(void) {
+    g_marked = TRUE;
+    g_markSlots = g_slots;
+    g_markSlotCount = g_slotCount;
+    g_markActionCount = g_actionCount;
+    g_undoCount = 0;
+}
+
+// Records added since the mark sit in slots that were empty when every older record was placed,
+// so clearing them leaves the older probe chains as they were
+void actions_rollback(void) {
+    if (!g_marked) return;
+    while (g_undoCount > 0) {
+        const ActionUndo* u = &g_undo[--g_undoCount];
+        if (u->record) *u->record = u->before;
+        else u->slots[u->slot] = NULL;
+    }
+    g_slots = g_markSlots;
+    g_slotCount = g_markSlotCount;
+    g_actionCount = g_markActionCount;
+}
+
+const MenuAction* actions_find(UINT id) {
+    if (!g_slots) return NULL;
+    for (UINT s = slot_of(id, g_slotCount); g_slots[s]; s = (s + 1) & (g_slotCount - 1)) {
+        if (g_slots[s]->id == id) return g_slots[s];
+    }
+    return NULL;
+}
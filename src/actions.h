@@ -0,0 +1,45 @@
+#pragma once
+#include <windows.h>
+#include "arena.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// What a menu command does when picked. Registered while the menu is built, looked up by id on click.
+typedef enum {
+    MA_NONE = 0,
+    MA_OPEN_URI,      // open_uri(path)
+    MA_OPEN_FILE,     // open_shell_known("open", path, params)
+    MA_RUN_CMD,       // cmd.exe with path as arguments
+    MA_OPEN_ITEM,     // open_shell_item(path): files, folders and shell namespaces
+    MA_POWER,         // arg = CI_POWER_* verb
+    MA_TASKKILL,      // arg = process id, hwnd = the window it was listed for
+    MA_RECENT_OPEN,   // path = resolved recent target
+    MA_RECENT_CLEAR
+} MenuActionKind;
+
+typedef struct MenuAction {
+    UINT id;
+    MenuActionKind kind;
+    DWORD arg;            // pid or power verb, depending on kind
+    HWND hwnd;            // MA_TASKKILL: checked to still belong to arg before terminating
+    const WCHAR* params;  // optional parameters (points into the menu model)
+    const WCHAR* path;    // never NULL; copied into the session arena
+} MenuAction;
+
+// Drops all registered actions and backs the table with arena (NULL disables registration).
+// Records live in the arena, so releasing the arena releases the whole table.
+void actions_reset(Arena* arena);
+// Registers (or replaces) the action for id; returns NULL only when out of memory
+MenuAction* actions_add(UINT id, MenuActionKind kind, const WCHAR* path);
+// O(1) lookup by command id; NULL if nothing was registered
+const MenuAction* actions_find(UINT id);
+// Remembers the table as it is now; actions_rollback undoes every add since, so the arena can
+// then be rolled back to a mark taken at the same time. The mark holds until actions_reset.
+void actions_mark(void);
+void actions_rollback(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,98 @@
+#include "arena.h"
+
+#define ARENA_ALIGN 16
+#define ARENA_DEFAULT_CHUNK (64 * 1024)
+
+struct ArenaChunk {
+    ArenaChunk* next;
+    SIZE_T size;
+    SIZE_T used;
+    SIZE_T pad; // keeps data 16-byte aligned on 32-bit builds
+};
+
+static BYTE* chunk_data(ArenaChunk* c) { return (BYTE*)(c + 1); }
+
+void* arena_alloc(Arena* a, SIZE_T size) {
+    if (!a) return NULL;
+    size = (size + (ARENA_ALIGN - 1)) & ~(SIZE_T)(ARENA_ALIGN - 1);
+    ArenaChunk* c = a->head;
+    if (!c || c->size - c->used < size) {
+        SIZE_T want = a->chunkSize ? a->chunkSize : ARENA_DEFAULT_CHUNK;
+        if (want < size) want = size;
+        c = (ArenaChunk*)LocalAlloc(LMEM_FIXED, sizeof(ArenaChunk) + want);
+        if (!c) return NULL;
+        c->size = want;
+        c->used = 0;
+        c->next = a->head;
+        a->head = c;
+        a->bytesReserved += want;
+    }
+    void* p = chunk_data(c) + c->used;
+    c->used += size;
+    a->bytesUsed += size;
+    ZeroMemory(p, size);
+    return p;
+}
+
+WCHAR* arena_wcsdup(Arena* a, const WCHAR* s) {
+    if (!s) s = L"";
+    int len = lstrlenW(s);
+    WCHAR* d = (WCHAR*)arena_alloc(a, (SIZE_T)(len + 1) * sizeof(WCHAR));
+    if (d) CopyMemory(d, s, (SIZE_T)(len + 1) * sizeof(WCHAR));
+    return d;
+}
+
+void* arena_grow(Arena* a, void* old, UINT count, UINT* cap, SIZE_T elem) {
+    UINT ncap = *cap ? *cap * 2 : 64;
+    void* p = arena_alloc(a, (SIZE_T)ncap * elem);
+    if (!p) return NULL;
+    if (old && count) CopyMemory(p, old, (SIZE_T)count * elem);
+    *cap = ncap;
+    return p;
+}
+
+ArenaMark arena_mark(const Arena* a) {
+    ArenaMark m = { a->head, a->head ? a->head->used : 0, a->bytesUsed };
+    return m;
+}
+
+void arena_reset_to(Arena* a, ArenaMark mark) {
+    if (!a || !a->head) return;
+    if (!mark.chunk) { arena_reset(a); return; }
+    // Chunks added after the mark go back to the heap
+    while (a->head && a->head != mark.chunk) {
+        ArenaChunk* next = a->head->next;
+        a->bytesReserved -= a->head->size;
+        LocalFree(a->head);
+        a->head = next;
+    }
+    if (!a->head) { a->bytesUsed = 0; return; }
+    a->head->used = mark.used;
+    a->bytesUsed = mark.bytesUsed;
+}
+
+void arena_reset(Arena* a) {
+    if (!a || !a->head) return;
+    // Keep the oldest chunk (the tail of the list); free the rest
+    ArenaChunk* keep = a->head;
+    while (keep->next) {
+        ArenaChunk* next = keep->next;
+        a->bytesReserved -= keep->size;
+        LocalFree(keep);
+        keep = next;
+    }
+    keep->used = 0;
+    a->head = keep;
+    a->bytesUsed = 0;
+}
+
+void arena_free(Arena* a) {
+    if (!a) return;
+    while (a->head) {
+        ArenaChunk* next = a->head->next;
+        LocalFree(a->head);
+        a->head = next;
+    }
+    a->bytesUsed = 0;
+    a->bytesReserved = 0;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <windows.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Chunked bump allocator. Allocations are never freed individually; the whole arena is
+// released at once. Used for per-menu-session tables so building a menu makes no per-entry heap calls.
+typedef struct ArenaChunk ArenaChunk;
+
+typedef struct Arena {
+    ArenaChunk* head;     // current chunk (most recent first)
+    SIZE_T chunkSize;     // default chunk payload size (0 = 64 KB)
+    SIZE_T bytesUsed;     // total bytes handed out since the last reset
+    SIZE_T bytesReserved; // total chunk payload currently held
+} Arena;
+
+// Returns zeroed memory aligned to 16 bytes, or NULL when out of memory
+void* arena_alloc(Arena* a, SIZE_T size);
+WCHAR* arena_wcsdup(Arena* a, const WCHAR* s);
+// Growable table inside the arena: returns a block of twice *cap elements (64 when empty) holding
+// the first count elements of old, and updates *cap. The old block is abandoned. NULL when out of memory.
+void* arena_grow(Arena* a, void* old, UINT count, UINT* cap, SIZE_T elem);
+// Position to roll back to: arena_reset_to drops everything allocated after it and keeps the rest.
+// Valid until the next arena_reset or arena_free.
+typedef struct ArenaMark {
+    ArenaChunk* chunk;
+    SIZE_T used;
+    SIZE_T bytesUsed;
+} ArenaMark;
+
+ArenaMark arena_mark(const Arena* a);
+void arena_reset_to(Arena* a, ArenaMark mark);
+// Drops all allocations but keeps the first chunk around for the next session
+void arena_reset(Arena* a);
+// Releases every chunk
+void arena_free(Arena* a);
+
+#ifdef __cplusplus
+}
+#endif
@@ -65,6 +65,7 @@ typedef struct Config {
     enum { SORT_NAME=0, SORT_DATE_MODIFIED, SORT_DATE_CREATED, SORT_TYPE, SORT_SIZE } sortField;
     BOOL sortDescending;
     BOOL sortFoldersFirst;
+    BOOL sortNatural; // digits compare as numbers ("file2" before "file10")
     
     // Paging
     int maxItems; // Maximum items to show per folder page (0 = unlimited)
@@ -102,6 +103,7 @@ typedef struct Config {
     BOOL recentShowExtensions; // [General] RecentShowExtensions=true keeps extensions in recent submenu (inverse of deprecated RecentHideExtensions)
     BOOL recentShowCleanItems; // [General] RecentShowCleanItems=true (default true) adds a "Clear Recent Items" action at bottom of recent submenu
     BOOL recentShowIcons;      // [General] RecentShowIcons=true shows file icons in recent submenu
+    BOOL recentShowSlowItems;  // [RecentItems] RecentSlowItems=show|hide: items whose target check times out
     
     // TaskKill defaults
     int taskKillMax;
@@ -143,11 +145,23 @@ typedef struct Config {
     BOOL homeAsSubmenu;         // [Home] HomeAsSubmenu=true|false (default false)
     ConfigItem items[64];
     int count;
+    // Snapshot stamp of the INI this Config was compiled from (maintained by config_load)
+    BOOL iniSnapshot;       // TRUE once config_load has run
+    ULONGLONG iniSize;      // file size in bytes
+    FILETIME iniWriteTime;  // last write time
+    DWORD iniHash;          // FNV-1a of the raw file bytes
+    LONG iniWatchGen;       // folder change generation seen at load (0 = no watch available)
 } Config;
 
 // Resolves config path, creates default file if missing; returns TRUE if path is available
 BOOL config_ensure(Config* out);
 BOOL config_load(Config* out);
+struct IniFile;
+// Fills every setting and item of out from a parsed INI (missing keys take their defaults)
+void config_parse(Config* out, const struct IniFile* ini);
+// Re-parses only when the INI's size, write time or content hash changed since the last load.
+// Returns TRUE when the snapshot was (re)built, FALSE when the existing one is still current.
+BOOL config_load_cached(Config* cfg);
 // Overrides the default INI path; call before config_load. Will create defaults if missing.
 void config_set_path(Config* out, const WCHAR* path);
 // Set a global default path override used by config_ensure/load callers that supply a fresh Config.
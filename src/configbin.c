@@ -0,0 +1,105 @@
+#include "configbin.h"
+#include <shlobj.h>
+#include <shlwapi.h>
+#include <stddef.h> // offsetof
+
+#ifndef ARRAYSIZE
+#define ARRAYSIZE(a) (sizeof(a)/sizeof((a)[0]))
+#endif
+
+#define CONFIG_IMAGE_SIZE offsetof(Config, items)
+
+BOOL configbin_path(const WCHAR* iniPath, WCHAR* out, int cch, BOOL create) {
+    if (!iniPath[0] || cch < MAX_PATH) return FALSE;
+    if (FAILED(SHGetFolderPathW(NULL, CSIDL_LOCAL_APPDATA, NULL, SHGFP_TYPE_CURRENT, out))) return FALSE;
+    if (!PathAppendW(out, L"WinMacMenu")) return FALSE;
+    if (create) {
+        int rc = SHCreateDirectoryExW(NULL, out, NULL);
+        if (rc != ERROR_SUCCESS && rc != ERROR_ALREADY_EXISTS) return FALSE;
+    }
+    // One image per INI: FNV-1a of the case-folded path
+    DWORD h = 2166136261u;
+    for (const WCHAR* p = iniPath; *p; ++p) {
+        WCHAR c = *p;
+        if (c >= L'A' && c <= L'Z') c = (WCHAR)(c + 32);
+        h ^= c; h *= 16777619u;
+    }
+    WCHAR name[32];
+    wsprintfW(name, L"config-%08x.bin", h);
+    return PathAppendW(out, name);
+}
+
+// Checks the mapped image and copies it into cfg
+static BOOL apply_image(const BYTE* view, DWORD fileSize, ULONGLONG iniSize, const FILETIME* iniWriteTime, DWORD contextHash, Config* cfg) {
+    const ConfigBinHeader* h = (const ConfigBinHeader*)view;
+    if (h->magic != CONFIGBIN_MAGIC || h->version != CONFIGBIN_VERSION || h->headerSize != sizeof(ConfigBinHeader)) return FALSE;
+    // Layout must match this build exactly
+    if (h->configSize != CONFIG_IMAGE_SIZE || h->itemSize != sizeof(ConfigItem) || h->itemCount > ARRAYSIZE(cfg->items)) return FALSE;
+    if (h->iniSize != iniSize || CompareFileTime(&h->iniWriteTime, iniWriteTime) != 0 || h->contextHash != contextHash) return FALSE;
+    // Written whole through a rename, so an exact size rules out truncation without hashing the payload
+    if (h->configOffset != h->headerSize || h->itemsOffset != h->configOffset + h->configSize) return FALSE;
+    if (fileSize != h->itemsOffset + h->itemCount * h->itemSize) return FALSE;
+    CopyMemory(cfg, view + h->configOffset, CONFIG_IMAGE_SIZE);
+    CopyMemory(cfg->items, view + h->itemsOffset, (SIZE_T)h->itemCount * sizeof(ConfigItem));
+    cfg->count = (int)h->itemCount;
+    cfg->iniSize = h->iniSize;
+    cfg->iniWriteTime = h->iniWriteTime;
+    cfg->iniHash = h->iniHash;
+    return TRUE;
+}
+
+BOOL configbin_read(const WCHAR* binPath, ULONGLONG iniSize, const FILETIME* iniWriteTime, DWORD contextHash, Config* cfg) {
+    HANDLE hf = CreateFileW(binPath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hf == INVALID_HANDLE_VALUE) return FALSE;
+    BOOL ok = FALSE;
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(hf, &size) && size.QuadPart >= (LONGLONG)sizeof(ConfigBinHeader) && size.QuadPart <= 4 * 1024 * 1024) {
+        HANDLE map = CreateFileMappingW(hf, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (map) {
+            const BYTE* view = (const BYTE*)MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+            if (view) {
+                ok = apply_image(view, (DWORD)size.QuadPart, iniSize, iniWriteTime, contextHash, cfg);
+                UnmapViewOfFile(view);
+            }
+            CloseHandle(map);
+        }
+    }
+    CloseHandle(hf);
+    return ok;
+}
+
+BOOL configbin_write(const WCHAR* binPath, const Config* cfg, DWORD contextHash) {
+    int count = cfg->count;
+    if (count < 0) count = 0;
+    if (count > (int)ARRAYSIZE(cfg->items)) count = (int)ARRAYSIZE(cfg->items);
+    ConfigBinHeader h;
+    ZeroMemory(&h, sizeof(h));
+    h.magic = CONFIGBIN_MAGIC;
+    h.version = CONFIGBIN_VERSION;
+    h.headerSize = sizeof(ConfigBinHeader);
+    h.configOffset = sizeof(ConfigBinHeader);
+    h.configSize = CONFIG_IMAGE_SIZE;
+    h.itemsOffset = h.configOffset + h.configSize;
+    h.itemSize = sizeof(ConfigItem);
+    h.itemCount = (DWORD)count;
+    h.iniSize = cfg->iniSize;
+    h.iniWriteTime = cfg->iniWriteTime;
+    h.iniHash = cfg->iniHash;
+    h.contextHash = contextHash;
+
+    WCHAR tmp[MAX_PATH + 8];
+    if (lstrlenW(binPath) + 5 > (int)ARRAYSIZE(tmp)) return FALSE;
+    lstrcpyW(tmp, binPath);
+    lstrcatW(tmp, L".tmp");
+    HANDLE hf = CreateFileW(tmp, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hf == INVALID_HANDLE_VALUE) return FALSE;
+    DWORD wrote = 0;
+    BOOL ok = WriteFile(hf, &h, sizeof(h), &wrote, NULL) && wrote == sizeof(h);
+    ok = ok && WriteFile(hf, cfg, (DWORD)CONFIG_IMAGE_SIZE, &wrote, NULL) && wrote == CONFIG_IMAGE_SIZE;
+    DWORD itemBytes = (DWORD)count * sizeof(ConfigItem);
+    ok = ok && (itemBytes == 0 || (WriteFile(hf, cfg->items, itemBytes, &wrote, NULL) && wrote == itemBytes));
+    CloseHandle(hf);
+    if (ok) ok = MoveFileExW(tmp, binPath, MOVEFILE_REPLACE_EXISTING);
+    if (!ok) DeleteFileW(tmp);
+    return ok;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <windows.h>
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Compiled config sidecar: a versioned, offset-based image of a parsed Config and its items,
+// written after a successful parse so the next start can skip reading and parsing the INI. Kept in
+// %LOCALAPPDATA%\WinMacMenu (named after the INI path) so writing it never touches the INI folder
+// the config watch listens to. An image is only accepted for the INI size and write time and the
+// load context (executable build + environment, which parsing expands into paths) it was compiled
+// from; validating it takes one open and a map, with no hashing and no heap allocation.
+
+#define CONFIGBIN_MAGIC   0x42434D57 // "WMCB"
+#define CONFIGBIN_VERSION 2
+
+typedef struct ConfigBinHeader {
+    DWORD magic;
+    DWORD version;
+    DWORD headerSize;
+    DWORD configOffset;   // Config fields before items[]
+    DWORD configSize;
+    DWORD itemsOffset;    // items[0..itemCount), the file ends right after them
+    DWORD itemSize;
+    DWORD itemCount;
+    ULONGLONG iniSize;
+    FILETIME iniWriteTime;
+    DWORD iniHash;        // FNV-1a of the INI bytes, restored into Config.iniHash
+    DWORD contextHash;
+} ConfigBinHeader;
+
+// Sidecar path for an INI path (creating its folder when create is set); FALSE if there is none
+BOOL configbin_path(const WCHAR* iniPath, WCHAR* out, int cch, BOOL create);
+// Fills the image part of cfg (everything before items[], the items and count) and its INI stamp
+// when binPath holds a valid image for that stamp and context. cfg is left untouched otherwise.
+BOOL configbin_read(const WCHAR* binPath, ULONGLONG iniSize, const FILETIME* iniWriteTime, DWORD contextHash, Config* cfg);
+// Writes the image of cfg (replacing binPath atomically); best effort
+BOOL configbin_write(const WCHAR* binPath, const Config* cfg, DWORD contextHash);
+
+#ifdef __cplusplus
+}
+#endif
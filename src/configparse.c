@@ -0,0 +1,553 @@
+#include "config.h"
+#include "ini.h"
+#include <shlwapi.h>
+
+// INI -> Config compilation. No file I/O of its own: config_load hands in the parsed INI.
+
+// Expand %ENVVAR% sequences in-place (destination buffer provided).
+// If no '%' is present we skip calling the API for performance.
+static void expand_env(const WCHAR* in, WCHAR* out, size_t cchOut) {
+    if (!in || !out || cchOut == 0) return;
+    // Quick scan for '%'
+    const WCHAR* p = in; BOOL hasPct = FALSE;
+    while (*p) { if (*p == L'%') { hasPct = TRUE; break; } ++p; }
+    if (!hasPct) { lstrcpynW(out, in, (int)cchOut); return; }
+    WCHAR tmp[4096];
+    DWORD n = ExpandEnvironmentStringsW(in, tmp, ARRAYSIZE(tmp));
+    if (n == 0 || n > ARRAYSIZE(tmp)) { // failure or truncated; fallback copy
+        lstrcpynW(out, in, (int)cchOut);
+        return;
+    }
+    lstrcpynW(out, tmp, (int)cchOut);
+}
+
+// Trim leading/trailing whitespace in-place for small config strings.
+static void trim_inplace(WCHAR* s) {
+    if (!s || !*s) return;
+    // Leading
+    WCHAR* p = s;
+    while (*p == L' ' || *p == L'\t' || *p == L'\r' || *p == L'\n') ++p;
+    if (p != s) {
+        WCHAR* d = s; while (*p) *d++ = *p++; *d = 0;
+    }
+    // Trailing
+    size_t len = lstrlenW(s);
+    while (len > 0) {
+        WCHAR ch = s[len - 1];
+        if (ch == L' ' || ch == L'\t' || ch == L'\r' || ch == L'\n') {
+            s[len - 1] = 0;
+            --len;
+        } else {
+            break;
+        }
+    }
+}
+
+static ConfigItemType parse_type(const WCHAR* s) {
+    if (!s) return CI_SEPARATOR;
+    if (!lstrcmpiW(s, L"SEPARATOR")) return CI_SEPARATOR;
+    if (!lstrcmpiW(s, L"URI")) return CI_URI;
+    if (!lstrcmpiW(s, L"FILE")) return CI_FILE;
+    if (!lstrcmpiW(s, L"CMD")) return CI_CMD;
+    if (!lstrcmpiW(s, L"FOLDER")) return CI_FOLDER;
+    if (!lstrcmpiW(s, L"FOLDER_SUBMENU")) return CI_FOLDER_SUBMENU;
+    if (!lstrcmpiW(s, L"POWER_SLEEP")) return CI_POWER_SLEEP;
+    if (!lstrcmpiW(s, L"POWER_SHUTDOWN")) return CI_POWER_SHUTDOWN;
+    if (!lstrcmpiW(s, L"POWER_RESTART")) return CI_POWER_RESTART;
+    if (!lstrcmpiW(s, L"POWER_LOCK")) return CI_POWER_LOCK;
+    if (!lstrcmpiW(s, L"POWER_LOGOFF")) return CI_POWER_LOGOFF;
+    if (!lstrcmpiW(s, L"POWER_HIBERNATE")) return CI_POWER_HIBERNATE;
+    if (!lstrcmpiW(s, L"RECENT_SUBMENU")) return CI_RECENT_SUBMENU;
+    if (!lstrcmpiW(s, L"RECENT")) return CI_RECENT_SUBMENU;
+    if (!lstrcmpiW(s, L"POWER_MENU")) return CI_POWER_MENU;
+    if (!lstrcmpiW(s, L"TASKKILL")) return CI_TASKKILL;
+    if (!lstrcmpiW(s, L"THISPC")) return CI_THISPC;
+    if (!lstrcmpiW(s, L"HOME")) return CI_HOME;
+    return CI_SEPARATOR;
+}
+
+static ControlActionType parse_control_action(const WCHAR* s) {
+    if (!s) return CA_NOTHING;
+    if (!lstrcmpiW(s, L"Nothing")) return CA_NOTHING;
+    if (!lstrcmpiW(s, L"WinMacMenu") || !lstrcmpiW(s, L"WinMac Menu")) return CA_WINMAC_MENU;
+    if (!lstrcmpiW(s, L"WindowsMenu") || !lstrcmpiW(s, L"Windows Menu") || !lstrcmpiW(s, L"WindowsStartMenu") || !lstrcmpiW(s, L"Windows Start Menu")) return CA_WINDOWS_MENU;
+    if (!lstrcmpiW(s, L"CustomCommand") || !lstrcmpiW(s, L"Custom Command") || !lstrcmpiW(s, L"Command")) return CA_CUSTOM_COMMAND;
+    return CA_NOTHING;
+}
+
+static int parse_menu(Config* cfg, const IniFile* ini) {
+    cfg->count = 0;
+    WCHAR section[] = L"Menu";
+    for (int i = 1; i <= 64; ++i) {
+        WCHAR key[32]; wsprintfW(key, L"Item%d", i);
+        WCHAR line[1024] = {0};
+        ini_get_string(ini, section, key, L"", line, ARRAYSIZE(line));
+        if (!line[0]) continue;
+
+        // Expected: Label|TYPE|Path|Params(optional)|Icon(optional)
+        WCHAR* p = line;
+        WCHAR* label = p;
+        WCHAR* type = NULL;
+        WCHAR* path = NULL;
+        WCHAR* params = NULL;
+        WCHAR* icon = NULL;
+        for (int part=0; part<5; ++part) {
+            WCHAR* bar = wcschr(p, L'|');
+            if (!bar) {
+                if (part==0) { type = L"SEPARATOR"; p = L""; }
+                else if (part==1) { type = p; p = L""; }
+                else if (part==2) { path = p; p = L""; }
+                else if (part==3) { params = p; p = L""; }
+                else if (part==4) { icon = p; p = L""; }
+                break;
+            }
+            *bar = 0;
+            if (part==0) type = bar+1;
+            else if (part==1) path = bar+1;
+            else if (part==2) params = bar+1;
+            else if (part==3) icon = bar+1;
+            p = bar+1;
+        }
+        ConfigItem* it = &cfg->items[cfg->count++];
+        // Expand environment variables in label
+        expand_env(label, it->label, ARRAYSIZE(it->label));
+        it->type = parse_type(type);
+        if (path) expand_env(path, it->path, ARRAYSIZE(it->path)); else it->path[0]=0;
+        if (params) expand_env(params, it->params, ARRAYSIZE(it->params)); else it->params[0]=0;
+    if (icon) expand_env(icon, it->iconPath, ARRAYSIZE(it->iconPath)); else it->iconPath[0]=0;
+    // Initialize theme-specific per-item icons empty; filled via [IconsLight]/[IconsDark] sections
+    it->iconPathLight[0] = 0;
+    it->iconPathDark[0] = 0;
+        it->submenu = (it->type == CI_FOLDER_SUBMENU || it->type == CI_RECENT_SUBMENU);
+        if (it->type == CI_THISPC && cfg->thisPCAsSubmenu) it->submenu = TRUE;
+        if (it->type == CI_HOME && cfg->homeAsSubmenu) it->submenu = TRUE;
+
+        // Allow FOLDER items to set mode via 4th field: "submenu" or "link"
+        if ((it->type == CI_FOLDER || it->type == CI_THISPC || it->type == CI_HOME) && it->params[0]) {
+            WCHAR pLower[256]; lstrcpynW(pLower, it->params, ARRAYSIZE(pLower));
+            for (WCHAR* q=pLower; *q; ++q) *q = (WCHAR)towlower(*q);
+            if (wcsstr(pLower, L"submenu")) it->submenu = TRUE;
+            else if (wcsstr(pLower, L"link")) it->submenu = FALSE;
+            
+            // Experimental inline expansion: include token "inline" to inject folder contents at root
+            if (wcsstr(pLower, L"inline")) it->inlineExpand = TRUE; 
+            else if ((it->type == CI_THISPC || it->type == CI_HOME) && !it->submenu) it->inlineExpand = TRUE; // THISPC/HOME defaults to inline
+            else it->inlineExpand = FALSE;
+
+            if (it->inlineExpand) {
+                BOOL explicitNoTitle = (wcsstr(pLower, L"notitle") || wcsstr(pLower, L"noheader"));
+                if (explicitNoTitle) {
+                    it->inlineNoHeader = TRUE;
+                } else if (wcsstr(pLower, L"title")) {
+                    it->inlineNoHeader = FALSE;
+                } else {
+                    // Default behavior if neither specified
+                    if (it->type == CI_THISPC || it->type == CI_HOME) it->inlineNoHeader = TRUE; // Default hidden for THISPC/HOME
+                    else it->inlineNoHeader = FALSE; // Default shown for FOLDER
+                }
+            } else {
+                it->inlineNoHeader = FALSE;
+            }
+
+            if (it->inlineExpand && wcsstr(pLower, L"inlineopen")) it->inlineOpen = TRUE; else it->inlineOpen = FALSE;
+        } else if (it->type == CI_FOLDER) {
+            it->inlineExpand = FALSE;
+            it->inlineNoHeader = FALSE;
+            it->inlineOpen = FALSE;
+        } else if (it->type == CI_THISPC || it->type == CI_HOME) {
+            // Default to inline/notitle for THISPC/HOME if no params provided
+            it->inlineExpand = TRUE;
+            it->inlineNoHeader = TRUE;
+            it->inlineOpen = FALSE;
+        } else {
+            it->inlineExpand = FALSE; // non-folder
+            it->inlineNoHeader = FALSE;
+            it->inlineOpen = FALSE;
+        }
+        if (cfg->count >= 64) break;
+    }
+    return cfg->count;
+}
+
+static void parse_icons(Config* cfg, const IniFile* ini) {
+    // Optional [Icons] section: Icon1..IconN map to Item1..ItemN
+    WCHAR section[] = L"Icons";
+    for (int i = 1; i <= cfg->count; ++i) {
+        WCHAR key[32]; wsprintfW(key, L"Icon%d", i);
+        WCHAR path[MAX_PATH] = {0};
+        ini_get_string(ini, section, key, L"", path, ARRAYSIZE(path));
+        if (path[0]) {
+            // Expand environment variables in icon path
+            WCHAR expanded[MAX_PATH];
+            expand_env(path, expanded, ARRAYSIZE(expanded));
+            lstrcpynW(cfg->items[i-1].iconPath, expanded, ARRAYSIZE(cfg->items[i-1].iconPath));
+        }
+    }
+    // Optional [IconsLight] and [IconsDark]
+    WCHAR sectionL[] = L"IconsLight";
+    WCHAR sectionD[] = L"IconsDark";
+    for (int i = 1; i <= cfg->count; ++i) {
+        WCHAR key[32]; wsprintfW(key, L"Icon%d", i);
+        WCHAR pathL[MAX_PATH] = {0};
+        WCHAR pathD[MAX_PATH] = {0};
+        ini_get_string(ini, sectionL, key, L"", pathL, ARRAYSIZE(pathL));
+        ini_get_string(ini, sectionD, key, L"", pathD, ARRAYSIZE(pathD));
+        if (pathL[0]) {
+            WCHAR expandedL[MAX_PATH];
+            expand_env(pathL, expandedL, ARRAYSIZE(expandedL));
+            lstrcpynW(cfg->items[i-1].iconPathLight, expandedL, ARRAYSIZE(cfg->items[i-1].iconPathLight));
+        }
+        if (pathD[0]) {
+            WCHAR expandedD[MAX_PATH];
+            expand_env(pathD, expandedD, ARRAYSIZE(expandedD));
+            lstrcpynW(cfg->items[i-1].iconPathDark,  expandedD, ARRAYSIZE(cfg->items[i-1].iconPathDark));
+        }
+    }
+}
+
+void config_parse(Config* out, const IniFile* ini) {
+    // Explicit defaults for control flags so missing keys don't inherit prior memory/state
+    // Removed resident/trigger controls
+    // RunInBackground and tray icon
+    WCHAR buf[32];
+    ini_get_string(ini, L"General", L"RunInBackground", L"true", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    out->runInBackground = (!lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"1"));
+    // ShowOnLaunch (default true) controls whether we show the initial menu when starting in background
+    ini_get_string(ini, L"General", L"ShowOnLaunch", L"true", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    out->showOnLaunch = (!lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"1"));
+    ini_get_string(ini, L"General", L"ShowTrayIcon", L"true", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    out->showTrayIcon = (!lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"1"));
+    // Start on login (registry Run entry)
+    ini_get_string(ini, L"General", L"StartOnLogin", L"false", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    out->startOnLogin = (!lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"1"));
+
+    out->recentMax = ini_get_int(ini, L"RecentItems", L"RecentMax", 12);
+    out->folderMaxDepth = ini_get_int(ini, L"General", L"FolderSubmenuDepth", 4);
+    if (out->folderMaxDepth < 1) out->folderMaxDepth = 1;
+    if (out->folderMaxDepth > 4) out->folderMaxDepth = 4;
+    
+    // Fallback default now single
+    ini_get_string(ini, L"General", L"FolderSubmenuOpen", L"single", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    out->folderSingleClickOpen = (!lstrcmpiW(buf, L"single")) ? TRUE : FALSE;
+    // Global toggle for showing "Open <folder>" entry in submenus (default true)
+    ini_get_string(ini, L"General", L"FolderShowOpenEntry", L"true", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    out->folderShowOpenEntry = (!lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"1"));
+
+    // Global toggle for showing icons in Recent submenu (default false)
+    ini_get_string(ini, L"RecentItems", L"RecentShowIcons", L"false", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    out->recentShowIcons = (!lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"1"));
+
+    // Recent items whose target cannot be checked in time (offline shares): hide (default) or show
+    ini_get_string(ini, L"RecentItems", L"RecentSlowItems", L"hide", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    out->recentShowSlowItems = (!lstrcmpiW(buf, L"show") || !lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"1"));
+    
+    // Sorting options
+    ini_get_string(ini, L"Sorting", L"SortBy", L"name", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    if (!lstrcmpiW(buf, L"date_modified") || !lstrcmpiW(buf, L"datemodified") || !lstrcmpiW(buf, L"modified")) out->sortField = SORT_DATE_MODIFIED;
+    else if (!lstrcmpiW(buf, L"date_created") || !lstrcmpiW(buf, L"datecreated") || !lstrcmpiW(buf, L"created")) out->sortField = SORT_DATE_CREATED;
+    else if (!lstrcmpiW(buf, L"type")) out->sortField = SORT_TYPE;
+    else if (!lstrcmpiW(buf, L"size")) out->sortField = SORT_SIZE;
+    else out->sortField = SORT_NAME;
+
+    ini_get_string(ini, L"Sorting", L"SortDirection", L"ascending", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    out->sortDescending = (!lstrcmpiW(buf, L"descending") || !lstrcmpiW(buf, L"desc"));
+
+    ini_get_string(ini, L"Sorting", L"FoldersFirst", L"true", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    out->sortFoldersFirst = (!lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"1"));
+
+    ini_get_string(ini, L"Sorting", L"NaturalSort", L"false", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    out->sortNatural = (!lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"1"));
+
+    out->maxItems = ini_get_int(ini, L"General", L"MaxItems", 40);
+
+    ini_get_string(ini, L"General", L"ShowHidden", L"false", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    out->showHidden = (!lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"1"));
+
+    // TaskKill defaults
+    out->taskKillMax = ini_get_int(ini, L"TaskKill", L"TaskKillMax", 10);
+    
+    ini_get_string(ini, L"TaskKill", L"TaskKillIgnoreSystem", L"false", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    out->taskKillIgnoreSystem = (!lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"1"));
+
+    ini_get_string(ini, L"TaskKill", L"TaskKillShowIcons", L"true", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    out->taskKillShowIcons = (!lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"1"));
+
+    ini_get_string(ini, L"TaskKill", L"TaskKillListWindows", L"false", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    out->taskKillListWindows = (!lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"1"));
+
+    ini_get_string(ini, L"TaskKill", L"TaskKillAllDesktops", L"false", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    out->taskKillAllDesktops = (!lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"1"));
+
+    ini_get_string(ini, L"TaskKill", L"TaskKillExcludes", L"", out->taskKillExcludes, ARRAYSIZE(out->taskKillExcludes));
+
+    ini_get_string(ini, L"ThisPC", L"ThisPCItemsAsSubmenus", L"true", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    out->thisPCItemsAsSubmenus = (!lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"1"));
+
+    ini_get_string(ini, L"ThisPC", L"ThisPCShowIcons", L"true", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    out->thisPCShowIcons = (!lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"1"));
+
+    ini_get_string(ini, L"ThisPC", L"ThisPCAsSubmenu", L"false", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    out->thisPCAsSubmenu = (!lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"1"));
+
+    ini_get_string(ini, L"Home", L"HomeItemsAsSubmenus", L"true", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    out->homeItemsAsSubmenus = (!lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"1"));
+
+    ini_get_string(ini, L"Home", L"HomeShowIcons", L"true", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    out->homeShowIcons = (!lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"1"));
+
+    ini_get_string(ini, L"Home", L"HomeAsSubmenu", L"false", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    out->homeAsSubmenu = (!lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"1"));
+
+    ini_get_string(ini, L"General", L"ShowDotfiles", L"false", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    // Accept both dashed and concatenated forms (files-only, folders-only)
+    if (!lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"1")) { out->dotMode = 3; out->showDotfiles = TRUE; }
+    else if (!lstrcmpiW(buf, L"filesonly") || !lstrcmpiW(buf, L"files-only")) { out->dotMode = 1; out->showDotfiles = TRUE; }
+    else if (!lstrcmpiW(buf, L"foldersonly") || !lstrcmpiW(buf, L"folders-only")) { out->dotMode = 2; out->showDotfiles = TRUE; }
+    else { out->dotMode = 0; out->showDotfiles = FALSE; }
+    // Default to legacy if missing
+    ini_get_string(ini, L"General", L"MenuStyle", L"legacy", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+#ifdef ENABLE_MODERN_STYLE
+    if (!lstrcmpiW(buf, L"legacy")) out->menuStyle = 0; else out->menuStyle = 1; // only other value treated as modern
+#else
+    out->menuStyle = 0; // force legacy when modern disabled at build time
+#endif
+    ini_get_string(ini, L"General", L"DefaultIcon", L"", out->defaultIconPath, ARRAYSIZE(out->defaultIconPath));
+    if (!out->defaultIconPath[0]) ini_get_string(ini, L"Icons", L"DefaultIcon", L"", out->defaultIconPath, ARRAYSIZE(out->defaultIconPath));
+    ini_get_string(ini, L"General", L"DefaultIconLight", L"", out->defaultIconPathLight, ARRAYSIZE(out->defaultIconPathLight));
+    if (!out->defaultIconPathLight[0]) ini_get_string(ini, L"Icons", L"DefaultIconLight", L"", out->defaultIconPathLight, ARRAYSIZE(out->defaultIconPathLight));
+    ini_get_string(ini, L"General", L"DefaultIconDark", L"", out->defaultIconPathDark, ARRAYSIZE(out->defaultIconPathDark));
+    if (!out->defaultIconPathDark[0]) ini_get_string(ini, L"Icons", L"DefaultIconDark", L"", out->defaultIconPathDark, ARRAYSIZE(out->defaultIconPathDark));
+    // Expand any environment variables in default icon path
+    if (out->defaultIconPath[0]) {
+        WCHAR expanded[MAX_PATH];
+        expand_env(out->defaultIconPath, expanded, ARRAYSIZE(expanded));
+        lstrcpynW(out->defaultIconPath, expanded, ARRAYSIZE(out->defaultIconPath));
+    }
+    if (out->defaultIconPathLight[0]) {
+        WCHAR expanded[MAX_PATH];
+        expand_env(out->defaultIconPathLight, expanded, ARRAYSIZE(expanded));
+        lstrcpynW(out->defaultIconPathLight, expanded, ARRAYSIZE(out->defaultIconPathLight));
+    }
+    if (out->defaultIconPathDark[0]) {
+        WCHAR expanded[MAX_PATH];
+        expand_env(out->defaultIconPathDark, expanded, ARRAYSIZE(expanded));
+        lstrcpynW(out->defaultIconPathDark, expanded, ARRAYSIZE(out->defaultIconPathDark));
+    }
+    ini_get_string(ini, L"General", L"ShowIcons", L"", buf, ARRAYSIZE(buf));
+    if (!buf[0]) ini_get_string(ini, L"General", L"LegacyIcons", L"false", buf, ARRAYSIZE(buf)); // backward compatibility
+    trim_inplace(buf);
+    if (!lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"1")) out->showIcons = 1;
+    else if (!lstrcmpiW(buf, L"other")) out->showIcons = 2;
+    else out->showIcons = 0;
+    // Modern-only options (with [General] fallback) - ignored if modern disabled
+#ifdef ENABLE_MODERN_STYLE
+    ini_get_string(ini, L"Modern", L"Corners", L"", buf, ARRAYSIZE(buf));
+    if (!buf[0]) ini_get_string(ini, L"General", L"Corners", L"rounded", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    out->roundedCorners = (lstrcmpiW(buf, L"square") != 0); // default rounded
+#else
+    out->roundedCorners = FALSE;
+#endif
+    ini_get_string(ini, L"Placement", L"Horizontal", L"right", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    if (!lstrcmpiW(buf, L"left")) out->hPlacement = 0; else if (!lstrcmpiW(buf, L"center")) out->hPlacement = 1; else out->hPlacement = 2;
+    out->hOffset = ini_get_int(ini, L"Placement", L"HOffset", 0);
+    ini_get_string(ini, L"Placement", L"Vertical", L"bottom", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    if (!lstrcmpiW(buf, L"top")) out->vPlacement = 0; else if (!lstrcmpiW(buf, L"center")) out->vPlacement = 1; else out->vPlacement = 2;
+    out->vOffset = ini_get_int(ini, L"Placement", L"VOffset", 0);
+    ini_get_string(ini, L"Placement", L"PointerRelative", L"true", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    out->pointerRelative = (!lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"1"));
+    // Optional: IgnoreOffsetWhenCentered = false|true|hoffset|voffset (controls whether HOffset/VOffset are ignored when centered)
+    out->ignoreHOffsetWhenCentered = FALSE;
+    out->ignoreVOffsetWhenCentered = FALSE;
+    ini_get_string(ini, L"Placement", L"IgnoreOffsetWhenCentered", L"false", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    if (!lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"both")) {
+        out->ignoreHOffsetWhenCentered = TRUE;
+        out->ignoreVOffsetWhenCentered = TRUE;
+    } else if (!lstrcmpiW(buf, L"hoffset") || !lstrcmpiW(buf, L"h") || !lstrcmpiW(buf, L"horizontal")) {
+        out->ignoreHOffsetWhenCentered = TRUE;
+    } else if (!lstrcmpiW(buf, L"voffset") || !lstrcmpiW(buf, L"v") || !lstrcmpiW(buf, L"vertical")) {
+        out->ignoreVOffsetWhenCentered = TRUE;
+    }
+    // Optional: IgnoreOffsetWhenRelative = false|true|hoffset|voffset
+    out->ignoreHOffsetWhenRelative = FALSE;
+    out->ignoreVOffsetWhenRelative = FALSE;
+    ini_get_string(ini, L"Placement", L"IgnoreOffsetWhenRelative", L"false", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    if (!lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"both")) {
+        out->ignoreHOffsetWhenRelative = TRUE;
+        out->ignoreVOffsetWhenRelative = TRUE;
+    } else if (!lstrcmpiW(buf, L"hoffset") || !lstrcmpiW(buf, L"h") || !lstrcmpiW(buf, L"horizontal")) {
+        out->ignoreHOffsetWhenRelative = TRUE;
+    } else if (!lstrcmpiW(buf, L"voffset") || !lstrcmpiW(buf, L"v") || !lstrcmpiW(buf, L"vertical")) {
+        out->ignoreVOffsetWhenRelative = TRUE;
+    }
+    // Modern-only width override (ignored when disabled)
+#ifdef ENABLE_MODERN_STYLE
+    out->menuWidth = ini_get_int(ini, L"General", L"MenuWidth", 0);
+#else
+    out->menuWidth = 0;
+#endif
+    // Logging: LogConfig=off|false|0, basic|true|1, verbose|2. Fallback: [Debug] section if not in [General].
+    out->logLevel = 0; out->logFolderPath[0] = 0; out->logFilePath[0] = 0;
+    ini_get_string(ini, L"General", L"LogConfig", L"", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    if (!buf[0]) { // fallback to [Debug]
+        ini_get_string(ini, L"Debug", L"LogConfig", L"", buf, ARRAYSIZE(buf));
+        trim_inplace(buf);
+    }
+    if (buf[0]) {
+        if (!lstrcmpiW(buf, L"verbose") || !lstrcmpiW(buf, L"2")) out->logLevel = 2;
+        else if (!lstrcmpiW(buf, L"basic") || !lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"1")) out->logLevel = 1;
+        else out->logLevel = 0; // off / false / 0 / unknown
+    }
+    // New: LogFolder replaces LogFile. We create a dynamic log filename:
+    // WinMacMenu_<configBase>_<yyMMdd-HHmm>.log inside specified folder (default = EXE directory when blank)
+    WCHAR lf[512]; lf[0]=0;
+    ini_get_string(ini, L"General", L"LogFolder", L"", lf, ARRAYSIZE(lf));
+    trim_inplace(lf);
+    if (!lf[0]) {
+        ini_get_string(ini, L"Debug", L"LogFolder", L"", lf, ARRAYSIZE(lf));
+        trim_inplace(lf);
+    }
+    if (lf[0]) {
+        expand_env(lf, out->logFolderPath, ARRAYSIZE(out->logFolderPath));
+    } else {
+        // Default to executable directory
+        GetModuleFileNameW(NULL, out->logFolderPath, ARRAYSIZE(out->logFolderPath));
+        PathRemoveFileSpecW(out->logFolderPath);
+    }
+    // RecentLabel (default fullpath). Accept synonyms: full, fullpath, path, name, filename, file, leaf
+    ini_get_string(ini, L"RecentItems", L"RecentLabel", L"fullpath", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    if (!lstrcmpiW(buf, L"name") || !lstrcmpiW(buf, L"filename") || !lstrcmpiW(buf, L"file") || !lstrcmpiW(buf, L"leaf")) out->recentLabelMode = 1; else out->recentLabelMode = 0;
+    // ShowFileExtensions (default true). Backward compatibility: ShowExtensions (old) and HideExtensions (legacy inverse).
+    ini_get_string(ini, L"General", L"ShowFileExtensions", L"", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    BOOL haveShow = buf[0] != 0;
+    BOOL showExt = TRUE; // default
+    if (haveShow) {
+        showExt = (!lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"1"));
+    } else {
+        WCHAR bufOld[32]; bufOld[0]=0;
+        ini_get_string(ini, L"General", L"ShowExtensions", L"", bufOld, ARRAYSIZE(bufOld));
+        trim_inplace(bufOld);
+        if (bufOld[0]) {
+            showExt = (!lstrcmpiW(bufOld, L"true") || !lstrcmpiW(bufOld, L"1"));
+            haveShow = TRUE;
+        }
+    }
+    WCHAR tmpOld[32]; tmpOld[0]=0;
+    ini_get_string(ini, L"General", L"HideExtensions", L"", tmpOld, ARRAYSIZE(tmpOld));
+    trim_inplace(tmpOld);
+    if (tmpOld[0]) {
+        // Old semantics: HideExtensions=true means do NOT show extensions
+        BOOL hideOld = (!lstrcmpiW(tmpOld, L"true") || !lstrcmpiW(tmpOld, L"1"));
+        showExt = !hideOld; // override
+    }
+    out->showExtensions = showExt;
+    // ShowFolderIcons
+    ini_get_string(ini, L"General", L"ShowFolderIcons", L"false", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    out->showFolderIcons = (!lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"1"));
+    // RecentShowExtensions (default true). Back compat: RecentHideExtensions overrides if present.
+    ini_get_string(ini, L"RecentItems", L"RecentShowExtensions", L"", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    BOOL haveRecentShow = buf[0] != 0;
+    BOOL recentShow = TRUE;
+    if (haveRecentShow) {
+        recentShow = (!lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"1"));
+    }
+    WCHAR tmpOldR[32]; tmpOldR[0]=0;
+    ini_get_string(ini, L"RecentItems", L"RecentHideExtensions", L"", tmpOldR, ARRAYSIZE(tmpOldR));
+    trim_inplace(tmpOldR);
+    if (tmpOldR[0]) {
+        BOOL hideOldR = (!lstrcmpiW(tmpOldR, L"true") || !lstrcmpiW(tmpOldR, L"1"));
+        recentShow = !hideOldR;
+    }
+    out->recentShowExtensions = recentShow;
+    // RecentShowCleanItems flag (default true)
+    ini_get_string(ini, L"RecentItems", L"RecentShowCleanItems", L"true", buf, ARRAYSIZE(buf));
+    trim_inplace(buf);
+    out->recentShowCleanItems = (!lstrcmpiW(buf, L"true") || !lstrcmpiW(buf, L"1"));
+    // Themed tray icon optional paths
+    out->trayIconPath[0]=0; out->trayIconPathLight[0]=0; out->trayIconPathDark[0]=0;
+    ini_get_string(ini, L"General", L"TrayIcon", L"", out->trayIconPath, ARRAYSIZE(out->trayIconPath));
+    ini_get_string(ini, L"General", L"TrayIconLight", L"", out->trayIconPathLight, ARRAYSIZE(out->trayIconPathLight));
+    ini_get_string(ini, L"General", L"TrayIconDark", L"", out->trayIconPathDark, ARRAYSIZE(out->trayIconPathDark));
+    if (out->trayIconPath[0]) { WCHAR ex[MAX_PATH]; expand_env(out->trayIconPath, ex, ARRAYSIZE(ex)); lstrcpynW(out->trayIconPath, ex, ARRAYSIZE(out->trayIconPath)); }
+    if (out->trayIconPathLight[0]) { WCHAR ex[MAX_PATH]; expand_env(out->trayIconPathLight, ex, ARRAYSIZE(ex)); lstrcpynW(out->trayIconPathLight, ex, ARRAYSIZE(out->trayIconPathLight)); }
+    if (out->trayIconPathDark[0]) { WCHAR ex[MAX_PATH]; expand_env(out->trayIconPathDark, ex, ARRAYSIZE(ex)); lstrcpynW(out->trayIconPathDark, ex, ARRAYSIZE(out->trayIconPathDark)); }
+    
+    // Parse Control section
+    WCHAR controlBuf[256];
+    ini_get_string(ini, L"Control", L"LeftClick", L"WinMacMenu", controlBuf, ARRAYSIZE(controlBuf));
+    trim_inplace(controlBuf);
+    out->leftClickAction = parse_control_action(controlBuf);
+    
+    ini_get_string(ini, L"Control", L"LeftClickCommand", L"", out->leftClickCommand, ARRAYSIZE(out->leftClickCommand));
+    trim_inplace(out->leftClickCommand);
+    if (out->leftClickCommand[0]) {
+        WCHAR expanded[MAX_PATH];
+        expand_env(out->leftClickCommand, expanded, ARRAYSIZE(expanded));
+        lstrcpynW(out->leftClickCommand, expanded, ARRAYSIZE(out->leftClickCommand));
+    }
+    
+    ini_get_string(ini, L"Control", L"WindowsKey", L"WinMacMenu", controlBuf, ARRAYSIZE(controlBuf));
+    trim_inplace(controlBuf);
+    out->windowsKeyAction = parse_control_action(controlBuf);
+    
+    ini_get_string(ini, L"Control", L"WindowsKeyCommand", L"", out->windowsKeyCommand, ARRAYSIZE(out->windowsKeyCommand));
+    trim_inplace(out->windowsKeyCommand);
+    if (out->windowsKeyCommand[0]) {
+        WCHAR expanded[MAX_PATH];
+        expand_env(out->windowsKeyCommand, expanded, ARRAYSIZE(expanded));
+        lstrcpynW(out->windowsKeyCommand, expanded, ARRAYSIZE(out->windowsKeyCommand));
+    }
+    
+    parse_menu(out, ini);
+    parse_icons(out, ini);
+    // Power menu exclusions (default all FALSE). Support legacy Exclude* keys and new inclusion model.
+    out->excludeSleep = ini_get_int(ini, L"Power", L"ExcludeSleep", 0) ? TRUE : FALSE;
+    out->excludeShutdown = ini_get_int(ini, L"Power", L"ExcludeShutdown", 0) ? TRUE : FALSE;
+    out->excludeRestart = ini_get_int(ini, L"Power", L"ExcludeRestart", 0) ? TRUE : FALSE;
+    out->excludeLock = ini_get_int(ini, L"Power", L"ExcludeLock", 0) ? TRUE : FALSE;
+    out->excludeLogoff = ini_get_int(ini, L"Power", L"ExcludeLogoff", 0) ? TRUE : FALSE;
+    out->excludeHibernate = ini_get_int(ini, L"Power", L"ExcludeHibernate", 0) ? TRUE : FALSE;
+    // New style: only write option when excluded as Name=0; if present with value 0, mark excluded.
+    // If both legacy and new keys exist, new key overrides.
+    if (ini_get_int(ini, L"Power", L"Sleep", 1) == 0) out->excludeSleep = TRUE;
+    if (ini_get_int(ini, L"Power", L"Hibernate", 1) == 0) out->excludeHibernate = TRUE;
+    if (ini_get_int(ini, L"Power", L"Shutdown", 1) == 0) out->excludeShutdown = TRUE;
+    if (ini_get_int(ini, L"Power", L"Restart", 1) == 0) out->excludeRestart = TRUE;
+    if (ini_get_int(ini, L"Power", L"Lock", 1) == 0) out->excludeLock = TRUE;
+    if (ini_get_int(ini, L"Power", L"Logoff", 1) == 0) out->excludeLogoff = TRUE;
+}
@@ -0,0 +1,144 @@
+#include "dircache.h"
+
+#define DIRCACHE_MAX_ENTRIES 64
+#define DIRCACHE_MAX_BYTES (16 * 1024 * 1024)
+
+typedef struct DirCacheEntry {
+    FolderListing* lst;
+    HANDLE watch;        // INVALID_HANDLE_VALUE if the folder cannot be watched (mtime check instead)
+    ULONGLONG lastUse;   // LRU stamp
+    ULONG session;       // last session that handed the listing out
+} DirCacheEntry;
+
+static DirCacheEntry g_entries[DIRCACHE_MAX_ENTRIES];
+static int g_count = 0;
+static ULONGLONG g_clock = 0;
+static ULONG g_session = 1;
+static FolderListing* g_retired = NULL; // dropped while the open menu may still use them
+static DirCacheStats g_stats;
+
+static void release_entry(int i) {
+    DirCacheEntry* e = &g_entries[i];
+    if (e->watch != INVALID_HANDLE_VALUE) FindCloseChangeNotification(e->watch);
+    if (e->session == g_session) {
+        e->lst->next = g_retired;
+        g_retired = e->lst;
+    } else {
+        listing_free(e->lst);
+    }
+    g_entries[i] = g_entries[--g_count];
+}
+
+// Still matches the folder on disk? A signaled watch means something changed since insertion.
+static BOOL entry_is_current(const DirCacheEntry* e) {
+    if (e->watch != INVALID_HANDLE_VALUE) return WaitForSingleObject(e->watch, 0) != WAIT_OBJECT_0;
+    FILETIME now = listing_dir_write_time(e->lst->dir);
+    return CompareFileTime(&now, &e->lst->dirWriteTime) == 0;
+}
+
+static int find_entry(const WCHAR* dir, const ListingOptions* opt) {
+    for (int i = 0; i < g_count; ++i) {
+        const FolderListing* lst = g_entries[i].lst;
+        if (!lstrcmpiW(lst->dir, dir) && !memcmp(&lst->opt, opt, sizeof(*opt))) return i;
+    }
+    return -1;
+}
+
+// Index of a valid entry, dropping it first if the folder changed
+static int find_current(const WCHAR* dir, const ListingOptions* opt) {
+    int i = find_entry(dir, opt);
+    if (i >= 0 && !entry_is_current(&g_entries[i])) {
+        g_stats.invalidations++;
+        release_entry(i);
+        i = -1;
+    }
+    return i;
+}
+
+// Least recently used entry not handed out in the current session, or -1
+static int find_victim(void) {
+    int victim = -1;
+    for (int i = 0; i < g_count; ++i) {
+        if (g_entries[i].session == g_session) continue;
+        if (victim < 0 || g_entries[i].lastUse < g_entries[victim].lastUse) victim = i;
+    }
+    return victim;
+}
+
+FolderListing* dircache_lookup(const WCHAR* dir, const ListingOptions* opt) {
+    int i = find_current(dir, opt);
+    if (i < 0) {
+        g_stats.misses++;
+        return NULL;
+    }
+    g_stats.hits++;
+    g_entries[i].lastUse = ++g_clock;
+    g_entries[i].session = g_session;
+    return g_entries[i].lst;
+}
+
+BOOL dircache_contains(const WCHAR* dir, const ListingOptions* opt) {
+    return find_current(dir, opt) >= 0;
+}
+
+BOOL dircache_insert(FolderListing* lst) {
+    if (!lst || !listing_is_cacheable(lst->dir)) return FALSE;
+    // The listing's watch was opened before it enumerated: if it has fired, the listing is already
+    // stale. Without a watch the stamp taken before enumerating is the only check, so an unreadable
+    // stamp means "don't cache".
+    HANDLE watch = lst->watch;
+    if (watch != INVALID_HANDLE_VALUE) {
+        if (WaitForSingleObject(watch, 0) == WAIT_OBJECT_0) return FALSE;
+    } else {
+        FILETIME now = listing_dir_write_time(lst->dir);
+        BOOL stamped = (lst->dirWriteTime.dwLowDateTime | lst->dirWriteTime.dwHighDateTime) != 0;
+        if (!stamped || CompareFileTime(&now, &lst->dirWriteTime) != 0) return FALSE;
+    }
+
+    int old = find_entry(lst->dir, &lst->opt);
+    if (old >= 0) release_entry(old);
+    if (g_count >= DIRCACHE_MAX_ENTRIES) {
+        int victim = find_victim();
+        if (victim < 0) return FALSE;
+        g_stats.evictions++;
+        release_entry(victim);
+    }
+    DirCacheEntry* e = &g_entries[g_count++];
+    e->lst = lst;
+    e->watch = watch;
+    lst->watch = INVALID_HANDLE_VALUE; // the entry owns the watch now
+    e->lastUse = ++g_clock;
+    e->session = g_session;
+    lst->next = NULL;
+    return TRUE;
+}
+
+void dircache_end_session(void) {
+    while (g_retired) {
+        FolderListing* next = g_retired->next;
+        listing_free(g_retired);
+        g_retired = next;
+    }
+    g_session++;
+    // Listings grow sort keys and sorted prefixes after insertion, so the byte bound is enforced here
+    SIZE_T bytes = 0;
+    for (int i = 0; i < g_count; ++i) bytes += listing_memory(g_entries[i].lst);
+    while (bytes > DIRCACHE_MAX_BYTES) {
+        int victim = find_victim();
+        if (victim < 0) break;
+        bytes -= listing_memory(g_entries[victim].lst);
+        g_stats.evictions++;
+        release_entry(victim);
+    }
+}
+
+void dircache_flush(void) {
+    while (g_count > 0) release_entry(g_count - 1);
+}
+
+void dircache_get_stats(DirCacheStats* out) {
+    *out = g_stats;
+    out->entries = g_count;
+    out->bytes = 0;
+    for (int i = 0; i < g_count; ++i) out->bytes += listing_memory(g_entries[i].lst);
+}
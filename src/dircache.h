@@ -0,0 +1,38 @@
+#pragma once
+#include <windows.h>
+#include "listing.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// In-process cache of folder listings keyed by (path, listing options). Each entry watches its
+// folder with a change notification and is dropped as soon as the folder changes. Bounded by
+// entry count and bytes, least recently used first. Folders on removable, optical and network
+// volumes are not cached (listing_is_cacheable). UI thread only.
+
+typedef struct DirCacheStats {
+    ULONG hits;
+    ULONG misses;
+    ULONG invalidations; // dropped because the folder changed
+    ULONG evictions;     // dropped to stay within bounds
+    int entries;
+    SIZE_T bytes;
+} DirCacheStats;
+
+// Returns the cached listing or NULL. The listing stays owned by the cache and remains valid
+// until dircache_end_session, even if the folder changes in the meantime.
+FolderListing* dircache_lookup(const WCHAR* dir, const ListingOptions* opt);
+// TRUE if a valid listing is cached (no hit/miss accounting)
+BOOL dircache_contains(const WCHAR* dir, const ListingOptions* opt);
+// Hands lst to the cache; FALSE if it was not taken (caller keeps ownership)
+BOOL dircache_insert(FolderListing* lst);
+// Called when the menu closes: frees retired listings and trims to the size bound
+void dircache_end_session(void);
+// Drops every entry (e.g. after the config changed)
+void dircache_flush(void);
+void dircache_get_stats(DirCacheStats* out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,430 @@
+#include "iconcache.h"
+#include <shlobj.h>
+#include <shlwapi.h>
+
+typedef struct IconEntry {
+    DWORD hash;
+    WORD size;
+    BYTE kind;
+    BYTE dark;
+    ULONGLONG srcWrite;
+    HICON icon;          // NULL when nothing could be extracted (not retried this process)
+    HBITMAP bmp;         // premultiplied 32-bpp menu bitmap of icon, made on first request
+    DWORD* pixels;       // rasterized image not yet handed to a pack write
+    ULONGLONG lastUse;   // LRU stamp
+    ULONG session;       // last session the icon was handed out in
+    WCHAR* source;
+} IconEntry;
+
+static IconEntry* g_entries = NULL;
+static int g_count = 0, g_cap = 0;
+static ULONGLONG g_clock = 0;
+static ULONG g_session = 1;
+static int g_dirty = 0;              // entries holding pixels that are not in the pack yet
+static int g_bitmaps = 0;            // entries holding a menu bitmap
+static LONG g_themeGen = 0;          // theme generation the in-memory icons were rendered for
+typedef struct Retired { HICON icon; HBITMAP bmp; } Retired;
+static Retired* g_retired = NULL;    // replaced or uncached icons/bitmaps still in use by the open menu
+static int g_retiredCount = 0, g_retiredCap = 0;
+static IconCacheStats g_stats;
+
+static BOOL g_packTried = FALSE;
+static HANDLE g_packFile = INVALID_HANDLE_VALUE;
+static HANDLE g_packMap = NULL;
+static IconPackView g_pack;
+static BYTE* g_packUsed = NULL;      // per pack entry: served this process (kept first when trimming)
+
+// A pack write handed to a worker. The UI thread fills it and owns it again once done is
+// signaled; meanwhile the worker only reads items (fresh images owned here, the rest pointing
+// into the mapped pack, which stays open until the write is installed) and writes tmp.
+typedef struct PackWrite {
+    HANDLE done;
+    IconPackItem* items;
+    int count;
+    DWORD** pixels;      // fresh images
+    int fresh;
+    WCHAR* names;        // fresh names, one block
+    BOOL ok;             // worker: tmp written completely
+    WCHAR path[MAX_PATH];
+    WCHAR tmp[MAX_PATH + 8];
+} PackWrite;
+static PackWrite* g_write = NULL;
+static ULONGLONG g_lastWrite = 0;    // GetTickCount64 when the last write started
+
+// ---- Pack (level 2) ----
+
+static BOOL pack_path(WCHAR* out, BOOL create) {
+    if (FAILED(SHGetFolderPathW(NULL, CSIDL_LOCAL_APPDATA, NULL, SHGFP_TYPE_CURRENT, out))) return FALSE;
+    if (!PathAppendW(out, L"WinMacMenu")) return FALSE;
+    if (create) {
+        int rc = SHCreateDirectoryExW(NULL, out, NULL);
+        if (rc != ERROR_SUCCESS && rc != ERROR_ALREADY_EXISTS) return FALSE;
+    }
+    return PathAppendW(out, L"icons.bin");
+}
+
+static void pack_close(void) {
+    if (g_pack.base) UnmapViewOfFile(g_pack.base);
+    if (g_packMap) CloseHandle(g_packMap);
+    if (g_packFile != INVALID_HANDLE_VALUE) CloseHandle(g_packFile);
+    if (g_packUsed) LocalFree(g_packUsed);
+    ZeroMemory(&g_pack, sizeof(g_pack));
+    g_packMap = NULL; g_packFile = INVALID_HANDLE_VALUE; g_packUsed = NULL;
+    g_packTried = FALSE;
+}
+
+// Maps the pack once per process (again after it was rewritten); a missing or foreign file is ignored
+static void pack_open(void) {
+    if (g_packTried) return;
+    g_packTried = TRUE;
+    WCHAR path[MAX_PATH];
+    if (!pack_path(path, FALSE)) return;
+    HANDLE f = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (f == INVALID_HANDLE_VALUE) return;
+    LARGE_INTEGER len;
+    HANDLE map = NULL;
+    const BYTE* base = NULL;
+    IconPackView view;
+    if (GetFileSizeEx(f, &len) && len.QuadPart >= (LONGLONG)sizeof(IconPackHeader) && len.QuadPart <= ICONPACK_MAX_BYTES) {
+        map = CreateFileMappingW(f, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (map) base = (const BYTE*)MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+    }
+    if (!base || !iconpack_parse(&view, base, (SIZE_T)len.QuadPart) ||
+        !(g_packUsed = (BYTE*)LocalAlloc(LMEM_FIXED|LMEM_ZEROINIT, view.count ? view.count : 1))) {
+        if (base) UnmapViewOfFile(base);
+        if (map) CloseHandle(map);
+        CloseHandle(f);
+        return;
+    }
+    g_packFile = f;
+    g_packMap = map;
+    g_pack = view;
+}
+
+static BOOL write_all(HANDLE f, const void* data, DWORD len) {
+    DWORD written = 0;
+    return WriteFile(f, data, len, &written, NULL) && written == len;
+}
+
+static VOID CALLBACK pack_write_worker(PTP_CALLBACK_INSTANCE instance, PVOID context) {
+    (void)instance;
+    PackWrite* w = (PackWrite*)context;
+    SIZE_T len = 0;
+    BYTE* buf = iconpack_build(w->items, w->count, &len);
+    if (buf) {
+        HANDLE f = CreateFileW(w->tmp, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (f != INVALID_HANDLE_VALUE) {
+            w->ok = write_all(f, buf, (DWORD)len);
+            CloseHandle(f);
+            if (!w->ok) DeleteFileW(w->tmp);
+        }
+        LocalFree(buf);
+    }
+    SetEvent(w->done); // the write belongs to the UI thread again
+}
+
+static void free_write(PackWrite* w) {
+    for (int i = 0; i < w->fresh; ++i) LocalFree(w->pixels[i]);
+    if (w->pixels) LocalFree(w->pixels);
+    if (w->items) LocalFree(w->items);
+    if (w->names) LocalFree(w->names);
+    if (w->done) CloseHandle(w->done);
+    LocalFree(w);
+}
+
+// Installs a finished write: the mapped pack is closed so the file can be replaced, and is mapped
+// again on the next lookup. FALSE if the worker is still writing (wait FALSE).
+static BOOL write_finish(BOOL wait) {
+    if (!g_write) return TRUE;
+    if (WaitForSingleObject(g_write->done, wait ? INFINITE : 0) != WAIT_OBJECT_0) return FALSE;
+    if (g_write->ok) {
+        pack_close();
+        if (MoveFileExW(g_write->tmp, g_write->path, MOVEFILE_REPLACE_EXISTING)) g_stats.packWrites++;
+        else DeleteFileW(g_write->tmp);
+    }
+    free_write(g_write);
+    g_write = NULL;
+    return TRUE;
+}
+
+// Stops carrying images that cannot be written
+static void drop_pending(void) {
+    for (int i = 0; i < g_count; ++i) {
+        if (g_entries[i].pixels) { LocalFree(g_entries[i].pixels); g_entries[i].pixels = NULL; }
+    }
+    g_dirty = 0;
+}
+
+// Hands the pending images to a worker that writes them merged with the current pack. Newest
+// images are kept first, then pack images served this process, then the rest, up to
+// ICONPACK_MAX_ENTRIES. Only the merge runs here; building and writing the file do not.
+static void write_start(void) {
+    if (g_write || g_dirty == 0) return;
+    pack_open();
+    g_lastWrite = GetTickCount64();
+    int fresh = g_dirty < ICONPACK_MAX_ENTRIES ? g_dirty : ICONPACK_MAX_ENTRIES;
+    SIZE_T chars = 0;
+    for (int i = 0; i < g_count; ++i) {
+        if (g_entries[i].pixels) chars += (SIZE_T)lstrlenW(g_entries[i].source) + 1;
+    }
+    PackWrite* w = (PackWrite*)LocalAlloc(LMEM_FIXED|LMEM_ZEROINIT, sizeof(PackWrite));
+    if (w) {
+        w->done = CreateEventW(NULL, TRUE, FALSE, NULL);
+        w->items = (IconPackItem*)LocalAlloc(LMEM_FIXED|LMEM_ZEROINIT, ((SIZE_T)fresh + g_pack.count + 1) * sizeof(IconPackItem));
+        w->pixels = (DWORD**)LocalAlloc(LMEM_FIXED, (SIZE_T)fresh * sizeof(DWORD*));
+        w->names = (WCHAR*)LocalAlloc(LMEM_FIXED, chars * sizeof(WCHAR));
+    }
+    if (!w || !w->done || !w->items || !w->pixels || !w->names || !pack_path(w->path, TRUE)) {
+        if (w) free_write(w);
+        drop_pending();
+        return;
+    }
+    wsprintfW(w->tmp, L"%s.tmp", w->path);
+    WCHAR* name = w->names;
+    for (int i = 0; i < g_count; ++i) {
+        IconEntry* e = &g_entries[i];
+        if (!e->pixels) continue;
+        if (w->fresh == fresh) { LocalFree(e->pixels); e->pixels = NULL; continue; }
+        IconPackItem* it = &w->items[w->fresh];
+        it->e.hash = e->hash; it->e.size = e->size; it->e.kind = e->kind; it->e.dark = e->dark;
+        it->e.srcWrite = e->srcWrite;
+        it->e.nameLen = (DWORD)lstrlenW(e->source);
+        lstrcpyW(name, e->source);
+        it->name = name;
+        name += it->e.nameLen + 1;
+        it->pixels = e->pixels;
+        w->pixels[w->fresh++] = e->pixels;
+        e->pixels = NULL;
+    }
+    g_dirty = 0;
+    w->count = iconpack_merge(w->items, w->fresh, &g_pack, g_packUsed);
+    g_write = w;
+    if (!TrySubmitThreadpoolCallback(pack_write_worker, w, NULL)) pack_write_worker(NULL, w); // no pool: write inline
+}
+
+// ---- Memory (level 1) ----
+
+static void destroy_retired(const IconRenderer* r, const Retired* d) {
+    if (d->icon) r->destroyIcon(d->icon);
+    if (d->bmp) r->deleteBitmap(d->bmp);
+}
+
+// Defers destruction to the end of the session
+static void retire(const IconRenderer* r, HICON icon, HBITMAP bmp) {
+    Retired d = { icon, bmp };
+    if (!icon && !bmp) return;
+    if (g_retiredCount == g_retiredCap) {
+        int cap = g_retiredCap ? g_retiredCap * 2 : 16;
+        Retired* grown = (Retired*)LocalAlloc(LMEM_FIXED, cap * sizeof(Retired));
+        if (!grown) { destroy_retired(r, &d); return; } // rather a missing icon than a leak
+        if (g_retired) {
+            memcpy(grown, g_retired, g_retiredCount * sizeof(Retired));
+            LocalFree(g_retired);
+        }
+        g_retired = grown;
+        g_retiredCap = cap;
+    }
+    g_retired[g_retiredCount++] = d;
+}
+
+static void release_entry(const IconRenderer* r, IconEntry* e) {
+    if (e->bmp) g_bitmaps--;
+    if (e->session == g_session) {
+        retire(r, e->icon, e->bmp);
+    } else {
+        if (e->icon) r->destroyIcon(e->icon);
+        if (e->bmp) r->deleteBitmap(e->bmp);
+    }
+    if (e->pixels) { LocalFree(e->pixels); g_dirty--; }
+    if (e->source) LocalFree(e->source);
+    ZeroMemory(e, sizeof(*e));
+}
+
+static IconEntry* find_entry(DWORD hash, int size, BYTE kind, BOOL dark, const WCHAR* source) {
+    for (int i = 0; i < g_count; ++i) {
+        IconEntry* e = &g_entries[i];
+        if (iconpack_same_key(hash, size, kind, dark, source, e->hash, e->size, e->kind, e->dark, e->source)) return e;
+    }
+    return NULL;
+}
+
+// Slot for a new entry: grows the table, else reuses the least recently used entry that the
+// open menu is not drawing with. NULL if every entry is in use.
+static IconEntry* new_entry(const IconRenderer* r) {
+    if (g_count == g_cap && g_cap < ICONCACHE_MAX_ENTRIES) {
+        int cap = g_cap ? g_cap * 2 : 64;
+        IconEntry* grown = (IconEntry*)LocalAlloc(LMEM_FIXED|LMEM_ZEROINIT, cap * sizeof(IconEntry));
+        if (grown) {
+            if (g_entries) {
+                memcpy(grown, g_entries, g_count * sizeof(IconEntry));
+                LocalFree(g_entries);
+            }
+            g_entries = grown;
+            g_cap = cap;
+        }
+    }
+    if (g_count < g_cap) return &g_entries[g_count++];
+    IconEntry* victim = NULL;
+    for (int i = 0; i < g_count; ++i) {
+        if (g_entries[i].session == g_session) continue;
+        if (!victim || g_entries[i].lastUse < victim->lastUse) victim = &g_entries[i];
+    }
+    if (victim) release_entry(r, victim);
+    return victim;
+}
+
+// Frees every in-memory icon and bitmap (those on screen are retired until the menu closes).
+// Pending images go to a pack write first; if one is still running they are dropped and
+// rasterized again when next needed.
+static void release_graphics(const IconRenderer* r) {
+    write_finish(FALSE);
+    write_start();
+    for (int i = 0; i < g_count; ++i) release_entry(r, &g_entries[i]);
+    g_count = 0;
+}
+
+HICON iconcache_lookup(const IconRenderer* r, BYTE kind, const WCHAR* source, int size, BOOL dark) {
+    if (!source || !source[0] || size <= 0 || size > ICON_MAX_SIZE) return NULL;
+    DWORD hash = iconpack_hash(kind, size, dark, source);
+    IconEntry* e = find_entry(hash, size, kind, dark, source);
+    ULONGLONG srcWrite = 0;
+    BOOL stamped = FALSE;
+    if (e && kind == IK_FILE) {
+        // Shell icons of files (executables, .ico, shortcuts) follow their content
+        srcWrite = r->sourceWriteTime(kind, source);
+        stamped = TRUE;
+        if (srcWrite != e->srcWrite) {
+            release_entry(r, e);
+            *e = g_entries[--g_count];
+            e = NULL;
+        }
+    }
+    if (e) {
+        g_stats.hits++;
+        e->lastUse = ++g_clock;
+        e->session = g_session;
+        return e->icon;
+    }
+
+    if (!stamped) srcWrite = r->sourceWriteTime(kind, source);
+    HICON icon = NULL;
+    DWORD* pixels = NULL;
+    pack_open();
+    int pi = iconpack_find(&g_pack, hash, size, kind, dark, source);
+    if (pi >= 0 && g_pack.entries[pi].srcWrite == srcWrite) {
+        const DWORD* px = iconpack_pixels(&g_pack, &g_pack.entries[pi]);
+        if (px) icon = r->iconFromPixels(px, size);
+        if (icon) {
+            g_packUsed[pi] = 1;
+            g_stats.packHits++;
+        }
+    }
+    if (!icon) {
+        g_stats.misses++;
+        HICON raw = r->extract(kind, source, size);
+        if (raw) {
+            pixels = r->rasterize(raw, size);
+            r->destroyIcon(raw);
+            if (pixels) icon = r->iconFromPixels(pixels, size);
+            if (!icon && pixels) { LocalFree(pixels); pixels = NULL; }
+        }
+    }
+
+    WCHAR* copy = (WCHAR*)LocalAlloc(LMEM_FIXED, (lstrlenW(source) + 1) * sizeof(WCHAR));
+    e = copy ? new_entry(r) : NULL;
+    if (!e) {
+        // Not cached: hand the icon out anyway and destroy it when the menu closes
+        if (copy) LocalFree(copy);
+        if (pixels) LocalFree(pixels);
+        retire(r, icon, NULL);
+        return icon;
+    }
+    lstrcpyW(copy, source);
+    e->hash = hash;
+    e->size = (WORD)size;
+    e->kind = kind;
+    e->dark = dark ? 1 : 0;
+    e->srcWrite = srcWrite;
+    e->icon = icon;
+    e->pixels = pixels;
+    e->lastUse = ++g_clock;
+    e->session = g_session;
+    e->source = copy;
+    if (pixels) g_dirty++;
+    return icon;
+}
+
+HBITMAP iconcache_lookup_bitmap(const IconRenderer* r, HICON icon) {
+    if (!icon) return NULL;
+    IconEntry* e = NULL;
+    for (int i = 0; i < g_count && !e; ++i) {
+        if (g_entries[i].icon == icon) e = &g_entries[i];
+    }
+    if (!e) return NULL;
+    if (!e->bmp) {
+        // Menus alpha-blend item bitmaps, so store premultiplied colors
+        DWORD* px = r->rasterize(icon, e->size);
+        if (!px) return NULL;
+        for (int i = 0, n = e->size * e->size; i < n; ++i) {
+            DWORD p = px[i], a = p >> 24;
+            if (a == 255 || a == 0) { px[i] = a ? p : 0; continue; }
+            px[i] = (a << 24) | ((((p >> 16) & 0xFF) * a / 255) << 16) | ((((p >> 8) & 0xFF) * a / 255) << 8) | ((p & 0xFF) * a / 255);
+        }
+        e->bmp = r->bitmapFromPixels(px, e->size);
+        if (e->bmp) g_bitmaps++;
+        LocalFree(px);
+    }
+    e->lastUse = ++g_clock;
+    e->session = g_session;
+    return e->bmp;
+}
+
+// Drops in-memory icons and bitmaps once the theme or DPI changed (the pack is keyed by size
+// and theme, so it stays valid)
+void iconcache_session_begin(const IconRenderer* r, LONG themeGen) {
+    if (themeGen == g_themeGen) return;
+    if (g_themeGen) release_graphics(r);
+    g_themeGen = themeGen;
+}
+
+void iconcache_session_end(const IconRenderer* r) {
+    for (int i = 0; i < g_retiredCount; ++i) destroy_retired(r, &g_retired[i]);
+    g_retiredCount = 0;
+    g_session++;
+    write_finish(FALSE);
+    if (g_dirty >= ICONCACHE_WRITE_PENDING) write_start();
+}
+
+void iconcache_idle(ULONGLONG now) {
+    write_finish(FALSE);
+    if (g_dirty && now >= g_lastWrite + ICONCACHE_WRITE_IDLE_MS) write_start();
+}
+
+void iconcache_flush(void) {
+    write_finish(TRUE);
+    write_start();
+    write_finish(TRUE);
+}
+
+void iconcache_get_stats(IconCacheStats* out) {
+    *out = g_stats;
+    out->entries = g_count;
+    out->packEntries = (int)g_pack.count;
+    out->bitmaps = g_bitmaps;
+    out->pending = g_dirty;
+}
+
+void iconcache_reset(const IconRenderer* r) {
+    iconcache_flush();
+    g_session++; // nothing is on screen any more
+    for (int i = 0; i < g_count; ++i) release_entry(r, &g_entries[i]);
+    for (int i = 0; i < g_retiredCount; ++i) destroy_retired(r, &g_retired[i]);
+    if (g_entries) LocalFree(g_entries);
+    if (g_retired) LocalFree(g_retired);
+    g_entries = NULL; g_retired = NULL;
+    g_count = g_cap = g_retiredCount = g_retiredCap = 0;
+    g_dirty = 0;
+    g_bitmaps = 0;
+    g_themeGen = 0;
+    pack_close();
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <windows.h>
+#include "iconpack.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Two-level cache of menu icons keyed by (source, pixel size, theme). Level 1 holds ready HICONs
+// in memory (LRU); level 2 is a pack of pre-rasterized 32-bpp images in
+// %LOCALAPPDATA%\WinMacMenu\icons.bin (iconpack.h), memory-mapped on first use, so a warm start
+// extracts nothing. Entries remember the source file's write time and are re-extracted when it
+// changes. In-memory icons and bitmaps are dropped when a menu build starts under a new theme
+// generation. Newly rasterized images are written to the pack in batches on a worker thread.
+// The cache is portable; icons and bitmaps are made through an IconRenderer (iconcache_win32.h
+// supplies the GDI one). UI thread only.
+
+#define ICONCACHE_MAX_ENTRIES 512
+// A closing menu starts a pack write once this many new images are pending
+#define ICONCACHE_WRITE_PENDING 32
+// Otherwise pending images are written when idle, at most this often, and on exit
+#define ICONCACHE_WRITE_IDLE_MS 60000
+
+typedef struct IconRenderer {
+    // Icon straight from the source: IK_SPEC "file.ico" or "module.dll,index", IK_FILE shell icon
+    HICON (*extract)(BYTE kind, const WCHAR* source, int size);
+    // Last-write time the image follows, 0 if not tracked
+    ULONGLONG (*sourceWriteTime)(BYTE kind, const WCHAR* source);
+    // size*size BGRA with straight alpha (LocalAlloc'd), NULL on failure
+    DWORD* (*rasterize)(HICON icon, int size);
+    HICON (*iconFromPixels)(const DWORD* pixels, int size);
+    // 32-bpp menu bitmap from premultiplied BGRA
+    HBITMAP (*bitmapFromPixels)(const DWORD* premultiplied, int size);
+    void (*destroyIcon)(HICON icon);
+    void (*deleteBitmap)(HBITMAP bmp);
+} IconRenderer;
+
+typedef struct IconCacheStats {
+    ULONG hits;      // served from memory
+    ULONG packHits;  // rasterized image taken from the pack
+    ULONG misses;    // extracted from the source
+    ULONG packWrites;
+    int entries;
+    int packEntries;
+    int bitmaps;     // menu bitmaps held for cached icons
+    int pending;     // rasterized images not written to the pack yet
+} IconCacheStats;
+
+// Icon for source, owned by the cache; NULL if nothing could be loaded
+HICON iconcache_lookup(const IconRenderer* r, BYTE kind, const WCHAR* source, int size, BOOL dark);
+// Menu item bitmap for an icon returned by this cache, made once and reused across popups; owned
+// by the cache. NULL if icon did not come from the cache.
+HBITMAP iconcache_lookup_bitmap(const IconRenderer* r, HICON icon);
+// A menu build starts: drops in-memory icons and bitmaps if themeGen differs from the last build
+void iconcache_session_begin(const IconRenderer* r, LONG themeGen);
+// The menu closed: icons handed out become evictable again, retired ones are destroyed, and a
+// pack write starts if ICONCACHE_WRITE_PENDING images are waiting
+void iconcache_session_end(const IconRenderer* r);
+// Idle time (now in ms): starts a pack write for pending images if the last one is
+// ICONCACHE_WRITE_IDLE_MS old, and installs a finished one
+void iconcache_idle(ULONGLONG now);
+// Writes pending images and waits for the pack to be replaced (exit)
+void iconcache_flush(void);
+void iconcache_get_stats(IconCacheStats* out);
+// Writes pending images, destroys every cached icon and unmaps the pack
+void iconcache_reset(const IconRenderer* r);
+
+#ifdef __cplusplus
+}
+#endif
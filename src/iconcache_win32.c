@@ -0,0 +1,208 @@
+#include "iconcache_win32.h"
+#include "theme.h"
+#include <shellapi.h>
+#include <shlwapi.h>
+#include <stdlib.h> // _wtoi
+
+static ULONGLONG file_write_time(const WCHAR* path, BOOL dirsToo) {
+    WIN32_FILE_ATTRIBUTE_DATA fad;
+    if (!GetFileAttributesExW(path, GetFileExInfoStandard, &fad)) return 0;
+    if (!dirsToo && (fad.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) return 0; // changes with every file inside
+    return ((ULONGLONG)fad.ftLastWriteTime.dwHighDateTime << 32) | fad.ftLastWriteTime.dwLowDateTime;
+}
+
+// Splits "module,index" into a full module path; FALSE for a plain .ico path
+static BOOL resolve_spec(const WCHAR* spec, WCHAR* module, int* index) {
+    const WCHAR* comma = wcschr(spec, L',');
+    if (!comma) return FALSE;
+    size_t len = (size_t)(comma - spec);
+    if (len >= MAX_PATH) len = MAX_PATH - 1;
+    for (size_t i = 0; i < len; i++) module[i] = spec[i];
+    module[len] = 0;
+    *index = _wtoi(comma + 1); // handles negative values (resource IDs)
+    // If no backslash at all, assume System32 for bare module names like 'shell32.dll'.
+    if (!wcschr(module, L'\\')) {
+        WCHAR combined[MAX_PATH];
+        if (GetSystemDirectoryW(combined, ARRAYSIZE(combined))) {
+            PathAppendW(combined, module);
+            lstrcpynW(module, combined, MAX_PATH);
+        }
+    }
+    WCHAR expanded[MAX_PATH];
+    if (ExpandEnvironmentStringsW(module, expanded, ARRAYSIZE(expanded)) && expanded[0]) {
+        lstrcpynW(module, expanded, MAX_PATH);
+    }
+    return TRUE;
+}
+
+static ULONGLONG source_write_time(BYTE kind, const WCHAR* source) {
+    if (kind == IK_FILE) return file_write_time(source, FALSE);
+    WCHAR module[MAX_PATH];
+    int index;
+    return file_write_time(resolve_spec(source, module, &index) ? module : source, TRUE);
+}
+
+// Accepted forms:
+//   C:\Windows\System32\shell32.dll,10
+//   shell32.dll,10            (searches System32)
+//   imageres.dll,-3           (negative index still passed through; Windows treats as resource ID)
+//   C:\icons\app.ico
+static HICON extract_spec(const WCHAR* spec, int size) {
+    WCHAR module[MAX_PATH];
+    int index;
+    if (resolve_spec(spec, module, &index)) {
+        HICON hSmall = NULL, hLarge = NULL;
+        if (ExtractIconExW(module, index, &hLarge, &hSmall, 1) > 0) {
+            if (hLarge) DestroyIcon(hLarge);
+            if (hSmall) return hSmall;
+        }
+    }
+    return (HICON)LoadImageW(NULL, spec, IMAGE_ICON, size, size, LR_LOADFROMFILE);
+}
+
+static HICON extract_file(const WCHAR* path) {
+    SHFILEINFOW sfi = {0};
+    if (SHGetFileInfoW(path, 0, &sfi, sizeof(sfi), SHGFI_ICON | SHGFI_SMALLICON)) return sfi.hIcon;
+    return NULL;
+}
+
+static void init_bitmap_info(BITMAPINFO* bmi, int size) {
+    ZeroMemory(bmi, sizeof(*bmi));
+    bmi->bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi->bmiHeader.biWidth = size;
+    bmi->bmiHeader.biHeight = -size; // top-down
+    bmi->bmiHeader.biPlanes = 1;
+    bmi->bmiHeader.biBitCount = 32;
+    bmi->bmiHeader.biCompression = BI_RGB;
+}
+
+// Renders hico at size x size into straight-alpha BGRA (LocalAlloc'd)
+static DWORD* rasterize_icon(HICON hico, int size) {
+    int n = size * size;
+    DWORD* out = (DWORD*)LocalAlloc(LMEM_FIXED, n * sizeof(DWORD));
+    if (!out) return NULL;
+    BITMAPINFO bmi;
+    init_bitmap_info(&bmi, size);
+    void* bits = NULL;
+    HDC screen = GetDC(NULL);
+    HBITMAP dib = CreateDIBSection(screen, &bmi, DIB_RGB_COLORS, &bits, NULL, 0);
+    HDC mem = dib ? CreateCompatibleDC(screen) : NULL;
+    BOOL ok = FALSE;
+    if (mem) {
+        HGDIOBJ old = SelectObject(mem, dib);
+        DWORD* px = (DWORD*)bits;
+        ZeroMemory(px, n * sizeof(DWORD));
+        if (DrawIconEx(mem, 0, 0, hico, size, size, 0, NULL, DI_NORMAL)) {
+            GdiFlush();
+            BOOL hasAlpha = FALSE;
+            for (int i = 0; i < n && !hasAlpha; ++i) hasAlpha = (px[i] >> 24) != 0;
+            if (hasAlpha) {
+                // Blended onto black, so colors come back premultiplied; icons want straight alpha
+                for (int i = 0; i < n; ++i) {
+                    DWORD p = px[i], a = p >> 24;
+                    if (a == 0) { out[i] = 0; continue; }
+                    if (a == 255) { out[i] = p; continue; }
+                    DWORD r = ((p >> 16) & 0xFF) * 255 / a, g = ((p >> 8) & 0xFF) * 255 / a, b = (p & 0xFF) * 255 / a;
+                    if (r > 255) r = 255;
+                    if (g > 255) g = 255;
+                    if (b > 255) b = 255;
+                    out[i] = (a << 24) | (r << 16) | (g << 8) | b;
+                }
+                ok = TRUE;
+            } else {
+                // Legacy icon without alpha: coverage comes from the AND mask (white = transparent)
+                CopyMemory(out, px, n * sizeof(DWORD));
+                for (int i = 0; i < n; ++i) px[i] = 0x00FFFFFF;
+                if (DrawIconEx(mem, 0, 0, hico, size, size, 0, NULL, DI_MASK)) {
+                    GdiFlush();
+                    for (int i = 0; i < n; ++i) out[i] = ((px[i] & 0xFF) >= 0x80) ? 0 : (out[i] | 0xFF000000);
+                    ok = TRUE;
+                }
+            }
+        }
+        SelectObject(mem, old);
+        DeleteDC(mem);
+    }
+    if (dib) DeleteObject(dib);
+    ReleaseDC(NULL, screen);
+    if (!ok) {
+        LocalFree(out);
+        return NULL;
+    }
+    return out;
+}
+
+static HICON icon_from_pixels(const DWORD* px, int size) {
+    BITMAPINFO bmi;
+    init_bitmap_info(&bmi, size);
+    void* bits = NULL;
+    HDC screen = GetDC(NULL);
+    HBITMAP color = CreateDIBSection(screen, &bmi, DIB_RGB_COLORS, &bits, NULL, 0);
+    ReleaseDC(NULL, screen);
+    if (!color) return NULL;
+    CopyMemory(bits, px, (SIZE_T)size * size * sizeof(DWORD));
+    // All-opaque AND mask; the alpha channel decides transparency
+    BYTE* maskBits = (BYTE*)LocalAlloc(LMEM_FIXED|LMEM_ZEROINIT, ((size + 15) / 16) * 2 * size);
+    HBITMAP mask = maskBits ? CreateBitmap(size, size, 1, 1, maskBits) : NULL;
+    HICON icon = NULL;
+    if (mask) {
+        ICONINFO ii = { TRUE, 0, 0, mask, color };
+        icon = CreateIconIndirect(&ii);
+        DeleteObject(mask);
+    }
+    if (maskBits) LocalFree(maskBits);
+    DeleteObject(color);
+    return icon;
+}
+
+// Menu bitmap from premultiplied pixels
+static HBITMAP bitmap_from_pixels(const DWORD* px, int size) {
+    BITMAPINFO bmi;
+    init_bitmap_info(&bmi, size);
+    void* bits = NULL;
+    HDC screen = GetDC(NULL);
+    HBITMAP bmp = CreateDIBSection(screen, &bmi, DIB_RGB_COLORS, &bits, NULL, 0);
+    ReleaseDC(NULL, screen);
+    if (bmp) CopyMemory(bits, px, (SIZE_T)size * size * sizeof(DWORD));
+    return bmp;
+}
+
+static HICON extract(BYTE kind, const WCHAR* source, int size) {
+    return kind == IK_SPEC ? extract_spec(source, size) : extract_file(source);
+}
+
+static void destroy_icon(HICON icon) {
+    DestroyIcon(icon);
+}
+
+static void delete_bitmap(HBITMAP bmp) {
+    DeleteObject(bmp);
+}
+
+static const IconRenderer g_gdiRenderer = {
+    extract, source_write_time, rasterize_icon, icon_from_pixels, bitmap_from_pixels, destroy_icon, delete_bitmap
+};
+
+HICON iconcache_get_spec(const WCHAR* spec, int size, BOOL dark) {
+    return iconcache_lookup(&g_gdiRenderer, IK_SPEC, spec, size, dark);
+}
+
+HICON iconcache_get_file(const WCHAR* path, int size, BOOL dark) {
+    return iconcache_lookup(&g_gdiRenderer, IK_FILE, path, size, dark);
+}
+
+HBITMAP iconcache_get_bitmap(HICON icon) {
+    return iconcache_lookup_bitmap(&g_gdiRenderer, icon);
+}
+
+void iconcache_begin_session(void) {
+    iconcache_session_begin(&g_gdiRenderer, theme_generation());
+}
+
+void iconcache_end_session(void) {
+    iconcache_session_end(&g_gdiRenderer);
+}
+
+void iconcache_clear(void) {
+    iconcache_reset(&g_gdiRenderer);
+}
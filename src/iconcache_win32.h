@@ -0,0 +1,29 @@
+#pragma once
+#include <windows.h>
+#include "iconcache.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The icon cache drawn through ExtractIconEx, SHGetFileInfo and GDI
+
+// Icon for an icon spec: "file.ico" or "module.dll,index" (bare module names resolve to System32,
+// environment variables are expanded). Owned by the cache; NULL if nothing could be loaded.
+HICON iconcache_get_spec(const WCHAR* spec, int size, BOOL dark);
+// Shell small icon for a file or folder. Owned by the cache; NULL if none.
+HICON iconcache_get_file(const WCHAR* path, int size, BOOL dark);
+// Premultiplied 32-bpp menu item bitmap for an icon returned by this cache, made once and reused
+// across popups; owned by the cache. NULL if icon did not come from the cache.
+HBITMAP iconcache_get_bitmap(HICON icon);
+// Called when a menu build starts: the theme is checked here, never in the middle of a build,
+// so icons handed out earlier in the build keep their bitmaps
+void iconcache_begin_session(void);
+// Called when the menu closes: icons handed out become evictable again
+void iconcache_end_session(void);
+// Writes pending images, destroys every cached icon and unmaps the pack
+void iconcache_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
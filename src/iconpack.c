@@ -0,0 +1,126 @@
+#include "iconpack.h"
+#include <stdlib.h> // qsort
+
+// Same folding as lstrcmpiW; towlower only maps A-Z in the C runtime's default locale
+static WCHAR fold(WCHAR c) {
+    if (c < 0x80) return (c >= L'A' && c <= L'Z') ? (WCHAR)(c + 32) : c;
+    return (WCHAR)(ULONG_PTR)CharLowerW((LPWSTR)(ULONG_PTR)c);
+}
+
+DWORD iconpack_hash(BYTE kind, int size, BOOL dark, const WCHAR* s) {
+    DWORD h = 2166136261u;
+    for (; *s; ++s) { h ^= fold(*s); h *= 16777619u; }
+    h ^= (DWORD)size | ((DWORD)kind << 16) | ((DWORD)(dark ? 1 : 0) << 24);
+    h *= 16777619u;
+    return h;
+}
+
+BOOL iconpack_same_key(DWORD hash, int size, BYTE kind, BOOL dark, const WCHAR* a,
+                       DWORD hash2, int size2, BYTE kind2, BOOL dark2, const WCHAR* b) {
+    return hash == hash2 && size == size2 && kind == kind2 && !dark == !dark2 && lstrcmpiW(a, b) == 0;
+}
+
+BOOL iconpack_parse(IconPackView* out, const BYTE* base, SIZE_T len) {
+    ZeroMemory(out, sizeof(*out));
+    if (!base || len < sizeof(IconPackHeader) || len > ICONPACK_MAX_BYTES) return FALSE;
+    const IconPackHeader* h = (const IconPackHeader*)base;
+    if (h->magic != ICONPACK_MAGIC || h->version != ICONPACK_VERSION || h->count > ICONPACK_MAX_ENTRIES) return FALSE;
+    if (sizeof(IconPackHeader) + (SIZE_T)h->count * sizeof(IconPackEntry) > len) return FALSE;
+    out->base = base;
+    out->len = len;
+    out->entries = (const IconPackEntry*)(base + sizeof(IconPackHeader));
+    out->count = h->count;
+    return TRUE;
+}
+
+const WCHAR* iconpack_name(const IconPackView* pack, const IconPackEntry* pe) {
+    if ((pe->nameOffset & 1) || pe->nameLen >= 32768) return NULL;
+    SIZE_T end = (SIZE_T)pe->nameOffset + ((SIZE_T)pe->nameLen + 1) * sizeof(WCHAR);
+    if (end > pack->len) return NULL;
+    const WCHAR* name = (const WCHAR*)(pack->base + pe->nameOffset);
+    return name[pe->nameLen] == 0 ? name : NULL;
+}
+
+const DWORD* iconpack_pixels(const IconPackView* pack, const IconPackEntry* pe) {
+    if ((pe->pixelOffset & 3) || pe->size == 0 || pe->size > ICON_MAX_SIZE) return NULL;
+    SIZE_T end = (SIZE_T)pe->pixelOffset + (SIZE_T)pe->size * pe->size * sizeof(DWORD);
+    return end <= pack->len ? (const DWORD*)(pack->base + pe->pixelOffset) : NULL;
+}
+
+int iconpack_find(const IconPackView* pack, DWORD hash, int size, BYTE kind, BOOL dark, const WCHAR* source) {
+    DWORD lo = 0, hi = pack->count;
+    while (lo < hi) {
+        DWORD mid = lo + (hi - lo) / 2;
+        if (pack->entries[mid].hash < hash) lo = mid + 1; else hi = mid;
+    }
+    for (DWORD i = lo; i < pack->count && pack->entries[i].hash == hash; ++i) {
+        const IconPackEntry* pe = &pack->entries[i];
+        const WCHAR* name = iconpack_name(pack, pe);
+        if (name && iconpack_same_key(hash, size, kind, dark, source, pe->hash, pe->size, pe->kind, pe->dark, name)) return (int)i;
+    }
+    return -1;
+}
+
+int iconpack_merge(IconPackItem* items, int fresh, const IconPackView* old, const BYTE* used) {
+    int n = fresh;
+    for (int pass = 0; pass < 2; ++pass) {
+        for (DWORD i = 0; i < old->count && n < ICONPACK_MAX_ENTRIES; ++i) {
+            BOOL wasUsed = used && used[i];
+            if (wasUsed != (pass == 0)) continue;
+            const IconPackEntry* pe = &old->entries[i];
+            const WCHAR* name = iconpack_name(old, pe);
+            const DWORD* px = iconpack_pixels(old, pe);
+            if (!name || !px) continue;
+            BOOL replaced = FALSE;
+            for (int j = 0; j < fresh && !replaced; ++j) {
+                replaced = iconpack_same_key(items[j].e.hash, items[j].e.size, items[j].e.kind, items[j].e.dark, items[j].name,
+                                             pe->hash, pe->size, pe->kind, pe->dark, name);
+            }
+            if (replaced) continue;
+            items[n].e = *pe;
+            items[n].name = name;
+            items[n].pixels = px;
+            n++;
+        }
+    }
+    return n;
+}
+
+static int compare_items(const void* a, const void* b) {
+    DWORD ha = ((const IconPackItem*)a)->e.hash, hb = ((const IconPackItem*)b)->e.hash;
+    return ha < hb ? -1 : (ha > hb ? 1 : 0);
+}
+
+BYTE* iconpack_build(IconPackItem* items, int count, SIZE_T* len) {
+    *len = 0;
+    if (count < 0 || count > ICONPACK_MAX_ENTRIES) return NULL;
+    qsort(items, count, sizeof(IconPackItem), compare_items);
+
+    // Lay out names after the entry table, then 4-byte aligned pixels
+    SIZE_T offset = sizeof(IconPackHeader) + (SIZE_T)count * sizeof(IconPackEntry);
+    for (int i = 0; i < count; ++i) {
+        if (items[i].e.size == 0 || items[i].e.size > ICON_MAX_SIZE || items[i].e.nameLen >= 32768) return NULL;
+        items[i].e.nameOffset = (DWORD)offset;
+        offset += ((SIZE_T)items[i].e.nameLen + 1) * sizeof(WCHAR);
+    }
+    offset = (offset + 3) & ~(SIZE_T)3;
+    for (int i = 0; i < count; ++i) {
+        items[i].e.pixelOffset = (DWORD)offset;
+        offset += (SIZE_T)items[i].e.size * items[i].e.size * sizeof(DWORD);
+        if (offset > ICONPACK_MAX_BYTES) return NULL;
+    }
+    BYTE* buf = (BYTE*)LocalAlloc(LMEM_FIXED|LMEM_ZEROINIT, offset);
+    if (!buf) return NULL;
+    IconPackHeader* h = (IconPackHeader*)buf;
+    h->magic = ICONPACK_MAGIC;
+    h->version = ICONPACK_VERSION;
+    h->count = (DWORD)count;
+    IconPackEntry* table = (IconPackEntry*)(buf + sizeof(IconPackHeader));
+    for (int i = 0; i < count; ++i) {
+        table[i] = items[i].e;
+        CopyMemory(buf + items[i].e.nameOffset, items[i].name, (SIZE_T)items[i].e.nameLen * sizeof(WCHAR));
+        CopyMemory(buf + items[i].e.pixelOffset, items[i].pixels, (SIZE_T)items[i].e.size * items[i].e.size * sizeof(DWORD));
+    }
+    *len = offset;
+    return buf;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <windows.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// File format of the icon pack (level 2 of the icon cache): pre-rasterized 32-bpp images keyed
+// by (source, pixel size, theme). Parsing and building work on memory only; the icon cache maps
+// and writes the file. Every offset read from a pack is checked against its length.
+
+#define ICONPACK_MAX_ENTRIES 2048
+#define ICONPACK_MAX_BYTES (64 * 1024 * 1024)
+#define ICONPACK_MAGIC 0x4B50494Du // "MIPK"
+#define ICONPACK_VERSION 2
+#define ICON_MAX_SIZE 256
+
+enum { IK_SPEC = 0, IK_FILE = 1 };
+
+// Pack layout (little-endian): header, entries sorted by hash, names, then pixels
+typedef struct IconPackHeader {
+    DWORD magic;
+    DWORD version;
+    DWORD count;
+    DWORD reserved;
+} IconPackHeader;
+
+typedef struct IconPackEntry {
+    DWORD hash;
+    WORD size;
+    BYTE kind;
+    BYTE dark;
+    ULONGLONG srcWrite;  // source last-write time when rasterized (0 = not tracked)
+    DWORD nameOffset;    // NUL-terminated WCHARs
+    DWORD nameLen;       // chars, without the NUL
+    DWORD pixelOffset;   // size*size BGRA with straight alpha, top-down
+    DWORD reserved;
+} IconPackEntry;
+
+// A validated pack in memory
+typedef struct IconPackView {
+    const BYTE* base;
+    SIZE_T len;
+    const IconPackEntry* entries;
+    DWORD count;
+} IconPackView;
+
+// One image to write: e.nameLen, hash, size, kind, dark and srcWrite are filled in by the caller,
+// the offsets by iconpack_build
+typedef struct IconPackItem {
+    IconPackEntry e;
+    const WCHAR* name;
+    const DWORD* pixels;
+} IconPackItem;
+
+// Hash of a key; the source is folded like lstrcmpiW, so keys that compare equal hash equal
+DWORD iconpack_hash(BYTE kind, int size, BOOL dark, const WCHAR* source);
+BOOL iconpack_same_key(DWORD hash, int size, BYTE kind, BOOL dark, const WCHAR* a,
+                       DWORD hash2, int size2, BYTE kind2, BOOL dark2, const WCHAR* b);
+
+// Checks the header and entry table of len bytes at base; FALSE for a foreign, old or truncated pack
+BOOL iconpack_parse(IconPackView* out, const BYTE* base, SIZE_T len);
+// Name or pixels of an entry, or NULL if its offsets do not fit the pack
+const WCHAR* iconpack_name(const IconPackView* pack, const IconPackEntry* pe);
+const DWORD* iconpack_pixels(const IconPackView* pack, const IconPackEntry* pe);
+// Index of the entry with this key, or -1
+int iconpack_find(const IconPackView* pack, DWORD hash, int size, BYTE kind, BOOL dark, const WCHAR* source);
+
+// Appends the readable entries of old that none of the first fresh items replace: those marked in
+// used (may be NULL) first, then the rest, up to ICONPACK_MAX_ENTRIES items in total. items must
+// have room for fresh + old->count; names and pixels point into old. Returns the new item count.
+int iconpack_merge(IconPackItem* items, int fresh, const IconPackView* old, const BYTE* used);
+// Sorts items by hash and lays them out as a pack (LocalAlloc'd, *len bytes). NULL if the pack
+// would exceed ICONPACK_MAX_BYTES or memory is short.
+BYTE* iconpack_build(IconPackItem* items, int count, SIZE_T* len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,274 @@
+#include "ini.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Single-pass INI reader. The decoded text is tokenized in place (NUL-terminated keys/values),
+// so every name and value is interned in one buffer and lookups never touch the file again.
+
+typedef struct IniEntry {
+    const IniChar* key;
+    const IniChar* value;
+    uint32_t hash;   // folded key hash seeded with the section index
+    int section;
+} IniEntry;
+
+struct IniFile {
+    IniChar* text;
+    const IniChar** sections;
+    uint32_t* sectionHashes; // folded name hashes, compared before the names
+    int sectionCount;
+    IniEntry* entries;
+    int entryCount;
+    int* slots;      // open addressing table of entry index + 1 (0 = empty)
+    uint32_t slotMask;
+};
+
+// Simple case folding for ASCII, Latin-1, Latin Extended-A, Greek and Cyrillic capitals
+static IniChar fold(IniChar c) {
+    if (c < 0x80) return (c >= 'A' && c <= 'Z') ? (IniChar)(c + 32) : c;
+    if (c >= 0xC0 && c <= 0xDE && c != 0xD7) return (IniChar)(c + 32);
+    if (c >= 0x100 && c <= 0x17F) {
+        // Pairs are even/odd, except 0x139-0x148 and 0x179-0x17E which are odd/even
+        if ((c >= 0x139 && c <= 0x148) || (c >= 0x179 && c <= 0x17E)) return (c & 1) ? (IniChar)(c + 1) : c;
+        if (c == 0x178) return 0xFF;
+        if (c == 0x130 || c == 0x131 || c == 0x138 || c == 0x149 || c == 0x17F) return c;
+        return (c & 1) ? c : (IniChar)(c + 1);
+    }
+    if ((c >= 0x391 && c <= 0x3AB && c != 0x3A2) || (c >= 0x410 && c <= 0x42F)) return (IniChar)(c + 32);
+    if (c >= 0x400 && c <= 0x40F) return (IniChar)(c + 80);
+    return c;
+}
+
+static int fold_equal(const IniChar* a, const IniChar* b) {
+    while (*a && *b) {
+        if (fold(*a) != fold(*b)) return 0;
+        ++a; ++b;
+    }
+    return *a == *b;
+}
+
+static uint32_t fold_hash(int section, const IniChar* s) {
+    uint32_t h = 2166136261u ^ (uint32_t)section;
+    for (; *s; ++s) { h ^= fold(*s); h *= 16777619u; }
+    return h;
+}
+
+static size_t str_len(const IniChar* s) {
+    const IniChar* p = s;
+    while (*p) ++p;
+    return (size_t)(p - s);
+}
+
+static int is_blank(IniChar c) { return c == ' ' || c == '\t'; }
+
+// Trim spaces/tabs from both ends of [s, e) in place; returns the new start, terminates at the new end.
+static IniChar* trim_span(IniChar* s, IniChar* e) {
+    while (s < e && is_blank(*s)) ++s;
+    while (e > s && is_blank(e[-1])) --e;
+    *e = 0;
+    return s;
+}
+
+// ISO-8859-1: every byte is the code point of the same value
+static size_t latin1_decode(const uint8_t* data, size_t len, IniChar* out, size_t cch) {
+    if (!out) return len;
+    if (len > cch) len = cch;
+    for (size_t i = 0; i < len; ++i) out[i] = data[i];
+    return len;
+}
+
+// UTF-8 to UTF-16; malformed sequences become U+FFFD. out must hold len units.
+static size_t utf8_decode(const uint8_t* s, size_t len, IniChar* out) {
+    size_t n = 0;
+    for (size_t i = 0; i < len;) {
+        uint32_t c = s[i], cp;
+        size_t need;
+        if (c < 0x80) { cp = c; need = 0; }
+        else if ((c & 0xE0) == 0xC0) { cp = c & 0x1F; need = 1; }
+        else if ((c & 0xF0) == 0xE0) { cp = c & 0x0F; need = 2; }
+        else if ((c & 0xF8) == 0xF0) { cp = c & 0x07; need = 3; }
+        else { out[n++] = 0xFFFD; ++i; continue; }
+        size_t k = 1;
+        for (; k <= need && i + k < len && (s[i + k] & 0xC0) == 0x80; ++k) cp = (cp << 6) | (s[i + k] & 0x3F);
+        if (k <= need || (need == 1 && cp < 0x80) || (need == 2 && cp < 0x800) || (need == 3 && cp < 0x10000) ||
+            cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+            out[n++] = 0xFFFD; // skip the lead byte and the continuation bytes consumed so far
+            i += k;
+            continue;
+        }
+        i += need + 1;
+        if (cp >= 0x10000) {
+            out[n++] = (IniChar)(0xD800 + ((cp - 0x10000) >> 10));
+            out[n++] = (IniChar)(0xDC00 + ((cp - 0x10000) & 0x3FF));
+        } else {
+            out[n++] = (IniChar)cp;
+        }
+    }
+    return n;
+}
+
+// Decode file bytes into a NUL-terminated UTF-16 buffer (malloc'd).
+static IniChar* decode_text(const uint8_t* data, size_t len, IniAnsiDecoder ansi, size_t* outChars) {
+    IniChar* text = NULL; size_t n = 0;
+    if (len >= 2 && ((data[0] == 0xFF && data[1] == 0xFE) || (data[0] == 0xFE && data[1] == 0xFF))) {
+        int be = (data[0] == 0xFE);
+        n = (len - 2) / 2;
+        text = (IniChar*)malloc((n + 1) * sizeof(IniChar));
+        if (!text) return NULL;
+        const uint8_t* p = data + 2;
+        for (size_t i = 0; i < n; ++i, p += 2) text[i] = be ? (IniChar)((p[0] << 8) | p[1]) : (IniChar)(p[0] | (p[1] << 8));
+    } else if (len >= 3 && data[0] == 0xEF && data[1] == 0xBB && data[2] == 0xBF) {
+        // A UTF-8 sequence never yields more UTF-16 units than it has bytes
+        text = (IniChar*)malloc((len - 3 + 1) * sizeof(IniChar));
+        if (!text) return NULL;
+        n = utf8_decode(data + 3, len - 3, text);
+    } else {
+        // No BOM: the profile API reads the file in the ANSI code page, even if it happens to be UTF-8
+        if (!ansi) ansi = latin1_decode;
+        size_t need = len ? ansi(data, len, NULL, 0) : 0;
+        text = (IniChar*)malloc((need + 1) * sizeof(IniChar));
+        if (!text) return NULL;
+        n = need ? ansi(data, len, text, need) : 0;
+    }
+    text[n] = 0;
+    *outChars = n;
+    return text;
+}
+
+static int find_section(const IniFile* ini, const IniChar* name, uint32_t hash) {
+    for (int i = 0; i < ini->sectionCount; ++i) {
+        if (ini->sectionHashes[i] == hash && fold_equal(ini->sections[i], name)) return i;
+    }
+    return -1;
+}
+
+static const IniEntry* find_entry(const IniFile* ini, int section, const IniChar* key, uint32_t hash) {
+    for (uint32_t s = hash & ini->slotMask;; s = (s + 1) & ini->slotMask) {
+        int idx = ini->slots[s];
+        if (!idx) return NULL;
+        const IniEntry* e = &ini->entries[idx - 1];
+        if (e->hash == hash && e->section == section && fold_equal(e->key, key)) return e;
+    }
+}
+
+IniFile* ini_parse_bytes(const uint8_t* data, size_t len, IniAnsiDecoder ansi) {
+    IniFile* ini = (IniFile*)calloc(1, sizeof(IniFile));
+    if (!ini) return NULL;
+    size_t chars = 0;
+    ini->text = decode_text(data ? data : (const uint8_t*)"", data ? len : 0, ansi, &chars);
+    if (!ini->text) { free(ini); return NULL; }
+
+    // Upper bound for sections/keys is the line count
+    size_t lines = 1;
+    for (size_t i = 0; i < chars; ++i) if (ini->text[i] == '\n' || ini->text[i] == '\r') ++lines;
+    size_t slotCount = 16;
+    while (slotCount < lines * 2) slotCount <<= 1;
+    ini->sections = (const IniChar**)malloc(lines * sizeof(IniChar*));
+    ini->sectionHashes = (uint32_t*)malloc(lines * sizeof(uint32_t));
+    ini->entries = (IniEntry*)malloc(lines * sizeof(IniEntry));
+    ini->slots = (int*)calloc(slotCount, sizeof(int));
+    if (!ini->sections || !ini->sectionHashes || !ini->entries || !ini->slots) { ini_free(ini); return NULL; }
+    ini->slotMask = (uint32_t)(slotCount - 1);
+
+    int current = -1; // keys outside a section (or in a repeated section) are ignored
+    IniChar* p = ini->text;
+    IniChar* end = ini->text + chars;
+    while (p < end) {
+        IniChar* lineEnd = p;
+        while (lineEnd < end && *lineEnd != '\n' && *lineEnd != '\r') ++lineEnd;
+        IniChar* next = lineEnd < end ? lineEnd + 1 : end;
+        IniChar* s = p;
+        while (s < lineEnd && is_blank(*s)) ++s;
+        if (s < lineEnd && *s != ';') {
+            if (*s == '[') {
+                IniChar* close = s + 1;
+                while (close < lineEnd && *close != ']') ++close;
+                if (close < lineEnd) {
+                    IniChar* name = trim_span(s + 1, close);
+                    // First occurrence of a section wins; later duplicates are skipped entirely
+                    uint32_t h = fold_hash(-1, name);
+                    if (find_section(ini, name, h) < 0) {
+                        current = ini->sectionCount;
+                        ini->sectionHashes[current] = h;
+                        ini->sections[ini->sectionCount++] = name;
+                    } else {
+                        current = -1;
+                    }
+                }
+            } else if (current >= 0) {
+                IniChar* eq = s;
+                while (eq < lineEnd && *eq != '=') ++eq;
+                if (eq < lineEnd) {
+                    IniChar* key = trim_span(s, eq);
+                    IniChar* value = trim_span(eq + 1, lineEnd);
+                    size_t vlen = str_len(value);
+                    if (vlen >= 2 && (value[0] == '"' || value[0] == '\'') && value[vlen - 1] == value[0]) {
+                        value[vlen - 1] = 0;
+                        ++value;
+                    }
+                    if (*key) {
+                        uint32_t h = fold_hash(current, key);
+                        if (!find_entry(ini, current, key, h)) { // first key occurrence wins
+                            IniEntry* e = &ini->entries[ini->entryCount];
+                            e->key = key; e->value = value; e->hash = h; e->section = current;
+                            uint32_t slot = h & ini->slotMask;
+                            while (ini->slots[slot]) slot = (slot + 1) & ini->slotMask;
+                            ini->slots[slot] = ++ini->entryCount;
+                        }
+                    }
+                }
+            }
+        }
+        *lineEnd = 0;
+        p = next;
+    }
+    return ini;
+}
+
+void ini_free(IniFile* ini) {
+    if (!ini) return;
+    free(ini->text);
+    free((void*)ini->sections);
+    free(ini->sectionHashes);
+    free(ini->entries);
+    free(ini->slots);
+    free(ini);
+}
+
+const IniChar* ini_get(const IniFile* ini, const IniChar* section, const IniChar* key) {
+    if (!ini || !section || !key) return NULL;
+    int sec = find_section(ini, section, fold_hash(-1, section));
+    if (sec < 0) return NULL;
+    const IniEntry* e = find_entry(ini, sec, key, fold_hash(sec, key));
+    return e ? e->value : NULL;
+}
+
+uint32_t ini_get_string(const IniFile* ini, const IniChar* section, const IniChar* key, const IniChar* def, IniChar* out, uint32_t cch) {
+    static const IniChar empty[1] = { 0 };
+    if (!out || cch == 0) return 0;
+    const IniChar* v = ini_get(ini, section, key);
+    if (!v) v = def ? def : empty;
+    uint32_t n = 0;
+    while (v[n] && n + 1 < cch) { out[n] = v[n]; ++n; }
+    out[n] = 0;
+    return n;
+}
+
+int ini_get_int(const IniFile* ini, const IniChar* section, const IniChar* key, int def) {
+    const IniChar* v = ini_get(ini, section, key);
+    if (!v || !*v) return def;
+    int neg = 0;
+    if (*v == '-' || *v == '+') { neg = (*v == '-'); ++v; }
+    unsigned int n = 0;
+    if (v[0] == '0' && (v[1] == 'x' || v[1] == 'X')) {
+        for (v += 2;; ++v) {
+            if (*v >= '0' && *v <= '9') n = n * 16 + (*v - '0');
+            else if (*v >= 'a' && *v <= 'f') n = n * 16 + (*v - 'a' + 10);
+            else if (*v >= 'A' && *v <= 'F') n = n * 16 + (*v - 'A' + 10);
+            else break;
+        }
+    } else {
+        for (; *v >= '0' && *v <= '9'; ++v) n = n * 10 + (*v - '0');
+    }
+    return neg ? -(int)n : (int)n;
+}
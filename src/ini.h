@@ -0,0 +1,36 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Parsed INI file: the whole file is decoded once and indexed by section/key.
+// Lookups follow the Win32 profile API rules (case-insensitive names, first section
+// and first key occurrence win, surrounding quotes stripped from values, only ';' starts
+// a comment). Platform independent: characters are UTF-16 code units, so WCHAR strings
+// can be passed directly. ini_win32.h adds the Windows entry points.
+typedef uint16_t IniChar;
+typedef struct IniFile IniFile;
+
+// Decodes len bytes of the system ANSI code page into out (cch units, not terminated) and returns
+// the units written; with out == NULL returns the units needed.
+typedef size_t (*IniAnsiDecoder)(const uint8_t* data, size_t len, IniChar* out, size_t cch);
+
+// Parses raw file bytes: UTF-16LE/BE or UTF-8 when the file starts with the matching BOM,
+// otherwise the ANSI code page through ansi (NULL decodes as ISO-8859-1).
+// Never returns NULL unless out of memory; an empty buffer yields an empty index.
+IniFile* ini_parse_bytes(const uint8_t* data, size_t len, IniAnsiDecoder ansi);
+void ini_free(IniFile* ini);
+
+// Returns the value for section/key or NULL if absent. Pointer stays valid until ini_free.
+const IniChar* ini_get(const IniFile* ini, const IniChar* section, const IniChar* key);
+// GetPrivateProfileStringW-like: copies value (or def) into out, returns chars copied.
+uint32_t ini_get_string(const IniFile* ini, const IniChar* section, const IniChar* key, const IniChar* def, IniChar* out, uint32_t cch);
+// GetPrivateProfileIntW-like: missing or empty key yields def; accepts sign and 0x hex prefix.
+int ini_get_int(const IniFile* ini, const IniChar* section, const IniChar* key, int def);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,25 @@
+#include "ini_win32.h"
+
+static size_t ansi_decode(const uint8_t* data, size_t len, IniChar* out, size_t cch) {
+    int n = MultiByteToWideChar(CP_ACP, 0, (LPCSTR)data, (int)len, (LPWSTR)out, out ? (int)cch : 0);
+    return n > 0 ? (size_t)n : 0;
+}
+
+IniFile* ini_parse(const BYTE* data, DWORD len) {
+    return ini_parse_bytes(data, len, ansi_decode);
+}
+
+IniFile* ini_open(const WCHAR* path) {
+    HANDLE hf = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hf == INVALID_HANDLE_VALUE) return NULL;
+    IniFile* ini = NULL;
+    DWORD len = GetFileSize(hf, NULL);
+    if (len != INVALID_FILE_SIZE) {
+        BYTE* data = (BYTE*)LocalAlloc(LMEM_FIXED, len ? len : 1);
+        DWORD got = 0;
+        if (data && (len == 0 || ReadFile(hf, data, len, &got, NULL))) ini = ini_parse(data, got);
+        if (data) LocalFree(data);
+    }
+    CloseHandle(hf);
+    return ini;
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <windows.h>
+#include "ini.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Windows entry points for the INI reader: BOM-less files decode in the ANSI code page (CP_ACP),
+// as GetPrivateProfileString reads them.
+IniFile* ini_parse(const BYTE* data, DWORD len);
+// Reads and parses a file; returns NULL when the file cannot be read.
+IniFile* ini_open(const WCHAR* path);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,310 @@
+#include "listing.h"
+#include "config.h"
+#include <shlwapi.h>
+
+#define LISTING_WATCH_FLAGS (FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_ATTRIBUTES | \
+                             FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_CREATION)
+
+// Grow a LocalAlloc'd array to hold at least `need` elements (doubling); returns FALSE on OOM
+static BOOL grow_array(void** arr, DWORD* cap, DWORD need, SIZE_T elem, DWORD initial) {
+    if (need <= *cap) return TRUE;
+    DWORD ncap = *cap ? *cap : initial;
+    while (ncap < need) ncap *= 2;
+    void* p = LocalAlloc(LMEM_FIXED, ncap * elem);
+    if (!p) return FALSE;
+    if (*arr) {
+        memcpy(p, *arr, *cap * elem);
+        LocalFree(*arr);
+    }
+    *arr = p;
+    *cap = ncap;
+    return TRUE;
+}
+
+static void free_sort_keys(FolderListing* lst);
+
+static BOOL passes_filters(const WIN32_FIND_DATAW* fd, const ListingOptions* opt) {
+    if (!lstrcmpW(fd->cFileName, L".") || !lstrcmpW(fd->cFileName, L"..")) return FALSE;
+    BOOL isDot = (fd->cFileName[0] == L'.');
+    if (!opt->showHidden && (fd->dwFileAttributes & FILE_ATTRIBUTE_HIDDEN)) {
+        if (!(isDot && opt->dotMode > 0)) return FALSE;
+    }
+    if (isDot) {
+        if (opt->dotMode == 0) return FALSE;
+        BOOL isDir = (fd->dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+        if (isDir && opt->dotMode == 1) return FALSE;
+        if (!isDir && opt->dotMode == 2) return FALSE;
+    }
+    return TRUE;
+}
+
+BOOL listing_is_cacheable(const WCHAR* dir) {
+    WCHAR root[MAX_PATH];
+    lstrcpynW(root, dir, ARRAYSIZE(root));
+    UINT type = GetDriveTypeW(PathStripToRootW(root) ? root : NULL);
+    return type != DRIVE_REMOVABLE && type != DRIVE_CDROM && type != DRIVE_REMOTE;
+}
+
+FILETIME listing_dir_write_time(const WCHAR* dir) {
+    WIN32_FILE_ATTRIBUTE_DATA fad;
+    if (!GetFileAttributesExW(dir, GetFileExInfoStandard, &fad)) {
+        FILETIME none = {0};
+        return none;
+    }
+    return fad.ftLastWriteTime;
+}
+
+FolderListing* listing_begin(const WCHAR* dir, const ListingOptions* opt) {
+    FolderListing* lst = (FolderListing*)LocalAlloc(LMEM_FIXED|LMEM_ZEROINIT, sizeof(FolderListing));
+    if (!lst) return NULL;
+    lstrcpynW(lst->dir, dir, ARRAYSIZE(lst->dir));
+    lst->opt = *opt;
+    lst->watch = INVALID_HANDLE_VALUE;
+    return lst;
+}
+
+BOOL listing_add(FolderListing* lst, const WIN32_FIND_DATAW* fd) {
+    if (!passes_filters(fd, &lst->opt)) return TRUE;
+    DWORD nameLen = (DWORD)lstrlenW(fd->cFileName);
+    if (!grow_array((void**)&lst->entries, &lst->entryCap, (DWORD)lst->count + 1, sizeof(ListEntry), 64)) return FALSE;
+    if (!grow_array((void**)&lst->pool, &lst->poolCap, lst->poolLen + nameLen + 1, sizeof(WCHAR), 4096)) return FALSE;
+    ListEntry* e = &lst->entries[lst->count++];
+    e->nameOffset = lst->poolLen;
+    e->nameLen = (WORD)nameLen;
+    e->flags = (fd->dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) ? LE_DIR : 0;
+    e->ftLastWrite = fd->ftLastWriteTime;
+    e->ftCreation = fd->ftCreationTime;
+    e->size = ((ULONGLONG)fd->nFileSizeHigh << 32) | fd->nFileSizeLow;
+    memcpy(lst->pool + lst->poolLen, fd->cFileName, (nameLen + 1) * sizeof(WCHAR));
+    lst->poolLen += nameLen + 1;
+    return TRUE;
+}
+
+BOOL listing_finish(FolderListing* lst) {
+    if (lst->count > 0) {
+        lst->order = (int*)LocalAlloc(LMEM_FIXED, lst->count * sizeof(int));
+        if (!lst->order) { listing_free(lst); return FALSE; }
+        for (int i = 0; i < lst->count; ++i) lst->order[i] = i;
+    }
+    return TRUE;
+}
+
+FolderListing* listing_enumerate(const WCHAR* dir, const ListingOptions* opt) {
+    WIN32_FIND_DATAW fd; WCHAR pattern[MAX_PATH];
+    // Watch and stamp before enumerating: a change made while we read the folder then shows up
+    // as a signaled watch (or a newer stamp) instead of slipping into a cached listing
+    HANDLE watch = listing_is_cacheable(dir) ? FindFirstChangeNotificationW(dir, FALSE, LISTING_WATCH_FLAGS) : INVALID_HANDLE_VALUE;
+    FILETIME dirWriteTime = listing_dir_write_time(dir);
+    PathCombineW(pattern, dir, L"*");
+    HANDLE h = FindFirstFileExW(pattern, FindExInfoBasic, &fd, FindExSearchNameMatch, NULL, FIND_FIRST_EX_LARGE_FETCH);
+    FolderListing* lst = h != INVALID_HANDLE_VALUE ? listing_begin(dir, opt) : NULL;
+    if (!lst) {
+        if (h != INVALID_HANDLE_VALUE) FindClose(h);
+        if (watch != INVALID_HANDLE_VALUE) FindCloseChangeNotification(watch);
+        return NULL;
+    }
+    lst->dirWriteTime = dirWriteTime;
+    lst->watch = watch;
+    do {
+        if (!listing_add(lst, &fd)) break;
+    } while (FindNextFileW(h, &fd));
+    FindClose(h);
+    return listing_finish(lst) ? lst : NULL;
+}
+
+void listing_free(FolderListing* lst) {
+    if (!lst) return;
+    if (lst->watch != INVALID_HANDLE_VALUE) FindCloseChangeNotification(lst->watch);
+    if (lst->entries) LocalFree(lst->entries);
+    if (lst->order) LocalFree(lst->order);
+    if (lst->pool) LocalFree(lst->pool);
+    free_sort_keys(lst);
+    LocalFree(lst);
+}
+
+const WCHAR* listing_name(const FolderListing* lst, const ListEntry* e) {
+    return lst->pool + e->nameOffset;
+}
+
+const ListEntry* listing_at(const FolderListing* lst, int pos) {
+    return &lst->entries[lst->order[pos]];
+}
+
+void listing_full_path(const FolderListing* lst, const ListEntry* e, WCHAR* out, int cch) {
+    WCHAR tmp[MAX_PATH];
+    if (!PathCombineW(tmp, lst->dir, listing_name(lst, e))) tmp[0] = 0;
+    lstrcpynW(out, tmp, cch);
+}
+
+// Byte offsets of an entry's sort keys in keyPool. Sort keys compare with memcmp exactly like
+// CompareStringEx compares the source strings, so the comparator never re-folds case.
+typedef struct ListKey {
+    DWORD name;
+    DWORD ext;
+    WORD nameLen;
+    WORD extLen;          // 0 when the type key is not needed or the name has no extension
+} ListKey;
+
+SIZE_T listing_memory(const FolderListing* lst) {
+    if (!lst) return 0;
+    SIZE_T n = sizeof(FolderListing);
+    n += (SIZE_T)lst->count * (sizeof(ListEntry) + sizeof(int));
+    n += (SIZE_T)lst->poolLen * sizeof(WCHAR);
+    if (lst->keys) n += (SIZE_T)lst->count * sizeof(ListKey) + lst->keyPoolLen;
+    return n;
+}
+
+static DWORD collation_flags(const ListingOptions* opt) {
+    return NORM_IGNORECASE | (opt->sortNatural ? SORT_DIGITSASNUMBERS : 0);
+}
+
+// Appends the sort key of s[0..len) to the key pool; returns FALSE on failure
+static BOOL append_sort_key(FolderListing* lst, DWORD* poolLen, DWORD* poolCap, const WCHAR* s, int len, DWORD* off, WORD* keyLen) {
+    *off = *poolLen;
+    *keyLen = 0;
+    if (len <= 0) return TRUE;
+    DWORD flags = LCMAP_SORTKEY | collation_flags(&lst->opt);
+    int need = LCMapStringEx(LOCALE_NAME_USER_DEFAULT, flags, s, len, NULL, 0, NULL, NULL, 0);
+    if (need <= 0 || need > 0xFFFF) return FALSE;
+    if (!grow_array((void**)&lst->keyPool, poolCap, *poolLen + (DWORD)need, 1, 16384)) return FALSE;
+    if (!LCMapStringEx(LOCALE_NAME_USER_DEFAULT, flags, s, len, (LPWSTR)(lst->keyPool + *poolLen), need, NULL, NULL, 0)) return FALSE;
+    *poolLen += (DWORD)need;
+    *keyLen = (WORD)need;
+    return TRUE;
+}
+
+static void free_sort_keys(FolderListing* lst) {
+    if (lst->keys) LocalFree(lst->keys);
+    if (lst->keyPool) LocalFree(lst->keyPool);
+    lst->keys = NULL;
+    lst->keyPool = NULL;
+    lst->keyPoolLen = 0;
+}
+
+// One pass over the entries: name key (primary or tie-breaker), extension key for SORT_TYPE.
+// Date and size orders only compare names on ties, which is too rare to pay for n keys up front.
+static void build_sort_keys(FolderListing* lst) {
+    if (lst->keys || lst->count == 0) return;
+    if (lst->opt.sortField != SORT_NAME && lst->opt.sortField != SORT_TYPE) return;
+    lst->keys = (ListKey*)LocalAlloc(LMEM_FIXED, lst->count * sizeof(ListKey));
+    if (!lst->keys) return;
+    DWORD poolLen = 0, poolCap = 0;
+    BOOL wantExt = (lst->opt.sortField == SORT_TYPE);
+    for (int i = 0; i < lst->count; ++i) {
+        const ListEntry* e = &lst->entries[i];
+        const WCHAR* name = listing_name(lst, e);
+        ListKey* k = &lst->keys[i];
+        if (!append_sort_key(lst, &poolLen, &poolCap, name, e->nameLen, &k->name, &k->nameLen)) { free_sort_keys(lst); return; }
+        k->ext = 0; k->extLen = 0;
+        if (wantExt) {
+            const WCHAR* ext = wcsrchr(name, L'.');
+            if (ext && !append_sort_key(lst, &poolLen, &poolCap, ext, lstrlenW(ext), &k->ext, &k->extLen)) { free_sort_keys(lst); return; }
+        }
+    }
+    lst->keyPoolLen = poolLen;
+}
+
+static int compare_key(const BYTE* pool, DWORD a, WORD la, DWORD b, WORD lb) {
+    int r = memcmp(pool + a, pool + b, la < lb ? la : lb);
+    if (r) return r;
+    return (int)la - (int)lb;
+}
+
+static int compare_text(const FolderListing* lst, const WCHAR* a, const WCHAR* b) {
+    return CompareStringEx(LOCALE_NAME_USER_DEFAULT, collation_flags(&lst->opt), a, -1, b, -1, NULL, NULL, 0) - CSTR_EQUAL;
+}
+
+static int compare_names(const FolderListing* lst, int ia, int ib) {
+    if (lst->keys) {
+        const ListKey* ka = &lst->keys[ia];
+        const ListKey* kb = &lst->keys[ib];
+        return compare_key(lst->keyPool, ka->name, ka->nameLen, kb->name, kb->nameLen);
+    }
+    return compare_text(lst, listing_name(lst, &lst->entries[ia]), listing_name(lst, &lst->entries[ib]));
+}
+
+static int compare_exts(const FolderListing* lst, int ia, int ib) {
+    if (lst->keys) {
+        const ListKey* ka = &lst->keys[ia];
+        const ListKey* kb = &lst->keys[ib];
+        return compare_key(lst->keyPool, ka->ext, ka->extLen, kb->ext, kb->extLen);
+    }
+    const WCHAR* extA = wcsrchr(listing_name(lst, &lst->entries[ia]), L'.');
+    const WCHAR* extB = wcsrchr(listing_name(lst, &lst->entries[ib]), L'.');
+    return compare_text(lst, extA ? extA : L"", extB ? extB : L"");
+}
+
+static int compare_entries(const FolderListing* lst, int ia, int ib) {
+    const ListEntry* fa = &lst->entries[ia];
+    const ListEntry* fb = &lst->entries[ib];
+
+    // Folders first logic
+    if (lst->opt.sortFoldersFirst) {
+        BOOL da = (fa->flags & LE_DIR) != 0, db = (fb->flags & LE_DIR) != 0;
+        if (da && !db) return -1;
+        if (!da && db) return 1;
+    }
+
+    int res = 0;
+    switch (lst->opt.sortField) {
+        case SORT_DATE_MODIFIED:
+            res = CompareFileTime(&fa->ftLastWrite, &fb->ftLastWrite);
+            break;
+        case SORT_DATE_CREATED:
+            res = CompareFileTime(&fa->ftCreation, &fb->ftCreation);
+            break;
+        case SORT_SIZE:
+            if (fa->size < fb->size) res = -1;
+            else if (fa->size > fb->size) res = 1;
+            break;
+        case SORT_TYPE:
+            res = compare_exts(lst, ia, ib);
+            break;
+        case SORT_NAME:
+        default:
+            res = compare_names(lst, ia, ib);
+            break;
+    }
+
+    if (lst->opt.sortDescending) res = -res;
+
+    // Fallback to name if equal (always ascending for stability)
+    if (res == 0) res = compare_names(lst, ia, ib);
+    return res;
+}
+
+// Max-heap sift-down over heap[0..n) (largest entry at the root)
+static void heap_sift_down(const FolderListing* lst, int* heap, int n, int i) {
+    for (;;) {
+        int l = 2 * i + 1, r = l + 1, m = i;
+        if (l < n && compare_entries(lst, heap[l], heap[m]) > 0) m = l;
+        if (r < n && compare_entries(lst, heap[r], heap[m]) > 0) m = r;
+        if (m == i) return;
+        int t = heap[i]; heap[i] = heap[m]; heap[m] = t;
+        i = m;
+    }
+}
+
+// Pick the k smallest of the unsorted remainder with a bounded max-heap, then heap-sort just
+// those k. Page N of n entries therefore costs O(n log k) instead of a full sort.
+void listing_sort_prefix(FolderListing* lst, int upTo) {
+    if (!lst) return;
+    if (upTo > lst->count) upTo = lst->count;
+    if (upTo <= lst->sorted) return;
+    build_sort_keys(lst);
+    int* heap = lst->order + lst->sorted;
+    int remain = lst->count - lst->sorted;
+    int k = upTo - lst->sorted;
+    for (int i = k / 2 - 1; i >= 0; --i) heap_sift_down(lst, heap, k, i);
+    for (int i = k; i < remain; ++i) {
+        if (compare_entries(lst, heap[i], heap[0]) < 0) {
+            int t = heap[0]; heap[0] = heap[i]; heap[i] = t;
+            heap_sift_down(lst, heap, k, 0);
+        }
+    }
+    for (int n = k - 1; n > 0; --n) {
+        int t = heap[0]; heap[0] = heap[n]; heap[n] = t;
+        heap_sift_down(lst, heap, n, 0);
+    }
+    lst->sorted = upTo;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <windows.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Filter/sort settings captured from Config when a listing is made (listings never read g_cfg)
+typedef struct ListingOptions {
+    BOOL showHidden;
+    int dotMode;          // same encoding as Config.dotMode
+    int sortField;        // SORT_* from config.h
+    BOOL sortDescending;
+    BOOL sortFoldersFirst;
+    BOOL sortNatural;     // digit runs compare numerically
+} ListingOptions;
+
+#define LE_DIR 0x0001
+
+// Compact directory entry (32 bytes): the name lives in the listing's string pool
+typedef struct ListEntry {
+    DWORD nameOffset;     // WCHAR offset into FolderListing.pool (NUL-terminated)
+    WORD nameLen;
+    WORD flags;           // LE_*
+    FILETIME ftLastWrite;
+    FILETIME ftCreation;
+    ULONGLONG size;
+} ListEntry;
+
+// Enumerated, filtered folder contents. Sorting is incremental: order[0..sorted) holds the
+// first `sorted` entries in final order, the remaining indices are unordered.
+typedef struct FolderListing {
+    struct FolderListing* next; // free for the owner to chain listings
+    WCHAR dir[MAX_PATH];
+    FILETIME dirWriteTime;      // directory's own last-write time, read before enumerating
+    HANDLE watch;               // change notification opened before enumerating (INVALID_HANDLE_VALUE if
+                                // none); whoever caches the listing takes it over
+    ListingOptions opt;
+    ListEntry* entries;
+    int count;
+    DWORD entryCap;             // capacities while the listing is being built
+    DWORD poolCap;
+    int* order;
+    int sorted;
+    WCHAR* pool;
+    DWORD poolLen;
+    // Collation keys for name/type orders, built once before the first sort (NULL for other
+    // orders or if that failed: comparisons fall back to CompareStringEx)
+    struct ListKey* keys;
+    BYTE* keyPool;
+    DWORD keyPoolLen;
+} FolderListing;
+
+// Returns NULL when the folder cannot be enumerated; free with listing_free
+FolderListing* listing_enumerate(const WCHAR* dir, const ListingOptions* opt);
+// Builds a listing from entries the caller enumerates: listing_begin, listing_add per find record,
+// then listing_finish. listing_add applies the filters and returns FALSE only when out of memory;
+// listing_finish returns FALSE (and frees lst) when out of memory.
+FolderListing* listing_begin(const WCHAR* dir, const ListingOptions* opt);
+BOOL listing_add(FolderListing* lst, const WIN32_FIND_DATAW* fd);
+BOOL listing_finish(FolderListing* lst);
+void listing_free(FolderListing* lst);
+// Extend the sorted prefix to at least upTo entries (top-k selection of the unsorted remainder)
+void listing_sort_prefix(FolderListing* lst, int upTo);
+// Entry at sorted position pos (pos < lst->sorted)
+const ListEntry* listing_at(const FolderListing* lst, int pos);
+const WCHAR* listing_name(const FolderListing* lst, const ListEntry* e);
+// Heap bytes held by the listing (records, names, order and sort keys)
+SIZE_T listing_memory(const FolderListing* lst);
+// FALSE for folders on removable, optical or network volumes. Those are neither watched nor cached:
+// an open change notification blocks safe eject, and re-checking a stamp spins up media or waits
+// on a disconnected share.
+BOOL listing_is_cacheable(const WCHAR* dir);
+// Last-write time of dir (zero if it cannot be read)
+FILETIME listing_dir_write_time(const WCHAR* dir);
+// Builds dir\name on demand into out
+void listing_full_path(const FolderListing* lst, const ListEntry* e, WCHAR* out, int cch);
+
+#ifdef __cplusplus
+}
+#endif
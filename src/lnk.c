@@ -0,0 +1,186 @@
+#include "lnk.h"
+#include <shlwapi.h>
+
+#define LNK_HEADER_SIZE 0x4C
+#define LNK_MAX_FILE (1024 * 1024)
+
+// ShellLinkHeader.LinkFlags
+#define LF_HAS_ID_LIST         0x00000001
+#define LF_HAS_LINK_INFO       0x00000002
+#define LF_HAS_NAME            0x00000004
+#define LF_HAS_RELATIVE_PATH   0x00000008
+#define LF_IS_UNICODE          0x00000080
+#define LF_FORCE_NO_LINK_INFO  0x00000100
+
+// LinkInfo.LinkInfoFlags
+#define LI_VOLUME_ID_AND_LOCAL_BASE_PATH 0x1
+#define LI_COMMON_NETWORK_RELATIVE_LINK  0x2
+
+// {00021401-0000-0000-C000-000000000046} as stored on disk
+static const BYTE k_linkClsid[16] = { 0x01,0x14,0x02,0x00, 0x00,0x00, 0x00,0x00, 0xC0,0x00,0x00,0x00,0x00,0x00,0x00,0x46 };
+
+static BOOL rd16(const BYTE* d, SIZE_T len, SIZE_T off, WORD* v) {
+    if (off > len || len - off < 2) return FALSE;
+    *v = (WORD)(d[off] | (d[off + 1] << 8));
+    return TRUE;
+}
+
+static BOOL rd32(const BYTE* d, SIZE_T len, SIZE_T off, DWORD* v) {
+    if (off > len || len - off < 4) return FALSE;
+    *v = (DWORD)d[off] | ((DWORD)d[off + 1] << 8) | ((DWORD)d[off + 2] << 16) | ((DWORD)d[off + 3] << 24);
+    return TRUE;
+}
+
+// Appends count characters at d[off] (UTF-16LE or system code page) to out; FALSE if out of bounds
+static BOOL append_chars(const BYTE* d, SIZE_T len, SIZE_T off, SIZE_T count, BOOL unicode, WCHAR* out, int cch) {
+    int used = lstrlenW(out);
+    SIZE_T bytes = unicode ? count * 2 : count;
+    if (off > len || len - off < bytes) return FALSE;
+    if (count == 0) return TRUE;
+    if (unicode) {
+        if ((SIZE_T)used + count >= (SIZE_T)cch) return FALSE;
+        for (SIZE_T i = 0; i < count; ++i) out[used + i] = (WCHAR)(d[off + 2 * i] | (d[off + 2 * i + 1] << 8));
+        out[used + count] = 0;
+    } else {
+        int w = MultiByteToWideChar(CP_ACP, 0, (LPCSTR)(d + off), (int)count, out + used, cch - used - 1);
+        if (w <= 0) return FALSE;
+        out[used + w] = 0;
+    }
+    return TRUE;
+}
+
+// Appends the NUL-terminated string at d[off], which must end before len
+static BOOL append_sz(const BYTE* d, SIZE_T len, SIZE_T off, BOOL unicode, WCHAR* out, int cch) {
+    SIZE_T n = 0;
+    if (unicode) {
+        while (off + 2 * n + 1 < len && (d[off + 2 * n] | d[off + 2 * n + 1])) n++;
+        if (off + 2 * n + 1 >= len) return FALSE; // unterminated
+    } else {
+        while (off + n < len && d[off + n]) n++;
+        if (off + n >= len) return FALSE;
+    }
+    return append_chars(d, len, off, n, unicode, out, cch);
+}
+
+// LinkInfo: LocalBasePath + CommonPathSuffix, or NetName \ CommonPathSuffix. Unicode offsets win when present.
+static BOOL parse_link_info(const BYTE* d, SIZE_T len, LnkTarget* out) {
+    DWORD size, hdr, flags, localOff, netOff, suffixOff, localOffW = 0, suffixOffW = 0;
+    if (!rd32(d, len, 0, &size) || size < 0x1C || size > len) return FALSE;
+    len = size;
+    if (!rd32(d, len, 4, &hdr) || !rd32(d, len, 8, &flags) || !rd32(d, len, 16, &localOff) ||
+        !rd32(d, len, 20, &netOff) || !rd32(d, len, 24, &suffixOff)) return FALSE;
+    if (hdr >= 0x24 && (!rd32(d, len, 28, &localOffW) || !rd32(d, len, 32, &suffixOffW))) return FALSE;
+
+    out->path[0] = 0;
+    BOOL network = FALSE;
+    if (flags & LI_VOLUME_ID_AND_LOCAL_BASE_PATH) {
+        BOOL ok = localOffW ? append_sz(d, len, localOffW, TRUE, out->path, MAX_PATH)
+                            : append_sz(d, len, localOff, FALSE, out->path, MAX_PATH);
+        if (!ok) return FALSE;
+    } else if (flags & LI_COMMON_NETWORK_RELATIVE_LINK) {
+        // CommonNetworkRelativeLink: Size, Flags, NetNameOffset, DeviceNameOffset, ProviderType[, NetNameOffsetUnicode]
+        DWORD cnSize, netNameOff, netNameOffW = 0;
+        if (!rd32(d, len, netOff, &cnSize) || cnSize < 0x14 || cnSize > len - netOff) return FALSE;
+        const BYTE* cn = d + netOff;
+        if (!rd32(cn, cnSize, 8, &netNameOff)) return FALSE;
+        if (netNameOff > 0x14 && !rd32(cn, cnSize, 0x14, &netNameOffW)) return FALSE;
+        BOOL ok = netNameOffW ? append_sz(cn, cnSize, netNameOffW, TRUE, out->path, MAX_PATH)
+                              : append_sz(cn, cnSize, netNameOff, FALSE, out->path, MAX_PATH);
+        if (!ok) return FALSE;
+        network = TRUE;
+    } else {
+        return FALSE;
+    }
+
+    WCHAR suffix[MAX_PATH] = {0};
+    if (suffixOffW || suffixOff) {
+        BOOL ok = suffixOffW ? append_sz(d, len, suffixOffW, TRUE, suffix, MAX_PATH)
+                             : append_sz(d, len, suffixOff, FALSE, suffix, MAX_PATH);
+        if (!ok) return FALSE;
+    }
+    if (suffix[0]) {
+        int used = lstrlenW(out->path);
+        if (network && used > 0 && out->path[used - 1] != L'\\') {
+            if (used + 1 >= MAX_PATH) return FALSE;
+            out->path[used++] = L'\\';
+            out->path[used] = 0;
+        }
+        if (used + lstrlenW(suffix) >= MAX_PATH) return FALSE;
+        lstrcpyW(out->path + used, suffix);
+    }
+    return out->path[0] != 0;
+}
+
+// StringData entry: WORD character count followed by the characters (not terminated)
+static BOOL read_counted(const BYTE* d, SIZE_T len, SIZE_T* pos, BOOL unicode, WCHAR* out, int cch) {
+    WORD count;
+    if (!rd16(d, len, *pos, &count)) return FALSE;
+    SIZE_T start = *pos + 2;
+    SIZE_T bytes = unicode ? (SIZE_T)count * 2 : count;
+    if (start > len || len - start < bytes) return FALSE;
+    *pos = start + bytes;
+    if (!out) return TRUE;
+    out[0] = 0;
+    return append_chars(d, len, start, count, unicode, out, cch);
+}
+
+BOOL lnk_parse(const BYTE* data, SIZE_T len, LnkTarget* out) {
+    DWORD headerSize, flags;
+    if (!data || !out || len < LNK_HEADER_SIZE) return FALSE;
+    if (!rd32(data, len, 0, &headerSize) || headerSize != LNK_HEADER_SIZE) return FALSE;
+    if (memcmp(data + 4, k_linkClsid, sizeof(k_linkClsid)) != 0) return FALSE;
+    if (!rd32(data, len, 20, &flags) || !rd32(data, len, 24, &out->attributes)) return FALSE;
+    out->path[0] = 0;
+    out->relative = FALSE;
+
+    SIZE_T pos = LNK_HEADER_SIZE;
+    if (flags & LF_HAS_ID_LIST) {
+        WORD idSize;
+        if (!rd16(data, len, pos, &idSize)) return FALSE;
+        pos += 2 + (SIZE_T)idSize;
+        if (pos > len) return FALSE;
+    }
+    if (flags & LF_HAS_LINK_INFO) {
+        DWORD infoSize;
+        if (!rd32(data, len, pos, &infoSize) || infoSize > len - pos) return FALSE;
+        if (!(flags & LF_FORCE_NO_LINK_INFO) && parse_link_info(data + pos, infoSize, out)) return TRUE;
+        pos += infoSize;
+    }
+
+    BOOL unicode = (flags & LF_IS_UNICODE) != 0;
+    if ((flags & LF_HAS_NAME) && !read_counted(data, len, &pos, unicode, NULL, 0)) return FALSE;
+    if ((flags & LF_HAS_RELATIVE_PATH) && read_counted(data, len, &pos, unicode, out->path, MAX_PATH) && out->path[0]) {
+        out->relative = TRUE;
+        return TRUE;
+    }
+    return FALSE;
+}
+
+BOOL lnk_read(const WCHAR* lnkPath, LnkTarget* out) {
+    HANDLE f = CreateFileW(lnkPath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (f == INVALID_HANDLE_VALUE) return FALSE;
+    BOOL ok = FALSE;
+    LARGE_INTEGER size;
+    // A file with a mapped view cannot be truncated, so the view stays valid while parsing
+    if (GetFileSizeEx(f, &size) && size.QuadPart >= LNK_HEADER_SIZE && size.QuadPart <= LNK_MAX_FILE) {
+        HANDLE map = CreateFileMappingW(f, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (map) {
+            const BYTE* view = (const BYTE*)MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+            if (view) {
+                ok = lnk_parse(view, (SIZE_T)size.QuadPart, out);
+                UnmapViewOfFile(view);
+            }
+            CloseHandle(map);
+        }
+    }
+    CloseHandle(f);
+    if (ok && out->relative) {
+        WCHAR dir[MAX_PATH], full[MAX_PATH];
+        lstrcpynW(dir, lnkPath, ARRAYSIZE(dir));
+        PathRemoveFileSpecW(dir);
+        if (!PathCombineW(full, dir, out->path)) return FALSE;
+        lstrcpynW(out->path, full, ARRAYSIZE(out->path));
+        out->relative = FALSE;
+    }
+    return ok;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <windows.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Minimal reader for the Shell Link binary format (MS-SHLLINK): extracts the file system target
+// recorded in LinkInfo (local or network path) or, failing that, the relative path string.
+// Links that only carry a shell namespace ID list are not handled; callers fall back to IShellLink.
+
+typedef struct LnkTarget {
+    WCHAR path[MAX_PATH];
+    DWORD attributes;   // target attributes recorded when the link was written
+    BOOL relative;      // path is relative to the folder holding the .lnk
+} LnkTarget;
+
+// Parses an in-memory link; every offset is bounds-checked against len. No allocations.
+BOOL lnk_parse(const BYTE* data, SIZE_T len, LnkTarget* out);
+// Maps lnkPath read-only and parses it; relative targets are resolved against the link's folder
+BOOL lnk_read(const WCHAR* lnkPath, LnkTarget* out);
+
+#ifdef __cplusplus
+}
+#endif
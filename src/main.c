@@ -7,6 +7,8 @@
 #include <stdio.h>
 #include <io.h>
 #include <fcntl.h>
+#include <psapi.h>
+#include <dbt.h>
 #include "menu.h"
 #include "theme.h"
 #include "util.h"
@@ -15,8 +17,13 @@
 #include "settings.h"
 #include "controls.h"
 #include "taskbar_hook.h"
+#include "winlist.h"
+#include "perf.h"
+#include "iconcache.h"
+#include "places.h"
 
 #pragma comment(lib, "comctl32.lib")
+#pragma comment(lib, "psapi.lib")
 
 // CLI operation modes
 typedef enum {
@@ -26,6 +33,9 @@ typedef enum {
     CLI_MODE_SHUTDOWN,      // Shutdown specific PID
     CLI_MODE_SETTINGS,      // Open settings for specific PID
     CLI_MODE_OPEN_INI,      // Open ini file for specific PID
+    CLI_MODE_MEMORY,        // Print GDI/USER objects and private bytes of specific PID
+    CLI_MODE_STATS,         // Print popup latency per phase and cache counters of specific PID
+    CLI_MODE_BENCH,         // Build the configured menu repeatedly without showing it and print timings
     CLI_MODE_HELP           // Show help
 } CliModeType;
 
@@ -38,6 +48,7 @@ typedef enum {
 typedef struct {
     CliModeType mode;
     DWORD targetPid;        // For reload/shutdown/settings operations
+    int iterations;         // For --bench
     WCHAR configPath[MAX_PATH];
     OutputFormat outputFormat; // For --list command
 } CliArgs;
@@ -339,6 +350,128 @@ static BOOL cli_open_ini_pid(DWORD pid) {
     return TRUE;
 }
 
+// CLI implementation: Print resource counters of specific PID (run repeatedly to check that
+// memory stays flat across popups in background mode)
+static BOOL cli_memory_pid(DWORD pid) {
+    HWND hwnd = NULL;
+    WCHAR title[260] = {0};
+    
+    if (!find_winmacmenu_window_by_pid(pid, &hwnd, title, ARRAYSIZE(title))) {
+        wprintf(L"Error: No WinMacMenu session found with PID %lu\n", pid);
+        return FALSE;
+    }
+    
+    HANDLE hProcess = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION | PROCESS_VM_READ, FALSE, pid);
+    if (!hProcess) {
+        wprintf(L"Error: Cannot open process %lu (error %lu)\n", pid, GetLastError());
+        return FALSE;
+    }
+    
+    PROCESS_MEMORY_COUNTERS_EX pmc = { sizeof(pmc) };
+    DWORD handles = 0;
+    BOOL haveMem = GetProcessMemoryInfo(hProcess, (PROCESS_MEMORY_COUNTERS*)&pmc, sizeof(pmc));
+    GetProcessHandleCount(hProcess, &handles);
+    
+    wprintf(L"WinMacMenu session (PID: %lu, Title: %s)\n", pid, title);
+    wprintf(L"GDI objects: %lu (peak %lu)\n", GetGuiResources(hProcess, GR_GDIOBJECTS), GetGuiResources(hProcess, GR_GDIOBJECTS_PEAK));
+    wprintf(L"USER objects: %lu (peak %lu)\n", GetGuiResources(hProcess, GR_USEROBJECTS), GetGuiResources(hProcess, GR_USEROBJECTS_PEAK));
+    wprintf(L"Handles: %lu\n", handles);
+    if (haveMem) {
+        wprintf(L"Private bytes: %lu KB\n", (unsigned long)(pmc.PrivateUsage / 1024));
+        wprintf(L"Working set: %lu KB (peak %lu KB)\n", (unsigned long)(pmc.WorkingSetSize / 1024), (unsigned long)(pmc.PeakWorkingSetSize / 1024));
+    } else {
+        wprintf(L"Private bytes: <unavailable>\n");
+    }
+    
+    CloseHandle(hProcess);
+    return TRUE;
+}
+
+// CLI implementation: Print the popup latency histograms and cache counters a session publishes
+static BOOL cli_stats_pid(DWORD pid) {
+    HWND hwnd = NULL;
+    WCHAR title[260] = {0};
+    
+    if (!find_winmacmenu_window_by_pid(pid, &hwnd, title, ARRAYSIZE(title))) {
+        wprintf(L"Error: No WinMacMenu session found with PID %lu\n", pid);
+        return FALSE;
+    }
+    
+    HANDLE mapping = NULL;
+    const PerfShared* st = perf_map_process(pid, &mapping);
+    if (!st) {
+        wprintf(L"Error: Session %lu does not publish statistics (older version?)\n", pid);
+        return FALSE;
+    }
+    
+    wprintf(L"WinMacMenu session (PID: %lu, Title: %s)\n\n", pid, title);
+    wprintf(L"%-26s %7s %9s %9s %9s %9s %9s\n", L"Phase (ms)", L"Count", L"Mean", L"p50", L"p95", L"p99", L"Max");
+    for (int i = 0; i < PERF_PHASE_COUNT; ++i) {
+        const PerfHistogram* h = &st->hist[i];
+        if (h->count <= 0) continue;
+        wprintf(L"%-26s %7ld %9.2f %9.2f %9.2f %9.2f %9.2f\n", perf_phase_name(i), h->count,
+                (double)h->totalUs / h->count / 1000.0,
+                perf_percentile(h, 50) / 1000.0, perf_percentile(h, 95) / 1000.0,
+                perf_percentile(h, 99) / 1000.0, h->maxUs / 1000.0);
+    }
+    
+    // Most recent popups, newest first
+    LONG next = st->ringNext;
+    int shown = 0;
+    for (LONG n = next; n > 0 && next - n < PERF_RING_SIZE && shown < 10; --n) {
+        const PerfSample* s = &st->ring[(n - 1) & (PERF_RING_SIZE - 1)];
+        if (s->phase != PERF_SHOW) continue;
+        if (shown++ == 0) wprintf(L"\nRecent popups (ms):");
+        wprintf(L" %.2f", s->us / 1000.0);
+    }
+    if (shown) wprintf(L"\n");
+    
+    const PerfCounters* c = &st->counters;
+    wprintf(L"\nPopups: %lu (%lu pre-built)\n", c->popups, c->warmHits);
+    wprintf(L"Menu model: %lu items recompiled, %lu reused\n", c->modelRebuilt, c->modelReused);
+    wprintf(L"Folder cache: %lu hits, %lu misses, %lu invalidations, %lu evictions, %ld entries\n",
+            c->dirHits, c->dirMisses, c->dirInvalidations, c->dirEvictions, c->dirEntries);
+    wprintf(L"Icon cache: %lu hits, %lu pack hits, %lu misses, %ld icons, %ld bitmaps\n",
+            c->iconHits, c->iconPackHits, c->iconMisses, c->iconEntries, c->iconBitmaps);
+    wprintf(L"Process info cache: %lu hits, %lu misses, %ld entries\n", c->procHits, c->procMisses, c->procEntries);
+    
+    perf_unmap(st, mapping);
+    return TRUE;
+}
+
+// CLI implementation: Build the menu of the given (or default) config repeatedly in this process
+// without showing it, and print timings, memory and leftover GDI/USER objects
+static BOOL cli_bench(const WCHAR* configPath, int iterations) {
+    if (configPath[0]) config_set_default_path(configPath);
+    HANDLE hProcess = GetCurrentProcess();
+    DWORD gdiBefore = GetGuiResources(hProcess, GR_GDIOBJECTS);
+    DWORD userBefore = GetGuiResources(hProcess, GR_USEROBJECTS);
+    PROCESS_MEMORY_COUNTERS_EX before = { sizeof(before) }, after = { sizeof(after) };
+    GetProcessMemoryInfo(hProcess, (PROCESS_MEMORY_COUNTERS*)&before, sizeof(before));
+    
+    MenuBenchResult r;
+    if (!MenuRunBenchmark(iterations, &r)) {
+        wprintf(L"Error: Benchmark could not allocate its working memory\n");
+        return FALSE;
+    }
+    
+    GetProcessMemoryInfo(hProcess, (PROCESS_MEMORY_COUNTERS*)&after, sizeof(after));
+    wprintf(L"WinMacMenu menu build benchmark (%d iterations)\n", r.iterations);
+    wprintf(L"Config: %d items, menu model: %d nodes (%lu bytes), last popup: %d items\n\n",
+            r.configItems, r.modelNodes, (unsigned long)r.modelBytes, r.menuItems);
+    wprintf(L"Config parse:            %9.3f ms\n", r.configLoadMs);
+    wprintf(L"Model compile (cold):    %9.3f ms\n", r.modelColdMs);
+    wprintf(L"Model update (warm):     %9.3f ms\n", r.modelWarmMs);
+    wprintf(L"First popup build:       %9.3f ms\n", r.firstBuildMs);
+    wprintf(L"Popup build (avg):       %9.3f ms\n", r.buildMs);
+    wprintf(L"Folder popups expanded:  %9.3f ms\n", r.expandMs);
+    wprintf(L"Session arena (max):     %9lu KB\n", (unsigned long)(r.sessionBytes / 1024));
+    wprintf(L"Private bytes growth:    %9ld KB\n", (long)(((LONGLONG)after.PrivateUsage - (LONGLONG)before.PrivateUsage) / 1024));
+    wprintf(L"GDI objects left:        %9ld\n", (long)GetGuiResources(hProcess, GR_GDIOBJECTS) - (long)gdiBefore);
+    wprintf(L"USER objects left:       %9ld\n", (long)GetGuiResources(hProcess, GR_USEROBJECTS) - (long)userBefore);
+    return TRUE;
+}
+
 // CLI implementation: Show help
 static void cli_show_help(void) {
     wprintf(L"WinMacMenu - Command Line Interface\n");
@@ -352,6 +485,9 @@ static void cli_show_help(void) {
     wprintf(L"  --shutdown <pid>, -k    Shutdown specific session by PID\n");
     wprintf(L"  --settings <pid>, -s    Open settings for specific session by PID\n");
     wprintf(L"  --open-ini <pid>, -o    Open ini file for specific session by PID\n");
+    wprintf(L"  --memory <pid>, -m      Show GDI/USER objects and private bytes of session by PID\n");
+    wprintf(L"  --stats <pid>           Show popup latency per phase and cache counters of session by PID\n");
+    wprintf(L"  --bench [iterations]    Build the menu repeatedly without showing it and print timings\n");
     wprintf(L"  --help, -h, /?          Show this help message\n\n");
     wprintf(L"Examples:\n");
     wprintf(L"  WinMacMenu.exe --list\n");
@@ -366,6 +502,9 @@ static void cli_show_help(void) {
     wprintf(L"  WinMacMenu.exe -s 1234\n");
     wprintf(L"  WinMacMenu.exe --open-ini 1234\n");
     wprintf(L"  WinMacMenu.exe -o 1234\n");
+    wprintf(L"  WinMacMenu.exe --memory 1234\n");
+    wprintf(L"  WinMacMenu.exe --stats 1234\n");
+    wprintf(L"  WinMacMenu.exe --bench 50 --config \"custom.ini\"\n");
     wprintf(L"  WinMacMenu.exe --config \"custom.ini\"\n\n");
     wprintf(L"When run without CLI options, WinMacMenu starts normally in GUI mode.\n");
 }
@@ -567,32 +706,62 @@ static DWORD simple_hash_w(const wchar_t* s) {
     return h;
 }
 
+// Force Quit window tracking only pays off when this process stays resident and the menu has the item
+static void sync_window_tracking(HWND hWnd) {
+    BOOL wanted = FALSE;
+    if (g_runInBackground) {
+        for (int i = 0; i < g_cfg.count; ++i) {
+            if (g_cfg.items[i].type == CI_TASKKILL) { wanted = TRUE; break; }
+        }
+    }
+    if (wanted) winlist_start(hWnd); else winlist_stop(hWnd);
+}
+
 LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+    if (winlist_on_message(msg, wParam, lParam)) return 0;
     switch (msg) {
     case WM_CREATE:
         InitCommonControls();
         theme_apply_to_window(hWnd);
         g_msgTaskbarCreated = RegisterWindowMessageW(L"TaskbarCreated");
         if (g_runInBackground && g_cfg.showTrayIcon) tray_add(hWnd);
+        sync_window_tracking(hWnd);
+        MenuPrewarmEnable(hWnd, g_runInBackground);
         return 0;
     case WM_DESTROY:
+        MenuPrewarmEnable(hWnd, FALSE);
+        iconcache_flush(); // icon images rasterized since the last pack write
+        winlist_stop(hWnd);
         if (g_trayAdded) tray_remove(hWnd);
         PostQuitMessage(0);
         return 0;
     case WM_SETTINGCHANGE:
     case WM_THEMECHANGED:
+        theme_refresh(); // icon caches follow the theme generation
         theme_apply_to_window(hWnd);
+        MenuPrewarmInvalidate(hWnd);
         if (g_runInBackground && g_cfg.showTrayIcon) tray_reload(hWnd); // ensure themed tray icon updates
         return 0;
     case WM_DEVICECHANGE: // try to ensure tray is restored on some device changes
         if (g_runInBackground && g_cfg.showTrayIcon && !g_trayAdded) tray_add(hWnd);
+        // Only volumes appearing or going away change This PC; DBT_DEVNODES_CHANGED storms are ignored
+        if ((wParam == DBT_DEVICEARRIVAL || wParam == DBT_DEVICEREMOVECOMPLETE) && lParam &&
+            ((const DEV_BROADCAST_HDR*)lParam)->dbch_devicetype == DBT_DEVTYP_VOLUME) {
+            places_invalidate_drives(); // labels and media change without touching the drive mask
+            MenuPrewarmInvalidate(hWnd);
+        }
         break;
     case WM_DPICHANGED:
+        theme_refresh(); // menu icons are rasterized for the DPI in the theme state
+        MenuPrewarmInvalidate(hWnd);
         // Reload icons at new DPI (tray + class small) for sharpness
         if (g_runInBackground && g_cfg.showTrayIcon) {
             tray_reload(hWnd);
         }
         break;
+    case WM_TIMER:
+        if (wParam == IDT_MENU_PREWARM) { MenuPrewarmOnTimer(hWnd); return 0; }
+        break;
     case WM_ACTIVATEAPP:
         if (g_menuShowingNow && wParam == FALSE) { EndMenu(); return 0; }
         break;
@@ -727,12 +896,16 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
                 // Toggle ShowIcons (legacy icons in menu)
                 g_cfg.showIcons = !g_cfg.showIcons;
                 WritePrivateProfileStringW(L"General", L"ShowIcons", g_cfg.showIcons ? L"true" : L"false", g_cfg.iniPath);
+                MenuPrewarmInvalidate(hWnd);
             } else if (cmd == 10005) {
                 // Show settings dialog (replaces opening raw INI)
                 Config before = g_cfg; // snapshot
                 if (ShowSettingsDialog(hWnd, &g_cfg)) {
                     // Apply changes that need runtime updates
                     g_runInBackground = g_cfg.runInBackground;
+                    sync_window_tracking(hWnd);
+                    MenuPrewarmEnable(hWnd, g_runInBackground);
+                    MenuPrewarmInvalidate(hWnd);
                     if (g_cfg.showTrayIcon != before.showTrayIcon) {
                         if (g_cfg.showTrayIcon) tray_add(hWnd); else tray_remove(hWnd);
                     } else if (g_cfg.showTrayIcon) {
@@ -849,6 +1022,9 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
             if (ShowSettingsDialog(hWnd, &g_cfg)) {
                 // Apply changes that need runtime updates
                 g_runInBackground = g_cfg.runInBackground;
+                sync_window_tracking(hWnd);
+                MenuPrewarmEnable(hWnd, g_runInBackground);
+                MenuPrewarmInvalidate(hWnd);
                 if (g_cfg.showTrayIcon != before.showTrayIcon) {
                     if (g_cfg.showTrayIcon) tray_add(hWnd); else tray_remove(hWnd);
                 } else if (g_cfg.showTrayIcon) {
@@ -901,6 +1077,9 @@ static BOOL cli_reload_pid(DWORD pid);
 static BOOL cli_shutdown_pid(DWORD pid);
 static BOOL cli_settings_pid(DWORD pid);
 static BOOL cli_open_ini_pid(DWORD pid);
+static BOOL cli_memory_pid(DWORD pid);
+static BOOL cli_stats_pid(DWORD pid);
+static BOOL cli_bench(const WCHAR* configPath, int iterations);
 static void cli_show_help(void);
 static BOOL find_winmacmenu_window_by_pid(DWORD pid, HWND* outHwnd, WCHAR* outTitle, size_t titleSize);
 
@@ -964,6 +1143,39 @@ static BOOL parse_cli_args(CliArgs* args) {
             }
             ++i; // Skip next argument
         }
+        else if ((!lstrcmpiW(argv[i], L"--memory") || !lstrcmpiW(argv[i], L"-m")) && i + 1 < argc) {
+            args->mode = CLI_MODE_MEMORY;
+            args->targetPid = _wtoi(argv[i + 1]);
+            if (args->targetPid == 0) {
+                wprintf(L"Error: Invalid PID '%s' for %s\n", argv[i + 1], argv[i]);
+                result = FALSE;
+                break;
+            }
+            ++i; // Skip next argument
+        }
+        else if (!lstrcmpiW(argv[i], L"--stats") && i + 1 < argc) {
+            args->mode = CLI_MODE_STATS;
+            args->targetPid = _wtoi(argv[i + 1]);
+            if (args->targetPid == 0) {
+                wprintf(L"Error: Invalid PID '%s' for %s\n", argv[i + 1], argv[i]);
+                result = FALSE;
+                break;
+            }
+            ++i; // Skip next argument
+        }
+        else if (!lstrcmpiW(argv[i], L"--bench")) {
+            args->mode = CLI_MODE_BENCH;
+            args->iterations = 20;
+            if (i + 1 < argc && argv[i + 1][0] >= L'0' && argv[i + 1][0] <= L'9') {
+                args->iterations = _wtoi(argv[i + 1]);
+                if (args->iterations <= 0) {
+                    wprintf(L"Error: Invalid iteration count '%s' for %s\n", argv[i + 1], argv[i]);
+                    result = FALSE;
+                    break;
+                }
+                ++i; // Skip next argument
+            }
+        }
         else if (!lstrcmpiW(argv[i], L"--help") || !lstrcmpiW(argv[i], L"-h") || !lstrcmpiW(argv[i], L"/?")) {
             args->mode = CLI_MODE_HELP;
         }
@@ -1028,6 +1240,15 @@ int APIENTRY wWinMain(HINSTANCE hInstance, HINSTANCE hPrev, LPWSTR lpCmdLine, in
             case CLI_MODE_OPEN_INI:
                 success = cli_open_ini_pid(cliArgs.targetPid);
                 break;
+            case CLI_MODE_MEMORY:
+                success = cli_memory_pid(cliArgs.targetPid);
+                break;
+            case CLI_MODE_STATS:
+                success = cli_stats_pid(cliArgs.targetPid);
+                break;
+            case CLI_MODE_BENCH:
+                success = cli_bench(cliArgs.configPath, cliArgs.iterations);
+                break;
             case CLI_MODE_HELP:
                 cli_show_help();
                 success = TRUE;
@@ -1078,7 +1299,10 @@ int APIENTRY wWinMain(HINSTANCE hInstance, HINSTANCE hPrev, LPWSTR lpCmdLine, in
     }
 
     // Load config before creating window so tray-add logic has correct flags
+    perf_init();
+    LONGLONG tLoad = perf_begin();
     config_load(&g_cfg);
+    perf_end(PERF_CONFIG_LOAD, tLoad);
     g_runInBackground = g_cfg.runInBackground;
 
     WNDCLASSEXW wc = { sizeof(wc) };
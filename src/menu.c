@@ -12,6 +12,19 @@
 #include "recent.h"
 #include "util.h"
 #include "theme.h"
+#include "actions.h"
+#include "arena.h"
+#include "listing.h"
+#include "prefetch.h"
+#include "dircache.h"
+#include "procinfo_win32.h"
+#include "strset.h"
+#include "winlist.h"
+#include "iconcache_win32.h"
+#include "places_win32.h"
+#include "menumodel.h"
+#include "prewarm.h"
+#include "perf.h"
 
 #ifndef ARRAYSIZE
 #define ARRAYSIZE(a) (sizeof(a)/sizeof((a)[0]))
@@ -24,50 +37,142 @@
 
 BOOL g_shouldReopenMenu = FALSE;
 
-typedef struct MapEntry {
-    UINT id;
-    WCHAR path[MAX_PATH];
-} MapEntry;
-
 typedef struct FolderMenuData {
     WCHAR path[MAX_PATH];
     int depth;
     int offset;
     BOOL forceLinks;
+    FolderListing* listing; // "Show more items..." pages reuse the listing of the previous page
 } FolderMenuData;
 
 // Forward declaration
-static void attach_menu_data(HMENU hMenu, const WCHAR* path, int depth, int offset, BOOL forceLinks);
+static FolderMenuData* attach_menu_data(HMENU hMenu, const WCHAR* path, int depth, int offset, BOOL forceLinks);
 
 
 static Config g_cfg; // loaded on demand
-static MapEntry g_map[4096];
-static UINT g_mapCount = 0;
+static MenuModel g_model; // compiled root menu, kept between popups
 static UINT g_nextFolderId = IDM_FOLDER_BASE;
+// Per-menu-session storage: action table, icon/bitmap tables, item path strings (dwItemData) and
+// folder descriptors (MIM_MENUDATA). Released in one shot after DestroyMenu.
+static Arena g_session;
 typedef struct ItemIcon { UINT id; HICON h; } ItemIcon;
-static ItemIcon g_itemIcons[256];
-static UINT g_itemIconCount = 0;
+static ItemIcon* g_itemIcons = NULL;
+static UINT g_itemIconCount = 0, g_itemIconCap = 0;
 typedef struct ItemBmp { UINT id; HBITMAP hbmp; } ItemBmp;
-static ItemBmp g_itemBmps[256];
-static UINT g_itemBmpCount = 0;
+static ItemBmp* g_itemBmps = NULL;
+static UINT g_itemBmpCount = 0, g_itemBmpCap = 0;
+// Icons created for this session only (shell icons of Home/This PC items, Force Quit copies)
+static HICON* g_ownedIcons = NULL;
+static UINT g_ownedIconCount = 0, g_ownedIconCap = 0;
 // Forward declarations for legacy icon helpers
 static HBITMAP icon_to_hbmp(HICON hico, int cx, int cy);
+static HBITMAP item_bitmap_for_icon(UINT id, HICON hico);
 static void assign_legacy_item_bitmap(HMENU hMenu, UINT id, HICON hico);
+static void free_session_listings(void);
+
+// Re-registering an id appends; get_item_icon scans from the end so the latest icon wins
 static void add_item_icon(UINT id, HICON h) {
     if (!h) return;
-    for (UINT i=0;i<g_itemIconCount;i++) if (g_itemIcons[i].id==id) { g_itemIcons[i].h=h; return; }
-    if (g_itemIconCount < ARRAYSIZE(g_itemIcons)) { g_itemIcons[g_itemIconCount++] = (ItemIcon){ id, h }; }
+    if (g_itemIconCount == g_itemIconCap) {
+        ItemIcon* grown = (ItemIcon*)arena_grow(&g_session, g_itemIcons, g_itemIconCount, &g_itemIconCap, sizeof(ItemIcon));
+        if (!grown) return;
+        g_itemIcons = grown;
+    }
+    g_itemIcons[g_itemIconCount++] = (ItemIcon){ id, h };
+}
+
+// Remember a menu item bitmap so it can be deleted when the session ends (menus don't own hbmpItem)
+static void track_item_bitmap(UINT id, HBITMAP hb) {
+    if (!hb) return;
+    if (g_itemBmpCount == g_itemBmpCap) {
+        ItemBmp* grown = (ItemBmp*)arena_grow(&g_session, g_itemBmps, g_itemBmpCount, &g_itemBmpCap, sizeof(ItemBmp));
+        if (!grown) return;
+        g_itemBmps = grown;
+    }
+    g_itemBmps[g_itemBmpCount++] = (ItemBmp){ id, hb };
+}
+
+// Remember an icon this session created so it is destroyed with the menu (cache-owned icons are not tracked)
+static HICON track_item_icon(HICON h) {
+    if (!h) return NULL;
+    if (g_ownedIconCount == g_ownedIconCap) {
+        HICON* grown = (HICON*)arena_grow(&g_session, g_ownedIcons, g_ownedIconCount, &g_ownedIconCap, sizeof(HICON));
+        if (!grown) return h;
+        g_ownedIcons = grown;
+    }
+    g_ownedIcons[g_ownedIconCount++] = h;
+    return h;
+}
+
+// The session as the build left it. A warm refresh rolls back to it before regenerating the
+// Recent and Force Quit popups, so refreshes reuse the same arena memory and the icons and
+// bitmaps the previous refresh made are released instead of piling up until the next show.
+typedef struct SessionMark {
+    BOOL set;
+    ArenaMark arena;
+    ItemIcon* itemIcons; UINT itemIconCount, itemIconCap;
+    ItemBmp* itemBmps; UINT itemBmpCount, itemBmpCap;
+    HICON* ownedIcons; UINT ownedIconCount, ownedIconCap;
+} SessionMark;
+static SessionMark g_buildMark;
+
+static void session_mark(void) {
+    SessionMark* m = &g_buildMark;
+    m->set = TRUE;
+    m->arena = arena_mark(&g_session);
+    m->itemIcons = g_itemIcons; m->itemIconCount = g_itemIconCount; m->itemIconCap = g_itemIconCap;
+    m->itemBmps = g_itemBmps; m->itemBmpCount = g_itemBmpCount; m->itemBmpCap = g_itemBmpCap;
+    m->ownedIcons = g_ownedIcons; m->ownedIconCount = g_ownedIconCount; m->ownedIconCap = g_ownedIconCap;
+    actions_mark();
+}
+
+// Tables grown since the mark moved to newer arena blocks; their old blocks still hold the
+// entries that existed at the mark
+static void session_rollback(void) {
+    const SessionMark* m = &g_buildMark;
+    if (!m->set) return;
+    for (UINT i = m->itemBmpCount; i < g_itemBmpCount; ++i) DeleteObject(g_itemBmps[i].hbmp);
+    for (UINT i = m->ownedIconCount; i < g_ownedIconCount; ++i) DestroyIcon(g_ownedIcons[i]);
+    g_itemIcons = m->itemIcons; g_itemIconCount = m->itemIconCount; g_itemIconCap = m->itemIconCap;
+    g_itemBmps = m->itemBmps; g_itemBmpCount = m->itemBmpCount; g_itemBmpCap = m->itemBmpCap;
+    g_ownedIcons = m->ownedIcons; g_ownedIconCount = m->ownedIconCount; g_ownedIconCap = m->ownedIconCap;
+    actions_rollback();
+    arena_reset_to(&g_session, m->arena);
+}
+
+// End of a menu session: drop bitmaps, the dispatch table and everything else held by the arena
+static void menu_session_release(void) {
+    g_buildMark.set = FALSE;
+    prefetch_cancel_all();
+    for (UINT i = 0; i < g_itemBmpCount; ++i) DeleteObject(g_itemBmps[i].hbmp);
+    g_itemBmps = NULL; g_itemBmpCount = 0; g_itemBmpCap = 0;
+    for (UINT i = 0; i < g_ownedIconCount; ++i) DestroyIcon(g_ownedIcons[i]);
+    g_ownedIcons = NULL; g_ownedIconCount = 0; g_ownedIconCap = 0;
+    g_itemIcons = NULL; g_itemIconCount = 0; g_itemIconCap = 0;
+    actions_reset(NULL);
+    free_session_listings();
+    dircache_end_session();
+    iconcache_end_session();
+    arena_reset(&g_session);
 }
 static HICON get_item_icon(UINT id) {
-    for (UINT i=0;i<g_itemIconCount;i++) if (g_itemIcons[i].id==id) return g_itemIcons[i].h;
+    for (UINT i = g_itemIconCount; i-- > 0;) if (g_itemIcons[i].id == id) return g_itemIcons[i].h;
     return NULL;
 }
 
 static int get_preferred_icon_size() {
-    HDC hdc = GetDC(NULL);
-    int dpi = GetDeviceCaps(hdc, LOGPIXELSX);
-    ReleaseDC(NULL, hdc);
-    return MulDiv(16, dpi, 96);
+    return MulDiv(16, theme_dpi(), 96);
+}
+
+// Menu item bitmap for an icon: the icon cache's pooled bitmap (reused across popups) when the icon
+// came from the cache, else a conversion that is deleted with the session
+static HBITMAP item_bitmap_for_icon(UINT id, HICON hico) {
+    HBITMAP hb = iconcache_get_bitmap(hico);
+    if (hb) return hb;
+    int size = get_preferred_icon_size();
+    hb = icon_to_hbmp(hico, size, size);
+    track_item_bitmap(id, hb);
+    return hb;
 }
 
 // Assign an icon (converted to bitmap) to the most recently added item (typically a popup root)
@@ -76,8 +181,7 @@ static void assign_icon_to_last_popup(HMENU hMenu, HICON hico) {
     int count = GetMenuItemCount(hMenu);
     if (count <= 0) return;
     int pos = count - 1;
-    int size = get_preferred_icon_size();
-    HBITMAP hb = icon_to_hbmp(hico, size, size);
+    HBITMAP hb = item_bitmap_for_icon(0, hico);
     if (!hb) return;
     MENUITEMINFOW mii = { sizeof(mii) };
     mii.fMask = MIIM_BITMAP;
@@ -85,60 +189,13 @@ static void assign_icon_to_last_popup(HMENU hMenu, HICON hico) {
     SetMenuItemInfoW(hMenu, pos, TRUE, &mii);
 }
 
-// Helper: attempt to load an icon from either a direct .ico file path (existing logic)
-// or from a module (DLL/EXE) with an index specified using ",<index>" syntax.
-// Accepted forms:
-//   C:\Windows\System32\shell32.dll,10
-//   shell32.dll,10            (searches System32)
-//   imageres.dll,-3           (negative index still passed through; Windows treats as resource ID)
-// If no comma present, falls back to LoadImageW for .ico file.
+// Icon from an icon spec (".ico" path or "module.dll,index"), served by the icon cache.
+// The icon stays owned by the cache.
 static HICON load_icon_path_or_module(const WCHAR* spec) {
-    HICON hSmall = NULL;
-    HICON hLarge = NULL;
-    const WCHAR* comma;
-    WCHAR module[MAX_PATH];
-    size_t len;
-    const WCHAR* idxStr;
-    int idx;
-    WCHAR expanded[MAX_PATH];
-    UINT extracted;
-    int size = get_preferred_icon_size();
-
-    if (!spec || !spec[0]) return NULL;
-    comma = wcschr(spec, L',');
-    if (!comma) {
-        return (HICON)LoadImageW(NULL, spec, IMAGE_ICON, size, size, LR_LOADFROMFILE|LR_SHARED);
-    }
-    // Copy module portion up to (but not including) comma.
-    len = (size_t)(comma - spec);
-    if (len >= MAX_PATH) len = MAX_PATH - 1;
-    {
-        size_t i;
-        for (i=0;i<len;i++) module[i] = spec[i];
-        module[len] = 0;
-    }
-    idxStr = comma + 1;
-    idx = _wtoi(idxStr); // handles negative values
-    // If no backslash at all, assume System32 for bare module names like 'shell32.dll'.
-    if (!wcschr(module, L'\\')) {
-        WCHAR sysdir[MAX_PATH];
-        if (SHGetSpecialFolderPathW(NULL, sysdir, CSIDL_SYSTEM, FALSE)) {
-            WCHAR combined[MAX_PATH];
-            lstrcpynW(combined, sysdir, ARRAYSIZE(combined));
-            PathAppendW(combined, module);
-            lstrcpynW(module, combined, ARRAYSIZE(module));
-        }
-    }
-    // Expand any environment variables.
-    if (ExpandEnvironmentStringsW(module, expanded, ARRAYSIZE(expanded)) && expanded[0]) {
-        lstrcpynW(module, expanded, ARRAYSIZE(module));
-    }
-    extracted = ExtractIconExW(module, idx, &hLarge, &hSmall, 1);
-    if (extracted == 0) {
-        return (HICON)LoadImageW(NULL, spec, IMAGE_ICON, size, size, LR_LOADFROMFILE|LR_SHARED);
-    }
-    if (hLarge) DestroyIcon(hLarge);
-    return hSmall;
+    LONGLONG t = perf_begin();
+    HICON hico = iconcache_get_spec(spec, get_preferred_icon_size(), theme_is_dark());
+    perf_end(PERF_ICON_LOAD, t);
+    return hico;
 }
 
 static HICON get_system_folder_icon(void) {
@@ -152,17 +209,9 @@ static HICON get_system_folder_icon(void) {
     return hFolder;
 }
 
-static void map_add(UINT id, const WCHAR* path) {
-    if (g_mapCount < ARRAYSIZE(g_map)) {
-        g_map[g_mapCount].id = id;
-        lstrcpynW(g_map[g_mapCount].path, path, ARRAYSIZE(g_map[g_mapCount].path));
-        g_mapCount++;
-    }
-}
-
-static void attach_menu_data(HMENU hMenu, const WCHAR* path, int depth, int offset, BOOL forceLinks) {
-    FolderMenuData* data = (FolderMenuData*)LocalAlloc(LMEM_FIXED|LMEM_ZEROINIT, sizeof(FolderMenuData));
-    if (!data) return;
+static FolderMenuData* attach_menu_data(HMENU hMenu, const WCHAR* path, int depth, int offset, BOOL forceLinks) {
+    FolderMenuData* data = (FolderMenuData*)arena_alloc(&g_session, sizeof(FolderMenuData));
+    if (!data) return NULL;
     lstrcpynW(data->path, path, ARRAYSIZE(data->path));
     data->depth = depth;
     data->offset = offset;
@@ -171,27 +220,27 @@ static void attach_menu_data(HMENU hMenu, const WCHAR* path, int depth, int offs
     mi.fMask = MIM_MENUDATA;
     mi.dwMenuData = (ULONG_PTR)data;
     SetMenuInfo(hMenu, &mi);
+    return data;
 }
 
 static HICON get_file_icon(const WCHAR* path) {
-    SHFILEINFOW sfi = {0};
-    if (SHGetFileInfoW(path, 0, &sfi, sizeof(sfi), SHGFI_ICON | SHGFI_SMALLICON)) {
-        return sfi.hIcon;
-    }
-    return NULL;
+    return iconcache_get_file(path, get_preferred_icon_size(), theme_is_dark());
 }
 
 static HMENU build_recent_submenu(void) {
     HMENU sub = CreatePopupMenu();
     RecentItem* items = NULL;
     int maxItems = (g_cfg.recentMax > 0 ? g_cfg.recentMax : 12);
-    int n = recent_get_items(&items, maxItems);
+    LONGLONG t = perf_begin();
+    int n = recent_get_items(&items, maxItems, g_cfg.recentShowSlowItems);
+    perf_end(PERF_RECENT_ITEMS, t);
     if (n <= 0) {
         AppendMenuW(sub, MF_STRING | MF_GRAYED, 0, L"(None)");
         if (items) LocalFree(items);
         if (g_cfg.recentShowCleanItems) {
             AppendMenuW(sub, MF_SEPARATOR, 0, NULL);
             AppendMenuW(sub, MF_STRING, IDM_RECENT_BASE + 900, L"Clear Recent Items list");
+            actions_add(IDM_RECENT_BASE + 900, MA_RECENT_CLEAR, NULL);
         }
         return sub;
     }
@@ -217,6 +266,7 @@ static HMENU build_recent_submenu(void) {
             lstrcpynW(text, items[i].path, ARRAYSIZE(text));
         }
         AppendMenuW(sub, MF_STRING, IDM_RECENT_BASE + i, text);
+        actions_add(IDM_RECENT_BASE + i, MA_RECENT_OPEN, items[i].path);
         if (g_cfg.recentShowIcons) {
             HICON hIcon = get_file_icon(items[i].path);
             if (hIcon) {
@@ -231,6 +281,7 @@ static HMENU build_recent_submenu(void) {
     if (g_cfg.recentShowCleanItems) {
         AppendMenuW(sub, MF_SEPARATOR, 0, NULL);
         AppendMenuW(sub, MF_STRING, IDM_RECENT_BASE + 900, L"Clear Recent Items list");
+        actions_add(IDM_RECENT_BASE + 900, MA_RECENT_CLEAR, NULL);
     }
     return sub;
 }
@@ -244,174 +295,120 @@ static void get_name_from_path(const WCHAR* full, WCHAR* name, size_t cch) {
     }
 }
 
-typedef struct FileItem {
-    WCHAR name[MAX_PATH];
-    WCHAR fullPath[MAX_PATH];
-    BOOL isDir;
-    FILETIME ftLastWrite;
-    FILETIME ftCreation;
-    unsigned long long fileSize;
-} FileItem;
-
-static int compare_files(const void* a, const void* b) {
-    const FileItem* fa = (const FileItem*)a;
-    const FileItem* fb = (const FileItem*)b;
-
-    // Folders first logic
-    if (g_cfg.sortFoldersFirst) {
-        if (fa->isDir && !fb->isDir) return -1;
-        if (!fa->isDir && fb->isDir) return 1;
-    }
-
-    int res = 0;
-    switch (g_cfg.sortField) {
-        case SORT_DATE_MODIFIED:
-            res = CompareFileTime(&fa->ftLastWrite, &fb->ftLastWrite);
-            break;
-        case SORT_DATE_CREATED:
-            res = CompareFileTime(&fa->ftCreation, &fb->ftCreation);
-            break;
-        case SORT_SIZE:
-            if (fa->fileSize < fb->fileSize) res = -1;
-            else if (fa->fileSize > fb->fileSize) res = 1;
-            break;
-        case SORT_TYPE:
-        {
-            const WCHAR* extA = wcsrchr(fa->name, L'.');
-            const WCHAR* extB = wcsrchr(fb->name, L'.');
-            if (!extA) extA = L"";
-            if (!extB) extB = L"";
-            res = lstrcmpiW(extA, extB);
-            break;
-        }
-        case SORT_NAME:
-        default:
-            res = lstrcmpiW(fa->name, fb->name);
-            break;
-    }
+static FolderListing* g_sessionListings = NULL; // listings made during this menu session
 
-    if (g_cfg.sortDescending) res = -res;
-    
-    // Fallback to name if equal (always ascending for stability)
-    if (res == 0) {
-        res = lstrcmpiW(fa->name, fb->name);
+static void free_session_listings(void) {
+    while (g_sessionListings) {
+        FolderListing* next = g_sessionListings->next;
+        listing_free(g_sessionListings);
+        g_sessionListings = next;
     }
-    return res;
 }
 
-static int fill_menu_with_folder(HMENU hMenu, int insertPos, const WCHAR* path, int depth, int offset, BOOL forceLinks) {
-    WIN32_FIND_DATAW fd; WCHAR pattern[MAX_PATH];
-    PathCombineW(pattern, path, L"*");
-    HANDLE h = FindFirstFileExW(pattern, FindExInfoBasic, &fd, FindExSearchNameMatch, NULL, FIND_FIRST_EX_LARGE_FETCH);
-    if (h == INVALID_HANDLE_VALUE) {
-        InsertMenuW(hMenu, insertPos, MF_BYPOSITION | MF_STRING | MF_GRAYED, 0, L"(Empty)");
-        return 1;
-    }
+// Snapshot the folder filter/sort settings for the listing module
+static void listing_options_from_config(ListingOptions* opt) {
+    opt->showHidden = g_cfg.showHidden;
+    opt->dotMode = g_cfg.dotMode;
+    opt->sortField = g_cfg.sortField;
+    opt->sortDescending = g_cfg.sortDescending;
+    opt->sortFoldersFirst = g_cfg.sortFoldersFirst;
+    opt->sortNatural = g_cfg.sortNatural;
+}
 
-    // Collect items
-    FileItem* items = NULL;
-    int count = 0;
-    int capacity = 0;
+static int folder_page_size(void) {
+    return g_cfg.maxItems > 0 ? g_cfg.maxItems : 999999;
+}
 
-    do {
-        if (!lstrcmpW(fd.cFileName, L".") || !lstrcmpW(fd.cFileName, L"..")) continue;
-        BOOL isDot = (fd.cFileName[0] == L'.');
-        if (!g_cfg.showHidden && (fd.dwFileAttributes & FILE_ATTRIBUTE_HIDDEN)) {
-            if (!(isDot && g_cfg.dotMode > 0)) continue;
-        }
-        if (isDot) {
-            if (g_cfg.dotMode == 0) continue;
-            BOOL isDir = (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
-            if (isDir && g_cfg.dotMode == 1) continue;
-            if (!isDir && g_cfg.dotMode == 2) continue;
-        }
+// Start enumerating a folder submenu in the background while the root menu is on screen
+static void prefetch_folder(const WCHAR* path) {
+    ListingOptions opt;
+    listing_options_from_config(&opt);
+    if (dircache_contains(path, &opt)) return;
+    prefetch_submit(path, &opt, folder_page_size());
+}
 
-        if (count >= capacity) {
-            capacity = (capacity == 0) ? 16 : capacity * 2;
-            FileItem* newItems = (FileItem*)LocalAlloc(LMEM_FIXED, capacity * sizeof(FileItem));
-            if (items) {
-                memcpy(newItems, items, count * sizeof(FileItem));
-                LocalFree(items);
-            }
-            items = newItems;
-        }
-        
-        lstrcpynW(items[count].name, fd.cFileName, ARRAYSIZE(items[count].name));
-        PathCombineW(items[count].fullPath, path, fd.cFileName);
-        items[count].isDir = (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
-        items[count].ftLastWrite = fd.ftLastWriteTime;
-        items[count].ftCreation = fd.ftCreationTime;
-        items[count].fileSize = ((unsigned long long)fd.nFileSizeHigh << 32) | fd.nFileSizeLow;
-        count++;
-
-    } while (FindNextFileW(h, &fd));
-    FindClose(h);
-
-    if (count == 0) {
+// Returns NULL when the folder cannot be enumerated. Listings are owned by the folder cache, or by
+// the menu session when the cache does not take them; either way they live until the menu closes.
+static FolderListing* enumerate_folder(const WCHAR* path) {
+    ListingOptions opt;
+    listing_options_from_config(&opt);
+    FolderListing* lst = dircache_lookup(path, &opt);
+    if (lst) return lst;
+    lst = prefetch_take(path, &opt);
+    if (!lst) lst = listing_enumerate(path, &opt);
+    if (!lst) return NULL;
+    if (!dircache_insert(lst)) {
+        lst->next = g_sessionListings;
+        g_sessionListings = lst;
+    }
+    return lst;
+}
+
+static int fill_menu_with_folder(HMENU hMenu, int insertPos, const WCHAR* path, int depth, int offset, BOOL forceLinks, FolderListing* listing) {
+    FolderListing* lst = listing ? listing : enumerate_folder(path);
+    if (!lst || lst->count == 0) {
         InsertMenuW(hMenu, insertPos, MF_BYPOSITION | MF_STRING | MF_GRAYED, 0, L"(Empty)");
-        if (items) LocalFree(items);
         return 1;
     }
-
-    // Sort
-    qsort(items, count, sizeof(FileItem), compare_files);
+    int count = lst->count;
 
     // Paging
-    int max = g_cfg.maxItems;
-    if (max <= 0) max = 999999;
+    int max = folder_page_size();
     
     int start = offset;
     int end = offset + max;
     if (start > count) start = count;
     if (end > count) end = count;
 
+    // Sort only as far as this page needs
+    listing_sort_prefix(lst, end);
+
     int added = 0;
 
     // Populate
     for (int i = start; i < end; ++i) {
-        if (items[i].isDir) {
-            WCHAR name[260]; get_name_from_path(items[i].fullPath, name, ARRAYSIZE(name));
+        const ListEntry* e = listing_at(lst, i);
+        WCHAR fullPath[MAX_PATH]; listing_full_path(lst, e, fullPath, ARRAYSIZE(fullPath));
+        WCHAR name[260]; get_name_from_path(fullPath, name, ARRAYSIZE(name));
+        if (e->flags & LE_DIR) {
             if (!forceLinks && depth < g_cfg.folderMaxDepth) {
                 HMENU sub = CreatePopupMenu();
                 AppendMenuW(sub, MF_STRING | MF_GRAYED, 0, L"(Loading...)");
-                attach_menu_data(sub, items[i].fullPath, depth + 1, 0, FALSE);
+                attach_menu_data(sub, fullPath, depth + 1, 0, FALSE);
                 
                 MENUITEMINFOW mii = { sizeof(mii) };
                 mii.fMask = MIIM_STRING | MIIM_SUBMENU | MIIM_DATA;
                 mii.dwTypeData = name;
                 mii.hSubMenu = sub;
-                mii.dwItemData = (ULONG_PTR)LocalAlloc(LMEM_FIXED, (lstrlenW(items[i].fullPath) + 1) * sizeof(WCHAR));
-                if (mii.dwItemData) lstrcpyW((LPWSTR)mii.dwItemData, items[i].fullPath);
+                mii.dwItemData = (ULONG_PTR)arena_wcsdup(&g_session, fullPath);
                 InsertMenuItemW(hMenu, insertPos + added, TRUE, &mii);
             } else {
                 MENUITEMINFOW mii = { sizeof(mii) };
                 mii.fMask = MIIM_STRING | MIIM_ID | MIIM_DATA;
                 mii.dwTypeData = name;
                 mii.wID = g_nextFolderId++;
-                mii.dwItemData = (ULONG_PTR)LocalAlloc(LMEM_FIXED, (lstrlenW(items[i].fullPath) + 1) * sizeof(WCHAR));
-                if (mii.dwItemData) lstrcpyW((LPWSTR)mii.dwItemData, items[i].fullPath);
+                mii.dwItemData = (ULONG_PTR)arena_wcsdup(&g_session, fullPath);
                 InsertMenuItemW(hMenu, insertPos + added, TRUE, &mii);
-                map_add(mii.wID, items[i].fullPath);
+                actions_add(mii.wID, MA_OPEN_ITEM, fullPath);
             }
         } else {
-            WCHAR name[260]; get_name_from_path(items[i].fullPath, name, ARRAYSIZE(name));
             MENUITEMINFOW mii = { sizeof(mii) };
             mii.fMask = MIIM_STRING | MIIM_ID | MIIM_DATA;
             mii.dwTypeData = name;
             mii.wID = g_nextFolderId++;
-            mii.dwItemData = (ULONG_PTR)LocalAlloc(LMEM_FIXED, (lstrlenW(items[i].fullPath) + 1) * sizeof(WCHAR));
-            if (mii.dwItemData) lstrcpyW((LPWSTR)mii.dwItemData, items[i].fullPath);
+            mii.dwItemData = (ULONG_PTR)arena_wcsdup(&g_session, fullPath);
             InsertMenuItemW(hMenu, insertPos + added, TRUE, &mii);
-            map_add(mii.wID, items[i].fullPath);
+            actions_add(mii.wID, MA_OPEN_ITEM, fullPath);
         }
         added++;
     }
 
     if (end < count) {
-        // Show More Items
+        // Show More Items: the next page continues from this listing instead of re-enumerating
         HMENU sub = CreatePopupMenu();
         AppendMenuW(sub, MF_STRING | MF_GRAYED, 0, L"(Loading...)");
-        attach_menu_data(sub, path, depth, end, forceLinks);
+        FolderMenuData* more = attach_menu_data(sub, path, depth, end, forceLinks);
+        if (more) more->listing = lst;
         
         InsertMenuW(hMenu, insertPos + added, MF_BYPOSITION | MF_SEPARATOR, 0, NULL);
         added++;
@@ -424,7 +421,6 @@ static int fill_menu_with_folder(HMENU hMenu, int insertPos, const WCHAR* path,
         added++;
     }
 
-    if (items) LocalFree(items);
     return added;
 }
 
@@ -445,7 +441,9 @@ static void populate_folder_menu(HMENU parent, const FolderMenuData* data) {
         while (GetMenuItemCount(parent) > 0) DeleteMenu(parent, 0, MF_BYPOSITION);
     }
 
-    fill_menu_with_folder(parent, GetMenuItemCount(parent), data->path, data->depth, data->offset, data->forceLinks);
+    LONGLONG t = perf_begin();
+    fill_menu_with_folder(parent, GetMenuItemCount(parent), data->path, data->depth, data->offset, data->forceLinks, data->listing);
+    perf_end(PERF_FOLDER_FILL, t);
 }
 
 typedef struct TaskKillData {
@@ -455,17 +453,16 @@ typedef struct TaskKillData {
     UINT* pId;
     BOOL ignoreSystem;
     BOOL showIcons;
-    WCHAR** excludes;
-    int excludeCount;
     BOOL listWindows;
     BOOL allDesktops;
-    WCHAR addedNames[64][64];
-    int addedNamesCount;
+    const StringSet* excludes; // window titles to leave out
+    StringSet added;      // labels already listed (one entry per application)
 } TaskKillData;
 
 static HICON load_icon_path_or_module(const WCHAR* spec);
 
-static BOOL is_user_visible_window(HWND hwnd, BOOL allowCloakedShell) {
+// cloaked is the window's DWMWA_CLOAKED value (queried by the caller or tracked by winlist)
+static BOOL is_user_visible_window(HWND hwnd, DWORD cloaked, BOOL allowCloakedShell) {
     if (!IsWindowVisible(hwnd)) return FALSE;
 
     LONG_PTR exStyle = GetWindowLongPtrW(hwnd, GWL_EXSTYLE);
@@ -474,8 +471,7 @@ static BOOL is_user_visible_window(HWND hwnd, BOOL allowCloakedShell) {
     HWND owner = GetWindow(hwnd, GW_OWNER);
     if (owner && IsWindowVisible(owner) && !(exStyle & WS_EX_APPWINDOW)) return FALSE;
 
-    DWORD cloaked = 0;
-    if (SUCCEEDED(DwmGetWindowAttribute(hwnd, DWMWA_CLOAKED, &cloaked, sizeof(cloaked))) && cloaked) {
+    if (cloaked) {
         if (allowCloakedShell && cloaked == DWM_CLOAKED_SHELL) {
             // Allow windows cloaked by shell (virtual desktops)
         } else {
@@ -491,114 +487,61 @@ static BOOL is_user_visible_window(HWND hwnd, BOOL allowCloakedShell) {
     return TRUE;
 }
 
-static BOOL CALLBACK EnumWindowsProc(HWND hwnd, LPARAM lParam) {
-    TaskKillData* data = (TaskKillData*)lParam;
-    if (data->count >= data->max) return FALSE;
+// Adds one window to the Force Quit submenu if it passes the filters; cls/title/pid/cloaked come
+// either from a fresh query (EnumWindows) or from the tracked window list
+static void add_taskkill_window(TaskKillData* data, HWND hwnd, const WCHAR* cls, const WCHAR* title, DWORD pid, DWORD cloaked) {
+    if (!is_user_visible_window(hwnd, cloaked, data->allDesktops)) return;
 
-    if (!is_user_visible_window(hwnd, data->allDesktops)) return TRUE;
-    
-    WCHAR cls[64];
     BOOL isExplorer = FALSE;
-    if (GetClassNameW(hwnd, cls, ARRAYSIZE(cls))) {
-        if (lstrcmpiW(cls, L"Shell_TrayWnd") == 0 || lstrcmpiW(cls, L"Progman") == 0) return TRUE;
+    if (cls[0]) {
+        if (lstrcmpiW(cls, L"Shell_TrayWnd") == 0 || lstrcmpiW(cls, L"Progman") == 0) return;
         if (lstrcmpiW(cls, L"CabinetWClass") == 0) isExplorer = TRUE;
     }
 
-    WCHAR title[256];
-    if (GetWindowTextW(hwnd, title, ARRAYSIZE(title)) > 0) {
-        if (lstrcmpW(title, L"Program Manager") == 0) return TRUE;
+    if (title[0]) {
+        if (lstrcmpW(title, L"Program Manager") == 0) return;
         
         if (data->ignoreSystem) {
-            if (lstrcmpiW(title, L"Start") == 0) return TRUE;
-            if (lstrcmpiW(title, L"Windows Input Experience") == 0) return TRUE;
-            if (lstrcmpiW(title, L"Search") == 0) return TRUE;
-            if (lstrcmpiW(title, L"Cortana") == 0) return TRUE;
+            if (lstrcmpiW(title, L"Start") == 0) return;
+            if (lstrcmpiW(title, L"Windows Input Experience") == 0) return;
+            if (lstrcmpiW(title, L"Search") == 0) return;
+            if (lstrcmpiW(title, L"Cortana") == 0) return;
             // Filter UWP/System classes if needed, but title check covers user request
             if (lstrcmpiW(cls, L"Windows.UI.Core.CoreWindow") == 0 && 
                (lstrcmpiW(title, L"Start") == 0 || lstrcmpiW(title, L"Search") == 0 || lstrcmpiW(title, L"Windows Input Experience") == 0)) {
-                return TRUE;
+                return;
             }
         }
 
-        if (data->excludeCount > 0 && data->excludes) {
-            for (int i = 0; i < data->excludeCount; i++) {
-                if (lstrcmpiW(title, data->excludes[i]) == 0) return TRUE;
-            }
-        }
+        if (strset_contains(data->excludes, title)) return;
 
-        DWORD pid = 0;
-        GetWindowThreadProcessId(hwnd, &pid);
-        
         WCHAR label[256];
         lstrcpynW(label, title, ARRAYSIZE(label));
+        WCHAR path[MAX_PATH];
+        path[0] = 0;
 
         if (!data->listWindows) {
             HANDLE hProcess = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
             if (hProcess) {
-                WCHAR path[MAX_PATH];
                 DWORD size = ARRAYSIZE(path);
-                if (QueryFullProcessImageNameW(hProcess, 0, path, &size)) {
-                    // Try to get File Description
-                    DWORD handle;
-                    DWORD verSize = GetFileVersionInfoSizeW(path, &handle);
-                    BOOL gotDescription = FALSE;
-                    if (verSize > 0) {
-                        void* verData = malloc(verSize);
-                        if (verData) {
-                            if (GetFileVersionInfoW(path, handle, verSize, verData)) {
-                                struct LANGANDCODEPAGE {
-                                    WORD wLanguage;
-                                    WORD wCodePage;
-                                } *lpTranslate;
-                                UINT cbTranslate;
-
-                                // Read the list of languages and code pages.
-                                if (VerQueryValueW(verData, L"\\VarFileInfo\\Translation", (LPVOID*)&lpTranslate, &cbTranslate)) {
-                                    // Read the file description for each language and code page.
-                                    for( unsigned int i=0; i < (cbTranslate/sizeof(struct LANGANDCODEPAGE)); i++ ) {
-                                        WCHAR subBlock[50];
-                                        wsprintfW(subBlock, L"\\StringFileInfo\\%04x%04x\\FileDescription", lpTranslate[i].wLanguage, lpTranslate[i].wCodePage);
-                                        
-                                        WCHAR* description = NULL;
-                                        UINT descLen = 0;
-                                        if (VerQueryValueW(verData, subBlock, (LPVOID*)&description, &descLen) && descLen > 0) {
-                                            lstrcpynW(label, description, ARRAYSIZE(label));
-                                            gotDescription = TRUE;
-                                            break;
-                                        }
-                                    }
-                                }
-                            }
-                            free(verData);
-                        }
-                    }
+                if (!QueryFullProcessImageNameW(hProcess, 0, path, &size)) path[0] = 0;
+                if (path[0]) {
+                    // File Description (or file name), parsed once per executable
+                    procinfo_get_label(path, label, ARRAYSIZE(label));
 
                     WCHAR* name = PathFindFileNameW(path);
-                    if (!gotDescription) {
-                        lstrcpynW(label, name, ARRAYSIZE(label));
-                    }
-                    
                     if (lstrcmpiW(name, L"explorer.exe") == 0) isExplorer = TRUE;
 
                     // Check duplicates
-                    for (int i = 0; i < data->addedNamesCount; i++) {
-                        if (lstrcmpiW(data->addedNames[i], label) == 0) {
-                            CloseHandle(hProcess);
-                            return TRUE; // Skip duplicate
-                        }
-                    }
-                    
-                    if (data->addedNamesCount < 64) {
-                        lstrcpynW(data->addedNames[data->addedNamesCount++], label, 64);
+                    if (!strset_add(&data->added, label)) {
+                        CloseHandle(hProcess);
+                        return; // Skip duplicate
                     }
                 }
                 CloseHandle(hProcess);
             }
         }
 
-        WCHAR cmd[64];
-        wsprintfW(cmd, L"TASKKILL:%u", pid);
-        
         AppendMenuW(data->hMenu, MF_STRING, *data->pId, label);
         
         if (data->showIcons) {
@@ -611,9 +554,10 @@ static BOOL CALLBACK EnumWindowsProc(HWND hwnd, LPARAM lParam) {
             if (!hIcon) hIcon = (HICON)GetClassLongPtrW(hwnd, GCLP_HICONSM);
             if (!hIcon) hIcon = (HICON)SendMessageW(hwnd, WM_GETICON, ICON_BIG, 0);
             if (!hIcon) hIcon = (HICON)GetClassLongPtrW(hwnd, GCLP_HICON);
+            if (!hIcon && path[0]) hIcon = procinfo_get_icon(path); // cached, copied below like window icons
 
             if (hIcon) {
-                HICON hCopy = CopyIcon(hIcon);
+                HICON hCopy = track_item_icon(CopyIcon(hIcon));
                 if (hCopy) {
                     add_item_icon(*data->pId, hCopy);
                     if (g_cfg.menuStyle == STYLE_LEGACY && g_cfg.showIcons) {
@@ -623,668 +567,371 @@ static BOOL CALLBACK EnumWindowsProc(HWND hwnd, LPARAM lParam) {
             }
         }
         
-        map_add(*data->pId, cmd);
+        MenuAction* act = actions_add(*data->pId, MA_TASKKILL, NULL);
+        if (act) {
+            act->arg = pid;
+            act->hwnd = hwnd;
+        }
         
         (*data->pId)++;
         data->count++;
     }
+}
+
+static BOOL CALLBACK EnumWindowsProc(HWND hwnd, LPARAM lParam) {
+    TaskKillData* data = (TaskKillData*)lParam;
+    if (data->count >= data->max) return FALSE;
+    if (!IsWindowVisible(hwnd)) return TRUE;
+
+    WCHAR cls[64];
+    WCHAR title[256];
+    if (!GetClassNameW(hwnd, cls, ARRAYSIZE(cls))) cls[0] = 0;
+    if (GetWindowTextW(hwnd, title, ARRAYSIZE(title)) <= 0) title[0] = 0;
+    DWORD pid = 0;
+    GetWindowThreadProcessId(hwnd, &pid);
+    DWORD cloaked = 0;
+    if (FAILED(DwmGetWindowAttribute(hwnd, DWMWA_CLOAKED, &cloaked, sizeof(cloaked)))) cloaked = 0;
+    add_taskkill_window(data, hwnd, cls, title, pid, cloaked);
     return TRUE;
 }
 
-static HMENU build_taskkill_submenu(int maxItems, BOOL ignoreSystem, BOOL showIcons, WCHAR** excludes, int excludeCount, BOOL listWindows, BOOL allDesktops) {
+static HMENU build_taskkill_submenu(int maxItems, BOOL ignoreSystem, BOOL showIcons, const StringSet* excludes, BOOL listWindows, BOOL allDesktops) {
     HMENU sub = CreatePopupMenu();
     UINT id = IDM_TASKKILL_BASE;
-    TaskKillData data = { sub, 0, maxItems, &id, ignoreSystem, showIcons, excludes, excludeCount, listWindows, allDesktops, {{0}}, 0 };
-    EnumWindows(EnumWindowsProc, (LPARAM)&data);
+    TaskKillData data = { sub, 0, maxItems, &id, ignoreSystem, showIcons, listWindows, allDesktops, excludes };
+    strset_init(&data.added, &g_session);
+    WinListEntry* wins = NULL;
+    int n = winlist_active() ? winlist_snapshot(&wins) : 0;
+    if (wins) {
+        // Tracked model is already current; only the filters run here
+        for (int i = 0; i < n && data.count < data.max; ++i) {
+            add_taskkill_window(&data, wins[i].hwnd, wins[i].cls, wins[i].title, wins[i].pid, wins[i].cloaked);
+        }
+        LocalFree(wins);
+    } else {
+        EnumWindows(EnumWindowsProc, (LPARAM)&data);
+    }
     if (data.count == 0) {
         AppendMenuW(sub, MF_STRING | MF_GRAYED, 0, L"(None)");
     }
     return sub;
 }
 
-// GUID for shell:UsersFilesFolder {59031a47-3f72-44a7-89c5-5595fe6b30ee}
-static const GUID CLSID_UsersFilesFolder = { 0x59031a47, 0x3f72, 0x44a7, { 0x89, 0xc5, 0x55, 0x95, 0xfe, 0x6b, 0x30, 0xee } };
-
-static int fill_menu_with_home(HMENU hMenu, int insertPos, BOOL isSubmenu) {
-    CoInitialize(NULL);
+// Icons of This PC and Home items: in submenus when the section's icons are on and ShowIcons != 0,
+// at the root only in legacy mode (ShowIcons == 1)
+static BOOL place_icons_allowed(BOOL sectionIcons, BOOL isSubmenu) {
+    if (!sectionIcons) return FALSE;
+    return isSubmenu ? g_cfg.showIcons != 0 : g_cfg.showIcons == 1;
+}
 
-    IShellFolder* pDesktop = NULL;
-    if (FAILED(SHGetDesktopFolder(&pDesktop))) {
-        CoUninitialize();
-        return 0;
+// Inserts one This PC or Home item: a folder submenu filled when opened, or a command opening it
+static void insert_place_item(HMENU hMenu, int pos, const PlaceItem* it, BOOL asSubmenu, HICON hIcon) {
+    UINT id = g_nextFolderId++;
+    MENUITEMINFOW mii = { sizeof(mii) };
+    mii.fMask = MIIM_STRING | MIIM_ID | MIIM_DATA;
+    mii.dwTypeData = (LPWSTR)it->label;
+    mii.wID = id;
+    if (asSubmenu) {
+        HMENU sub = CreatePopupMenu();
+        AppendMenuW(sub, MF_STRING | MF_GRAYED, 0, L"(Loading...)");
+        attach_menu_data(sub, it->path, 1, 0, FALSE);
+        mii.fMask |= MIIM_SUBMENU;
+        mii.hSubMenu = sub;
+    }
+    if (it->path[0]) mii.dwItemData = (ULONG_PTR)arena_wcsdup(&g_session, it->path);
+    InsertMenuItemW(hMenu, pos, TRUE, &mii);
+    if (!asSubmenu && it->path[0]) actions_add(id, MA_OPEN_ITEM, it->path);
+
+    if (!hIcon) return;
+    // Register icon for both cases (normal and submenu)
+    add_item_icon(id, hIcon);
+    if (g_cfg.menuStyle != STYLE_LEGACY) return;
+    if (asSubmenu) {
+        HBITMAP hbmp = item_bitmap_for_icon(id, hIcon);
+        if (hbmp) {
+            MENUITEMINFOW miiIcon = { sizeof(miiIcon) };
+            miiIcon.fMask = MIIM_BITMAP;
+            miiIcon.hbmpItem = hbmp;
+            SetMenuItemInfoW(hMenu, pos, TRUE, &miiIcon);
+        }
+    } else {
+        assign_legacy_item_bitmap(hMenu, id, hIcon);
     }
+}
 
-    LPITEMIDLIST pidlUsersFiles = NULL;
-    // Parse ::{GUID}
-    if (FAILED(pDesktop->lpVtbl->ParseDisplayName(pDesktop, NULL, NULL, L"::{59031a47-3f72-44a7-89c5-5595fe6b30ee}", NULL, &pidlUsersFiles, NULL))) {
-        pDesktop->lpVtbl->Release(pDesktop);
-        CoUninitialize();
-        return 0;
+// Home items come from the places cache, read again only after the profile folder changed
+static int fill_menu_with_home(HMENU hMenu, int insertPos, BOOL isSubmenu) {
+    const PlaceItem* items;
+    int count;
+    if (!places_get_home(g_cfg.showHidden, &items, &count)) return 0;
+    BOOL allowIcons = place_icons_allowed(g_cfg.homeShowIcons, isSubmenu);
+    for (int i = 0; i < count; ++i) {
+        const PlaceItem* it = &items[i];
+        HICON hIcon = NULL;
+        if (allowIcons && it->idl) {
+            SHFILEINFOW sfi = {0};
+            if (SHGetFileInfoW((LPCWSTR)it->idl, 0, &sfi, sizeof(sfi), SHGFI_PIDL | SHGFI_ICON | SHGFI_SMALLICON)) {
+                hIcon = track_item_icon(sfi.hIcon);
+            }
+        }
+        insert_place_item(hMenu, insertPos + i, it, it->isFolder && g_cfg.homeItemsAsSubmenus, hIcon);
     }
+    return count;
+}
 
-    IShellFolder* pUsersFiles = NULL;
-    if (FAILED(pDesktop->lpVtbl->BindToObject(pDesktop, pidlUsersFiles, NULL, &IID_IShellFolder, (void**)&pUsersFiles))) {
-        CoTaskMemFree(pidlUsersFiles);
-        pDesktop->lpVtbl->Release(pDesktop);
-        CoUninitialize();
-        return 0;
+// Drives and their labels come from the places cache, read again only after a volume change
+static int fill_menu_with_thispc(HMENU hMenu, int insertPos, BOOL isSubmenu) {
+    const PlaceItem* items;
+    int count;
+    if (!places_get_drives(&items, &count)) {
+        InsertMenuW(hMenu, insertPos, MF_BYPOSITION | MF_STRING | MF_GRAYED, 0, L"(No drives found)");
+        return 1;
     }
+    BOOL allowIcons = place_icons_allowed(g_cfg.thisPCShowIcons, isSubmenu);
+    for (int i = 0; i < count; ++i) {
+        const PlaceItem* it = &items[i];
+        // Don't spin up media or touch network drives that may be disconnected
+        if (g_cfg.thisPCItemsAsSubmenus && listing_is_cacheable(it->path)) prefetch_folder(it->path);
+        HICON hIcon = NULL;
+        if (allowIcons) {
+            SHFILEINFOW sfi = {0};
+            if (SHGetFileInfoW(it->path, 0, &sfi, sizeof(sfi), SHGFI_ICON | SHGFI_SMALLICON)) {
+                hIcon = track_item_icon(sfi.hIcon);
+            }
+        }
+        insert_place_item(hMenu, insertPos + i, it, g_cfg.thisPCItemsAsSubmenus, hIcon);
+    }
+    return count;
+}
 
-    DWORD flags = SHCONTF_FOLDERS | SHCONTF_NONFOLDERS;
-    if (g_cfg.showHidden) flags |= SHCONTF_INCLUDEHIDDEN;
+static HICON node_icon(const MenuNode* n) {
+    if (n->flags & MNF_FOLDER_ICON) return get_system_folder_icon();
+    return n->icon ? load_icon_path_or_module(n->icon) : NULL;
+}
+
+// Appends a generated submenu as a popup of parent with the node's label; popup-root icons are
+// only shown in legacy style with ShowIcons=true
+static void append_node_popup(HMENU parent, HMENU sub, const MenuNode* n) {
+    AppendMenuW(parent, MF_POPUP, (UINT_PTR)sub, n->label);
+    if (g_cfg.menuStyle == STYLE_LEGACY && g_cfg.showIcons == 1) assign_icon_to_last_popup(parent, node_icon(n));
+}
 
-    IEnumIDList* pEnum = NULL;
-    if (FAILED(pUsersFiles->lpVtbl->EnumObjects(pUsersFiles, NULL, flags, &pEnum))) {
-        pUsersFiles->lpVtbl->Release(pUsersFiles);
-        CoTaskMemFree(pidlUsersFiles);
-        pDesktop->lpVtbl->Release(pDesktop);
-        CoUninitialize();
-        return 0;
+static void set_last_item_path(HMENU hMenu, HMENU sub, const WCHAR* path) {
+    MENUITEMINFOW mii = { sizeof(mii) };
+    mii.fMask = MIIM_DATA | MIIM_SUBMENU;
+    mii.dwItemData = (ULONG_PTR)arena_wcsdup(&g_session, path);
+    mii.hSubMenu = sub;
+    SetMenuItemInfoW(hMenu, GetMenuItemCount(hMenu) - 1, TRUE, &mii);
+}
+
+static PerfPhase node_phase(MenuNodeKind kind) {
+    switch (kind) {
+    case MN_COMMAND: return PERF_ITEM_COMMAND;
+    case MN_POPUP_END: return PERF_ITEM_POPUP;
+    case MN_FOLDER_POPUP: return PERF_ITEM_FOLDER;
+    case MN_FOLDER_INLINE: return PERF_ITEM_INLINE_FOLDER;
+    case MN_THISPC: return PERF_ITEM_THISPC;
+    case MN_HOME: return PERF_ITEM_HOME;
+    case MN_RECENT: return PERF_ITEM_RECENT;
+    case MN_TASKKILL: return PERF_ITEM_TASKKILL;
+    default: return PERF_PHASE_COUNT; // not timed
     }
+}
 
-    LPITEMIDLIST pidlItem = NULL;
-    ULONG fetched = 0;
-    int added = 0;
+// Recent and Force Quit popups of the last built menu, so a pre-built menu can regenerate just
+// these snapshots when they age instead of being rebuilt as a whole
+typedef struct VolatilePopup {
+    HMENU parent;
+    int pos;
+    const MenuNode* node; // in g_model, which only changes when the next menu is built
+} VolatilePopup;
+static VolatilePopup g_volatile[8];
+static int g_volatileCount = 0;
+
+static HMENU build_volatile_popup(const MenuNode* n) {
+    if (n->kind == MN_RECENT) return build_recent_submenu();
+    StringSet excludes; // window titles, no fixed cap
+    strset_init(&excludes, &g_session);
+    for (const WCHAR* p = n->excludes; p && *p; p += lstrlenW(p) + 1) strset_add(&excludes, p);
+    LONGLONG tk = perf_begin();
+    HMENU sub = build_taskkill_submenu(n->max, n->ignoreSystem, n->showIcons, &excludes, n->listWindows, g_cfg.taskKillAllDesktops);
+    perf_end(PERF_TASKKILL_MENU, tk);
+    return sub;
+}
 
-    while (pEnum->lpVtbl->Next(pEnum, 1, &pidlItem, &fetched) == S_OK && fetched == 1) {
-        STRRET str;
-        WCHAR name[MAX_PATH];
-        
-        // Display Name
-        if (SUCCEEDED(pUsersFiles->lpVtbl->GetDisplayNameOf(pUsersFiles, pidlItem, SHGDN_NORMAL, &str))) {
-            StrRetToBufW(&str, pidlItem, name, ARRAYSIZE(name));
-        } else {
-            name[0] = 0;
+// Swaps fresh Recent and Force Quit popups into the last built menu. Everything the previous
+// refresh made is released first (the popups it is about to replace are hidden, and the popups
+// from the build itself stay with the session). FALSE if a popup could not be rebuilt; the
+// caller then discards the menu.
+static BOOL refresh_volatile_popups(void) {
+    session_rollback();
+    for (int i = 0; i < g_volatileCount; ++i) {
+        const VolatilePopup* v = &g_volatile[i];
+        HMENU sub = build_volatile_popup(v->node);
+        if (!sub) return FALSE;
+        theme_style_menu(sub);
+        #ifdef ENABLE_MODERN_STYLE
+        if (g_cfg.menuStyle == STYLE_MODERN) {
+            extern void Menu_SetOwnerDrawRecursive(HMENU m);
+            Menu_SetOwnerDrawRecursive(sub);
         }
-
-        // Parsing Path
-        WCHAR path[MAX_PATH];
-        path[0] = 0;
-        if (SUCCEEDED(pUsersFiles->lpVtbl->GetDisplayNameOf(pUsersFiles, pidlItem, SHGDN_FORPARSING, &str))) {
-            StrRetToBufW(&str, pidlItem, path, ARRAYSIZE(path));
+        #endif
+        MENUITEMINFOW mii = { sizeof(mii) };
+        mii.fMask = MIIM_SUBMENU;
+        HMENU old = GetMenuItemInfoW(v->parent, v->pos, TRUE, &mii) ? mii.hSubMenu : NULL;
+        mii.hSubMenu = sub;
+        if (!old || !SetMenuItemInfoW(v->parent, v->pos, TRUE, &mii)) {
+            DestroyMenu(sub);
+            return FALSE;
         }
+        DestroyMenu(old);
+    }
+    return TRUE;
+}
 
-        ULONG attribs = SFGAO_FOLDER;
-        pUsersFiles->lpVtbl->GetAttributesOf(pUsersFiles, 1, (LPCITEMIDLIST*)&pidlItem, &attribs);
-        BOOL isFolder = (attribs & SFGAO_FOLDER);
-
-        if (name[0]) {
-            // Determine if we should show as submenu
-            BOOL asSubmenu = (isFolder && g_cfg.homeItemsAsSubmenus && path[0] && PathFileExistsW(path));
+// Inline folder contents, This PC and Home are part of the static menu; FALSE once one of those
+// folders or the drives changed
+static BOOL inline_folders_current(void) {
+    ListingOptions opt;
+    listing_options_from_config(&opt);
+    for (int s = 0; s < g_model.count; ++s) {
+        const MenuSegment* seg = &g_model.segs[s];
+        for (int i = 0; i < seg->count; ++i) {
+            const MenuNode* n = &seg->nodes[i];
+            if (n->kind == MN_FOLDER_INLINE && !dircache_contains(n->path, &opt)) return FALSE;
+            if (n->kind == MN_THISPC && !places_get_drives_current()) return FALSE;
+            if (n->kind == MN_HOME && !places_get_home_current(g_cfg.showHidden)) return FALSE;
+        }
+    }
+    return TRUE;
+}
 
-            if (asSubmenu) {
-                HMENU sub = CreatePopupMenu();
-                AppendMenuW(sub, MF_STRING | MF_GRAYED, 0, L"(Loading...)");
-                attach_menu_data(sub, path, 1, 0, FALSE);
-                
-                MENUITEMINFOW mii = { sizeof(mii) };
-                mii.fMask = MIIM_STRING | MIIM_SUBMENU | MIIM_DATA | MIIM_ID;
-                mii.dwTypeData = name;
-                mii.hSubMenu = sub;
-                mii.wID = g_nextFolderId++;
-                mii.dwItemData = (ULONG_PTR)LocalAlloc(LMEM_FIXED, (lstrlenW(path) + 1) * sizeof(WCHAR));
-                if (mii.dwItemData) lstrcpyW((LPWSTR)mii.dwItemData, path);
-                InsertMenuItemW(hMenu, insertPos + added, TRUE, &mii);
-            } else {
-                MENUITEMINFOW mii = { sizeof(mii) };
-                mii.fMask = MIIM_STRING | MIIM_ID | MIIM_DATA;
-                mii.dwTypeData = name;
-                mii.wID = g_nextFolderId++;
-                if (path[0]) {
-                    mii.dwItemData = (ULONG_PTR)LocalAlloc(LMEM_FIXED, (lstrlenW(path) + 1) * sizeof(WCHAR));
-                    if (mii.dwItemData) lstrcpyW((LPWSTR)mii.dwItemData, path);
-                    map_add(mii.wID, path);
-                }
-                InsertMenuItemW(hMenu, insertPos + added, TRUE, &mii);
-            }
+// Turns the compiled model into this session's menu: actions and icons are assigned here, and
+// folder, This PC, Home, Recent and Force Quit contents are generated from their caches
+typedef struct Materializer {
+    HMENU parents[MENUMODEL_MAX_DEPTH];
+    int depth;
+    HMENU cur;
+} Materializer;
 
-            // Icon
-            // Determine whether icons are allowed for this item:
-            // - If we're populating a submenu (`isSubmenu`==TRUE), allow icons when HomeShowIcons is enabled and ShowIcons != 0.
-            // - If we're populating the root menu, only allow icons when HomeShowIcons is enabled and ShowIcons == 1 (legacy).
-            BOOL allowIcons = FALSE;
-            if (g_cfg.homeShowIcons) {
-                if (isSubmenu) {
-                    if (g_cfg.showIcons != 0) allowIcons = TRUE;
-                } else {
-                    if (g_cfg.showIcons == 1) allowIcons = TRUE;
-                }
-            }
-            if (allowIcons) {
-                HICON hIcon = NULL;
-                LPITEMIDLIST pidlAbs = ILCombine(pidlUsersFiles, pidlItem);
-                SHFILEINFOW sfi = {0};
-                if (SHGetFileInfoW((LPCWSTR)pidlAbs, 0, &sfi, sizeof(sfi), SHGFI_PIDL | SHGFI_ICON | SHGFI_SMALLICON)) {
-                    hIcon = sfi.hIcon;
-                }
-                CoTaskMemFree(pidlAbs);
-
-                if (hIcon) {
-                    // Register icon for both cases (normal and submenu)
-                    add_item_icon(g_nextFolderId - 1, hIcon);
-
-                    if (g_cfg.menuStyle == STYLE_LEGACY) {
-                        if (asSubmenu) {
-                            int pos = insertPos + added;
-                            HBITMAP hbmp = icon_to_hbmp(hIcon, get_preferred_icon_size(), get_preferred_icon_size());
-                            if (hbmp) {
-                                MENUITEMINFOW miiIcon = { sizeof(miiIcon) };
-                                miiIcon.fMask = MIIM_BITMAP;
-                                miiIcon.hbmpItem = hbmp;
-                                SetMenuItemInfoW(hMenu, pos, TRUE, &miiIcon);
-                            }
-                        } else {
-                            assign_legacy_item_bitmap(hMenu, g_nextFolderId - 1, hIcon);
-                        }
-                    }
-                }
-            }
-            added++;
+static void mat_item(void* ctx, const MenuNode* n, UINT cmd) {
+    Materializer* m = (Materializer*)ctx;
+    if (n->kind == MN_SEPARATOR) {
+        AppendMenuW(m->cur, MF_SEPARATOR, 0, NULL);
+        return;
+    }
+    if (n->kind == MN_HEADER) {
+        AppendMenuW(m->cur, MF_STRING | MF_GRAYED, 0, n->label);
+        return;
+    }
+    LONGLONG t = perf_begin();
+    AppendMenuW(m->cur, MF_STRING, cmd, n->label);
+    MenuAction* act = actions_add(cmd, n->action, n->path);
+    if (act) {
+        act->arg = n->arg;
+        act->params = n->params;
+    }
+    // Root-level icons: only register item icons for legacy-visible mode (ShowIcons==1).
+    if (g_cfg.showIcons == 1 && (n->icon || (n->flags & MNF_FOLDER_ICON))) {
+        HICON hico = node_icon(n);
+        if (hico) {
+            add_item_icon(cmd, hico);
+            if (g_cfg.menuStyle == STYLE_LEGACY) assign_legacy_item_bitmap(m->cur, cmd, hico);
         }
-        CoTaskMemFree(pidlItem);
     }
-
-    pEnum->lpVtbl->Release(pEnum);
-    pUsersFiles->lpVtbl->Release(pUsersFiles);
-    CoTaskMemFree(pidlUsersFiles);
-    pDesktop->lpVtbl->Release(pDesktop);
-    CoUninitialize();
-    return added;
+    perf_end(PERF_ITEM_COMMAND, t);
 }
 
-static int fill_menu_with_thispc(HMENU hMenu, int insertPos, BOOL isSubmenu) {
-    WCHAR drives[512];
-    if (GetLogicalDriveStringsW(ARRAYSIZE(drives), drives) == 0) {
-        InsertMenuW(hMenu, insertPos, MF_BYPOSITION | MF_STRING | MF_GRAYED, 0, L"(No drives found)");
-        return 1;
-    }
+static void mat_popup_begin(void* ctx, const MenuNode* n) {
+    Materializer* m = (Materializer*)ctx;
+    UNREFERENCED_PARAMETER(n);
+    m->parents[m->depth++] = m->cur;
+    m->cur = CreatePopupMenu();
+}
 
-    int added = 0;
-    WCHAR* p = drives;
-    while (*p) {
-        WCHAR label[MAX_PATH + 32];
-        WCHAR volName[MAX_PATH] = {0};
-        
-        GetVolumeInformationW(p, volName, ARRAYSIZE(volName), NULL, NULL, NULL, NULL, 0);
-        
-        if (volName[0]) {
-            size_t len = lstrlenW(p);
-            if (len > 0 && p[len-1] == L'\\') p[len-1] = 0;
-            wsprintfW(label, L"%s (%s)", volName, p);
-            if (len > 0) p[len-1] = L'\\';
-        } else {
-            UINT type = GetDriveTypeW(p);
-            const WCHAR* typeStr = L"Local Disk";
-            if (type == DRIVE_REMOVABLE) typeStr = L"Removable Disk";
-            else if (type == DRIVE_CDROM) typeStr = L"CD Drive";
-            else if (type == DRIVE_REMOTE) typeStr = L"Network Drive";
-            
-            size_t len = lstrlenW(p);
-            if (len > 0 && p[len-1] == L'\\') p[len-1] = 0;
-            wsprintfW(label, L"%s (%s)", typeStr, p);
-            if (len > 0) p[len-1] = L'\\';
-        }
+static void mat_popup_end(void* ctx, const MenuNode* begin) {
+    Materializer* m = (Materializer*)ctx;
+    LONGLONG t = perf_begin();
+    HMENU sub = m->cur;
+    m->cur = m->parents[--m->depth];
+    append_node_popup(m->cur, sub, begin);
+    perf_end(PERF_ITEM_POPUP, t);
+}
 
-        MENUITEMINFOW mii = { sizeof(mii) };
-        
-        if (g_cfg.thisPCItemsAsSubmenus) {
+static void mat_generated(void* ctx, const MenuNode* n) {
+    Materializer* m = (Materializer*)ctx;
+    HMENU cur = m->cur;
+    LONGLONG t = perf_begin();
+    switch (n->kind) {
+    case MN_FOLDER_POPUP:
+    {
+        HMENU sub = CreatePopupMenu();
+        AppendMenuW(sub, MF_STRING | MF_GRAYED, 0, L"(Loading...)");
+        attach_menu_data(sub, n->path, 1, 0, FALSE);
+        if (n->flags & MNF_PREFETCH) prefetch_folder(n->path);
+        append_node_popup(cur, sub, n);
+        set_last_item_path(cur, sub, n->path);
+        break;
+    }
+    case MN_FOLDER_INLINE:
+    {
+        LONGLONG tf = perf_begin();
+        fill_menu_with_folder(cur, GetMenuItemCount(cur), n->path, 1, 0, FALSE, NULL);
+        perf_end(PERF_FOLDER_FILL, tf);
+        break;
+    }
+    case MN_THISPC:
+    case MN_HOME:
+        if (n->flags & MNF_SUBMENU) {
             HMENU sub = CreatePopupMenu();
-            AppendMenuW(sub, MF_STRING | MF_GRAYED, 0, L"(Loading...)");
-            attach_menu_data(sub, p, 1, 0, FALSE);
-            
-            mii.fMask = MIIM_STRING | MIIM_SUBMENU | MIIM_DATA | MIIM_ID;
-            mii.dwTypeData = label;
-            mii.hSubMenu = sub;
-            mii.wID = g_nextFolderId++;
-            mii.dwItemData = (ULONG_PTR)LocalAlloc(LMEM_FIXED, (lstrlenW(p) + 1) * sizeof(WCHAR));
-            if (mii.dwItemData) lstrcpyW((LPWSTR)mii.dwItemData, p);
-            InsertMenuItemW(hMenu, insertPos + added, TRUE, &mii);
+            if (n->kind == MN_HOME) fill_menu_with_home(sub, 0, TRUE);
+            else fill_menu_with_thispc(sub, 0, TRUE);
+            AppendMenuW(cur, MF_POPUP, (UINT_PTR)sub, n->label);
+            // Unlike the other popup roots, these show their icon in every style
+            if (g_cfg.showIcons == 1 && n->icon) assign_icon_to_last_popup(cur, node_icon(n));
+        } else if (n->kind == MN_HOME) {
+            fill_menu_with_home(cur, GetMenuItemCount(cur), FALSE);
         } else {
-            mii.fMask = MIIM_STRING | MIIM_ID | MIIM_DATA;
-            mii.dwTypeData = label;
-            mii.wID = g_nextFolderId++;
-            mii.dwItemData = (ULONG_PTR)LocalAlloc(LMEM_FIXED, (lstrlenW(p) + 1) * sizeof(WCHAR));
-            if (mii.dwItemData) lstrcpyW((LPWSTR)mii.dwItemData, p);
-            InsertMenuItemW(hMenu, insertPos + added, TRUE, &mii);
-            map_add(mii.wID, p);
+            fill_menu_with_thispc(cur, GetMenuItemCount(cur), FALSE);
         }
-        
-        // Determine whether icons are allowed for this drive item:
-        // - If populating a submenu (`isSubmenu`), allow icons when ThisPCShowIcons is enabled and ShowIcons != 0.
-        // - If populating the root menu, only allow icons when ThisPCShowIcons is enabled and ShowIcons == 1 (legacy).
-        BOOL allowIcons = FALSE;
-        if (g_cfg.thisPCShowIcons) {
-            if (isSubmenu) {
-                if (g_cfg.showIcons != 0) allowIcons = TRUE;
-            } else {
-                if (g_cfg.showIcons == 1) allowIcons = TRUE;
-            }
+        break;
+    case MN_RECENT:
+    case MN_TASKKILL:
+        append_node_popup(cur, build_volatile_popup(n), n);
+        if (g_volatileCount < (int)ARRAYSIZE(g_volatile)) {
+            g_volatile[g_volatileCount++] = (VolatilePopup){ cur, GetMenuItemCount(cur) - 1, n };
         }
-        if (allowIcons) {
-            HICON hIcon = NULL;
-            SHFILEINFOW sfi = {0};
-            if (SHGetFileInfoW(p, 0, &sfi, sizeof(sfi), SHGFI_ICON | SHGFI_SMALLICON)) {
-                hIcon = sfi.hIcon;
-            }
-            if (hIcon) {
-                // Register icon for both cases (normal and submenu)
-                // Note: For submenu, we just assigned an ID (g_nextFolderId - 1)
-                add_item_icon(g_nextFolderId - 1, hIcon);
-
-                if (g_cfg.menuStyle == STYLE_LEGACY) {
-                    if (g_cfg.thisPCItemsAsSubmenus) {
-                        int pos = insertPos + added;
-                        HBITMAP hbmp = icon_to_hbmp(hIcon, get_preferred_icon_size(), get_preferred_icon_size());
-                        if (hbmp) {
-                            MENUITEMINFOW miiIcon = { sizeof(miiIcon) };
-                            miiIcon.fMask = MIIM_BITMAP;
-                            miiIcon.hbmpItem = hbmp;
-                            SetMenuItemInfoW(hMenu, pos, TRUE, &miiIcon);
-                        }
-                    } else {
-                        assign_legacy_item_bitmap(hMenu, g_nextFolderId - 1, hIcon);
-                    }
-                }
-            }
-        } 
-
-
-        added++;
-        p += lstrlenW(p) + 1;
+        break;
+    default:
+        break;
     }
-    return added;
+    perf_end(node_phase(n->kind), t);
+}
+
+static void materialize_model(HMENU hMenu, const MenuModel* model) {
+    static const MenuSink sink = { mat_item, mat_popup_begin, mat_popup_end, mat_generated };
+    Materializer m = { { NULL }, 0, hMenu };
+    UINT id = IDM_DYNAMIC_BASE;
+    menumodel_emit(model, &sink, &m, &id, &g_nextFolderId);
 }
 
 static HMENU build_menu(void) {
-    config_load(&g_cfg);
+    LONGLONG tBuild = perf_begin();
+    LONGLONG t = perf_begin();
+    BOOL reloaded = config_load_cached(&g_cfg);
+    perf_end(PERF_CONFIG_LOAD, t);
     HMENU hMenu = CreatePopupMenu();
-    g_mapCount = 0; // reset mapping for this menu build
-    g_itemIconCount = 0; // reset icons
+    menu_session_release(); // in case a previous session was not closed through ShowWinXMenu
+    if (reloaded) dircache_flush(); // filters or sorting may have changed
+    iconcache_begin_session();
+    actions_reset(&g_session); // command dispatch for this menu build
     g_nextFolderId = IDM_FOLDER_BASE;
-    UINT id = IDM_DYNAMIC_BASE;
-    for (int i = 0; i < g_cfg.count; ++i) {
-        ConfigItem* it = &g_cfg.items[i];
-        switch (it->type) {
-        case CI_SEPARATOR:
-            AppendMenuW(hMenu, MF_SEPARATOR, 0, NULL);
-            break;
-        case CI_URI:
-        case CI_FILE:
-        case CI_CMD:
-        {
-            AppendMenuW(hMenu, MF_STRING, id, it->label[0] ? it->label : it->path);
-            // Pick icon path with theme awareness: per-item (Light/Dark) -> generic -> default (Light/Dark) -> default generic
-            const BOOL dark = theme_is_dark();
-            const WCHAR* ipath = NULL;
-            if (dark && it->iconPathDark[0]) ipath = it->iconPathDark;
-            else if (!dark && it->iconPathLight[0]) ipath = it->iconPathLight;
-            else if (it->iconPath[0]) ipath = it->iconPath;
-            else if (dark && g_cfg.defaultIconPathDark[0]) ipath = g_cfg.defaultIconPathDark;
-            else if (!dark && g_cfg.defaultIconPathLight[0]) ipath = g_cfg.defaultIconPathLight;
-            else if (g_cfg.defaultIconPath[0]) ipath = g_cfg.defaultIconPath;
-                if (ipath) {
-                    HICON hico = load_icon_path_or_module(ipath);
-                    // Root-level icons: only register item icons for legacy-visible mode (ShowIcons==1).
-                    if (g_cfg.showIcons == 1) add_item_icon(id, hico);
-                    if (g_cfg.menuStyle == STYLE_LEGACY && g_cfg.showIcons == 1) assign_legacy_item_bitmap(hMenu, id, hico);
-                }
-            id++;
-            break;
-        }
-            break;
-        case CI_FOLDER:
-        {
-            if (it->submenu) {
-                HMENU sub = CreatePopupMenu();
-                AppendMenuW(sub, MF_STRING | MF_GRAYED, 0, L"(Loading...)");
-                attach_menu_data(sub, it->path, 1, 0, FALSE);
-                AppendMenuW(hMenu, MF_POPUP, (UINT_PTR)sub, it->label[0] ? it->label : it->path);
-                MENUITEMINFOW mii = { sizeof(mii) };
-                mii.fMask = MIIM_DATA | MIIM_SUBMENU;
-                mii.dwItemData = (ULONG_PTR)LocalAlloc(LMEM_FIXED, (lstrlenW(it->path) + 1) * sizeof(WCHAR));
-                if (mii.dwItemData) lstrcpyW((LPWSTR)mii.dwItemData, it->path);
-                mii.hSubMenu = sub;
-                int pos = GetMenuItemCount(hMenu) - 1;
-                SetMenuItemInfoW(hMenu, pos, TRUE, &mii);
-            } else if (it->inlineExpand) {
-                // Inline expand: inject folder entries directly at root at this position
-                // Optional header (may be suppressed by future flag)
-                if (it->label[0] && !it->inlineNoHeader) {
-                    if (it->inlineOpen) {
-                        // Clickable header that opens the folder
-                        AppendMenuW(hMenu, MF_STRING, g_nextFolderId, it->label);
-                        map_add(g_nextFolderId++, it->path);
-                    } else {
-                        AppendMenuW(hMenu, MF_STRING | MF_GRAYED, 0, it->label);
-                    }
-                }
-                
-                fill_menu_with_folder(hMenu, GetMenuItemCount(hMenu), it->path, 1, 0, FALSE);
-                
-                // No automatic trailing separator; user controls separators explicitly in config.
-            } else {
-                AppendMenuW(hMenu, MF_STRING, id, it->label[0] ? it->label : it->path);
-                const BOOL dark = theme_is_dark();
-                const WCHAR* ipath = NULL;
-                HICON hico = NULL;
-                // Prefer per-item icon first
-                if (dark && it->iconPathDark[0]) ipath = it->iconPathDark;
-                else if (!dark && it->iconPathLight[0]) ipath = it->iconPathLight;
-                else if (it->iconPath[0]) ipath = it->iconPath;
-                if (!ipath) {
-                    if (g_cfg.showFolderIcons) {
-                        // When showing folder icons and no per-item icon, use system folder icon
-                        hico = get_system_folder_icon();
-                    } else {
-                        // Fall back to defaults
-                        if (dark && g_cfg.defaultIconPathDark[0]) ipath = g_cfg.defaultIconPathDark;
-                        else if (!dark && g_cfg.defaultIconPathLight[0]) ipath = g_cfg.defaultIconPathLight;
-                        else if (g_cfg.defaultIconPath[0]) ipath = g_cfg.defaultIconPath;
-                    }
-                }
-                if (!hico && ipath) {
-                    hico = load_icon_path_or_module(ipath);
-                }
-                if (hico) {
-                    // Root-level icons: only register item icons for legacy-visible mode (ShowIcons==1).
-                    if (g_cfg.showIcons == 1) add_item_icon(id, hico);
-                    if (g_cfg.menuStyle == STYLE_LEGACY && g_cfg.showIcons == 1) assign_legacy_item_bitmap(hMenu, id, hico);
-                }
-                id++;
-            }
-            break;
-        }
-        case CI_THISPC:
-        {
-            if (it->submenu) {
-                HMENU sub = CreatePopupMenu();
-                fill_menu_with_thispc(sub, 0, TRUE);
-                AppendMenuW(hMenu, MF_POPUP, (UINT_PTR)sub, it->label[0] ? it->label : L"This PC");
-                
-                const BOOL dark = theme_is_dark();
-                const WCHAR* ipath = NULL;
-                if (dark && it->iconPathDark[0]) ipath = it->iconPathDark;
-                else if (!dark && it->iconPathLight[0]) ipath = it->iconPathLight;
-                else if (it->iconPath[0]) ipath = it->iconPath;
-                else if (dark && g_cfg.defaultIconPathDark[0]) ipath = g_cfg.defaultIconPathDark;
-                else if (!dark && g_cfg.defaultIconPathLight[0]) ipath = g_cfg.defaultIconPathLight;
-                else if (g_cfg.defaultIconPath[0]) ipath = g_cfg.defaultIconPath;
-                if (ipath) {
-                    // Only load/assign popup-root icons when icons are enabled (legacy only).
-                    // When ShowIcons is not legacy (==1), do not show icons for submenu roots.
-                    if (g_cfg.showIcons == 1) {
-                        HICON hico = load_icon_path_or_module(ipath);
-                        if (hico) assign_icon_to_last_popup(hMenu, hico);
-                    }
-                }
-            } else {
-                if (it->label[0] && !it->inlineNoHeader) {
-                    if (it->inlineOpen) {
-                        AppendMenuW(hMenu, MF_STRING, g_nextFolderId, it->label);
-                        map_add(g_nextFolderId++, L"::{20D04FE0-3AEA-1069-A2D8-08002B30309D}");
-                    } else {
-                        AppendMenuW(hMenu, MF_STRING | MF_GRAYED, 0, it->label);
-                    }
-                }
-                fill_menu_with_thispc(hMenu, GetMenuItemCount(hMenu), FALSE);
-            }
-            break;
-        }
-        case CI_HOME:
-        {
-            if (it->submenu) {
-                HMENU sub = CreatePopupMenu();
-                fill_menu_with_home(sub, 0, TRUE);
-                AppendMenuW(hMenu, MF_POPUP, (UINT_PTR)sub, it->label[0] ? it->label : L"Home");
-                
-                const BOOL dark = theme_is_dark();
-                const WCHAR* ipath = NULL;
-                if (dark && it->iconPathDark[0]) ipath = it->iconPathDark;
-                else if (!dark && it->iconPathLight[0]) ipath = it->iconPathLight;
-                else if (it->iconPath[0]) ipath = it->iconPath;
-                else if (dark && g_cfg.defaultIconPathDark[0]) ipath = g_cfg.defaultIconPathDark;
-                else if (!dark && g_cfg.defaultIconPathLight[0]) ipath = g_cfg.defaultIconPathLight;
-                else if (g_cfg.defaultIconPath[0]) ipath = g_cfg.defaultIconPath;
-                if (ipath) {
-                    // Only load/assign popup-root icons when icons are enabled (legacy only).
-                    // When ShowIcons is not legacy (==1), do not show icons for submenu roots.
-                    if (g_cfg.showIcons == 1) {
-                        HICON hico = load_icon_path_or_module(ipath);
-                        if (hico) assign_icon_to_last_popup(hMenu, hico);
-                    }
-                }
-            } else {
-                if (it->label[0] && !it->inlineNoHeader) {
-                    if (it->inlineOpen) {
-                        AppendMenuW(hMenu, MF_STRING, g_nextFolderId, it->label);
-                        map_add(g_nextFolderId++, L"::{59031a47-3f72-44a7-89c5-5595fe6b30ee}");
-                    } else {
-                        AppendMenuW(hMenu, MF_STRING | MF_GRAYED, 0, it->label);
-                    }
-                }
-                fill_menu_with_home(hMenu, GetMenuItemCount(hMenu), FALSE);
-            }
-            break;
-        }
-        case CI_FOLDER_SUBMENU:
-        {
-            HMENU sub = CreatePopupMenu();
-            AppendMenuW(sub, MF_STRING | MF_GRAYED, 0, L"(Loading...)");
-            attach_menu_data(sub, it->path, 1, 0, FALSE);
-            AppendMenuW(hMenu, MF_POPUP, (UINT_PTR)sub, it->label[0] ? it->label : it->path);
-            if (g_cfg.menuStyle == STYLE_LEGACY && g_cfg.showIcons == 1) {
-                const BOOL dark = theme_is_dark();
-                HICON hicoF = NULL;
-                const WCHAR* ipath = NULL;
-                // Prefer per-item icon first
-                if (dark && it->iconPathDark[0]) ipath = it->iconPathDark;
-                else if (!dark && it->iconPathLight[0]) ipath = it->iconPathLight;
-                else if (it->iconPath[0]) ipath = it->iconPath;
-                if (!ipath) {
-                    if (g_cfg.showFolderIcons) {
-                        hicoF = get_system_folder_icon();
-                    } else {
-                        if (dark && g_cfg.defaultIconPathDark[0]) ipath = g_cfg.defaultIconPathDark;
-                        else if (!dark && g_cfg.defaultIconPathLight[0]) ipath = g_cfg.defaultIconPathLight;
-                        else if (g_cfg.defaultIconPath[0]) ipath = g_cfg.defaultIconPath;
-                    }
-                }
-                if (!hicoF && ipath) hicoF = load_icon_path_or_module(ipath);
-                assign_icon_to_last_popup(hMenu, hicoF);
-            }
-            MENUITEMINFOW mii = { sizeof(mii) };
-            mii.fMask = MIIM_DATA | MIIM_SUBMENU;
-            mii.dwItemData = (ULONG_PTR)LocalAlloc(LMEM_FIXED, (lstrlenW(it->path) + 1) * sizeof(WCHAR));
-            if (mii.dwItemData) lstrcpyW((LPWSTR)mii.dwItemData, it->path);
-            mii.hSubMenu = sub;
-            int pos = GetMenuItemCount(hMenu) - 1;
-            SetMenuItemInfoW(hMenu, pos, TRUE, &mii);
-            break;
-        }
-        case CI_POWER_SLEEP:
-        case CI_POWER_SHUTDOWN:
-        case CI_POWER_RESTART:
-        case CI_POWER_LOCK:
-        case CI_POWER_LOGOFF:
-            AppendMenuW(hMenu, MF_STRING, id++, it->label);
-            break;
-        case CI_POWER_HIBERNATE:
-            AppendMenuW(hMenu, MF_STRING, id++, it->label);
-            break;
-    case CI_RECENT_SUBMENU:
-        {
-            HMENU sub = build_recent_submenu();
-            AppendMenuW(hMenu, MF_POPUP, (UINT_PTR)sub, it->label[0] ? it->label : L"Recent Items");
-            if (g_cfg.menuStyle == STYLE_LEGACY && g_cfg.showIcons == 1) {
-                const BOOL dark = theme_is_dark();
-                HICON hicoR = NULL;
-                const WCHAR* ipath = NULL;
-                if (dark && it->iconPathDark[0]) ipath = it->iconPathDark;
-                else if (!dark && it->iconPathLight[0]) ipath = it->iconPathLight;
-                else if (it->iconPath[0]) ipath = it->iconPath;
-                else if (dark && g_cfg.defaultIconPathDark[0]) ipath = g_cfg.defaultIconPathDark;
-                else if (!dark && g_cfg.defaultIconPathLight[0]) ipath = g_cfg.defaultIconPathLight;
-                else if (g_cfg.defaultIconPath[0]) ipath = g_cfg.defaultIconPath;
-                if (ipath) hicoR = load_icon_path_or_module(ipath);
-                assign_icon_to_last_popup(hMenu, hicoR);
-            }
-            break;
-        }
-        case CI_POWER_MENU:
-        {
-            HMENU sub = CreatePopupMenu();
-            // Order: Sleep, Hibernate, Shutdown, Restart, Lock, Log off (group with separator before lock group)
-            BOOL firstGroupAdded = FALSE;
-            if (!g_cfg.excludeSleep) { AppendMenuW(sub, MF_STRING, id, L"Sleep"); map_add(id++, L"POWER_SLEEP"); firstGroupAdded=TRUE; }
-            if (!g_cfg.excludeHibernate) { AppendMenuW(sub, MF_STRING, id, L"Hibernate"); map_add(id++, L"POWER_HIBERNATE"); firstGroupAdded=TRUE; }
-            if (!g_cfg.excludeShutdown) { AppendMenuW(sub, MF_STRING, id, L"Shut down"); map_add(id++, L"POWER_SHUTDOWN"); firstGroupAdded=TRUE; }
-            if (!g_cfg.excludeRestart) { AppendMenuW(sub, MF_STRING, id, L"Restart"); map_add(id++, L"POWER_RESTART"); firstGroupAdded=TRUE; }
-            BOOL secondGroup = FALSE;
-            if (!g_cfg.excludeLock || !g_cfg.excludeLogoff) {
-                if (firstGroupAdded) AppendMenuW(sub, MF_SEPARATOR, 0, NULL);
-                secondGroup = TRUE;
-            }
-            if (!g_cfg.excludeLock) { AppendMenuW(sub, MF_STRING, id, L"Lock"); map_add(id++, L"POWER_LOCK"); }
-            if (!g_cfg.excludeLogoff) { AppendMenuW(sub, MF_STRING, id, L"Log off"); map_add(id++, L"POWER_LOGOFF"); }
-            // If everything excluded, show placeholder disabled item
-            if (!firstGroupAdded && !secondGroup) {
-                AppendMenuW(sub, MF_STRING | MF_GRAYED, 0, L"(None)");
-            }
-            AppendMenuW(hMenu, MF_POPUP, (UINT_PTR)sub, it->label[0] ? it->label : L"Power");
-            if (g_cfg.menuStyle == STYLE_LEGACY && g_cfg.showIcons == 1) {
-                const BOOL dark = theme_is_dark();
-                HICON hicoP = NULL;
-                const WCHAR* ipath = NULL;
-                if (dark && it->iconPathDark[0]) ipath = it->iconPathDark;
-                else if (!dark && it->iconPathLight[0]) ipath = it->iconPathLight;
-                else if (it->iconPath[0]) ipath = it->iconPath;
-                else if (dark && g_cfg.defaultIconPathDark[0]) ipath = g_cfg.defaultIconPathDark;
-                else if (!dark && g_cfg.defaultIconPathLight[0]) ipath = g_cfg.defaultIconPathLight;
-                else if (g_cfg.defaultIconPath[0]) ipath = g_cfg.defaultIconPath;
-                if (ipath) hicoP = load_icon_path_or_module(ipath);
-                assign_icon_to_last_popup(hMenu, hicoP);
-            }
-            break;
-        }
-        case CI_TASKKILL:
-        {
-            int max = g_cfg.taskKillMax;
-            BOOL ignoreSystem = g_cfg.taskKillIgnoreSystem;
-            BOOL showIcons = g_cfg.taskKillShowIcons;
-            BOOL listWindows = g_cfg.taskKillListWindows;
-            WCHAR* excludes[32];
-            int excludeCount = 0;
-            
-            // Parse global excludes
-            WCHAR globalBuf[512];
-            lstrcpynW(globalBuf, g_cfg.taskKillExcludes, ARRAYSIZE(globalBuf));
-            
-            WCHAR* p = globalBuf;
-            while (*p && excludeCount < 32) {
-                WCHAR* next = wcschr(p, L',');
-                if (next) *next = 0;
-                if (*p) excludes[excludeCount++] = p;
-                if (!next) break;
-                p = next + 1;
-            }
-
-            // Override with item params if present
-            if (it->params[0]) {
-                excludeCount = 0; // Reset excludes if params provided
-                
-                WCHAR buf[256];
-                lstrcpynW(buf, it->params, ARRAYSIZE(buf));
-                p = buf;
-
-                if (*p) {
-                    WCHAR* next = wcschr(p, L',');
-                    if (next) *next = 0;
-                    max = _wtoi(p);
-                    if (next) {
-                        p = next + 1;
-                        next = wcschr(p, L',');
-                        if (next) *next = 0;
-                        if (lstrcmpiW(p, L"true") == 0 || lstrcmpiW(p, L"1") == 0) ignoreSystem = TRUE;
-                        else if (lstrcmpiW(p, L"false") == 0 || lstrcmpiW(p, L"0") == 0) ignoreSystem = FALSE;
-                        
-                        if (next) {
-                            p = next + 1;
-                            
-                            // Check for optional ShowIcons boolean
-                            WCHAR* comma = wcschr(p, L',');
-                            if (comma) *comma = 0;
-                            BOOL isBool = (lstrcmpiW(p, L"true") == 0 || lstrcmpiW(p, L"false") == 0 || 
-                                           lstrcmpiW(p, L"1") == 0 || lstrcmpiW(p, L"0") == 0);
-                            
-                            if (isBool) {
-                                if (lstrcmpiW(p, L"false") == 0 || lstrcmpiW(p, L"0") == 0) showIcons = FALSE;
-                                else showIcons = TRUE;
-                                
-                                if (comma) {
-                                    p = comma + 1;
-                                    
-                                    // Check for optional ListWindows boolean
-                                    comma = wcschr(p, L',');
-                                    if (comma) *comma = 0;
-                                    BOOL isBool2 = (lstrcmpiW(p, L"true") == 0 || lstrcmpiW(p, L"false") == 0 || 
-                                                   lstrcmpiW(p, L"1") == 0 || lstrcmpiW(p, L"0") == 0);
-                                    
-                                    if (isBool2) {
-                                        if (lstrcmpiW(p, L"false") == 0 || lstrcmpiW(p, L"0") == 0) listWindows = FALSE;
-                                        else listWindows = TRUE;
-                                        
-                                        if (comma) {
-                                            p = comma + 1;
-                                        } else {
-                                            p = NULL;
-                                        }
-                                    } else {
-                                        // Not a bool, so it's an exclude
-                                        excludes[excludeCount++] = p;
-                                        if (comma) p = comma + 1;
-                                        else p = NULL;
-                                    }
-                                } else {
-                                    p = NULL;
-                                }
-                            } else {
-                                if (comma) {
-                                    excludes[excludeCount++] = p;
-                                    p = comma + 1;
-                                } else {
-                                    excludes[excludeCount++] = p;
-                                    p = NULL;
-                                }
-                            }
-
-                            while (p && *p && excludeCount < 32) {
-                                next = wcschr(p, L',');
-                                if (next) *next = 0;
-                                excludes[excludeCount++] = p;
-                                if (!next) break;
-                                p = next + 1;
-                            }
-                        }
-                    }
-                }
-            }
-            if (max <= 0) max = 10;
-            HMENU sub = build_taskkill_submenu(max, ignoreSystem, showIcons, excludes, excludeCount, listWindows, g_cfg.taskKillAllDesktops);
-            AppendMenuW(hMenu, MF_POPUP, (UINT_PTR)sub, it->label[0] ? it->label : L"Task Kill");
-            if (g_cfg.menuStyle == STYLE_LEGACY && g_cfg.showIcons == 1) {
-                const BOOL dark = theme_is_dark();
-                HICON hico = NULL;
-                const WCHAR* ipath = NULL;
-                if (dark && it->iconPathDark[0]) ipath = it->iconPathDark;
-                else if (!dark && it->iconPathLight[0]) ipath = it->iconPathLight;
-                else if (it->iconPath[0]) ipath = it->iconPath;
-                if (ipath) hico = load_icon_path_or_module(ipath);
-                assign_icon_to_last_popup(hMenu, hico);
-            }
-            break;
-        }
-        }
-    }
+    // Only items whose config or theme inputs changed since the last popup are recompiled
+    t = perf_begin();
+    menumodel_update(&g_model, &g_cfg, theme_is_dark());
+    perf_end(PERF_MODEL_UPDATE, t);
+    g_volatileCount = 0;
+    materialize_model(hMenu, &g_model);
     theme_style_menu(hMenu);
     #ifdef ENABLE_MODERN_STYLE
     if (g_cfg.menuStyle == STYLE_MODERN) {
@@ -1293,6 +940,8 @@ static HMENU build_menu(void) {
     }
     #endif
     // No width shim anymore; modern width is controlled in measure/draw, legacy stays native.
+    session_mark();
+    perf_end(PERF_BUILD_MENU, tBuild);
     return hMenu;
 }
 
@@ -1380,87 +1029,256 @@ void MenuOnInitMenuPopup(HWND owner, HMENU hMenu, UINT item, BOOL isSystemMenu)
     }
 }
 
+// Counts the items below hMenu, filling lazily populated folder popups (including "Show more
+// items..." pages) down to depth levels as if each one had been hovered
+static int expand_folder_popups(HMENU hMenu, int depth) {
+    int items = GetMenuItemCount(hMenu);
+    if (depth <= 0 || items <= 0) return items > 0 ? items : 0;
+    for (int i = 0; i < GetMenuItemCount(hMenu); ++i) {
+        HMENU sub = GetSubMenu(hMenu, i);
+        if (!sub) continue;
+        MenuOnInitMenuPopup(NULL, sub, (UINT)i, FALSE);
+        items += expand_folder_popups(sub, depth - 1);
+    }
+    return items;
+}
+
+BOOL MenuRunBenchmark(int iterations, MenuBenchResult* out) {
+    ZeroMemory(out, sizeof(*out));
+    if (iterations < 1) iterations = 1;
+    out->iterations = iterations;
+    Config* parsed = (Config*)LocalAlloc(LPTR, sizeof(Config));
+    MenuModel* fresh = (MenuModel*)LocalAlloc(LPTR, sizeof(MenuModel));
+    if (!parsed || !fresh) {
+        if (parsed) LocalFree(parsed);
+        if (fresh) LocalFree(fresh);
+        return FALSE;
+    }
+
+    LONGLONG t = perf_begin();
+    for (int i = 0; i < iterations; ++i) {
+        ZeroMemory(parsed, sizeof(*parsed));
+        config_load(parsed);
+    }
+    out->configLoadMs = perf_ms_since(t) / iterations;
+    LocalFree(parsed);
+    config_load_cached(&g_cfg);
+    out->configItems = g_cfg.count;
+
+    // Item switch and parameter parsing alone, from scratch and with nothing changed
+    const BOOL dark = theme_is_dark();
+    t = perf_begin();
+    for (int i = 0; i < iterations; ++i) {
+        menumodel_update(fresh, &g_cfg, dark);
+        menumodel_free(fresh);
+    }
+    out->modelColdMs = perf_ms_since(t) / iterations;
+    LocalFree(fresh);
+    menumodel_update(&g_model, &g_cfg, dark);
+    t = perf_begin();
+    for (int i = 0; i < iterations; ++i) menumodel_update(&g_model, &g_cfg, dark);
+    out->modelWarmMs = perf_ms_since(t) / iterations;
+    for (int i = 0; i < g_model.count; ++i) {
+        out->modelNodes += g_model.segs[i].count;
+        out->modelBytes += g_model.segs[i].arena.bytesUsed;
+    }
+
+    // Full popups: the first one runs against cold folder/icon/recent caches
+    for (int i = 0; i <= iterations; ++i) {
+        t = perf_begin();
+        HMENU hMenu = build_menu();
+        double ms = perf_ms_since(t);
+        if (i == 0) out->firstBuildMs = ms;
+        else out->buildMs += ms;
+        t = perf_begin();
+        out->menuItems = expand_folder_popups(hMenu, 2);
+        out->expandMs += perf_ms_since(t);
+        if (g_session.bytesUsed > out->sessionBytes) out->sessionBytes = g_session.bytesUsed;
+        DestroyMenu(hMenu);
+        menu_session_release();
+    }
+    out->buildMs /= iterations;
+    out->expandMs /= iterations + 1;
+    return TRUE;
+}
+
+static void run_power_verb(ConfigItemType verb) {
+    switch (verb) {
+    case CI_POWER_SLEEP: system_sleep(); break;
+    case CI_POWER_SHUTDOWN: system_shutdown(FALSE); break;
+    case CI_POWER_RESTART: system_shutdown(TRUE); break;
+    case CI_POWER_LOCK: LockWorkStation(); break;
+    case CI_POWER_LOGOFF: ExitWindowsEx(EWX_LOGOFF, 0); break;
+    case CI_POWER_HIBERNATE: system_hibernate(); break;
+    default: break;
+    }
+}
+
 void MenuExecuteCommand(HWND owner, UINT cmd) {
     if (!cmd) return;
-    for (UINT i = 0; i < g_mapCount; ++i) {
-        if (g_map[i].id == (UINT)cmd) {
-            // Interpret special power markers
-            if (!lstrcmpiW(g_map[i].path, L"POWER_SLEEP")) { system_sleep(); return; }
-            if (!lstrcmpiW(g_map[i].path, L"POWER_SHUTDOWN")) { system_shutdown(FALSE); return; }
-            if (!lstrcmpiW(g_map[i].path, L"POWER_RESTART")) { system_shutdown(TRUE); return; }
-            if (!lstrcmpiW(g_map[i].path, L"POWER_LOCK")) { LockWorkStation(); return; }
-            if (!lstrcmpiW(g_map[i].path, L"POWER_LOGOFF")) { ExitWindowsEx(EWX_LOGOFF, 0); return; }
-        if (!lstrcmpiW(g_map[i].path, L"POWER_HIBERNATE")) { system_hibernate(); return; }
-            if (wcsncmp(g_map[i].path, L"TASKKILL:", 9) == 0) {
-                DWORD pid = _wtoi(g_map[i].path + 9);
-                if (pid) {
-                    HANDLE hProcess = OpenProcess(PROCESS_TERMINATE, FALSE, pid);
-                    if (hProcess) {
-                        TerminateProcess(hProcess, 1);
-                        CloseHandle(hProcess);
-                    }
-                }
-                return;
+    const MenuAction* act = actions_find(cmd);
+    if (!act) return;
+    switch (act->kind) {
+    case MA_OPEN_URI:
+        open_uri(act->path);
+        break;
+    case MA_OPEN_FILE:
+        open_shell_known(L"open", act->path, act->params);
+        break;
+    case MA_RUN_CMD:
+        open_shell_known(L"open", L"cmd.exe", act->path);
+        break;
+    case MA_OPEN_ITEM:
+        open_shell_item(act->path);
+        break;
+    case MA_POWER:
+        run_power_verb((ConfigItemType)act->arg);
+        break;
+    case MA_TASKKILL:
+        if (act->arg && act->hwnd && IsWindow(act->hwnd)) {
+            // The menu may be a pre-built snapshot: if the window closed, its pid may now be reused
+            DWORD pid = 0;
+            GetWindowThreadProcessId(act->hwnd, &pid);
+            if (pid != act->arg) break;
+            HANDLE hProcess = OpenProcess(PROCESS_TERMINATE, FALSE, act->arg);
+            if (hProcess) {
+                TerminateProcess(hProcess, 1);
+                CloseHandle(hProcess);
             }
-            open_shell_item(g_map[i].path); return; }
-    }
-    if (cmd >= IDM_RECENT_BASE && cmd < IDM_RECENT_BASE + 1000) {
-        if (cmd == IDM_RECENT_BASE + 900) {
-            recent_clear_all();
-            return; // no reopen; user can reopen menu manually
         }
-        RecentItem *items = NULL; int n = recent_get_items(&items, g_cfg.recentMax > 0 ? g_cfg.recentMax : 12);
-        int idx = cmd - IDM_RECENT_BASE;
-        if (idx >= 0 && idx < n) recent_open_item(&items[idx]);
-        if (items) LocalFree(items);
+        break;
+    case MA_RECENT_OPEN:
+    {
+        RecentItem item = {0};
+        lstrcpynW(item.path, act->path, ARRAYSIZE(item.path));
+        recent_open_item(&item);
+        break;
+    }
+    case MA_RECENT_CLEAR:
+        recent_clear_all(); // no reopen; user can reopen menu manually
+        break;
+    default:
+        break;
+    }
+}
+
+// Background mode keeps the next popup built ahead of time; prewarm.c decides when
+static BOOL g_prewarmEnabled = FALSE;
+static BOOL g_menuShowing = FALSE;
+static PrewarmPolicy g_prewarmPolicy;
+static PrewarmState g_prewarm;
+static HMENU g_warmMenu = NULL;
+static LONG g_warmThemeGen = 0;
+static ULONG g_popups = 0, g_warmHits = 0;
+
+static void publish_counters(void) {
+    PerfCounters c = {0};
+    DirCacheStats ds; IconCacheStats is; ProcInfoStats ps;
+    dircache_get_stats(&ds);
+    iconcache_get_stats(&is);
+    procinfo_get_stats(&ps);
+    c.popups = g_popups;
+    c.warmHits = g_warmHits;
+    c.modelRebuilt = g_model.rebuilt;
+    c.modelReused = g_model.reused;
+    c.dirHits = ds.hits; c.dirMisses = ds.misses; c.dirInvalidations = ds.invalidations; c.dirEvictions = ds.evictions;
+    c.dirEntries = ds.entries;
+    c.iconHits = is.hits; c.iconPackHits = is.packHits; c.iconMisses = is.misses;
+    c.iconEntries = is.entries; c.iconBitmaps = is.bitmaps;
+    c.procHits = ps.hits; c.procMisses = ps.misses;
+    c.procEntries = ps.entries;
+    perf_set_counters(&c);
+}
+
+static void discard_warm_menu(void) {
+    if (!g_warmMenu) return;
+    DestroyMenu(g_warmMenu);
+    g_warmMenu = NULL;
+    menu_session_release();
+    prewarm_note_dropped(&g_prewarm);
+}
+
+// The pre-built menu if it may still be shown: not past the age cap, same theme and DPI, and
+// the INI unchanged. NULL means the caller builds one now.
+static HMENU take_warm_menu(void) {
+    if (!g_warmMenu) return NULL;
+    BOOL usable = prewarm_usable(&g_prewarmPolicy, &g_prewarm, GetTickCount64()) && g_warmThemeGen == theme_generation();
+    if (usable && config_load_cached(&g_cfg)) {
+        dircache_flush(); // build_menu will not see the reload
+        usable = FALSE;
+    }
+    if (!usable) {
+        discard_warm_menu();
+        return NULL;
+    }
+    HMENU hMenu = g_warmMenu;
+    g_warmMenu = NULL;
+    return hMenu;
+}
+
+static void schedule_prewarm(HWND owner) {
+    if (!g_prewarmEnabled || g_menuShowing) {
+        KillTimer(owner, IDT_MENU_PREWARM);
         return;
     }
-    UINT id = IDM_DYNAMIC_BASE;
-    for (int i = 0; i < g_cfg.count; ++i) {
-        ConfigItem* it = &g_cfg.items[i];
-        switch (it->type) {
-        case CI_SEPARATOR: break;
-        case CI_URI:
-            if (id == cmd) { open_uri(it->path); return; } id++; break;
-        case CI_FILE:
-            if (id == cmd) { open_shell_known(L"open", it->path, it->params[0]?it->params:NULL); return; } id++; break;
-        case CI_CMD:
-            if (id == cmd) { open_shell_known(L"open", L"cmd.exe", it->params[0] ? it->params : it->path); return; } id++; break;
-        case CI_FOLDER:
-            if (!it->submenu) {
-                if (it->inlineExpand) {
-                    // Inline-expanded folder does NOT create a direct command item, so it must NOT
-                    // consume or compare the current dynamic id. Skip without increment.
-                } else {
-                    if (id == cmd) { open_shell_item(it->path); return; }
-                    id++;
-                }
-            }
-            break;
-        case CI_FOLDER_SUBMENU:
-            break;
-        case CI_POWER_SLEEP:
-            if (id == cmd) { system_sleep(); return; } id++; break;
-        case CI_POWER_SHUTDOWN:
-            if (id == cmd) { system_shutdown(FALSE); return; } id++; break;
-        case CI_POWER_RESTART:
-            if (id == cmd) { system_shutdown(TRUE); return; } id++; break;
-        case CI_POWER_LOCK:
-            if (id == cmd) { LockWorkStation(); return; } id++; break;
-        case CI_POWER_LOGOFF:
-            if (id == cmd) { ExitWindowsEx(EWX_LOGOFF, 0); return; } id++; break;
-        case CI_POWER_HIBERNATE:
-            if (id == cmd) { system_hibernate(); return; } id++; break;
-        case CI_RECENT_SUBMENU:
-            break;
-        }
+    DWORD due = INFINITE;
+    PrewarmAction action = prewarm_decide(&g_prewarmPolicy, &g_prewarm, GetTickCount64(), &due);
+    if (action == PREWARM_REFRESH && g_warmMenu && inline_folders_current() && refresh_volatile_popups()) {
+        prewarm_note_refreshed(&g_prewarm, GetTickCount64());
+        action = prewarm_decide(&g_prewarmPolicy, &g_prewarm, GetTickCount64(), &due);
+    }
+    if (action == PREWARM_BUILD || action == PREWARM_REFRESH) {
+        discard_warm_menu();
+        g_warmMenu = build_menu();
+        g_warmThemeGen = theme_generation();
+        prewarm_note_built(&g_prewarm, GetTickCount64());
+        action = prewarm_decide(&g_prewarmPolicy, &g_prewarm, GetTickCount64(), &due);
     }
+    if (action == PREWARM_DROP) {
+        discard_warm_menu();
+        action = prewarm_decide(&g_prewarmPolicy, &g_prewarm, GetTickCount64(), &due);
+    }
+    if (action != PREWARM_WAIT || due == INFINITE) KillTimer(owner, IDT_MENU_PREWARM);
+    else SetTimer(owner, IDT_MENU_PREWARM, due ? due : 1, NULL);
+}
+
+void MenuPrewarmEnable(HWND owner, BOOL enable) {
+    if (enable == g_prewarmEnabled) return;
+    g_prewarmEnabled = enable;
+    if (enable) {
+        prewarm_default_policy(&g_prewarmPolicy);
+        prewarm_note_start(&g_prewarm, GetTickCount64());
+    } else if (!g_menuShowing) {
+        discard_warm_menu();
+    }
+    schedule_prewarm(owner);
+}
+
+void MenuPrewarmInvalidate(HWND owner) {
+    if (!g_prewarmEnabled) return;
+    prewarm_note_dirty(&g_prewarm, GetTickCount64());
+    schedule_prewarm(owner);
+}
+
+void MenuPrewarmOnTimer(HWND owner) {
+    // Timers still fire inside TrackPopupMenu's modal loop; the menu close reschedules
+    schedule_prewarm(owner);
+    if (!g_menuShowing) iconcache_idle(GetTickCount64()); // idle: new icon images may go to the pack
 }
 
 void ShowWinXMenu(HWND owner, POINT screenPt) {
-    HMENU hMenu = build_menu();
+    if (g_menuShowing) return;
+    LONGLONG tShow = perf_begin();
+    g_menuShowing = TRUE;
+    KillTimer(owner, IDT_MENU_PREWARM);
+    HMENU hMenu = take_warm_menu();
+    if (hMenu) g_warmHits++;
+    else hMenu = build_menu();
+    g_popups++;
     if (screenPt.x == 0 && screenPt.y == 0) {
+        LONGLONG t = perf_begin();
         screenPt = compute_menu_pos(owner);
+        perf_end(PERF_MENU_POS, t);
     }
     SetForegroundWindow(owner);
     UINT flags = TPM_RIGHTBUTTON | TPM_VERPOSANIMATION | TPM_HORIZONTAL | TPM_RETURNCMD;
@@ -1477,11 +1295,19 @@ void ShowWinXMenu(HWND owner, POINT screenPt) {
         else if (g_cfg.vPlacement == 1) flags |= TPM_VCENTERALIGN;
         else flags |= TPM_BOTTOMALIGN;
     }
+    perf_end(PERF_SHOW, tShow);
     int cmd = TrackPopupMenu(hMenu, flags, screenPt.x, screenPt.y, 0, owner, NULL);
     PostMessageW(owner, WM_NULL, 0, 0);
     MenuExecuteCommand(owner, (UINT)cmd);
     DestroyMenu(hMenu);
+    menu_session_release();
+    g_menuShowing = FALSE;
+    publish_counters();
     // In background mode the window stays alive; WM_CLOSE is posted by caller when needed.
+    if (g_prewarmEnabled) {
+        prewarm_note_shown(&g_prewarm, GetTickCount64());
+        schedule_prewarm(owner);
+    }
 }
 
 // ===== Modern owner-draw implementation (compiled only when ENABLE_MODERN_STYLE) =====
@@ -1585,15 +1411,9 @@ BOOL MenuOnMeasureItem(HWND owner, MEASUREITEMSTRUCT* mis) {
     int w = 0;
     if (g_cfg.menuWidth >= 226 && g_cfg.menuWidth <= 255) {
         // Scale the logical width similarly across DPI to keep perceived width consistent
-        HDC sdc = GetDC(owner);
-        int dpi = GetDeviceCaps(sdc, LOGPIXELSX);
-        ReleaseDC(owner, sdc);
-        w = MulDiv(g_cfg.menuWidth, dpi, 96);
+        w = MulDiv(g_cfg.menuWidth, theme_dpi(), 96);
     } else {
-        HDC sdc = GetDC(owner);
-        int dpi = GetDeviceCaps(sdc, LOGPIXELSX);
-        ReleaseDC(owner, sdc);
-        w = MulDiv(264, dpi, 96);
+        w = MulDiv(264, theme_dpi(), 96);
     }
     mis->itemWidth = w;
     SelectObject(hdc, old);
@@ -1670,10 +1490,7 @@ BOOL MenuOnDrawItem(HWND owner, const DRAWITEMSTRUCT* dis) {
         if (id != (UINT)-1) icon = get_item_icon(id);
     }
 
-    HDC sdc = GetDC(owner);
-    int dpi = GetDeviceCaps(sdc, LOGPIXELSX);
-    ReleaseDC(owner, sdc);
-    int iconSize = MulDiv(16, dpi, 96);
+    int iconSize = MulDiv(16, theme_dpi(), 96);
 
     int leftPad = 16;
     if (icon) {
@@ -1726,12 +1543,10 @@ static HBITMAP icon_to_hbmp(HICON hico, int cx, int cy) {
 
 static void assign_legacy_item_bitmap(HMENU hMenu, UINT id, HICON hico) {
     if (!hico) return;
-    int size = get_preferred_icon_size();
-    HBITMAP hb = icon_to_hbmp(hico, size, size);
+    HBITMAP hb = item_bitmap_for_icon(id, hico);
     if (!hb) return;
     MENUITEMINFOW mii = { sizeof(mii) };
     mii.fMask = MIIM_BITMAP;
     mii.hbmpItem = hb;
     SetMenuItemInfoW(hMenu, id, FALSE, &mii);
-    if (g_itemBmpCount < ARRAYSIZE(g_itemBmps)) g_itemBmps[g_itemBmpCount++] = (ItemBmp){ id, hb };
 }
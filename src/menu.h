@@ -3,7 +3,32 @@
 
 #define IDM_FOLDER_BASE   5000
 
+#define IDT_MENU_PREWARM  1 // owner window timer used while pre-warming
+
 void ShowWinXMenu(HWND owner, POINT screenPt);
+// Background mode: build the next popup while idle so showing it only positions and tracks it
+void MenuPrewarmEnable(HWND owner, BOOL enable);
+// Menu inputs changed (theme, DPI, devices, settings); the pre-built menu is rebuilt shortly
+void MenuPrewarmInvalidate(HWND owner);
+void MenuPrewarmOnTimer(HWND owner);
+
+// Headless build benchmark (--bench): times config parsing, the menu model and whole popups
+// built from the active config, without showing anything
+typedef struct MenuBenchResult {
+    int iterations;
+    int configItems;
+    int modelNodes;
+    int menuItems;         // items of the last popup, folder popups expanded two levels deep
+    double configLoadMs;   // full INI parse
+    double modelColdMs;    // model compiled from scratch
+    double modelWarmMs;    // model update with nothing changed
+    double firstBuildMs;   // first popup, cold caches
+    double buildMs;        // average of the following popups
+    double expandMs;       // average time to fill the expanded folder popups
+    SIZE_T modelBytes;
+    SIZE_T sessionBytes;   // largest session arena use
+} MenuBenchResult;
+BOOL MenuRunBenchmark(int iterations, MenuBenchResult* out);
 void MenuExecuteCommand(HWND owner, UINT cmd);
 void MenuOnMenuSelect(HWND owner, WPARAM wParam, LPARAM lParam);
 void MenuOnInitMenuPopup(HWND owner, HMENU hMenu, UINT item, BOOL isSystemMenu);
@@ -0,0 +1,456 @@
+#include "menumodel.h"
+#include <stdlib.h> // _wtoi
+
+#ifndef ARRAYSIZE
+#define ARRAYSIZE(a) (sizeof(a)/sizeof((a)[0]))
+#endif
+
+#define SEGMENT_MAX_NODES 16  // the Power menu is the largest item (9 nodes)
+#define SEGMENT_CHUNK     2048
+
+typedef struct ExcludeList {
+    WCHAR buf[800]; // global list (512) or item params (256), double-NUL terminated
+    int len;
+} ExcludeList;
+
+static DWORD hash_bytes(DWORD h, const void* p, SIZE_T n) {
+    const BYTE* b = (const BYTE*)p;
+    for (SIZE_T i = 0; i < n; ++i) { h ^= b[i]; h *= 16777619u; }
+    return h;
+}
+
+static DWORD hash_str(DWORD h, const WCHAR* s) {
+    return hash_bytes(h, s, (SIZE_T)(lstrlenW(s) + 1) * sizeof(WCHAR));
+}
+
+static DWORD hash_int(DWORD h, int v) {
+    return hash_bytes(h, &v, sizeof(v));
+}
+
+// Settings that change how items compile; mixed into every segment key
+static DWORD settings_key(const Config* cfg, BOOL dark) {
+    DWORD h = 2166136261u;
+    h = hash_int(h, dark);
+    h = hash_str(h, cfg->defaultIconPath);
+    h = hash_str(h, cfg->defaultIconPathLight);
+    h = hash_str(h, cfg->defaultIconPathDark);
+    h = hash_int(h, cfg->showFolderIcons);
+    h = hash_int(h, cfg->excludeSleep);
+    h = hash_int(h, cfg->excludeShutdown);
+    h = hash_int(h, cfg->excludeRestart);
+    h = hash_int(h, cfg->excludeLock);
+    h = hash_int(h, cfg->excludeLogoff);
+    h = hash_int(h, cfg->excludeHibernate);
+    h = hash_int(h, cfg->taskKillMax);
+    h = hash_int(h, cfg->taskKillIgnoreSystem);
+    h = hash_int(h, cfg->taskKillShowIcons);
+    h = hash_int(h, cfg->taskKillListWindows);
+    h = hash_str(h, cfg->taskKillExcludes);
+    return h;
+}
+
+static DWORD item_key(DWORD h, const ConfigItem* it) {
+    h = hash_int(h, it->type);
+    h = hash_str(h, it->label);
+    h = hash_str(h, it->path);
+    h = hash_str(h, it->params);
+    h = hash_str(h, it->iconPath);
+    h = hash_str(h, it->iconPathLight);
+    h = hash_str(h, it->iconPathDark);
+    h = hash_int(h, it->submenu);
+    h = hash_int(h, it->inlineExpand);
+    h = hash_int(h, it->inlineNoHeader);
+    h = hash_int(h, it->inlineOpen);
+    return h;
+}
+
+// Per-item icon: theme override, then generic
+static const WCHAR* item_icon(const ConfigItem* it, BOOL dark) {
+    if (dark && it->iconPathDark[0]) return it->iconPathDark;
+    if (!dark && it->iconPathLight[0]) return it->iconPathLight;
+    if (it->iconPath[0]) return it->iconPath;
+    return NULL;
+}
+
+static const WCHAR* default_icon(const Config* cfg, BOOL dark) {
+    if (dark && cfg->defaultIconPathDark[0]) return cfg->defaultIconPathDark;
+    if (!dark && cfg->defaultIconPathLight[0]) return cfg->defaultIconPathLight;
+    if (cfg->defaultIconPath[0]) return cfg->defaultIconPath;
+    return NULL;
+}
+
+static const WCHAR* item_or_default_icon(const Config* cfg, const ConfigItem* it, BOOL dark) {
+    const WCHAR* icon = item_icon(it, dark);
+    return icon ? icon : default_icon(cfg, dark);
+}
+
+static const WCHAR* copy_str(MenuSegment* seg, const WCHAR* s) {
+    return s ? arena_wcsdup(&seg->arena, s) : NULL;
+}
+
+static MenuNode* push_node(MenuSegment* seg, MenuNodeKind kind, const WCHAR* label) {
+    if (!seg->nodes || seg->count >= SEGMENT_MAX_NODES) return NULL;
+    MenuNode* n = &seg->nodes[seg->count++];
+    n->kind = kind;
+    n->label = label ? copy_str(seg, label) : L"";
+    return n;
+}
+
+static void push_command(MenuSegment* seg, const WCHAR* label, MenuActionKind action, const WCHAR* path) {
+    MenuNode* n = push_node(seg, MN_COMMAND, label);
+    if (!n) return;
+    n->action = action;
+    n->path = copy_str(seg, path);
+}
+
+static void push_power(MenuSegment* seg, const WCHAR* label, ConfigItemType verb) {
+    MenuNode* n = push_node(seg, MN_COMMAND, NULL);
+    if (!n) return;
+    n->label = label; // static text
+    n->action = MA_POWER;
+    n->arg = verb;
+}
+
+// Optional header above an inline expansion: clickable when InlineOpen, grayed otherwise
+static void push_inline_header(MenuSegment* seg, const ConfigItem* it, const WCHAR* target) {
+    if (!it->label[0] || it->inlineNoHeader) return;
+    if (it->inlineOpen) {
+        push_command(seg, it->label, MA_OPEN_ITEM, target);
+        if (seg->count > 0) seg->nodes[seg->count - 1].flags |= MNF_FOLDER_ID;
+    } else {
+        push_node(seg, MN_HEADER, it->label);
+    }
+}
+
+static void exclude_add(ExcludeList* list, const WCHAR* s) {
+    int len = lstrlenW(s);
+    if (len == 0) return; // would end the list
+    if (list->len + len + 2 > (int)ARRAYSIZE(list->buf)) return;
+    CopyMemory(list->buf + list->len, s, (SIZE_T)(len + 1) * sizeof(WCHAR));
+    list->len += len + 1;
+    list->buf[list->len] = 0;
+}
+
+static BOOL is_bool_word(const WCHAR* p) {
+    return lstrcmpiW(p, L"true") == 0 || lstrcmpiW(p, L"false") == 0 ||
+           lstrcmpiW(p, L"1") == 0 || lstrcmpiW(p, L"0") == 0;
+}
+
+static BOOL is_false_word(const WCHAR* p) {
+    return lstrcmpiW(p, L"false") == 0 || lstrcmpiW(p, L"0") == 0;
+}
+
+// Force Quit options: global defaults, replaced by the item's
+// "max,ignoreSystem[,showIcons[,listWindows]][,exclude...]" params when present
+static void compile_taskkill(MenuNode* n, const Config* cfg, const ConfigItem* it, ExcludeList* ex) {
+    n->max = cfg->taskKillMax;
+    n->ignoreSystem = cfg->taskKillIgnoreSystem;
+    n->showIcons = cfg->taskKillShowIcons;
+    n->listWindows = cfg->taskKillListWindows;
+    ex->len = 0;
+    ex->buf[0] = ex->buf[1] = 0;
+
+    WCHAR globalBuf[512];
+    lstrcpynW(globalBuf, cfg->taskKillExcludes, ARRAYSIZE(globalBuf));
+    WCHAR* p = globalBuf;
+    while (*p) {
+        WCHAR* next = wcschr(p, L',');
+        if (next) *next = 0;
+        if (*p) exclude_add(ex, p);
+        if (!next) break;
+        p = next + 1;
+    }
+
+    if (it->params[0]) {
+        ex->len = 0; // item params replace the global excludes
+        ex->buf[0] = ex->buf[1] = 0;
+        WCHAR buf[256];
+        lstrcpynW(buf, it->params, ARRAYSIZE(buf));
+        p = buf;
+        WCHAR* next = wcschr(p, L',');
+        if (next) *next = 0;
+        n->max = _wtoi(p);
+        if (next) {
+            p = next + 1;
+            next = wcschr(p, L',');
+            if (next) *next = 0;
+            if (lstrcmpiW(p, L"true") == 0 || lstrcmpiW(p, L"1") == 0) n->ignoreSystem = TRUE;
+            else if (is_false_word(p)) n->ignoreSystem = FALSE;
+            if (next) {
+                p = next + 1;
+                // Optional ShowIcons, then optional ListWindows; the first non-boolean starts the excludes
+                WCHAR* comma = wcschr(p, L',');
+                if (comma) *comma = 0;
+                if (is_bool_word(p)) {
+                    n->showIcons = !is_false_word(p);
+                    p = comma ? comma + 1 : NULL;
+                    if (p) {
+                        comma = wcschr(p, L',');
+                        if (comma) *comma = 0;
+                        if (is_bool_word(p)) n->listWindows = !is_false_word(p);
+                        else exclude_add(ex, p);
+                        p = comma ? comma + 1 : NULL;
+                    }
+                } else {
+                    exclude_add(ex, p);
+                    p = comma ? comma + 1 : NULL;
+                }
+                while (p && *p) {
+                    next = wcschr(p, L',');
+                    if (next) *next = 0;
+                    exclude_add(ex, p);
+                    if (!next) break;
+                    p = next + 1;
+                }
+            }
+        }
+    }
+    if (n->max <= 0) n->max = 10;
+}
+
+static void compile_item(MenuSegment* seg, const Config* cfg, const ConfigItem* it, BOOL dark) {
+    MenuNode* n;
+    switch (it->type) {
+    case CI_SEPARATOR:
+        push_node(seg, MN_SEPARATOR, NULL);
+        break;
+    case CI_URI:
+    case CI_FILE:
+    case CI_CMD:
+        if (it->type == CI_URI) {
+            push_command(seg, it->label[0] ? it->label : it->path, MA_OPEN_URI, it->path);
+        } else if (it->type == CI_FILE) {
+            push_command(seg, it->label[0] ? it->label : it->path, MA_OPEN_FILE, it->path);
+            if (seg->count > 0 && it->params[0]) seg->nodes[seg->count - 1].params = copy_str(seg, it->params);
+        } else {
+            push_command(seg, it->label[0] ? it->label : it->path, MA_RUN_CMD, it->params[0] ? it->params : it->path);
+        }
+        if (seg->count > 0) seg->nodes[seg->count - 1].icon = copy_str(seg, item_or_default_icon(cfg, it, dark));
+        break;
+    case CI_FOLDER:
+        if (it->submenu) {
+            if ((n = push_node(seg, MN_FOLDER_POPUP, it->label[0] ? it->label : it->path)) != NULL) {
+                n->path = copy_str(seg, it->path);
+            }
+        } else if (it->inlineExpand) {
+            push_inline_header(seg, it, it->path);
+            if ((n = push_node(seg, MN_FOLDER_INLINE, NULL)) != NULL) n->path = copy_str(seg, it->path);
+        } else {
+            push_command(seg, it->label[0] ? it->label : it->path, MA_OPEN_ITEM, it->path);
+            if (seg->count == 0) break;
+            n = &seg->nodes[seg->count - 1];
+            const WCHAR* icon = item_icon(it, dark);
+            if (!icon && cfg->showFolderIcons) n->flags |= MNF_FOLDER_ICON;
+            else n->icon = copy_str(seg, icon ? icon : default_icon(cfg, dark));
+        }
+        break;
+    case CI_FOLDER_SUBMENU:
+        if ((n = push_node(seg, MN_FOLDER_POPUP, it->label[0] ? it->label : it->path)) != NULL) {
+            n->flags |= MNF_PREFETCH;
+            n->path = copy_str(seg, it->path);
+            const WCHAR* icon = item_icon(it, dark);
+            if (!icon && cfg->showFolderIcons) n->flags |= MNF_FOLDER_ICON;
+            else n->icon = copy_str(seg, icon ? icon : default_icon(cfg, dark));
+        }
+        break;
+    case CI_THISPC:
+    case CI_HOME:
+    {
+        BOOL home = (it->type == CI_HOME);
+        MenuNodeKind kind = home ? MN_HOME : MN_THISPC;
+        if (it->submenu) {
+            if ((n = push_node(seg, kind, it->label[0] ? it->label : (home ? L"Home" : L"This PC"))) != NULL) {
+                n->flags |= MNF_SUBMENU;
+                n->icon = copy_str(seg, item_or_default_icon(cfg, it, dark));
+            }
+        } else {
+            push_inline_header(seg, it, home ? L"::{59031a47-3f72-44a7-89c5-5595fe6b30ee}"
+                                             : L"::{20D04FE0-3AEA-1069-A2D8-08002B30309D}");
+            push_node(seg, kind, NULL);
+        }
+        break;
+    }
+    case CI_POWER_SLEEP:
+    case CI_POWER_SHUTDOWN:
+    case CI_POWER_RESTART:
+    case CI_POWER_LOCK:
+    case CI_POWER_LOGOFF:
+    case CI_POWER_HIBERNATE:
+        if ((n = push_node(seg, MN_COMMAND, it->label)) != NULL) {
+            n->action = MA_POWER;
+            n->arg = it->type;
+        }
+        break;
+    case CI_RECENT_SUBMENU:
+        if ((n = push_node(seg, MN_RECENT, it->label[0] ? it->label : L"Recent Items")) != NULL) {
+            n->icon = copy_str(seg, item_or_default_icon(cfg, it, dark));
+        }
+        break;
+    case CI_POWER_MENU:
+    {
+        if ((n = push_node(seg, MN_POPUP_BEGIN, it->label[0] ? it->label : L"Power")) == NULL) break;
+        n->icon = copy_str(seg, item_or_default_icon(cfg, it, dark));
+        // Order: Sleep, Hibernate, Shutdown, Restart, then Lock and Log off after a separator
+        BOOL firstGroup = FALSE;
+        if (!cfg->excludeSleep) { push_power(seg, L"Sleep", CI_POWER_SLEEP); firstGroup = TRUE; }
+        if (!cfg->excludeHibernate) { push_power(seg, L"Hibernate", CI_POWER_HIBERNATE); firstGroup = TRUE; }
+        if (!cfg->excludeShutdown) { push_power(seg, L"Shut down", CI_POWER_SHUTDOWN); firstGroup = TRUE; }
+        if (!cfg->excludeRestart) { push_power(seg, L"Restart", CI_POWER_RESTART); firstGroup = TRUE; }
+        BOOL secondGroup = !cfg->excludeLock || !cfg->excludeLogoff;
+        if (secondGroup && firstGroup) push_node(seg, MN_SEPARATOR, NULL);
+        if (!cfg->excludeLock) push_power(seg, L"Lock", CI_POWER_LOCK);
+        if (!cfg->excludeLogoff) push_power(seg, L"Log off", CI_POWER_LOGOFF);
+        if (!firstGroup && !secondGroup) push_node(seg, MN_HEADER, L"(None)");
+        push_node(seg, MN_POPUP_END, NULL);
+        break;
+    }
+    case CI_TASKKILL:
+    {
+        if ((n = push_node(seg, MN_TASKKILL, it->label[0] ? it->label : L"Task Kill")) == NULL) break;
+        n->icon = copy_str(seg, item_icon(it, dark)); // no default icon for Force Quit
+        ExcludeList* ex = (ExcludeList*)LocalAlloc(LMEM_FIXED, sizeof(ExcludeList));
+        if (!ex) { n->max = 10; n->excludes = L"\0"; break; }
+        compile_taskkill(n, cfg, it, ex);
+        WCHAR* list = (WCHAR*)arena_alloc(&seg->arena, (SIZE_T)(ex->len + 1) * sizeof(WCHAR));
+        if (list) CopyMemory(list, ex->buf, (SIZE_T)(ex->len + 1) * sizeof(WCHAR));
+        n->excludes = list ? list : L"\0";
+        LocalFree(ex);
+        break;
+    }
+    }
+}
+
+// Records what the segment is compiled from; FALSE when out of memory
+static BOOL store_source(MenuSegment* seg, const Config* cfg, const ConfigItem* it, BOOL dark) {
+    MenuSegmentSource* s = &seg->src;
+    s->type = it->type;
+    s->submenu = it->submenu;
+    s->inlineExpand = it->inlineExpand;
+    s->inlineNoHeader = it->inlineNoHeader;
+    s->inlineOpen = it->inlineOpen;
+    s->dark = dark;
+    s->showFolderIcons = cfg->showFolderIcons;
+    s->excludeSleep = cfg->excludeSleep;
+    s->excludeShutdown = cfg->excludeShutdown;
+    s->excludeRestart = cfg->excludeRestart;
+    s->excludeLock = cfg->excludeLock;
+    s->excludeLogoff = cfg->excludeLogoff;
+    s->excludeHibernate = cfg->excludeHibernate;
+    s->taskKillMax = cfg->taskKillMax;
+    s->taskKillIgnoreSystem = cfg->taskKillIgnoreSystem;
+    s->taskKillShowIcons = cfg->taskKillShowIcons;
+    s->taskKillListWindows = cfg->taskKillListWindows;
+    s->label = copy_str(seg, it->label);
+    s->path = copy_str(seg, it->path);
+    s->params = copy_str(seg, it->params);
+    s->iconPath = copy_str(seg, it->iconPath);
+    s->iconPathLight = copy_str(seg, it->iconPathLight);
+    s->iconPathDark = copy_str(seg, it->iconPathDark);
+    s->defaultIconPath = copy_str(seg, cfg->defaultIconPath);
+    s->defaultIconPathLight = copy_str(seg, cfg->defaultIconPathLight);
+    s->defaultIconPathDark = copy_str(seg, cfg->defaultIconPathDark);
+    s->taskKillExcludes = copy_str(seg, cfg->taskKillExcludes);
+    return s->label && s->path && s->params && s->iconPath && s->iconPathLight && s->iconPathDark &&
+           s->defaultIconPath && s->defaultIconPathLight && s->defaultIconPathDark && s->taskKillExcludes;
+}
+
+// Full comparison behind the key: a 32-bit hash match alone does not prove the inputs are equal
+static BOOL same_source(const MenuSegmentSource* s, const Config* cfg, const ConfigItem* it, BOOL dark) {
+    return s->type == it->type && s->submenu == it->submenu && s->inlineExpand == it->inlineExpand &&
+           s->inlineNoHeader == it->inlineNoHeader && s->inlineOpen == it->inlineOpen && s->dark == dark &&
+           s->showFolderIcons == cfg->showFolderIcons &&
+           s->excludeSleep == cfg->excludeSleep && s->excludeShutdown == cfg->excludeShutdown &&
+           s->excludeRestart == cfg->excludeRestart && s->excludeLock == cfg->excludeLock &&
+           s->excludeLogoff == cfg->excludeLogoff && s->excludeHibernate == cfg->excludeHibernate &&
+           s->taskKillMax == cfg->taskKillMax && s->taskKillIgnoreSystem == cfg->taskKillIgnoreSystem &&
+           s->taskKillShowIcons == cfg->taskKillShowIcons && s->taskKillListWindows == cfg->taskKillListWindows &&
+           !lstrcmpW(s->label, it->label) && !lstrcmpW(s->path, it->path) && !lstrcmpW(s->params, it->params) &&
+           !lstrcmpW(s->iconPath, it->iconPath) && !lstrcmpW(s->iconPathLight, it->iconPathLight) &&
+           !lstrcmpW(s->iconPathDark, it->iconPathDark) && !lstrcmpW(s->defaultIconPath, cfg->defaultIconPath) &&
+           !lstrcmpW(s->defaultIconPathLight, cfg->defaultIconPathLight) &&
+           !lstrcmpW(s->defaultIconPathDark, cfg->defaultIconPathDark) &&
+           !lstrcmpW(s->taskKillExcludes, cfg->taskKillExcludes);
+}
+
+static void compile_segment(MenuSegment* seg, const Config* cfg, const ConfigItem* it, BOOL dark) {
+    seg->arena.chunkSize = SEGMENT_CHUNK;
+    arena_reset(&seg->arena);
+    seg->count = 0;
+    seg->nodes = NULL;
+    if (!store_source(seg, cfg, it, dark)) return;
+    seg->nodes = (MenuNode*)arena_alloc(&seg->arena, SEGMENT_MAX_NODES * sizeof(MenuNode));
+    if (seg->nodes) compile_item(seg, cfg, it, dark);
+}
+
+int menumodel_update(MenuModel* model, const Config* cfg, BOOL dark) {
+    int items = cfg->count;
+    if (items > (int)ARRAYSIZE(model->segs)) items = (int)ARRAYSIZE(model->segs);
+    DWORD base = settings_key(cfg, dark);
+    int rebuilt = 0;
+    for (int i = 0; i < items; ++i) {
+        MenuSegment* seg = &model->segs[i];
+        DWORD key = item_key(base, &cfg->items[i]);
+        // A segment that failed to allocate is retried on the next update
+        if (i < model->count && seg->key == key && seg->nodes) {
+            if (same_source(&seg->src, cfg, &cfg->items[i], dark)) {
+                model->reused++;
+                continue;
+            }
+            model->collisions++;
+        }
+        compile_segment(seg, cfg, &cfg->items[i], dark);
+        seg->key = key;
+        rebuilt++;
+    }
+    // Segments past the end keep their arenas for reuse; only their contents are dropped
+    for (int i = items; i < model->count; ++i) {
+        arena_reset(&model->segs[i].arena);
+        model->segs[i].nodes = NULL;
+        model->segs[i].count = 0;
+    }
+    model->count = items;
+    model->rebuilt += rebuilt;
+    return rebuilt;
+}
+
+void menumodel_emit(const MenuModel* model, const MenuSink* sink, void* ctx, UINT* nextId, UINT* nextFolderId) {
+    const MenuNode* open[MENUMODEL_MAX_DEPTH];
+    int depth = 0, skipped = 0; // popups past the depth limit are left out with their contents
+    for (int s = 0; s < model->count; ++s) {
+        const MenuSegment* seg = &model->segs[s];
+        for (int i = 0; i < seg->count; ++i) {
+            const MenuNode* n = &seg->nodes[i];
+            if (skipped) {
+                if (n->kind == MN_POPUP_BEGIN) skipped++;
+                else if (n->kind == MN_POPUP_END) skipped--;
+                continue;
+            }
+            switch (n->kind) {
+            case MN_SEPARATOR:
+            case MN_HEADER:
+                sink->item(ctx, n, 0);
+                break;
+            case MN_COMMAND:
+                sink->item(ctx, n, (n->flags & MNF_FOLDER_ID) ? (*nextFolderId)++ : (*nextId)++);
+                break;
+            case MN_POPUP_BEGIN:
+                if (depth >= MENUMODEL_MAX_DEPTH) { skipped = 1; break; }
+                open[depth++] = n;
+                sink->popup_begin(ctx, n);
+                break;
+            case MN_POPUP_END:
+                if (depth > 0) sink->popup_end(ctx, open[--depth]);
+                break;
+            default:
+                sink->generated(ctx, n);
+                break;
+            }
+        }
+    }
+    while (depth > 0) sink->popup_end(ctx, open[--depth]); // unterminated popup
+}
+
+void menumodel_free(MenuModel* model) {
+    for (int i = 0; i < (int)ARRAYSIZE(model->segs); ++i) arena_free(&model->segs[i].arena);
+    ZeroMemory(model, sizeof(*model));
+}
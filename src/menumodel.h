@@ -0,0 +1,113 @@
+#pragma once
+#include <windows.h>
+#include "config.h"
+#include "actions.h"
+#include "arena.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Compiled form of the configured root menu: a flat preorder list of typed nodes with labels,
+// actions and theme-resolved icon specs, kept between popups in background mode. It holds no
+// window handles; menu.c turns it into an HMENU per session and expands the generated parts
+// (folder contents, This PC, Home, Recent, Force Quit) from their own caches at that point.
+// Nodes are grouped per config item and a group is only recompiled when its item, or a setting
+// it depends on, changes.
+
+typedef enum {
+    MN_SEPARATOR = 0,
+    MN_HEADER,          // grayed label
+    MN_COMMAND,         // action/path/params/arg; icon shown as a root item icon
+    MN_POPUP_BEGIN,     // static submenu; children follow up to the matching MN_POPUP_END
+    MN_POPUP_END,
+    MN_FOLDER_POPUP,    // lazily filled folder submenu
+    MN_FOLDER_INLINE,   // folder contents injected at this position
+    MN_THISPC,          // drives and This PC folders (MNF_SUBMENU or inline)
+    MN_HOME,            // Home folders (MNF_SUBMENU or inline)
+    MN_RECENT,          // recent items submenu, generated when shown
+    MN_TASKKILL         // Force Quit submenu, generated when shown
+} MenuNodeKind;
+
+#define MNF_SUBMENU     0x0001 // This PC / Home shown as a submenu rather than inline
+#define MNF_FOLDER_ICON 0x0002 // no icon spec: use the system folder icon
+#define MNF_PREFETCH    0x0004 // folder popup: start listing the folder in the background
+#define MNF_FOLDER_ID   0x0008 // command takes its id from the folder id range (inline headers)
+
+#define MENUMODEL_MAX_DEPTH 4
+
+typedef struct MenuNode {
+    MenuNodeKind kind;
+    DWORD flags;
+    MenuActionKind action; // MN_COMMAND
+    DWORD arg;             // MN_COMMAND: power verb
+    const WCHAR* label;
+    const WCHAR* path;     // command target or folder path; NULL when not used
+    const WCHAR* params;   // NULL when none
+    const WCHAR* icon;     // icon spec for the current theme; NULL when none
+    // MN_TASKKILL: defaults merged with the item's params
+    int max;
+    BOOL ignoreSystem;
+    BOOL showIcons;
+    BOOL listWindows;
+    const WCHAR* excludes; // window titles, double-NUL terminated
+} MenuNode;
+
+// What a segment was compiled from: the item and the settings items depend on. Strings live in
+// the segment's arena. Compared field by field before a segment whose key matches is reused.
+typedef struct MenuSegmentSource {
+    ConfigItemType type;
+    const WCHAR* label;
+    const WCHAR* path;
+    const WCHAR* params;
+    const WCHAR* iconPath;
+    const WCHAR* iconPathLight;
+    const WCHAR* iconPathDark;
+    BOOL submenu, inlineExpand, inlineNoHeader, inlineOpen;
+    BOOL dark;
+    const WCHAR* defaultIconPath;
+    const WCHAR* defaultIconPathLight;
+    const WCHAR* defaultIconPathDark;
+    BOOL showFolderIcons;
+    BOOL excludeSleep, excludeShutdown, excludeRestart, excludeLock, excludeLogoff, excludeHibernate;
+    int taskKillMax;
+    BOOL taskKillIgnoreSystem, taskKillShowIcons, taskKillListWindows;
+    const WCHAR* taskKillExcludes;
+} MenuSegmentSource;
+
+typedef struct MenuSegment {
+    DWORD key;        // hash of the item, theme and the settings it depends on
+    MenuSegmentSource src;
+    MenuNode* nodes;
+    int count;
+    Arena arena;      // nodes and strings of this segment
+} MenuSegment;
+
+typedef struct MenuModel {
+    MenuSegment segs[64]; // one per config item
+    int count;
+    ULONG rebuilt;        // segments recompiled so far
+    ULONG reused;         // segments kept as they were
+    ULONG collisions;     // key matched but the source differed
+} MenuModel;
+
+// Receives a model's nodes in menu order. menu.c appends them to an HMENU; the host harness
+// records them. Static popups arrive as begin/end pairs, nested at most MENUMODEL_MAX_DEPTH deep.
+typedef struct MenuSink {
+    void (*item)(void* ctx, const MenuNode* n, UINT id);    // separator, header (id 0) or command
+    void (*popup_begin)(void* ctx, const MenuNode* n);
+    void (*popup_end)(void* ctx, const MenuNode* begin);
+    void (*generated)(void* ctx, const MenuNode* n);        // folder, This PC, Home, Recent, Force Quit
+} MenuSink;
+
+// Brings model in line with cfg for the given theme; returns the number of segments recompiled.
+// Strings are copied, so cfg may be reloaded afterwards.
+int menumodel_update(MenuModel* model, const Config* cfg, BOOL dark);
+// Walks the model into sink. Commands take ids from *nextId, or from *nextFolderId when flagged
+// MNF_FOLDER_ID; both counters are advanced.
+void menumodel_emit(const MenuModel* model, const MenuSink* sink, void* ctx, UINT* nextId, UINT* nextFolderId);
+void menumodel_free(MenuModel* model);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,113 @@
+#include "perf.h"
+
+static PerfShared* g_perf = NULL;
+static HANDLE g_perfMapping = NULL;
+static LONGLONG g_qpcFreq = 0;
+
+static const WCHAR* const g_phaseNames[PERF_PHASE_COUNT] = {
+    L"show (to TrackPopupMenu)",
+    L"build_menu",
+    L"config_load",
+    L"model update",
+    L"item: command",
+    L"item: popup",
+    L"item: folder submenu",
+    L"item: inline folder",
+    L"item: This PC",
+    L"item: Home",
+    L"item: recent",
+    L"item: task kill",
+    L"load_icon_path_or_module",
+    L"fill_menu_with_folder",
+    L"recent_get_items",
+    L"build_taskkill_submenu",
+    L"compute_menu_pos",
+};
+
+static void stats_name(DWORD pid, WCHAR* out) {
+    wsprintfW(out, L"Local\\WinMacMenu.Stats.%lu", pid);
+}
+
+void perf_init(void) {
+    if (g_perf) return;
+    LARGE_INTEGER f;
+    if (!QueryPerformanceFrequency(&f) || f.QuadPart <= 0) return;
+    g_qpcFreq = f.QuadPart;
+    WCHAR name[64];
+    stats_name(GetCurrentProcessId(), name);
+    g_perfMapping = CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(PerfShared), name);
+    if (!g_perfMapping) return;
+    PerfShared* view = (PerfShared*)MapViewOfFile(g_perfMapping, FILE_MAP_WRITE, 0, 0, sizeof(PerfShared));
+    if (!view) {
+        CloseHandle(g_perfMapping);
+        g_perfMapping = NULL;
+        return;
+    }
+    // Pagefile-backed sections start zeroed
+    view->version = PERF_SHARED_VERSION;
+    view->phaseCount = PERF_PHASE_COUNT;
+    view->ringSize = PERF_RING_SIZE;
+    MemoryBarrier();
+    view->magic = PERF_SHARED_MAGIC;
+    g_perf = view;
+}
+
+LONGLONG perf_begin(void) {
+    LARGE_INTEGER t;
+    QueryPerformanceCounter(&t);
+    return t.QuadPart;
+}
+
+double perf_ms_since(LONGLONG start) {
+    if (!g_qpcFreq) {
+        LARGE_INTEGER f;
+        if (!QueryPerformanceFrequency(&f) || f.QuadPart <= 0) return 0.0;
+        g_qpcFreq = f.QuadPart;
+    }
+    return (double)(perf_begin() - start) * 1000.0 / (double)g_qpcFreq;
+}
+
+void perf_end(PerfPhase phase, LONGLONG start) {
+    if (!g_perf || (unsigned)phase >= PERF_PHASE_COUNT) return;
+    LONGLONG ticks = perf_begin() - start;
+    if (ticks < 0) ticks = 0;
+    LONGLONG us64 = ticks * 1000000 / g_qpcFreq;
+    ULONG us = us64 > MAXLONG ? MAXLONG : (ULONG)us64;
+
+    LONG n = InterlockedIncrement(&g_perf->ringNext);
+    PerfSample* s = &g_perf->ring[(n - 1) & (PERF_RING_SIZE - 1)];
+    s->phase = phase;
+    s->us = us;
+    s->tick = GetTickCount64();
+
+    perf_hist_record(&g_perf->hist[phase], us);
+}
+
+void perf_set_counters(const PerfCounters* counters) {
+    if (g_perf) g_perf->counters = *counters;
+}
+
+const WCHAR* perf_phase_name(int phase) {
+    return (phase >= 0 && phase < PERF_PHASE_COUNT) ? g_phaseNames[phase] : L"?";
+}
+
+const PerfShared* perf_map_process(DWORD pid, HANDLE* mapping) {
+    *mapping = NULL;
+    WCHAR name[64];
+    stats_name(pid, name);
+    HANDLE h = OpenFileMappingW(FILE_MAP_READ, FALSE, name);
+    if (!h) return NULL;
+    const PerfShared* view = (const PerfShared*)MapViewOfFile(h, FILE_MAP_READ, 0, 0, sizeof(PerfShared));
+    if (!view || view->magic != PERF_SHARED_MAGIC || view->version != PERF_SHARED_VERSION || view->phaseCount != PERF_PHASE_COUNT) {
+        if (view) UnmapViewOfFile(view);
+        CloseHandle(h);
+        return NULL;
+    }
+    *mapping = h;
+    return view;
+}
+
+void perf_unmap(const PerfShared* view, HANDLE mapping) {
+    if (view) UnmapViewOfFile(view);
+    if (mapping) CloseHandle(mapping);
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <windows.h>
+#include "perfhist.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Popup latency instrumentation. Phases are timed with QueryPerformanceCounter and recorded into
+// a shared-memory block (Local\WinMacMenu.Stats.<pid>) holding a ring of recent samples and a
+// log-scale histogram per phase, so `--stats <pid>` can read a running session without talking
+// to it. Recording is lock-free and may happen on any thread.
+
+typedef enum {
+    PERF_SHOW = 0,          // ShowWinXMenu entry to TrackPopupMenu entry
+    PERF_BUILD_MENU,        // whole build (config check, model update, materialization)
+    PERF_CONFIG_LOAD,
+    PERF_MODEL_UPDATE,
+    PERF_ITEM_COMMAND,      // per materialized item, by kind
+    PERF_ITEM_POPUP,
+    PERF_ITEM_FOLDER,
+    PERF_ITEM_INLINE_FOLDER,
+    PERF_ITEM_THISPC,
+    PERF_ITEM_HOME,
+    PERF_ITEM_RECENT,
+    PERF_ITEM_TASKKILL,
+    PERF_ICON_LOAD,         // load_icon_path_or_module
+    PERF_FOLDER_FILL,       // fill_menu_with_folder
+    PERF_RECENT_ITEMS,      // recent_get_items
+    PERF_TASKKILL_MENU,     // build_taskkill_submenu
+    PERF_MENU_POS,          // compute_menu_pos
+    PERF_PHASE_COUNT
+} PerfPhase;
+
+#define PERF_SHARED_MAGIC   0x5453504D // "MPST"
+#define PERF_SHARED_VERSION 1
+#define PERF_RING_SIZE      256        // power of two
+
+typedef struct PerfSample {
+    LONG phase;
+    ULONG us;
+    ULONGLONG tick;         // GetTickCount64 when recorded
+} PerfSample;
+
+// Cache counters published by the menu after each popup
+typedef struct PerfCounters {
+    ULONG popups;
+    ULONG warmHits;         // popups shown from the pre-built menu
+    ULONG modelRebuilt;     // menu model segments recompiled / reused
+    ULONG modelReused;
+    ULONG dirHits, dirMisses, dirInvalidations, dirEvictions;
+    LONG dirEntries;
+    ULONG iconHits, iconPackHits, iconMisses;
+    LONG iconEntries, iconBitmaps;
+    ULONG procHits, procMisses;
+    LONG procEntries;
+} PerfCounters;
+
+typedef struct PerfShared {
+    DWORD magic;
+    DWORD version;
+    DWORD phaseCount;
+    DWORD ringSize;
+    volatile LONG ringNext; // total samples recorded; ring slot = (n - 1) & (PERF_RING_SIZE - 1)
+    PerfSample ring[PERF_RING_SIZE];
+    PerfHistogram hist[PERF_PHASE_COUNT];
+    PerfCounters counters;
+} PerfShared;
+
+// Creates this process's stats block; recording is a no-op until then
+void perf_init(void);
+LONGLONG perf_begin(void);
+// Records the time since start (a perf_begin value) for phase
+void perf_end(PerfPhase phase, LONGLONG start);
+// Milliseconds since start (a perf_begin value), without recording anything
+double perf_ms_since(LONGLONG start);
+void perf_set_counters(const PerfCounters* counters);
+const WCHAR* perf_phase_name(int phase);
+// Maps the stats block of another session read-only; release with perf_unmap
+const PerfShared* perf_map_process(DWORD pid, HANDLE* mapping);
+void perf_unmap(const PerfShared* view, HANDLE mapping);
+
+#ifdef __cplusplus
+}
+#endif
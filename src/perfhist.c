@@ -0,0 +1,47 @@
+#include "perfhist.h"
+
+int perf_bucket_of(ULONG us) {
+    if (us < 4) return (int)us;
+    int log = 0;
+    for (ULONG v = us; v > 1; v >>= 1) log++;
+    int sub = (int)((us >> (log - 2)) & 3); // the two bits below the leading one
+    int b = log * 4 + sub;
+    return b < PERF_BUCKETS ? b : PERF_BUCKETS - 1;
+}
+
+ULONG perf_bucket_upper(int b) {
+    if (b < 4) return (ULONG)b;
+    if (b < 8) return 3; // unused: 4 us is already bucket 8
+    int log = b / 4, sub = b % 4;
+    ULONGLONG upper = ((ULONGLONG)(5 + sub) << (log - 2)) - 1;
+    return upper < 0xFFFFFFFF ? (ULONG)upper : 0xFFFFFFFF;
+}
+
+void perf_hist_record(PerfHistogram* h, ULONG us) {
+    InterlockedIncrement(&h->buckets[perf_bucket_of(us)]);
+    InterlockedExchangeAdd64(&h->totalUs, us);
+    LONG prev = h->maxUs;
+    while ((LONG)us > prev) {
+        LONG seen = InterlockedCompareExchange(&h->maxUs, (LONG)us, prev);
+        if (seen == prev) break;
+        prev = seen;
+    }
+    InterlockedIncrement(&h->count);
+}
+
+ULONG perf_percentile(const PerfHistogram* h, int pct) {
+    LONGLONG total = 0;
+    for (int b = 0; b < PERF_BUCKETS; ++b) total += h->buckets[b];
+    if (total == 0) return 0;
+    LONGLONG rank = (total * pct + 99) / 100; // nearest-rank
+    if (rank < 1) rank = 1;
+    LONGLONG seen = 0;
+    for (int b = 0; b < PERF_BUCKETS; ++b) {
+        seen += h->buckets[b];
+        if (seen >= rank) {
+            ULONG upper = perf_bucket_upper(b);
+            return upper < (ULONG)h->maxUs ? upper : (ULONG)h->maxUs;
+        }
+    }
+    return (ULONG)h->maxUs;
+}
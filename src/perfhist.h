@@ -0,0 +1,30 @@
+#pragma once
+#include <windows.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Latency histogram of the popup stats block: microseconds below 4 get a bucket each, above that
+// every octave is split into four (bucket 4*log2(us) + the two bits below the leading one), so
+// buckets 4..7 stay empty. Recording is lock-free; no timer or Win32 object is involved.
+#define PERF_BUCKETS        128        // quarter-octave buckets of microseconds
+
+typedef struct PerfHistogram {
+    LONG count;
+    LONG maxUs;
+    LONGLONG totalUs;
+    LONG buckets[PERF_BUCKETS];
+} PerfHistogram;
+
+int perf_bucket_of(ULONG us);
+// Largest value that falls into bucket b
+ULONG perf_bucket_upper(int b);
+void perf_hist_record(PerfHistogram* h, ULONG us);
+// Upper bound in microseconds of the bucket holding the pct-th percentile (nearest rank), never
+// above maxUs; 0 if empty
+ULONG perf_percentile(const PerfHistogram* h, int pct);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,134 @@
+#include "places.h"
+#include "arena.h"
+
+struct PlacesSink {
+    Arena arena;
+    PlaceItem* items;
+    UINT count, cap;
+    BOOL valid;
+};
+
+static PlacesSink g_drives;
+static PlacesSink g_home;
+static DWORD g_driveMask;
+static BOOL g_homeHidden;
+static HANDLE g_homeWatch = INVALID_HANDLE_VALUE;
+static PlacesStats g_stats;
+
+BOOL places_add(PlacesSink* sink, const WCHAR* label, const WCHAR* path, const void* idl, UINT idlSize, BOOL isFolder) {
+    if (sink->count == sink->cap) {
+        PlaceItem* grown = (PlaceItem*)arena_grow(&sink->arena, sink->items, sink->count, &sink->cap, sizeof(PlaceItem));
+        if (!grown) return FALSE;
+        sink->items = grown;
+    }
+    PlaceItem* it = &sink->items[sink->count];
+    it->label = arena_wcsdup(&sink->arena, label ? label : L"");
+    it->path = arena_wcsdup(&sink->arena, path ? path : L"");
+    it->idl = NULL;
+    it->idlSize = 0;
+    if (idl && idlSize) {
+        void* copy = arena_alloc(&sink->arena, idlSize);
+        if (!copy) return FALSE;
+        CopyMemory(copy, idl, idlSize);
+        it->idl = copy;
+        it->idlSize = idlSize;
+    }
+    it->isFolder = isFolder;
+    if (!it->label || !it->path) return FALSE;
+    sink->count++;
+    return TRUE;
+}
+
+static void release(PlacesSink* sink) {
+    arena_free(&sink->arena);
+    ZeroMemory(sink, sizeof(*sink));
+}
+
+static void close_watch(const PlacesReader* r) {
+    if (g_homeWatch != INVALID_HANDLE_VALUE && r->closeWatch) r->closeWatch(g_homeWatch);
+    g_homeWatch = INVALID_HANDLE_VALUE;
+}
+
+// Reads into a fresh list and replaces *list only when the read succeeded
+static BOOL read_list(PlacesSink* list, BOOL (*read)(const PlacesReader*, PlacesSink*, void*), const PlacesReader* r, void* ctx) {
+    PlacesSink fresh;
+    ZeroMemory(&fresh, sizeof(fresh));
+    g_stats.reads++;
+    if (!read(r, &fresh, ctx)) {
+        release(&fresh);
+        return FALSE;
+    }
+    release(list);
+    *list = fresh;
+    list->valid = TRUE;
+    return TRUE;
+}
+
+static BOOL read_drives(const PlacesReader* r, PlacesSink* sink, void* ctx) {
+    (void)ctx;
+    return r->readDrives && r->readDrives(sink);
+}
+
+static BOOL read_home(const PlacesReader* r, PlacesSink* sink, void* ctx) {
+    HANDLE* watch = (HANDLE*)ctx;
+    return r->readHome && r->readHome(sink, g_homeHidden, watch);
+}
+
+BOOL places_drives_current(const PlacesReader* r) {
+    return g_drives.valid && (!r->driveMask || r->driveMask() == g_driveMask);
+}
+
+BOOL places_home_current(const PlacesReader* r, BOOL showHidden) {
+    if (!g_home.valid || !g_homeHidden != !showHidden || g_homeWatch == INVALID_HANDLE_VALUE) return FALSE;
+    return !r->watchFired || !r->watchFired(g_homeWatch);
+}
+
+BOOL places_drives(const PlacesReader* r, const PlaceItem** items, int* count) {
+    if (places_drives_current(r)) {
+        g_stats.hits++;
+    } else {
+        // Mask taken before reading: a drive added meanwhile leaves it stale and is read next time
+        DWORD mask = r->driveMask ? r->driveMask() : 0;
+        g_drives.valid = FALSE;
+        if (read_list(&g_drives, read_drives, r, NULL)) g_driveMask = mask;
+    }
+    *items = g_drives.valid ? g_drives.items : NULL;
+    *count = g_drives.valid ? (int)g_drives.count : 0;
+    return g_drives.valid;
+}
+
+BOOL places_home(const PlacesReader* r, BOOL showHidden, const PlaceItem** items, int* count) {
+    if (places_home_current(r, showHidden)) {
+        g_stats.hits++;
+    } else {
+        close_watch(r);
+        g_home.valid = FALSE;
+        g_homeHidden = showHidden;
+        HANDLE watch = INVALID_HANDLE_VALUE;
+        if (!read_list(&g_home, read_home, r, &watch) && watch != INVALID_HANDLE_VALUE && r->closeWatch) {
+            r->closeWatch(watch);
+        } else {
+            g_homeWatch = watch;
+        }
+    }
+    *items = g_home.valid ? g_home.items : NULL;
+    *count = g_home.valid ? (int)g_home.count : 0;
+    return g_home.valid;
+}
+
+void places_invalidate_drives(void) {
+    g_drives.valid = FALSE;
+}
+
+void places_get_stats(PlacesStats* out) {
+    *out = g_stats;
+}
+
+void places_reset(const PlacesReader* r) {
+    close_watch(r);
+    release(&g_drives);
+    release(&g_home);
+    g_driveMask = 0;
+    g_homeHidden = FALSE;
+    ZeroMemory(&g_stats, sizeof(g_stats));
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <windows.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Contents of the This PC and Home sections, read once and kept between popups. Reading them is
+// the slow part of those sections: every drive is asked for its volume label (which waits for a
+// sleeping disk or a slow share) and Home is enumerated through the shell. The drive list is read
+// again when the logical drive mask changes or after places_invalidate_drives (volume arrival or
+// removal); the Home list when its folder's change watch fires or the hidden-items setting
+// differs. The cache is portable; reading goes through a PlacesReader (places_win32.h supplies
+// the shell one). UI thread only.
+
+typedef struct PlaceItem {
+    const WCHAR* label;
+    const WCHAR* path;  // drive root ("C:\") or parsing name; "" if the item has none
+    const void* idl;    // Home: absolute shell item id (for the icon); NULL for drives
+    UINT idlSize;
+    BOOL isFolder;      // Home: a folder present on disk, may be shown as a submenu
+} PlaceItem;
+
+// List being read; the reader hands each item to places_add
+typedef struct PlacesSink PlacesSink;
+// Copies the item into the list; FALSE when out of memory
+BOOL places_add(PlacesSink* sink, const WCHAR* label, const WCHAR* path, const void* idl, UINT idlSize, BOOL isFolder);
+
+typedef struct PlacesReader {
+    // Bit per drive letter (GetLogicalDrives); a change rereads the drive list
+    DWORD (*driveMask)(void);
+    BOOL (*readDrives)(PlacesSink* sink);
+    // *watch receives a change notification opened before enumerating, INVALID_HANDLE_VALUE if
+    // the folder cannot be watched (then the list is read for every build)
+    BOOL (*readHome)(PlacesSink* sink, BOOL showHidden, HANDLE* watch);
+    // TRUE once something changed under the watch
+    BOOL (*watchFired)(HANDLE watch);
+    void (*closeWatch)(HANDLE watch);
+} PlacesReader;
+
+typedef struct PlacesStats {
+    ULONG hits;
+    ULONG reads;
+} PlacesStats;
+
+// Drive roots with their labels. The items stay valid until the list is read again (the next
+// call after a change) or places_reset; copy what outlives the build. FALSE if nothing was read.
+BOOL places_drives(const PlacesReader* r, const PlaceItem** items, int* count);
+// Items of the Home folder, same lifetime as places_drives
+BOOL places_home(const PlacesReader* r, BOOL showHidden, const PlaceItem** items, int* count);
+// FALSE if the next places_drives / places_home call would read the list again
+BOOL places_drives_current(const PlacesReader* r);
+BOOL places_home_current(const PlacesReader* r, BOOL showHidden);
+// A volume arrived or went away; labels and media change without touching the drive mask
+void places_invalidate_drives(void);
+void places_get_stats(PlacesStats* out);
+// Frees both lists and closes the Home watch
+void places_reset(const PlacesReader* r);
+
+#ifdef __cplusplus
+}
+#endif
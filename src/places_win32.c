@@ -0,0 +1,130 @@
+#include "places_win32.h"
+#include <shlobj.h>
+#include <shlwapi.h>
+
+// Home is shell:UsersFilesFolder {59031a47-3f72-44a7-89c5-5595fe6b30ee}, the profile directory
+#define HOME_FOLDER L"::{59031a47-3f72-44a7-89c5-5595fe6b30ee}"
+#define HOME_WATCH_FLAGS (FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_ATTRIBUTES)
+
+static DWORD drive_mask(void) {
+    return GetLogicalDrives();
+}
+
+static BOOL read_drives(PlacesSink* sink) {
+    WCHAR drives[512];
+    if (GetLogicalDriveStringsW(ARRAYSIZE(drives), drives) == 0) return FALSE;
+    for (WCHAR* p = drives; *p; p += lstrlenW(p) + 1) {
+        WCHAR label[MAX_PATH + 32];
+        WCHAR volName[MAX_PATH] = {0};
+        GetVolumeInformationW(p, volName, ARRAYSIZE(volName), NULL, NULL, NULL, NULL, 0);
+        const WCHAR* name = volName;
+        if (!volName[0]) {
+            UINT type = GetDriveTypeW(p);
+            name = L"Local Disk";
+            if (type == DRIVE_REMOVABLE) name = L"Removable Disk";
+            else if (type == DRIVE_CDROM) name = L"CD Drive";
+            else if (type == DRIVE_REMOTE) name = L"Network Drive";
+        }
+        // "Label (C:)" for the root "C:\"
+        WCHAR letter[MAX_PATH];
+        lstrcpynW(letter, p, ARRAYSIZE(letter));
+        int len = lstrlenW(letter);
+        if (len > 0 && letter[len - 1] == L'\\') letter[len - 1] = 0;
+        wsprintfW(label, L"%s (%s)", name, letter);
+        if (!places_add(sink, label, p, NULL, 0, TRUE)) return FALSE;
+    }
+    return TRUE;
+}
+
+static HANDLE open_home_watch(void) {
+    WCHAR dir[MAX_PATH];
+    if (FAILED(SHGetFolderPathW(NULL, CSIDL_PROFILE, NULL, 0, dir))) return INVALID_HANDLE_VALUE;
+    return FindFirstChangeNotificationW(dir, FALSE, HOME_WATCH_FLAGS);
+}
+
+static BOOL enum_home(IShellFolder* home, LPITEMIDLIST pidlHome, PlacesSink* sink, BOOL showHidden) {
+    DWORD flags = SHCONTF_FOLDERS | SHCONTF_NONFOLDERS;
+    if (showHidden) flags |= SHCONTF_INCLUDEHIDDEN;
+    IEnumIDList* pEnum = NULL;
+    if (FAILED(home->lpVtbl->EnumObjects(home, NULL, flags, &pEnum)) || !pEnum) return FALSE;
+
+    BOOL ok = TRUE;
+    LPITEMIDLIST pidlItem = NULL;
+    ULONG fetched = 0;
+    while (ok && pEnum->lpVtbl->Next(pEnum, 1, &pidlItem, &fetched) == S_OK && fetched == 1) {
+        STRRET str;
+        WCHAR name[MAX_PATH];
+        name[0] = 0;
+        if (SUCCEEDED(home->lpVtbl->GetDisplayNameOf(home, pidlItem, SHGDN_NORMAL, &str))) {
+            StrRetToBufW(&str, pidlItem, name, ARRAYSIZE(name));
+        }
+        WCHAR path[MAX_PATH];
+        path[0] = 0;
+        if (SUCCEEDED(home->lpVtbl->GetDisplayNameOf(home, pidlItem, SHGDN_FORPARSING, &str))) {
+            StrRetToBufW(&str, pidlItem, path, ARRAYSIZE(path));
+        }
+        if (name[0]) {
+            ULONG attribs = SFGAO_FOLDER;
+            home->lpVtbl->GetAttributesOf(home, 1, (LPCITEMIDLIST*)&pidlItem, &attribs);
+            BOOL isFolder = (attribs & SFGAO_FOLDER) && path[0] && PathFileExistsW(path);
+            LPITEMIDLIST pidlAbs = ILCombine(pidlHome, pidlItem);
+            ok = places_add(sink, name, path, pidlAbs, pidlAbs ? ILGetSize(pidlAbs) : 0, isFolder);
+            CoTaskMemFree(pidlAbs);
+        }
+        CoTaskMemFree(pidlItem);
+    }
+    pEnum->lpVtbl->Release(pEnum);
+    return ok;
+}
+
+static BOOL read_home(PlacesSink* sink, BOOL showHidden, HANDLE* watch) {
+    // Opened first so a change during the enumeration leaves the list stale rather than lost
+    *watch = open_home_watch();
+    BOOL ok = FALSE;
+    CoInitialize(NULL);
+    IShellFolder* pDesktop = NULL;
+    if (SUCCEEDED(SHGetDesktopFolder(&pDesktop))) {
+        LPITEMIDLIST pidlHome = NULL;
+        if (SUCCEEDED(pDesktop->lpVtbl->ParseDisplayName(pDesktop, NULL, NULL, HOME_FOLDER, NULL, &pidlHome, NULL))) {
+            IShellFolder* home = NULL;
+            if (SUCCEEDED(pDesktop->lpVtbl->BindToObject(pDesktop, pidlHome, NULL, &IID_IShellFolder, (void**)&home))) {
+                ok = enum_home(home, pidlHome, sink, showHidden);
+                home->lpVtbl->Release(home);
+            }
+            CoTaskMemFree(pidlHome);
+        }
+        pDesktop->lpVtbl->Release(pDesktop);
+    }
+    CoUninitialize();
+    return ok;
+}
+
+static BOOL watch_fired(HANDLE watch) {
+    return WaitForSingleObject(watch, 0) == WAIT_OBJECT_0;
+}
+
+static void close_watch(HANDLE watch) {
+    FindCloseChangeNotification(watch);
+}
+
+static const PlacesReader g_reader = { drive_mask, read_drives, read_home, watch_fired, close_watch };
+
+BOOL places_get_drives(const PlaceItem** items, int* count) {
+    return places_drives(&g_reader, items, count);
+}
+
+BOOL places_get_home(BOOL showHidden, const PlaceItem** items, int* count) {
+    return places_home(&g_reader, showHidden, items, count);
+}
+
+BOOL places_get_drives_current(void) {
+    return places_drives_current(&g_reader);
+}
+
+BOOL places_get_home_current(BOOL showHidden) {
+    return places_home_current(&g_reader, showHidden);
+}
+
+void places_clear(void) {
+    places_reset(&g_reader);
+}
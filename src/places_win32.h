@@ -0,0 +1,22 @@
+#pragma once
+#include <windows.h>
+#include "places.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// This PC and Home read through GetVolumeInformation and the shell's Home folder
+// (shell:UsersFilesFolder, watched through the profile directory)
+
+BOOL places_get_drives(const PlaceItem** items, int* count);
+BOOL places_get_home(BOOL showHidden, const PlaceItem** items, int* count);
+// FALSE once the drives or the Home folder changed since they were read
+BOOL places_get_drives_current(void);
+BOOL places_get_home_current(BOOL showHidden);
+// Frees both lists and closes the Home watch
+void places_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,125 @@
+#include "prefetch.h"
+#include "dircache.h"
+
+// Prefetch jobs. The UI thread owns the job table; a worker owns its job from submission until it
+// pushes the job onto g_completed. Only the UI thread frees jobs and listings, after draining.
+#define PREFETCH_MAX_JOBS 32
+// How long opening a submenu waits for a running job before enumerating on the UI thread itself
+#define PREFETCH_TAKE_TIMEOUT_MS 50
+
+enum { JOB_QUEUED = 0, JOB_RUNNING, JOB_DONE, JOB_CANCELLED };
+
+typedef struct PrefetchJob {
+    SLIST_ENTRY link;       // must stay first (SLIST entries need MEMORY_ALLOCATION_ALIGNMENT)
+    volatile LONG state;    // JOB_*, claimed with compare-exchange by worker or UI
+    HANDLE done;            // signaled when the worker is finished with state/result
+    FolderListing* result;  // valid once state == JOB_DONE
+    int presort;
+    BOOL published;         // UI only: worker has handed the job back
+    BOOL detached;          // UI only: no longer in the table, free when published
+    ListingOptions opt;
+    WCHAR dir[MAX_PATH];
+} PrefetchJob;
+
+static SLIST_HEADER g_completed;
+static BOOL g_completedInit = FALSE;
+static PrefetchJob* g_jobs[PREFETCH_MAX_JOBS];
+static int g_jobCount = 0;
+
+// A finished listing nobody claimed still saves the next open: offer it to the folder cache
+static void free_job(PrefetchJob* job) {
+    if (job->result && job->state == JOB_DONE && dircache_insert(job->result)) job->result = NULL;
+    if (job->result) listing_free(job->result);
+    if (job->done) CloseHandle(job->done);
+    LocalFree(job);
+}
+
+// Collect jobs the workers have handed back; detached ones can now be freed
+static void drain_completed(void) {
+    if (!g_completedInit) {
+        InitializeSListHead(&g_completed);
+        g_completedInit = TRUE;
+    }
+    PSLIST_ENTRY e = InterlockedFlushSList(&g_completed);
+    while (e) {
+        PrefetchJob* job = CONTAINING_RECORD(e, PrefetchJob, link);
+        e = e->Next;
+        if (job->detached) free_job(job);
+        else job->published = TRUE;
+    }
+}
+
+static void detach_job(int index) {
+    PrefetchJob* job = g_jobs[index];
+    g_jobs[index] = g_jobs[--g_jobCount];
+    if (job->published) free_job(job);
+    else job->detached = TRUE;
+}
+
+static VOID CALLBACK prefetch_worker(PTP_CALLBACK_INSTANCE instance, PVOID context) {
+    PrefetchJob* job = (PrefetchJob*)context;
+    if (InterlockedCompareExchange(&job->state, JOB_RUNNING, JOB_QUEUED) == JOB_QUEUED) {
+        CallbackMayRunLong(instance); // network paths can stall; let the pool add threads
+        FolderListing* lst = listing_enumerate(job->dir, &job->opt);
+        if (lst && job->presort > 0) listing_sort_prefix(lst, job->presort);
+        job->result = lst;
+        InterlockedExchange(&job->state, JOB_DONE);
+    }
+    SetEvent(job->done);
+    InterlockedPushEntrySList(&g_completed, &job->link); // the job belongs to the UI thread again
+}
+
+static int find_job(const WCHAR* dir) {
+    for (int i = 0; i < g_jobCount; ++i) {
+        if (!lstrcmpiW(g_jobs[i]->dir, dir)) return i;
+    }
+    return -1;
+}
+
+void prefetch_submit(const WCHAR* dir, const ListingOptions* opt, int presort) {
+    drain_completed();
+    if (!dir || !dir[0] || g_jobCount >= PREFETCH_MAX_JOBS || find_job(dir) >= 0) return;
+    PrefetchJob* job = (PrefetchJob*)LocalAlloc(LMEM_FIXED|LMEM_ZEROINIT, sizeof(PrefetchJob));
+    if (!job) return;
+    job->done = CreateEventW(NULL, TRUE, FALSE, NULL);
+    if (!job->done) { LocalFree(job); return; }
+    job->state = JOB_QUEUED;
+    job->presort = presort;
+    job->opt = *opt;
+    lstrcpynW(job->dir, dir, ARRAYSIZE(job->dir));
+    if (!TrySubmitThreadpoolCallback(prefetch_worker, job, NULL)) {
+        free_job(job);
+        return;
+    }
+    g_jobs[g_jobCount++] = job;
+}
+
+FolderListing* prefetch_take(const WCHAR* dir, const ListingOptions* opt) {
+    drain_completed();
+    int i = find_job(dir);
+    if (i < 0) return NULL;
+    PrefetchJob* job = g_jobs[i];
+    if (InterlockedCompareExchange(&job->state, JOB_CANCELLED, JOB_QUEUED) == JOB_QUEUED) {
+        // Still queued: cancel it, the caller enumerates without waiting for a thread
+        detach_job(i);
+        return NULL;
+    }
+    // Running or finished. A job stuck on a slow path stays in the table so its listing still
+    // reaches the folder cache; the caller enumerates itself rather than hanging the menu.
+    if (WaitForSingleObject(job->done, PREFETCH_TAKE_TIMEOUT_MS) != WAIT_OBJECT_0) return NULL;
+    FolderListing* lst = NULL;
+    if (job->state == JOB_DONE && !memcmp(&job->opt, opt, sizeof(*opt))) {
+        lst = job->result;
+        job->result = NULL;
+    }
+    detach_job(i);
+    return lst;
+}
+
+void prefetch_cancel_all(void) {
+    drain_completed();
+    while (g_jobCount > 0) {
+        InterlockedCompareExchange(&g_jobs[g_jobCount - 1]->state, JOB_CANCELLED, JOB_QUEUED);
+        detach_job(g_jobCount - 1);
+    }
+}
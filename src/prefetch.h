@@ -0,0 +1,26 @@
+#pragma once
+#include <windows.h>
+#include "listing.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Background folder enumeration for the submenus a user is likely to open next. Jobs run on the
+// default thread pool; finished jobs are published to the UI thread through a lock-free SLIST.
+// All functions are called from the UI thread only.
+
+// Queues dir for enumeration (duplicates and requests beyond the per-session cap are ignored).
+// presort entries are ordered on the worker as well, so the first page costs nothing to show.
+void prefetch_submit(const WCHAR* dir, const ListingOptions* opt, int presort);
+// Takes the prefetched listing for dir, waiting briefly if the worker is still enumerating it.
+// Returns NULL when dir was never queued (or with other options), or the worker did not finish in
+// time; the caller then enumerates itself. The caller owns the result.
+FolderListing* prefetch_take(const WCHAR* dir, const ListingOptions* opt);
+// Ends the menu session: cancels queued jobs and hands unclaimed results to the folder cache.
+// Running jobs are detached; their listings are offered to the cache once they finish.
+void prefetch_cancel_all(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,72 @@
+#include "prewarm.h"
+
+void prewarm_default_policy(PrewarmPolicy* p) {
+    p->settleMs = 300;
+    p->changeSettleMs = 2000;
+    p->maxAgeMs = 15 * 1000;
+    p->keepWarmMs = 2 * 60 * 1000;
+}
+
+static DWORD until(ULONGLONG at, ULONGLONG now) {
+    if (at <= now) return 0;
+    ULONGLONG d = at - now;
+    return d >= INFINITE ? INFINITE - 1 : (DWORD)d;
+}
+
+PrewarmAction prewarm_decide(const PrewarmPolicy* p, const PrewarmState* s, ULONGLONG now, DWORD* dueMs) {
+    *dueMs = INFINITE;
+    ULONGLONG idleAt = s->usedAt + p->keepWarmMs;
+    if (now >= idleAt) {
+        // Idle: hold no menu (and no GDI objects) until the next popup
+        return s->warm ? PREWARM_DROP : PREWARM_WAIT;
+    }
+    // Only a change rebuilds the whole menu; age alone just regenerates the snapshots
+    ULONGLONG buildAt;
+    PrewarmAction action = PREWARM_BUILD;
+    if (s->dirtyAt) {
+        buildAt = s->dirtyAt + p->settleMs;
+        if (s->changedAt && s->changedAt + p->changeSettleMs > buildAt) buildAt = s->changedAt + p->changeSettleMs;
+    } else if (s->warm) { buildAt = s->freshAt + p->maxAgeMs; action = PREWARM_REFRESH; }
+    else buildAt = now;
+    if (now >= buildAt) return action;
+    if (buildAt > idleAt) buildAt = idleAt; // wake up to drop it instead
+    *dueMs = until(buildAt, now);
+    return PREWARM_WAIT;
+}
+
+BOOL prewarm_usable(const PrewarmPolicy* p, const PrewarmState* s, ULONGLONG now) {
+    return s->warm && !s->dirtyAt && now - s->freshAt <= p->maxAgeMs;
+}
+
+void prewarm_note_start(PrewarmState* s, ULONGLONG now) {
+    ZeroMemory(s, sizeof(*s));
+    s->usedAt = now;
+    s->dirtyAt = now ? now : 1;
+}
+
+void prewarm_note_built(PrewarmState* s, ULONGLONG now) {
+    s->warm = TRUE;
+    s->builtAt = now;
+    s->freshAt = now;
+    s->dirtyAt = 0;
+    s->changedAt = 0;
+}
+
+void prewarm_note_refreshed(PrewarmState* s, ULONGLONG now) {
+    s->freshAt = now;
+}
+
+void prewarm_note_dropped(PrewarmState* s) {
+    s->warm = FALSE;
+}
+
+void prewarm_note_dirty(PrewarmState* s, ULONGLONG now) {
+    s->dirtyAt = now ? now : 1;
+    s->changedAt = s->dirtyAt;
+}
+
+void prewarm_note_shown(PrewarmState* s, ULONGLONG now) {
+    s->warm = FALSE;
+    s->usedAt = now;
+    s->dirtyAt = now ? now : 1;
+}
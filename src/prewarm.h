@@ -0,0 +1,52 @@
+#pragma once
+#include <windows.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// When to build the next popup ahead of time in background mode. Pure bookkeeping: every call
+// takes the current tick count, nothing here reads a clock or touches a menu.
+
+typedef struct PrewarmPolicy {
+    DWORD settleMs;   // quiet period after a close before building
+    DWORD changeSettleMs; // quiet period after a change notification; devices and settings arrive
+                          // in bursts that can last seconds, and each burst should build once
+    DWORD maxAgeMs;   // cap on the age of the Recent and Force Quit snapshots; refreshed in place
+    DWORD keepWarmMs; // stop refreshing once the menu has not been used for this long
+} PrewarmPolicy;
+
+typedef struct PrewarmState {
+    BOOL warm;           // a built menu is waiting to be shown
+    ULONGLONG builtAt;
+    ULONGLONG freshAt;   // when its volatile sections (Recent, Force Quit) were last generated
+    ULONGLONG dirtyAt;   // last close or change notification not yet built for (0 = none)
+    ULONGLONG changedAt; // last change notification not yet built for (0 = none)
+    ULONGLONG usedAt;    // last popup (or start of pre-warming)
+} PrewarmState;
+
+typedef enum {
+    PREWARM_WAIT = 0,
+    PREWARM_BUILD,       // (re)build the menu now
+    PREWARM_REFRESH,     // regenerate only the volatile sections of the built menu
+    PREWARM_DROP         // free the built menu, nobody is using it
+} PrewarmAction;
+
+void prewarm_default_policy(PrewarmPolicy* p);
+// What to do at now; *dueMs receives the delay until the next decision (INFINITE = none pending)
+PrewarmAction prewarm_decide(const PrewarmPolicy* p, const PrewarmState* s, ULONGLONG now, DWORD* dueMs);
+// TRUE if the built menu may be shown as is at now
+BOOL prewarm_usable(const PrewarmPolicy* p, const PrewarmState* s, ULONGLONG now);
+
+void prewarm_note_start(PrewarmState* s, ULONGLONG now);
+void prewarm_note_built(PrewarmState* s, ULONGLONG now);
+void prewarm_note_refreshed(PrewarmState* s, ULONGLONG now);
+void prewarm_note_dropped(PrewarmState* s);
+// Inputs changed (theme, devices, settings); the built menu is no longer usable
+void prewarm_note_dirty(PrewarmState* s, ULONGLONG now);
+// A popup closed: the menu it showed is gone and the next one should follow shortly
+void prewarm_note_shown(PrewarmState* s, ULONGLONG now);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,141 @@
+#include "procinfo.h"
+#include <shlwapi.h>
+
+#define PROCINFO_MAX_ENTRIES 256
+
+typedef struct ProcInfoEntry {
+    DWORD hash;          // case-folded path hash
+    ULONGLONG size;
+    FILETIME writeTime;
+    ULONGLONG lastUse;   // LRU stamp
+    BOOL iconLoaded;     // extraction attempted (done lazily, only when icons are shown)
+    HICON icon;
+    WCHAR path[MAX_PATH];
+    WCHAR label[256];
+} ProcInfoEntry;
+
+static ProcInfoEntry* g_entries = NULL;
+static int g_count = 0, g_cap = 0;
+static ULONGLONG g_clock = 0;
+static ProcInfoStats g_stats;
+
+// Same folding as lstrcmpiW, so paths that compare equal hash equal
+static WCHAR fold(WCHAR c) {
+    if (c < 0x80) return (c >= L'A' && c <= L'Z') ? (WCHAR)(c + 32) : c;
+    return (WCHAR)(ULONG_PTR)CharLowerW((LPWSTR)(ULONG_PTR)c);
+}
+
+static DWORD path_hash(const WCHAR* s) {
+    DWORD h = 2166136261u;
+    for (; *s; ++s) { h ^= fold(*s); h *= 16777619u; }
+    return h;
+}
+
+static void release_icon(const ProcInfoReader* reader, ProcInfoEntry* e) {
+    if (e->icon && reader->freeIcon) reader->freeIcon(e->icon);
+    e->icon = NULL;
+    e->iconLoaded = FALSE;
+}
+
+static void read_label(const ProcInfoReader* reader, const WCHAR* path, WCHAR* out, int cch) {
+    if (!reader->readLabel || !reader->readLabel(path, out, cch)) lstrcpynW(out, PathFindFileNameW(path), cch);
+}
+
+static void fill_entry(const ProcInfoReader* reader, ProcInfoEntry* e, const WIN32_FILE_ATTRIBUTE_DATA* fad) {
+    release_icon(reader, e);
+    e->size = ((ULONGLONG)fad->nFileSizeHigh << 32) | fad->nFileSizeLow;
+    e->writeTime = fad->ftLastWriteTime;
+    read_label(reader, e->path, e->label, ARRAYSIZE(e->label));
+}
+
+// Slot for a new entry: grows the table, or reuses the least recently used slot once full
+static ProcInfoEntry* new_entry(const ProcInfoReader* reader) {
+    if (g_count < g_cap) return &g_entries[g_count++];
+    if (g_cap < PROCINFO_MAX_ENTRIES) {
+        int cap = g_cap ? g_cap * 2 : 32;
+        ProcInfoEntry* grown = (ProcInfoEntry*)LocalAlloc(LMEM_FIXED|LMEM_ZEROINIT, cap * sizeof(ProcInfoEntry));
+        if (grown) {
+            if (g_entries) {
+                memcpy(grown, g_entries, g_count * sizeof(ProcInfoEntry));
+                LocalFree(g_entries);
+            }
+            g_entries = grown;
+            g_cap = cap;
+            return &g_entries[g_count++];
+        }
+        if (g_count == 0) return NULL;
+    }
+    ProcInfoEntry* victim = &g_entries[0];
+    for (int i = 1; i < g_count; ++i) {
+        if (g_entries[i].lastUse < victim->lastUse) victim = &g_entries[i];
+    }
+    release_icon(reader, victim);
+    ZeroMemory(victim, sizeof(*victim));
+    return victim;
+}
+
+// Current entry for path; NULL when the image cannot be stat'ed or its path does not fit an entry
+static ProcInfoEntry* lookup(const ProcInfoReader* reader, const WCHAR* path, const WIN32_FILE_ATTRIBUTE_DATA* fad) {
+    if (lstrlenW(path) >= MAX_PATH) { // a truncated key would never match again
+        g_stats.misses++;
+        return NULL;
+    }
+    ULONGLONG size = ((ULONGLONG)fad->nFileSizeHigh << 32) | fad->nFileSizeLow;
+    DWORD hash = path_hash(path);
+    for (int i = 0; i < g_count; ++i) {
+        ProcInfoEntry* e = &g_entries[i];
+        if (e->hash != hash || lstrcmpiW(e->path, path) != 0) continue;
+        if (e->size == size && CompareFileTime(&e->writeTime, &fad->ftLastWriteTime) == 0) {
+            g_stats.hits++;
+        } else {
+            g_stats.misses++; // executable was updated in place
+            fill_entry(reader, e, fad);
+        }
+        e->lastUse = ++g_clock;
+        return e;
+    }
+    g_stats.misses++;
+    ProcInfoEntry* e = new_entry(reader);
+    if (!e) return NULL;
+    e->hash = hash;
+    lstrcpynW(e->path, path, ARRAYSIZE(e->path));
+    fill_entry(reader, e, fad);
+    e->lastUse = ++g_clock;
+    return e;
+}
+
+BOOL procinfo_lookup_label(const ProcInfoReader* reader, const WCHAR* imagePath, WCHAR* label, int cch) {
+    WIN32_FILE_ATTRIBUTE_DATA fad;
+    if (!GetFileAttributesExW(imagePath, GetFileExInfoStandard, &fad)) {
+        lstrcpynW(label, PathFindFileNameW(imagePath), cch);
+        return FALSE;
+    }
+    const ProcInfoEntry* e = lookup(reader, imagePath, &fad);
+    if (e) lstrcpynW(label, e->label, cch);
+    else read_label(reader, imagePath, label, cch);
+    return TRUE;
+}
+
+HICON procinfo_lookup_icon(const ProcInfoReader* reader, const WCHAR* imagePath) {
+    WIN32_FILE_ATTRIBUTE_DATA fad;
+    if (!GetFileAttributesExW(imagePath, GetFileExInfoStandard, &fad)) return NULL;
+    ProcInfoEntry* e = lookup(reader, imagePath, &fad);
+    if (!e) return NULL;
+    if (!e->iconLoaded) {
+        e->iconLoaded = TRUE;
+        e->icon = reader->readIcon ? reader->readIcon(e->path) : NULL;
+    }
+    return e->icon;
+}
+
+void procinfo_get_stats(ProcInfoStats* out) {
+    *out = g_stats;
+    out->entries = g_count;
+}
+
+void procinfo_reset(const ProcInfoReader* reader) {
+    for (int i = 0; i < g_count; ++i) release_icon(reader, &g_entries[i]);
+    if (g_entries) LocalFree(g_entries);
+    g_entries = NULL;
+    g_count = g_cap = 0;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <windows.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Per-executable metadata for the Force Quit submenu, cached by image path and revalidated
+// against the file's size and last-write time, so each executable's version resource is parsed once.
+// The cache is portable; reading the metadata goes through a ProcInfoReader (procinfo_win32.h
+// supplies the version-resource one).
+
+typedef struct ProcInfoReader {
+    // FileDescription of the image; FALSE when it has none (the file name is used instead)
+    BOOL (*readLabel)(const WCHAR* path, WCHAR* out, int cch);
+    // Small icon of the image, or NULL. Called at most once per cached entry.
+    HICON (*readIcon)(const WCHAR* path);
+    void (*freeIcon)(HICON icon);
+} ProcInfoReader;
+
+typedef struct ProcInfoStats {
+    ULONG hits;
+    ULONG misses;
+    int entries;
+} ProcInfoStats;
+
+// Label for an executable: its FileDescription, else its file name. Returns FALSE if the image
+// cannot be read at all (label still receives the file name). Paths of MAX_PATH or more are read
+// every time instead of being cached.
+BOOL procinfo_lookup_label(const ProcInfoReader* reader, const WCHAR* imagePath, WCHAR* label, int cch);
+// Small icon (owned by the cache, copy it before keeping it); NULL if none or not cacheable
+HICON procinfo_lookup_icon(const ProcInfoReader* reader, const WCHAR* imagePath);
+void procinfo_get_stats(ProcInfoStats* out);
+// Drops every entry, freeing icons through reader
+void procinfo_reset(const ProcInfoReader* reader);
+
+#ifdef __cplusplus
+}
+#endif
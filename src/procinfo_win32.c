@@ -0,0 +1,58 @@
+#include "procinfo_win32.h"
+#include <shellapi.h>
+
+// FileDescription from the first translation that has one
+static BOOL read_file_description(const WCHAR* path, WCHAR* out, int cch) {
+    DWORD handle;
+    DWORD verSize = GetFileVersionInfoSizeW(path, &handle);
+    if (verSize == 0) return FALSE;
+    void* verData = LocalAlloc(LMEM_FIXED, verSize);
+    if (!verData) return FALSE;
+    BOOL found = FALSE;
+    if (GetFileVersionInfoW(path, handle, verSize, verData)) {
+        struct LANGANDCODEPAGE {
+            WORD wLanguage;
+            WORD wCodePage;
+        } *lpTranslate;
+        UINT cbTranslate;
+        if (VerQueryValueW(verData, L"\\VarFileInfo\\Translation", (LPVOID*)&lpTranslate, &cbTranslate)) {
+            for (unsigned int i = 0; i < (cbTranslate / sizeof(struct LANGANDCODEPAGE)); i++) {
+                WCHAR subBlock[50];
+                wsprintfW(subBlock, L"\\StringFileInfo\\%04x%04x\\FileDescription", lpTranslate[i].wLanguage, lpTranslate[i].wCodePage);
+                WCHAR* description = NULL;
+                UINT descLen = 0;
+                if (VerQueryValueW(verData, subBlock, (LPVOID*)&description, &descLen) && descLen > 0) {
+                    lstrcpynW(out, description, cch);
+                    found = TRUE;
+                    break;
+                }
+            }
+        }
+    }
+    LocalFree(verData);
+    return found;
+}
+
+static HICON extract_icon(const WCHAR* path) {
+    HICON icon = NULL;
+    if (ExtractIconExW(path, 0, NULL, &icon, 1) == 0) icon = NULL;
+    return icon;
+}
+
+static void destroy_icon(HICON icon) {
+    DestroyIcon(icon);
+}
+
+static const ProcInfoReader g_versionReader = { read_file_description, extract_icon, destroy_icon };
+
+BOOL procinfo_get_label(const WCHAR* imagePath, WCHAR* label, int cch) {
+    return procinfo_lookup_label(&g_versionReader, imagePath, label, cch);
+}
+
+HICON procinfo_get_icon(const WCHAR* imagePath) {
+    return procinfo_lookup_icon(&g_versionReader, imagePath);
+}
+
+void procinfo_clear(void) {
+    procinfo_reset(&g_versionReader);
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <windows.h>
+#include "procinfo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The process metadata cache read through the executable's version resource and ExtractIconEx
+BOOL procinfo_get_label(const WCHAR* imagePath, WCHAR* label, int cch);
+HICON procinfo_get_icon(const WCHAR* imagePath);
+// Drops every entry and its icon
+void procinfo_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
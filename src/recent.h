@@ -1,18 +1,15 @@
 #pragma once
 #include <windows.h>
 #include <shlobj.h>
+#include "recentscan.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-typedef struct RecentItem {
-    WCHAR path[MAX_PATH];
-    BOOL isFolder;
-} RecentItem;
-
-// Fills recent items up to maxItems; returns count. Caller must LocalFree(list) when non-NULL.
-int recent_get_items(RecentItem **list, int maxItems);
+// Fills recent items up to maxItems, most recent first; returns count. Caller must LocalFree(list)
+// when non-NULL. Targets whose existence check misses the deadline are kept when showSlow is set.
+int recent_get_items(RecentItem **list, int maxItems, BOOL showSlow);
 void recent_open_item(const RecentItem *item);
 // Deletes all .lnk files from the Recent items folder (best-effort)
 void recent_clear_all(void);
@@ -0,0 +1,330 @@
+#include "recentscan.h"
+#include "lnk.h"
+#include <shlwapi.h>
+#include <wctype.h>
+
+// Index of resolved shortcuts in the Recent folder, keyed by .lnk file name. An entry is reused
+// while the shortcut keeps its size and last-write time, so resolution only runs for new or
+// changed shortcuts. Lives for the whole process; swept when it fills up.
+#define RECENT_INDEX_MAX 1024
+
+typedef struct RecentLink {
+    WCHAR name[MAX_PATH];   // .lnk file name inside the Recent folder
+    FILETIME lnkWrite;
+    DWORD lnkSize;
+    DWORD seen;             // scan generation that last used the entry
+    BOOL isFolder;          // from the link's own target metadata
+    WCHAR target[MAX_PATH]; // empty when the link has no file system target
+} RecentLink;
+
+static RecentLink* g_links = NULL;
+static int g_linkCount = 0, g_linkCap = 0;
+static int* g_slots = NULL;   // open addressing: entry index + 1 (0 = empty)
+static int g_slotCount = 0;   // power of two, twice g_linkCap
+static DWORD g_scanGen = 0;
+
+static DWORD name_hash(const WCHAR* s) {
+    DWORD h = 2166136261u;
+    for (; *s; ++s) {
+        WCHAR c = *s;
+        if (c < 0x80) { if (c >= L'A' && c <= L'Z') c = (WCHAR)(c + 32); }
+        else c = (WCHAR)towlower(c);
+        h ^= c; h *= 16777619u;
+    }
+    return h;
+}
+
+static void index_rebuild_slots(void) {
+    ZeroMemory(g_slots, g_slotCount * sizeof(int));
+    for (int i = 0; i < g_linkCount; ++i) {
+        int s = (int)(name_hash(g_links[i].name) & (DWORD)(g_slotCount - 1));
+        while (g_slots[s]) s = (s + 1) & (g_slotCount - 1);
+        g_slots[s] = i + 1;
+    }
+}
+
+static void index_clear(void) {
+    if (g_links) LocalFree(g_links);
+    if (g_slots) LocalFree(g_slots);
+    g_links = NULL; g_slots = NULL;
+    g_linkCount = g_linkCap = g_slotCount = 0;
+}
+
+static RecentLink* index_find(const WCHAR* name) {
+    if (!g_slots) return NULL;
+    for (int s = (int)(name_hash(name) & (DWORD)(g_slotCount - 1)); g_slots[s]; s = (s + 1) & (g_slotCount - 1)) {
+        RecentLink* l = &g_links[g_slots[s] - 1];
+        if (!lstrcmpiW(l->name, name)) return l;
+    }
+    return NULL;
+}
+
+// Drops entries not used by the current scan (shortcuts that were deleted or scrolled out)
+static void index_sweep(void) {
+    int kept = 0;
+    for (int i = 0; i < g_linkCount; ++i) {
+        if (g_links[i].seen == g_scanGen) g_links[kept++] = g_links[i];
+    }
+    g_linkCount = kept;
+    index_rebuild_slots();
+}
+
+static RecentLink* index_add(const WCHAR* name) {
+    if (g_linkCount >= RECENT_INDEX_MAX) index_sweep();
+    if (g_linkCount >= RECENT_INDEX_MAX) return NULL;
+    if (g_linkCount >= g_linkCap) {
+        int cap = g_linkCap ? g_linkCap * 2 : 32;
+        RecentLink* links = (RecentLink*)LocalAlloc(LMEM_FIXED, cap * sizeof(RecentLink));
+        int* slots = (int*)LocalAlloc(LMEM_FIXED, cap * 2 * sizeof(int));
+        if (!links || !slots) {
+            if (links) LocalFree(links);
+            if (slots) LocalFree(slots);
+            return NULL;
+        }
+        if (g_links) {
+            memcpy(links, g_links, g_linkCount * sizeof(RecentLink));
+            LocalFree(g_links);
+        }
+        if (g_slots) LocalFree(g_slots);
+        g_links = links; g_linkCap = cap;
+        g_slots = slots; g_slotCount = cap * 2;
+        index_rebuild_slots();
+    }
+    RecentLink* l = &g_links[g_linkCount];
+    ZeroMemory(l, sizeof(*l));
+    lstrcpynW(l->name, name, ARRAYSIZE(l->name));
+    int s = (int)(name_hash(name) & (DWORD)(g_slotCount - 1));
+    while (g_slots[s]) s = (s + 1) & (g_slotCount - 1);
+    g_slots[s] = ++g_linkCount;
+    return l;
+}
+
+static RecentScanStats g_stats;
+
+// Shortcut picked from directory metadata alone, before anything is resolved
+typedef struct RecentCandidate {
+    FILETIME lnkWrite;
+    DWORD lnkSize;
+    WCHAR name[MAX_PATH];
+} RecentCandidate;
+
+// Total recency order: newer first, ties broken by name so repeated passes never overlap
+static BOOL is_newer(const RecentCandidate* a, const RecentCandidate* b) {
+    int c = CompareFileTime(&a->lnkWrite, &b->lnkWrite);
+    if (c) return c > 0;
+    return lstrcmpiW(a->name, b->name) < 0;
+}
+
+// Min-heap by recency: the least recent kept candidate sits at the root
+static void candidate_sift_down(RecentCandidate* heap, int n, int i) {
+    for (;;) {
+        int l = 2 * i + 1, r = l + 1, m = i;
+        if (l < n && is_newer(&heap[m], &heap[l])) m = l;
+        if (r < n && is_newer(&heap[m], &heap[r])) m = r;
+        if (m == i) return;
+        RecentCandidate t = heap[i]; heap[i] = heap[m]; heap[m] = t;
+        i = m;
+    }
+}
+
+static void candidate_sift_up(RecentCandidate* heap, int i) {
+    while (i > 0) {
+        int p = (i - 1) / 2;
+        if (!is_newer(&heap[p], &heap[i])) return;
+        RecentCandidate t = heap[i]; heap[i] = heap[p]; heap[p] = t;
+        i = p;
+    }
+}
+
+// One pass over the Recent folder keeping the cap most recent shortcuts that rank after `after`
+// (all of them when after is NULL). Returns how many were kept, newest first.
+static int select_recent(const WCHAR* recentPath, RecentCandidate* heap, int cap, const RecentCandidate* after) {
+    WIN32_FIND_DATAW fd; WCHAR pattern[MAX_PATH];
+    PathCombineW(pattern, recentPath, L"*.lnk");
+    HANDLE h = FindFirstFileExW(pattern, FindExInfoBasic, &fd, FindExSearchNameMatch, NULL, FIND_FIRST_EX_LARGE_FETCH);
+    if (h == INVALID_HANDLE_VALUE) return 0;
+    int n = 0;
+    do {
+        if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) continue;
+        RecentCandidate c;
+        c.lnkWrite = fd.ftLastWriteTime;
+        c.lnkSize = fd.nFileSizeLow;
+        lstrcpynW(c.name, fd.cFileName, ARRAYSIZE(c.name));
+        if (after && !is_newer(after, &c)) continue;
+        if (n < cap) {
+            heap[n] = c;
+            candidate_sift_up(heap, n++);
+        } else if (is_newer(&c, &heap[0])) {
+            heap[0] = c;
+            candidate_sift_down(heap, n, 0);
+        }
+    } while (FindNextFileW(h, &fd));
+    FindClose(h);
+    // Heap-sort in place; popping the least recent to the back leaves the array newest first
+    for (int end = n - 1; end > 0; --end) {
+        RecentCandidate t = heap[0]; heap[0] = heap[end]; heap[end] = t;
+        candidate_sift_down(heap, end, 0);
+    }
+    return n;
+}
+
+// Resolution and existence checks run on a small private pool so one shortcut pointing at a
+// disconnected share cannot stall the popup. Each batch shares one deadline; jobs that miss it
+// are abandoned (the worker frees them when it finally returns).
+#define RECENT_POOL_THREADS 4
+#define RECENT_DEADLINE_MS 250
+
+typedef struct ResolveJob {
+    volatile LONG refs;     // UI + worker
+    HANDLE done;
+    BOOL needResolve;       // shortcut new or changed since it was indexed
+    WCHAR lnkPath[MAX_PATH];
+    WCHAR target[MAX_PATH]; // known target, or the resolved one when needResolve
+    BOOL isFolder;
+    DWORD attrs;            // target attributes, INVALID_FILE_ATTRIBUTES when missing
+    RecentShellResolver shell;
+} ResolveJob;
+
+static PTP_POOL g_pool = NULL;
+static TP_CALLBACK_ENVIRON g_poolEnv;
+
+static void release_job(ResolveJob* job) {
+    if (InterlockedDecrement(&job->refs) == 0) {
+        CloseHandle(job->done);
+        LocalFree(job);
+    }
+}
+
+static VOID CALLBACK resolve_worker(PTP_CALLBACK_INSTANCE instance, PVOID context) {
+    UNREFERENCED_PARAMETER(instance);
+    ResolveJob* job = (ResolveJob*)context;
+    if (job->needResolve) {
+        LnkTarget t;
+        if (lnk_read(job->lnkPath, &t)) {
+            lstrcpynW(job->target, t.path, MAX_PATH);
+            job->isFolder = (t.attributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+        } else if (!job->shell || !job->shell(job->lnkPath, job->target, &job->isFolder)) {
+            // ID-list-only links (shell namespace items) need the shell to resolve
+            job->target[0] = 0;
+        }
+    }
+    job->attrs = job->target[0] ? GetFileAttributesW(job->target) : INVALID_FILE_ATTRIBUTES;
+    SetEvent(job->done);
+    release_job(job);
+}
+
+static BOOL ensure_pool(void) {
+    if (g_pool) return TRUE;
+    PTP_POOL pool = CreateThreadpool(NULL);
+    if (!pool) return FALSE;
+    SetThreadpoolThreadMaximum(pool, RECENT_POOL_THREADS);
+    InitializeThreadpoolEnvironment(&g_poolEnv);
+    SetThreadpoolCallbackPool(&g_poolEnv, pool);
+    g_pool = pool;
+    return TRUE;
+}
+
+// Job for a candidate: indexed shortcuts only need their target checked
+static ResolveJob* start_job(const WCHAR* recentPath, const RecentCandidate* c, RecentShellResolver shell) {
+    ResolveJob* job = (ResolveJob*)LocalAlloc(LMEM_FIXED|LMEM_ZEROINIT, sizeof(ResolveJob));
+    if (!job) return NULL;
+    job->done = CreateEventW(NULL, TRUE, FALSE, NULL);
+    if (!job->done) { LocalFree(job); return NULL; }
+    job->refs = 2;
+    job->shell = shell;
+    PathCombineW(job->lnkPath, recentPath, c->name);
+    RecentLink* l = index_find(c->name);
+    if (l && l->lnkSize == c->lnkSize && CompareFileTime(&l->lnkWrite, &c->lnkWrite) == 0) {
+        l->seen = g_scanGen;
+        lstrcpynW(job->target, l->target, MAX_PATH);
+        job->isFolder = l->isFolder;
+        g_stats.fromIndex++;
+    } else {
+        job->needResolve = TRUE;
+        g_stats.resolved++;
+    }
+    if (!ensure_pool() || !TrySubmitThreadpoolCallback(resolve_worker, job, &g_poolEnv)) {
+        resolve_worker(NULL, job); // no pool: resolve inline
+    }
+    return job;
+}
+
+// Records a finished resolution in the index
+static void index_store(const RecentCandidate* c, const ResolveJob* job) {
+    RecentLink* l = index_find(c->name);
+    if (!l) l = index_add(c->name);
+    if (!l) return;
+    lstrcpynW(l->target, job->target, MAX_PATH);
+    l->isFolder = job->isFolder;
+    l->lnkSize = c->lnkSize;
+    l->lnkWrite = c->lnkWrite;
+    l->seen = g_scanGen;
+}
+
+int recentscan_collect(const WCHAR* recentPath, RecentItem* items, int maxItems, BOOL showSlow, RecentShellResolver shell) {
+    ZeroMemory(&g_stats, sizeof(g_stats));
+    if (!recentPath || !items || maxItems <= 0) return 0;
+    int cap = maxItems * 2; // slack for missing targets, usually avoids a second pass
+    RecentCandidate *heap = (RecentCandidate*)LocalAlloc(LMEM_FIXED, sizeof(RecentCandidate) * cap);
+    ResolveJob **jobs = (ResolveJob**)LocalAlloc(LMEM_FIXED, sizeof(ResolveJob*) * cap);
+    if (!heap || !jobs) {
+        if (heap) LocalFree(heap);
+        if (jobs) LocalFree(jobs);
+        return 0;
+    }
+
+    int count = 0;
+    RecentCandidate after;
+    BOOL haveAfter = FALSE;
+    g_scanGen++;
+    while (count < maxItems) {
+        int n = select_recent(recentPath, heap, cap, haveAfter ? &after : NULL);
+        g_stats.passes++;
+        g_stats.candidates += n;
+        for (int i = 0; i < n; ++i) jobs[i] = start_job(recentPath, &heap[i], shell);
+        ULONGLONG deadline = GetTickCount64() + RECENT_DEADLINE_MS;
+        for (int i = 0; i < n; ++i) {
+            ResolveJob* job = jobs[i];
+            if (!job) continue;
+            if (count < maxItems) {
+                ULONGLONG now = GetTickCount64();
+                DWORD wait = now < deadline ? (DWORD)(deadline - now) : 0;
+                if (WaitForSingleObject(job->done, wait) == WAIT_OBJECT_0) {
+                    if (job->needResolve) index_store(&heap[i], job);
+                    // Skip if empty or target does not exist anymore
+                    if (job->target[0] && job->attrs != INVALID_FILE_ATTRIBUTES) {
+                        lstrcpynW(items[count].path, job->target, MAX_PATH);
+                        items[count].isFolder = job->isFolder || (job->attrs & FILE_ATTRIBUTE_DIRECTORY);
+                        count++;
+                    }
+                } else {
+                    g_stats.late++;
+                    if (showSlow && !job->needResolve && job->target[0]) {
+                        // Target check still pending (e.g. offline share): show the indexed target optimistically
+                        lstrcpynW(items[count].path, job->target, MAX_PATH);
+                        items[count].isFolder = job->isFolder;
+                        count++;
+                    }
+                }
+            } else if (job->needResolve && WaitForSingleObject(job->done, 0) == WAIT_OBJECT_0) {
+                index_store(&heap[i], job); // not shown this time, but the next popup can reuse it
+            }
+            release_job(job);
+        }
+        if (n < cap) break; // folder exhausted
+        after = heap[n - 1];
+        haveAfter = TRUE;
+    }
+
+    LocalFree(jobs);
+    LocalFree(heap);
+    return count;
+}
+
+void recentscan_reset_index(void) {
+    index_clear();
+}
+
+void recentscan_get_stats(RecentScanStats* out) {
+    *out = g_stats;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <windows.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Recent items engine: picks the most recently written shortcuts in a folder from directory
+// metadata alone, then resolves and checks only those on a small thread pool with a deadline.
+// Shell-independent; recent.c supplies the folder and the IShellLink fallback. UI thread only.
+
+typedef struct RecentItem {
+    WCHAR path[MAX_PATH];
+    BOOL isFolder;
+} RecentItem;
+
+// Resolves a link lnk_read cannot handle (shell namespace ID list only). Runs on a pool thread;
+// returns FALSE when the link has no file system target.
+typedef BOOL (*RecentShellResolver)(const WCHAR* lnkPath, WCHAR* target, BOOL* isFolder);
+
+typedef struct RecentScanStats {
+    int passes;      // selection passes over the folder (more than one when targets were missing)
+    int candidates;  // shortcuts considered for resolution
+    int resolved;    // parsed because they were new or changed
+    int fromIndex;   // reused from the shortcut index, only the target was checked
+    int late;        // missed the deadline
+} RecentScanStats;
+
+// Fills items (maxItems slots) with the most recent shortcut targets in recentPath that still
+// exist, newest first; returns the count. Targets whose check misses the deadline are kept when
+// showSlow is set and their target is already known. shell may be NULL.
+int recentscan_collect(const WCHAR* recentPath, RecentItem* items, int maxItems, BOOL showSlow, RecentShellResolver shell);
+// Forgets every resolved shortcut (after the Recent folder was cleared)
+void recentscan_reset_index(void);
+// Counters of the last recentscan_collect call
+void recentscan_get_stats(RecentScanStats* out);
+
+#ifdef __cplusplus
+}
+#endif
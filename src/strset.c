@@ -0,0 +1,75 @@
+#include "strset.h"
+
+#define STRSET_MIN_SLOTS 64 // power of two
+
+// Same folding as lstrcmpiW; towlower only maps A-Z in the C runtime's default locale
+static WCHAR fold(WCHAR c) {
+    if (c < 0x80) return (c >= L'A' && c <= L'Z') ? (WCHAR)(c + 32) : c;
+    return (WCHAR)(ULONG_PTR)CharLowerW((LPWSTR)(ULONG_PTR)c);
+}
+
+static DWORD fold_hash(const WCHAR* s) {
+    DWORD h = 2166136261u;
+    for (; *s; ++s) { h ^= fold(*s); h *= 16777619u; }
+    return h;
+}
+
+static BOOL fold_equal(const WCHAR* a, const WCHAR* b) {
+    while (*a && *b) {
+        if (fold(*a) != fold(*b)) return FALSE;
+        ++a; ++b;
+    }
+    return *a == *b;
+}
+
+void strset_init(StringSet* set, Arena* arena) {
+    set->arena = arena;
+    set->slots = NULL;
+    set->slotCount = 0;
+    set->count = 0;
+}
+
+// Slot holding s, or the empty slot where it would go
+static StringSetSlot* probe(const StringSet* set, const WCHAR* s, DWORD hash) {
+    UINT mask = set->slotCount - 1;
+    for (UINT i = hash & mask;; i = (i + 1) & mask) {
+        StringSetSlot* slot = &set->slots[i];
+        if (!slot->str) return slot;
+        if (slot->hash == hash && fold_equal(slot->str, s)) return slot;
+    }
+}
+
+// Doubles the index (load factor stays <= 1/2); the old index is abandoned in the arena
+static BOOL grow(StringSet* set) {
+    UINT count = set->slotCount ? set->slotCount * 2 : STRSET_MIN_SLOTS;
+    StringSetSlot* slots = (StringSetSlot*)arena_alloc(set->arena, count * sizeof(StringSetSlot));
+    if (!slots) return FALSE;
+    for (UINT i = 0; i < set->slotCount; ++i) {
+        const StringSetSlot* old = &set->slots[i];
+        if (!old->str) continue;
+        UINT j = old->hash & (count - 1);
+        while (slots[j].str) j = (j + 1) & (count - 1);
+        slots[j] = *old;
+    }
+    set->slots = slots;
+    set->slotCount = count;
+    return TRUE;
+}
+
+BOOL strset_add(StringSet* set, const WCHAR* s) {
+    if (!s) return FALSE;
+    if ((set->count + 1) * 2 > set->slotCount && !grow(set)) return FALSE;
+    DWORD hash = fold_hash(s);
+    StringSetSlot* slot = probe(set, s, hash);
+    if (slot->str) return FALSE;
+    slot->str = arena_wcsdup(set->arena, s);
+    if (!slot->str) return FALSE;
+    slot->hash = hash;
+    set->count++;
+    return TRUE;
+}
+
+BOOL strset_contains(const StringSet* set, const WCHAR* s) {
+    if (!s || !set->count) return FALSE;
+    return probe(set, s, fold_hash(s))->str != NULL;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <windows.h>
+#include "arena.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Case-insensitive set of strings: open addressing over folded FNV-1a hashes. Strings and the
+// index live in an arena, so the set needs no cleanup of its own and has no size cap.
+typedef struct StringSetSlot {
+    DWORD hash;
+    const WCHAR* str;     // NULL = empty slot
+} StringSetSlot;
+
+typedef struct StringSet {
+    Arena* arena;
+    StringSetSlot* slots;
+    UINT slotCount;       // power of two (0 until the first add)
+    UINT count;
+} StringSet;
+
+void strset_init(StringSet* set, Arena* arena);
+// Adds a copy of s; returns FALSE if an equal string (ignoring case) was already present
+// (or when out of memory)
+BOOL strset_add(StringSet* set, const WCHAR* s);
+BOOL strset_contains(const StringSet* set, const WCHAR* s);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,59 +1,44 @@
 #include "theme.h"
-#include "config.h"
-#include <uxtheme.h>
-#include <dwmapi.h>
-#include <shlwapi.h>
-#pragma comment(lib, "UxTheme.lib")
-#pragma comment(lib, "Dwmapi.lib")
 
-static BOOL read_reg_dword(HKEY root, LPCWSTR subkey, LPCWSTR value, DWORD *out) {
-    HKEY k; if (RegOpenKeyExW(root, subkey, 0, KEY_READ, &k) != ERROR_SUCCESS) return FALSE;
-    DWORD type = 0, cb = sizeof(DWORD);
-    BOOL ok = (RegQueryValueExW(k, value, NULL, &type, (LPBYTE)out, &cb) == ERROR_SUCCESS && type == REG_DWORD);
-    RegCloseKey(k);
-    return ok;
-}
+// Theme state read once and re-read only from theme_refresh (settings/theme/DPI change messages)
+static ThemeState g_state;
+static BOOL g_stateLoaded = FALSE;
 
-BOOL theme_is_dark() {
+static void read_state(const ThemeProvider* provider, ThemeState* st) {
     DWORD appsUseLight = 1; // 1 means light
-    if (read_reg_dword(HKEY_CURRENT_USER, L"Software\\Microsoft\\Windows\\CurrentVersion\\Themes\\Personalize", L"AppsUseLightTheme", &appsUseLight)) {
-        return appsUseLight == 0;
+    st->dark = FALSE;
+    if (provider->appsUseLightTheme && provider->appsUseLightTheme(&appsUseLight)) {
+        st->dark = (appsUseLight == 0);
     }
-    return FALSE;
+    DWORD raw = 0;
+    st->hasAccent = provider->colorization && provider->colorization(&raw);
+    st->accent = st->hasAccent ? RGB(GetRValue(raw), GetGValue(raw), GetBValue(raw)) : 0;
+    st->dpi = provider->systemDpi ? provider->systemDpi() : 96;
+    if (st->dpi <= 0) st->dpi = 96;
 }
 
-void theme_apply_to_window(HWND hWnd) {
-    BOOL dark = theme_is_dark();
-    // Try set immersive dark mode for titlebar (Win11)
-    if (hWnd) {
-        BOOL val = dark ? TRUE : FALSE;
-        DwmSetWindowAttribute(hWnd, 20 /* DWMWA_USE_IMMERSIVE_DARK_MODE */, &val, sizeof(val));
-        // System menu colors follow system; Owner-drawn menu handled in menu.c
+const ThemeState* theme_state_from(const ThemeProvider* provider) {
+    if (!g_stateLoaded) {
+        read_state(provider, &g_state);
+        g_state.generation = 1;
+        g_stateLoaded = TRUE;
     }
+    return &g_state;
 }
 
-HMENU theme_style_menu(HMENU hMenu) {
-    // Lightweight styling: enable drop shadow and rounded corners on modern style (Win11+),
-    // legacy leaves defaults. Actual per-item owner-draw is not required here.
-    // Note: Win11 uses system theming automatically for popup menus.
-    // Try to set menu info for drop shadow regardless.
-    MENUINFO mi = { sizeof(mi) };
-    mi.fMask = MIM_STYLE;
-    GetMenuInfo(hMenu, &mi);
-    mi.dwStyle |= MNS_CHECKORBMP; // allows bitmaps/icons later
-    SetMenuInfo(hMenu, &mi);
-    return hMenu;
+BOOL theme_refresh_from(const ThemeProvider* provider) {
+    if (!g_stateLoaded) {
+        theme_state_from(provider);
+        return FALSE;
+    }
+    ThemeState now;
+    read_state(provider, &now);
+    if (now.dark == g_state.dark && now.hasAccent == g_state.hasAccent && now.accent == g_state.accent && now.dpi == g_state.dpi) return FALSE;
+    now.generation = g_state.generation + 1;
+    g_state = now;
+    return TRUE;
 }
 
-BOOL theme_get_accent(COLORREF* color) {
-    if (!color) return FALSE;
-    DWORD raw=0; BOOL opaque=FALSE;
-    if (DwmGetColorizationColor(&raw, &opaque) == S_OK) {
-        BYTE r = GetRValue(raw);
-        BYTE g = GetGValue(raw);
-        BYTE b = GetBValue(raw);
-        *color = RGB(r,g,b);
-        return TRUE;
-    }
-    return FALSE;
+void theme_reset(void) {
+    g_stateLoaded = FALSE;
 }
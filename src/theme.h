@@ -5,7 +5,38 @@
 extern "C" {
 #endif
 
+// Snapshot of the theme settings menus depend on. Read on first use and re-read only by
+// theme_refresh; generation increases whenever any field changes, so caches of rendered icons
+// and bitmaps can tell when to drop their contents.
+typedef struct ThemeState {
+    BOOL dark;          // apps use dark mode (Personalize\AppsUseLightTheme == 0)
+    BOOL hasAccent;
+    COLORREF accent;    // DWM colorization color (RGB, alpha ignored)
+    int dpi;            // system DPI (LOGPIXELSX)
+    LONG generation;
+} ThemeState;
+
+// Where the snapshot comes from. theme_win32.c reads the registry, DWM and the screen DC; tests
+// pass their own.
+typedef struct ThemeProvider {
+    BOOL (*appsUseLightTheme)(DWORD* value); // Personalize\AppsUseLightTheme; FALSE when unset
+    BOOL (*colorization)(DWORD* argb);        // DWM colorization color; FALSE when unavailable
+    int (*systemDpi)(void);                  // LOGPIXELSX of the screen, <= 0 when unknown
+} ThemeProvider;
+
+// Snapshot read through provider on first use; the accessors below use the system provider
+const ThemeState* theme_state_from(const ThemeProvider* provider);
+// Re-reads through provider; TRUE (and a new generation) only if a field changed
+BOOL theme_refresh_from(const ThemeProvider* provider);
+// Forgets the snapshot; the next read starts again at generation 1
+void theme_reset(void);
+
+const ThemeState* theme_state(void);
+// Re-reads the settings (call on WM_SETTINGCHANGE/WM_THEMECHANGED/WM_DPICHANGED); TRUE if anything changed
+BOOL theme_refresh(void);
+LONG theme_generation(void);
 BOOL theme_is_dark();
+int theme_dpi(void);
 void theme_apply_to_window(HWND hWnd);
 HMENU theme_style_menu(HMENU hMenu);
 // Returns TRUE if accent color retrieved; outputs RGB accent in *color (ignores alpha)
@@ -0,0 +1,84 @@
+#include "theme.h"
+#include "config.h"
+#include <uxtheme.h>
+#include <dwmapi.h>
+#include <shlwapi.h>
+#pragma comment(lib, "UxTheme.lib")
+#pragma comment(lib, "Dwmapi.lib")
+
+static BOOL read_reg_dword(HKEY root, LPCWSTR subkey, LPCWSTR value, DWORD *out) {
+    HKEY k; if (RegOpenKeyExW(root, subkey, 0, KEY_READ, &k) != ERROR_SUCCESS) return FALSE;
+    DWORD type = 0, cb = sizeof(DWORD);
+    BOOL ok = (RegQueryValueExW(k, value, NULL, &type, (LPBYTE)out, &cb) == ERROR_SUCCESS && type == REG_DWORD);
+    RegCloseKey(k);
+    return ok;
+}
+
+static BOOL system_apps_use_light_theme(DWORD* value) {
+    return read_reg_dword(HKEY_CURRENT_USER, L"Software\\Microsoft\\Windows\\CurrentVersion\\Themes\\Personalize", L"AppsUseLightTheme", value);
+}
+
+static BOOL system_colorization(DWORD* argb) {
+    BOOL opaque = FALSE;
+    return DwmGetColorizationColor(argb, &opaque) == S_OK;
+}
+
+static int system_dpi(void) {
+    HDC hdc = GetDC(NULL);
+    int dpi = hdc ? GetDeviceCaps(hdc, LOGPIXELSX) : 96;
+    if (hdc) ReleaseDC(NULL, hdc);
+    return dpi;
+}
+
+static const ThemeProvider g_system = { system_apps_use_light_theme, system_colorization, system_dpi };
+
+const ThemeState* theme_state(void) {
+    return theme_state_from(&g_system);
+}
+
+BOOL theme_refresh(void) {
+    return theme_refresh_from(&g_system);
+}
+
+LONG theme_generation(void) {
+    return theme_state()->generation;
+}
+
+BOOL theme_is_dark() {
+    return theme_state()->dark;
+}
+
+int theme_dpi(void) {
+    return theme_state()->dpi;
+}
+
+void theme_apply_to_window(HWND hWnd) {
+    BOOL dark = theme_is_dark();
+    // Try set immersive dark mode for titlebar (Win11)
+    if (hWnd) {
+        BOOL val = dark ? TRUE : FALSE;
+        DwmSetWindowAttribute(hWnd, 20 /* DWMWA_USE_IMMERSIVE_DARK_MODE */, &val, sizeof(val));
+        // System menu colors follow system; Owner-drawn menu handled in menu.c
+    }
+}
+
+HMENU theme_style_menu(HMENU hMenu) {
+    // Lightweight styling: enable drop shadow and rounded corners on modern style (Win11+),
+    // legacy leaves defaults. Actual per-item owner-draw is not required here.
+    // Note: Win11 uses system theming automatically for popup menus.
+    // Try to set menu info for drop shadow regardless.
+    MENUINFO mi = { sizeof(mi) };
+    mi.fMask = MIM_STYLE;
+    GetMenuInfo(hMenu, &mi);
+    mi.dwStyle |= MNS_CHECKORBMP; // allows bitmaps/icons later
+    SetMenuInfo(hMenu, &mi);
+    return hMenu;
+}
+
+BOOL theme_get_accent(COLORREF* color) {
+    if (!color) return FALSE;
+    const ThemeState* st = theme_state();
+    if (!st->hasAccent) return FALSE;
+    *color = st->accent;
+    return TRUE;
+}
@@ -0,0 +1,122 @@
+#include "winlist.h"
+#include <dwmapi.h>
+
+static WinModel g_model; // most recently activated first
+static UINT g_shellMsg = 0;
+static HWINEVENTHOOK g_showHook = NULL;
+static HWINEVENTHOOK g_cloakHook = NULL;
+static BOOL g_active = FALSE;
+
+static void read_entry(HWND hwnd, WinListEntry* e) {
+    ZeroMemory(e, sizeof(*e));
+    e->hwnd = hwnd;
+    GetWindowThreadProcessId(hwnd, &e->pid);
+    if (!GetClassNameW(hwnd, e->cls, ARRAYSIZE(e->cls))) e->cls[0] = 0;
+    if (GetWindowTextW(hwnd, e->title, ARRAYSIZE(e->title)) <= 0) e->title[0] = 0;
+    if (FAILED(DwmGetWindowAttribute(hwnd, DWMWA_CLOAKED, &e->cloaked, sizeof(e->cloaked)))) e->cloaked = 0;
+}
+
+// Adds hwnd (front or back) if it is not tracked yet; the window is only read when it is new
+static void track_window(HWND hwnd, BOOL front) {
+    if (winmodel_find(&g_model, hwnd) >= 0) return;
+    WinListEntry e;
+    read_entry(hwnd, &e);
+    winmodel_insert(&g_model, &e, front);
+}
+
+static BOOL is_top_level(HWND hwnd) {
+    return hwnd && GetAncestor(hwnd, GA_PARENT) == GetDesktopWindow();
+}
+
+static void CALLBACK win_event_proc(HWINEVENTHOOK hook, DWORD event, HWND hwnd, LONG idObject, LONG idChild, DWORD thread, DWORD time) {
+    UNREFERENCED_PARAMETER(hook); UNREFERENCED_PARAMETER(thread); UNREFERENCED_PARAMETER(time);
+    if (idObject != OBJID_WINDOW || idChild != CHILDID_SELF || !is_top_level(hwnd)) return;
+    if (event == EVENT_OBJECT_SHOW) {
+        track_window(hwnd, TRUE);
+    } else {
+        // Cloak state flips when switching virtual desktops or suspending UWP apps
+        if (winmodel_find(&g_model, hwnd) < 0) return;
+        DWORD cloaked = 0;
+        if (FAILED(DwmGetWindowAttribute(hwnd, DWMWA_CLOAKED, &cloaked, sizeof(cloaked)))) {
+            cloaked = (event == EVENT_OBJECT_CLOAKED) ? DWM_CLOAKED_SHELL : 0;
+        }
+        winmodel_cloak(&g_model, hwnd, cloaked);
+    }
+}
+
+static BOOL CALLBACK seed_proc(HWND hwnd, LPARAM lParam) {
+    UNREFERENCED_PARAMETER(lParam);
+    if (IsWindowVisible(hwnd)) track_window(hwnd, FALSE); // EnumWindows runs in z-order
+    return TRUE;
+}
+
+BOOL winlist_start(HWND owner) {
+    if (g_active) return TRUE;
+    g_shellMsg = RegisterWindowMessageW(L"SHELLHOOK");
+    if (!g_shellMsg || !RegisterShellHookWindow(owner)) return FALSE;
+    DWORD flags = WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS;
+    g_showHook = SetWinEventHook(EVENT_OBJECT_SHOW, EVENT_OBJECT_SHOW, NULL, win_event_proc, 0, 0, flags);
+    g_cloakHook = SetWinEventHook(EVENT_OBJECT_CLOAKED, EVENT_OBJECT_UNCLOAKED, NULL, win_event_proc, 0, 0, flags);
+    winmodel_clear(&g_model);
+    EnumWindows(seed_proc, 0);
+    g_active = TRUE;
+    return TRUE;
+}
+
+void winlist_stop(HWND owner) {
+    if (!g_active) return;
+    DeregisterShellHookWindow(owner);
+    if (g_showHook) UnhookWinEvent(g_showHook);
+    if (g_cloakHook) UnhookWinEvent(g_cloakHook);
+    g_showHook = g_cloakHook = NULL;
+    winmodel_free(&g_model);
+    g_active = FALSE;
+}
+
+BOOL winlist_active(void) {
+    return g_active;
+}
+
+BOOL winlist_on_message(UINT msg, WPARAM wParam, LPARAM lParam) {
+    if (!g_active || msg != g_shellMsg) return FALSE;
+    HWND hwnd = (HWND)lParam;
+    WCHAR title[256];
+    switch (wParam & 0x7FFF) { // high bit marks HSHELL_RUDEAPPACTIVATED / HSHELL_FLASH
+    case HSHELL_WINDOWCREATED:
+    case HSHELL_WINDOWREPLACING:
+        track_window(hwnd, TRUE);
+        break;
+    case HSHELL_WINDOWDESTROYED:
+    case HSHELL_WINDOWREPLACED:
+        winmodel_remove(&g_model, hwnd);
+        break;
+    case HSHELL_WINDOWACTIVATED:
+        if (!winmodel_activate(&g_model, hwnd) && hwnd && is_top_level(hwnd)) track_window(hwnd, TRUE);
+        break;
+    case HSHELL_REDRAW: // title or icon changed
+        if (winmodel_find(&g_model, hwnd) >= 0) {
+            if (GetWindowTextW(hwnd, title, ARRAYSIZE(title)) <= 0) title[0] = 0;
+            winmodel_rename(&g_model, hwnd, title);
+        }
+        break;
+    default:
+        break;
+    }
+    return TRUE;
+}
+
+static BOOL window_exists(HWND hwnd) {
+    return IsWindow(hwnd);
+}
+
+int winlist_snapshot(WinListEntry** out) {
+    *out = NULL;
+    // Windows destroyed without a shell notification (never shown in the taskbar) are dropped here
+    int count = winmodel_prune(&g_model, window_exists);
+    if (count == 0) return 0;
+    WinListEntry* copy = (WinListEntry*)LocalAlloc(LMEM_FIXED, count * sizeof(WinListEntry));
+    if (!copy) return 0;
+    memcpy(copy, g_model.wins, count * sizeof(WinListEntry));
+    *out = copy;
+    return count;
+}
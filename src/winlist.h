@@ -0,0 +1,25 @@
+#pragma once
+#include <windows.h>
+#include "winmodel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Live model of top-level application windows for the Force Quit submenu, kept current from
+// shell hook (create/destroy/title/activate) and WinEvent (show, cloak) notifications so the
+// menu does not have to walk every window on each open. Only used while running in background.
+// This file reads the windows and hooks; the list itself is a WinModel (winmodel.h).
+
+// Registers owner for shell hook messages and installs the WinEvent hooks; seeds the model
+BOOL winlist_start(HWND owner);
+void winlist_stop(HWND owner);
+BOOL winlist_active(void);
+// Feed every window message of owner through here; TRUE if it was a shell hook message
+BOOL winlist_on_message(UINT msg, WPARAM wParam, LPARAM lParam);
+// Copy of the model, most recently activated first; caller must LocalFree(*out) when non-NULL
+int winlist_snapshot(WinListEntry** out);
+
+#ifdef __cplusplus
+}
+#endif
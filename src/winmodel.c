@@ -0,0 +1,81 @@
+#include "winmodel.h"
+
+int winmodel_find(const WinModel* m, HWND hwnd) {
+    for (int i = 0; i < m->count; ++i) {
+        if (m->wins[i].hwnd == hwnd) return i;
+    }
+    return -1;
+}
+
+int winmodel_insert(WinModel* m, const WinListEntry* e, BOOL front) {
+    int i = winmodel_find(m, e->hwnd);
+    if (i >= 0) return i;
+    if (m->count >= m->cap) {
+        int cap = m->cap ? m->cap * 2 : 64;
+        WinListEntry* grown = (WinListEntry*)LocalAlloc(LMEM_FIXED, cap * sizeof(WinListEntry));
+        if (!grown) return -1;
+        if (m->wins) {
+            memcpy(grown, m->wins, m->count * sizeof(WinListEntry));
+            LocalFree(m->wins);
+        }
+        m->wins = grown;
+        m->cap = cap;
+    }
+    i = front ? 0 : m->count;
+    if (front) memmove(&m->wins[1], &m->wins[0], m->count * sizeof(WinListEntry));
+    m->count++;
+    m->wins[i] = *e;
+    return i;
+}
+
+BOOL winmodel_remove(WinModel* m, HWND hwnd) {
+    int i = winmodel_find(m, hwnd);
+    if (i < 0) return FALSE;
+    memmove(&m->wins[i], &m->wins[i + 1], (m->count - i - 1) * sizeof(WinListEntry));
+    m->count--;
+    return TRUE;
+}
+
+BOOL winmodel_activate(WinModel* m, HWND hwnd) {
+    int i = winmodel_find(m, hwnd);
+    if (i < 0) return FALSE;
+    if (i > 0) {
+        WinListEntry e = m->wins[i];
+        memmove(&m->wins[1], &m->wins[0], i * sizeof(WinListEntry));
+        m->wins[0] = e;
+    }
+    return TRUE;
+}
+
+BOOL winmodel_rename(WinModel* m, HWND hwnd, const WCHAR* title) {
+    int i = winmodel_find(m, hwnd);
+    if (i < 0) return FALSE;
+    lstrcpynW(m->wins[i].title, title ? title : L"", ARRAYSIZE(m->wins[i].title));
+    return TRUE;
+}
+
+BOOL winmodel_cloak(WinModel* m, HWND hwnd, DWORD cloaked) {
+    int i = winmodel_find(m, hwnd);
+    if (i < 0) return FALSE;
+    m->wins[i].cloaked = cloaked;
+    return TRUE;
+}
+
+int winmodel_prune(WinModel* m, BOOL (*alive)(HWND hwnd)) {
+    int kept = 0;
+    for (int i = 0; i < m->count; ++i) {
+        if (alive(m->wins[i].hwnd)) m->wins[kept++] = m->wins[i];
+    }
+    m->count = kept;
+    return kept;
+}
+
+void winmodel_clear(WinModel* m) {
+    m->count = 0;
+}
+
+void winmodel_free(WinModel* m) {
+    if (m->wins) LocalFree(m->wins);
+    m->wins = NULL;
+    m->count = m->cap = 0;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <windows.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Ordered list of top-level windows behind the Force Quit submenu, most recently activated first.
+// Pure list operations: callers pass in whatever the event carried (or what they read from the
+// window), so a recorded event trace can drive the model without any window existing.
+
+typedef struct WinListEntry {
+    HWND hwnd;
+    DWORD pid;
+    DWORD cloaked;      // DWMWA_CLOAKED value as of the last cloak event
+    WCHAR cls[64];
+    WCHAR title[256];
+} WinListEntry;
+
+typedef struct WinModel {
+    WinListEntry* wins;
+    int count;
+    int cap;
+} WinModel;
+
+int winmodel_find(const WinModel* m, HWND hwnd);
+// Adds a copy of e at the front or the back unless its window is tracked already. Returns the
+// window's index, or -1 when out of memory.
+int winmodel_insert(WinModel* m, const WinListEntry* e, BOOL front);
+// Each returns FALSE when hwnd is not tracked
+BOOL winmodel_remove(WinModel* m, HWND hwnd);
+BOOL winmodel_activate(WinModel* m, HWND hwnd); // moves it to the front
+BOOL winmodel_rename(WinModel* m, HWND hwnd, const WCHAR* title);
+BOOL winmodel_cloak(WinModel* m, HWND hwnd, DWORD cloaked);
+// Drops every window alive() rejects, keeping the order; returns the new count
+int winmodel_prune(WinModel* m, BOOL (*alive)(HWND hwnd));
+void winmodel_clear(WinModel* m);
+void winmodel_free(WinModel* m);
+
+#ifdef __cplusplus
+}
+#endif
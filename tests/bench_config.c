@@ -0,0 +1,68 @@
+// Cost of getting a Config per popup: full parse, load from the compiled sidecar, and the
+// config_load_cached check when nothing changed. Reports time and heap allocations per call.
+#include "test.h"
+#include "config.h"
+#include "configbin.h"
+#include <sys/stat.h>
+
+static void write_ini(const char* path, int items) {
+    size_t cap = 4096 + (size_t)items * 96;
+    char* text = (char*)malloc(cap);
+    size_t n = (size_t)snprintf(text, cap, "[General]\r\nRunInBackground=true\r\nShowIcons=true\r\n[Menu]\r\n");
+    for (int i = 1; i <= items; ++i) {
+        n += (size_t)snprintf(text + n, cap - n, "Item%d=Entry %d|FILE|C:\\Tools\\tool%d.exe|--flag %d\r\n", i, i, i, i);
+    }
+    n += (size_t)snprintf(text + n, cap - n, "[Icons]\r\n");
+    for (int i = 1; i <= items; i += 2) n += (size_t)snprintf(text + n, cap - n, "Icon%d=shell32.dll,-%d\r\n", i, i);
+    test_write_file(path, text, n);
+    free(text);
+}
+
+typedef BOOL (*LoadFn)(Config* cfg);
+
+static void measure(const char* label, int items, Config* cfg, LoadFn fn, int reps, const char* binPath) {
+    ShimAllocStats a0, a1;
+    double total = 0;
+    shim_alloc_stats(&a0);
+    for (int r = 0; r < reps; ++r) {
+        if (binPath) unlink(binPath);
+        double t0 = test_now_ms();
+        fn(cfg);
+        total += test_now_ms() - t0;
+    }
+    shim_alloc_stats(&a1);
+    printf("%-14s items=%-3d %10.2f us/call %8.1f allocs/call\n", label, items, total * 1000.0 / reps,
+           (double)(a1.allocs - a0.allocs) / reps);
+}
+
+int main(int argc, char** argv) {
+    int quick = bench_quick(argc, argv);
+    int reps = quick ? 1 : 200;
+    const char* tmp = test_temp_dir("bench_config");
+    if (!tmp) return 1;
+    char dir[512], ini[600], appdata[600], bin[MAX_PATH * 3];
+    snprintf(dir, sizeof(dir), "%s", tmp);
+    snprintf(ini, sizeof(ini), "%s/config.ini", dir);
+    snprintf(appdata, sizeof(appdata), "%s/appdata", dir);
+    mkdir(appdata, 0755);
+    setenv("LOCALAPPDATA", appdata, 1); // the sidecar lives under %LOCALAPPDATA%\WinMacMenu
+    WCHAR wini[600], wbin[MAX_PATH + 8];
+    shim_from_utf8(ini, wini, ARRAYSIZE(wini));
+    config_set_default_path(wini);
+    if (!configbin_path(wini, wbin, ARRAYSIZE(wbin), TRUE)) return 1;
+    shim_to_utf8(wbin, bin, sizeof(bin));
+
+    static const int sizes[] = { 8, 24, 64 };
+    Config* cfg = (Config*)calloc(1, sizeof(Config));
+    for (int s = 0; s < (int)ARRAYSIZE(sizes); ++s) {
+        write_ini(ini, sizes[s]);
+        measure("parse", sizes[s], cfg, config_load, reps, bin);
+        config_load(cfg); // leaves a current sidecar behind
+        measure("sidecar", sizes[s], cfg, config_load, reps, NULL);
+        config_load_cached(cfg);
+        measure("cached-check", sizes[s], cfg, config_load_cached, reps * 10, NULL);
+    }
+    free(cfg);
+    test_remove_dir(dir);
+    return 0;
+}
@@ -0,0 +1,60 @@
+// INI reader throughput on generated files of 10 to 10k keys: parse time, lookups per second and
+// heap allocations per parse. Linked with --wrap=malloc/calloc so the portable core's allocations count.
+#include "test.h"
+#include "ini.h"
+
+static long g_allocs = 0;
+void* __real_malloc(size_t n);
+void* __real_calloc(size_t n, size_t size);
+void* __wrap_malloc(size_t n) { g_allocs++; return __real_malloc(n); }
+void* __wrap_calloc(size_t n, size_t size) { g_allocs++; return __real_calloc(n, size); }
+
+// Keys are spread over sections of 50 keys each, like a large [Menu] plus per-folder sections
+static char* make_ini(int keys, size_t* len) {
+    size_t cap = (size_t)keys * 64 + 64;
+    char* text = (char*)__real_malloc(cap);
+    size_t n = 0;
+    for (int i = 0; i < keys; ++i) {
+        if (i % 50 == 0) n += (size_t)snprintf(text + n, cap - n, "[Section%d]\r\n", i / 50);
+        n += (size_t)snprintf(text + n, cap - n, "Key%d = Value number %d\r\n", i, i);
+    }
+    *len = n;
+    return text;
+}
+
+int main(int argc, char** argv) {
+    int quick = bench_quick(argc, argv);
+    static const int sizes[] = { 10, 100, 1000, 10000 };
+    for (int s = 0; s < (int)ARRAYSIZE(sizes); ++s) {
+        int keys = sizes[s];
+        size_t len = 0;
+        char* text = make_ini(keys, &len);
+        int reps = quick ? 1 : (int)(200000 / keys) + 5;
+
+        long a0 = g_allocs;
+        double t0 = test_now_ms();
+        for (int r = 0; r < reps; ++r) ini_free(ini_parse_bytes((const uint8_t*)text, len, NULL));
+        double parseMs = (test_now_ms() - t0) / reps;
+        double allocs = (double)(g_allocs - a0) / reps;
+
+        // Precomputed names so the loop measures lookups only
+        IniFile* ini = ini_parse_bytes((const uint8_t*)text, len, NULL);
+        WCHAR (*names)[2][24] = __real_malloc(sizeof(*names) * (size_t)keys);
+        for (int i = 0; i < keys; ++i) {
+            wsprintfW(names[i][0], L"SECTION%d", i / 50);
+            wsprintfW(names[i][1], L"key%d", i);
+        }
+        int lookups = quick ? keys : (keys < 200000 ? 200000 : keys), hits = 0;
+        t0 = test_now_ms();
+        for (int i = 0; i < lookups; ++i) hits += ini_get(ini, names[i % keys][0], names[i % keys][1]) != NULL;
+        double lookupMs = test_now_ms() - t0;
+        ini_free(ini);
+        free(names);
+        free(text);
+        if (hits != lookups) { fprintf(stderr, "lookup miss: %d of %d\n", lookups - hits, lookups); return 1; }
+
+        printf("keys=%-6d parse %9.2f us (%6.1f MB/s) %4.1f allocs/parse   lookup %8.2f Mkeys/s\n", keys,
+               parseMs * 1000.0, len / (parseMs * 1000.0), allocs, lookups / (lookupMs * 1000.0));
+    }
+    return 0;
+}
@@ -0,0 +1,174 @@
+// Folder listing ordering on synthetic listings of 1k to 1M entries, for every SORT_* field:
+// a full sort against the top-k page (40 entries) and the "Show more items..." extension to 80.
+// Then memory and sort time of the compact listing against the former ~1 KB FileItem array at 100k,
+// and the precomputed collation keys against the former lstrcmpiW/wcsrchr comparator.
+// The keys come from the shim's LCMapStringEx, so the orders checked here are the shim's, and the key
+// cost is not the cost of the real NLS collation; heap, top-k and key-compare costs carry over.
+#include "test.h"
+#include "listing.h"
+#include "config.h"
+
+#define PAGE 40
+
+static const char* k_fields[] = { "name", "modified", "created", "type", "size" };
+
+// Synthetic Downloads-like entry i; seed carries the pseudo-random state between calls
+static void synthetic_entry(WIN32_FIND_DATAW* fd, int i, UINT* seed) {
+    static const WCHAR* exts[] = { L".txt", L".exe", L".png", L".docx", L".zip", L"" };
+    *seed = *seed * 1103515245u + 12345u;
+    UINT r = *seed;
+    wsprintfW(fd->cFileName, L"Download %u (%u)%s", r % 1000000, i, exts[(r >> 5) % 6]);
+    fd->dwFileAttributes = (r >> 7) % 20 == 0 ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_NORMAL;
+    fd->nFileSizeLow = r >> 3;
+    fd->ftLastWriteTime.dwLowDateTime = r * 2654435761u;
+    fd->ftCreationTime.dwLowDateTime = r ^ 0x5bd1e995u;
+}
+
+static FolderListing* synthetic(const ListingOptions* opt, int n) {
+    FolderListing* lst = listing_begin(L"C:\\Users\\me\\Downloads", opt);
+    WIN32_FIND_DATAW fd;
+    ZeroMemory(&fd, sizeof(fd));
+    UINT seed = 1;
+    for (int i = 0; i < n; ++i) {
+        synthetic_entry(&fd, i, &seed);
+        listing_add(lst, &fd);
+    }
+    listing_finish(lst);
+    return lst;
+}
+
+// The record fill_menu_with_folder used to collect and qsort
+typedef struct LegacyFileItem {
+    WCHAR name[MAX_PATH];
+    WCHAR fullPath[MAX_PATH];
+    BOOL isDir;
+    FILETIME ftLastWrite;
+    FILETIME ftCreation;
+    unsigned long long fileSize;
+} LegacyFileItem;
+
+static int legacy_compare_size(const void* a, const void* b) {
+    const LegacyFileItem* fa = (const LegacyFileItem*)a;
+    const LegacyFileItem* fb = (const LegacyFileItem*)b;
+    if (fa->isDir != fb->isDir) return fa->isDir ? -1 : 1;
+    if (fa->fileSize != fb->fileSize) return fa->fileSize < fb->fileSize ? -1 : 1;
+    return lstrcmpiW(fa->name, fb->name);
+}
+
+static void compare_layouts(int n) {
+    WIN32_FIND_DATAW fd;
+    ZeroMemory(&fd, sizeof(fd));
+    UINT seed = 1, cap = 0, count = 0;
+    LegacyFileItem* items = NULL;
+    double t0 = test_now_ms();
+    for (int i = 0; i < n; ++i) {
+        synthetic_entry(&fd, i, &seed);
+        if (count == cap) { // LocalAlloc + memcpy doubling, as before
+            UINT ncap = cap ? cap * 2 : 64;
+            LegacyFileItem* grown = (LegacyFileItem*)LocalAlloc(LMEM_FIXED, ncap * sizeof(LegacyFileItem));
+            if (items) { memcpy(grown, items, count * sizeof(LegacyFileItem)); LocalFree(items); }
+            items = grown; cap = ncap;
+        }
+        LegacyFileItem* it = &items[count++];
+        lstrcpynW(it->name, fd.cFileName, MAX_PATH);
+        PathCombineW(it->fullPath, L"C:\\Users\\me\\Downloads", fd.cFileName);
+        it->isDir = (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+        it->ftLastWrite = fd.ftLastWriteTime;
+        it->ftCreation = fd.ftCreationTime;
+        it->fileSize = fd.nFileSizeLow;
+    }
+    double legacyBuild = test_now_ms() - t0;
+    t0 = test_now_ms();
+    qsort(items, count, sizeof(LegacyFileItem), legacy_compare_size);
+    double legacySort = test_now_ms() - t0;
+    SIZE_T legacyBytes = (SIZE_T)cap * sizeof(LegacyFileItem);
+    LocalFree(items);
+
+    ListingOptions opt = {0};
+    opt.sortField = SORT_SIZE;
+    opt.sortFoldersFirst = TRUE;
+    t0 = test_now_ms();
+    FolderListing* lst = synthetic(&opt, n);
+    double compactBuild = test_now_ms() - t0;
+    t0 = test_now_ms();
+    listing_sort_prefix(lst, lst->count);
+    double compactSort = test_now_ms() - t0;
+    SIZE_T compactBytes = listing_memory(lst);
+    listing_free(lst);
+
+    printf("\n%d entries, sorted by size   %10s %10s %12s %10s\n", n, "build ms", "sort ms", "MB", "B/entry");
+    printf("  FileItem array (%4d B)   %10.2f %10.2f %12.1f %10.1f\n", (int)sizeof(LegacyFileItem), legacyBuild, legacySort,
+           legacyBytes / 1048576.0, (double)legacyBytes / n);
+    printf("  compact listing (%3d B)   %10.2f %10.2f %12.1f %10.1f\n", (int)sizeof(ListEntry), compactBuild, compactSort,
+           compactBytes / 1048576.0, (double)compactBytes / n);
+}
+
+// Former compare_files for SORT_NAME/SORT_TYPE, over indices into a listing
+static const FolderListing* g_cmpListing;
+static int g_cmpType;
+static int legacy_compare_names(const void* a, const void* b) {
+    const WCHAR* na = listing_name(g_cmpListing, &g_cmpListing->entries[*(const int*)a]);
+    const WCHAR* nb = listing_name(g_cmpListing, &g_cmpListing->entries[*(const int*)b]);
+    int res = 0;
+    if (g_cmpType) {
+        const WCHAR* extA = wcsrchr(na, L'.');
+        const WCHAR* extB = wcsrchr(nb, L'.');
+        res = lstrcmpiW(extA ? extA : L"", extB ? extB : L"");
+    }
+    return res ? res : lstrcmpiW(na, nb);
+}
+
+static void compare_comparators(int n) {
+    printf("\n%d entries, full sort           %12s %12s\n", n, "lstrcmpiW ms", "keys ms");
+    for (int type = 0; type < 2; ++type) {
+        ListingOptions opt = {0};
+        opt.sortField = type ? SORT_TYPE : SORT_NAME;
+        FolderListing* lst = synthetic(&opt, n);
+        int* order = (int*)malloc((size_t)n * sizeof(int));
+        for (int i = 0; i < n; ++i) order[i] = i;
+        g_cmpListing = lst;
+        g_cmpType = type;
+        double t0 = test_now_ms();
+        qsort(order, (size_t)n, sizeof(int), legacy_compare_names);
+        double legacyMs = test_now_ms() - t0;
+        free(order);
+        t0 = test_now_ms();
+        listing_sort_prefix(lst, n); // includes building the keys
+        double keyMs = test_now_ms() - t0;
+        listing_free(lst);
+        printf("  %-30s %12.2f %12.2f\n", type ? "type" : "name", legacyMs, keyMs);
+    }
+}
+
+int main(int argc, char** argv) {
+    int quick = bench_quick(argc, argv);
+    static const int sizes[] = { 1000, 10000, 100000, 1000000 };
+    int sizeCount = quick ? 1 : (int)ARRAYSIZE(sizes);
+    printf("%-8s %-9s %12s %12s %12s\n", "entries", "field", "full ms", "top-k ms", "more ms");
+    for (int s = 0; s < sizeCount; ++s) {
+        for (int field = SORT_NAME; field <= SORT_SIZE; ++field) {
+            ListingOptions opt = {0};
+            opt.sortField = field;
+            opt.sortFoldersFirst = TRUE;
+            opt.sortNatural = TRUE;
+            FolderListing* lst = synthetic(&opt, sizes[s]);
+            double t0 = test_now_ms();
+            listing_sort_prefix(lst, lst->count);
+            double fullMs = test_now_ms() - t0;
+            listing_free(lst);
+
+            lst = synthetic(&opt, sizes[s]);
+            t0 = test_now_ms();
+            listing_sort_prefix(lst, PAGE);
+            double topMs = test_now_ms() - t0;
+            t0 = test_now_ms();
+            listing_sort_prefix(lst, PAGE * 2); // next page reuses the listing and its sort keys
+            double moreMs = test_now_ms() - t0;
+            listing_free(lst);
+            printf("%-8d %-9s %12.2f %12.2f %12.2f\n", sizes[s], k_fields[field], fullMs, topMs, moreMs);
+        }
+    }
+    compare_layouts(quick ? 1000 : 100000);
+    compare_comparators(quick ? 1000 : 100000);
+    return 0;
+}
@@ -0,0 +1,348 @@
+// Headless menu build over the portable model layer: generated INIs and folder trees are parsed,
+// compiled and emitted into a recording sink, with folder popups filled through the folder cache
+// the way hovering would (two levels deep, first page only). Reports time and heap allocations
+// per phase and configuration. Linked with --wrap=malloc/calloc, which LocalAlloc sits on.
+//
+// As a regression gate: the recorded menu's shape hash must match, and allocations may not grow
+// more than 10% over the baseline file given with --baseline (written with --write-baseline).
+#include "test.h"
+#include "config.h"
+#include "ini_win32.h"
+#include "menumodel.h"
+#include "listing.h"
+#include "dircache.h"
+#include <sys/stat.h>
+
+static long g_allocs = 0;
+void* __real_malloc(size_t n);
+void* __real_calloc(size_t n, size_t size);
+void* __wrap_malloc(size_t n) { g_allocs++; return __real_malloc(n); }
+void* __wrap_calloc(size_t n, size_t size) { g_allocs++; return __real_calloc(n, size); }
+
+#define HOVER_DEPTH 2
+
+typedef struct BenchConfig {
+    const char* name;
+    int items;        // menu items, up to the model's 64
+    int folders;      // folder submenus among them
+    int files;        // files per folder
+    int subfolders;   // subfolders per folder, each with files / 10 files
+    int maxItems;     // folder page size
+} BenchConfig;
+
+static const BenchConfig k_configs[] = {
+    { "small",   8, 1,   20,  2, 40 },
+    { "medium", 30, 3,  200, 10, 40 },
+    { "large",  60, 6, 2000, 20, 100 },
+};
+
+// ---- Recording sink ----
+
+typedef enum { REC_ITEM, REC_POPUP, REC_END, REC_GENERATED, REC_ENTRY, REC_MORE } RecordKind;
+
+typedef struct Record {
+    RecordKind kind;
+    int depth;
+    UINT id;
+    DWORD nodeKind;
+} Record;
+
+typedef struct Recorder {
+    Record* recs;
+    int count, cap;
+    int depth;
+    DWORD shape;        // FNV-1a over kinds, depths, ids and labels
+    const Config* cfg;
+    UINT nextFolderId;
+    FolderListing* session; // listings the cache did not take, freed when the popup closes
+} Recorder;
+
+static void record(Recorder* r, RecordKind kind, UINT id, DWORD nodeKind, const WCHAR* label) {
+    if (r->count == r->cap) {
+        r->cap = r->cap ? r->cap * 2 : 256;
+        Record* grown = (Record*)__real_malloc(sizeof(Record) * (size_t)r->cap);
+        if (r->recs) { memcpy(grown, r->recs, sizeof(Record) * (size_t)r->count); free(r->recs); }
+        r->recs = grown;
+    }
+    r->recs[r->count++] = (Record){ kind, r->depth, id, nodeKind };
+    DWORD h = r->shape;
+    DWORD v[4] = { kind, (DWORD)r->depth, id, nodeKind };
+    for (int i = 0; i < 4; ++i) { h ^= v[i]; h *= 16777619u; }
+    for (const WCHAR* p = label; p && *p; ++p) { h ^= *p; h *= 16777619u; }
+    r->shape = h;
+}
+
+static void listing_opts(const Config* cfg, ListingOptions* opt) {
+    opt->showHidden = cfg->showHidden;
+    opt->dotMode = cfg->dotMode;
+    opt->sortField = cfg->sortField;
+    opt->sortDescending = cfg->sortDescending;
+    opt->sortFoldersFirst = cfg->sortFoldersFirst;
+    opt->sortNatural = cfg->sortNatural;
+}
+
+// The portable part of menu.c's fill_menu_with_folder: cache lookup, first page, subfolder popups
+static void record_folder(Recorder* r, const WCHAR* path, int depth) {
+    ListingOptions opt;
+    listing_opts(r->cfg, &opt);
+    FolderListing* lst = dircache_lookup(path, &opt);
+    if (!lst && (lst = listing_enumerate(path, &opt)) != NULL && !dircache_insert(lst)) {
+        lst->next = r->session;
+        r->session = lst;
+    }
+    if (!lst || lst->count == 0) { record(r, REC_ITEM, 0, MN_HEADER, L"(Empty)"); return; }
+    int end = r->cfg->maxItems > 0 && r->cfg->maxItems < lst->count ? r->cfg->maxItems : lst->count;
+    listing_sort_prefix(lst, end);
+    for (int i = 0; i < end; ++i) {
+        const ListEntry* e = listing_at(lst, i);
+        WCHAR full[MAX_PATH];
+        listing_full_path(lst, e, full, ARRAYSIZE(full));
+        const WCHAR* name = PathFindFileNameW(full);
+        if ((e->flags & LE_DIR) && depth < r->cfg->folderMaxDepth) {
+            record(r, REC_POPUP, 0, MN_FOLDER_POPUP, name);
+            if (depth < HOVER_DEPTH) {
+                r->depth++;
+                record_folder(r, full, depth + 1);
+                r->depth--;
+            }
+        } else {
+            record(r, REC_ENTRY, r->nextFolderId++, 0, name);
+        }
+    }
+    if (end < lst->count) record(r, REC_MORE, 0, 0, L"Show more items...");
+}
+
+static void rec_item(void* ctx, const MenuNode* n, UINT id) {
+    record((Recorder*)ctx, REC_ITEM, id, n->kind, n->label);
+}
+
+static void rec_popup_begin(void* ctx, const MenuNode* n) {
+    Recorder* r = (Recorder*)ctx;
+    record(r, REC_POPUP, 0, n->kind, n->label);
+    r->depth++;
+}
+
+static void rec_popup_end(void* ctx, const MenuNode* begin) {
+    Recorder* r = (Recorder*)ctx;
+    r->depth--;
+    record(r, REC_END, 0, begin->kind, NULL);
+}
+
+// This PC, Home, Recent and Force Quit need the shell; they are recorded as placeholders
+static void rec_generated(void* ctx, const MenuNode* n) {
+    Recorder* r = (Recorder*)ctx;
+    record(r, REC_GENERATED, 0, n->kind, n->label);
+    if (n->kind == MN_FOLDER_POPUP || n->kind == MN_FOLDER_INLINE) {
+        r->depth++;
+        record_folder(r, n->path, 1);
+        r->depth--;
+    }
+}
+
+static const MenuSink k_sink = { rec_item, rec_popup_begin, rec_popup_end, rec_generated };
+
+// One popup: emit the model and hover the folder popups, then close the session as menu.c does
+static void popup(Recorder* r, const MenuModel* model, const Config* cfg) {
+    r->count = 0;
+    r->depth = 0;
+    r->shape = 2166136261u;
+    r->cfg = cfg;
+    r->nextFolderId = 0x4000;
+    UINT id = 0x1000;
+    menumodel_emit(model, &k_sink, r, &id, &r->nextFolderId);
+    while (r->session) {
+        FolderListing* next = r->session->next;
+        listing_free(r->session);
+        r->session = next;
+    }
+    dircache_end_session();
+}
+
+// ---- Generated inputs ----
+
+static void make_tree(const char* dir, int files, int subfolders) {
+    char path[700];
+    mkdir(dir, 0755);
+    for (int i = 0; i < files; ++i) {
+        snprintf(path, sizeof(path), "%s/File %04d.txt", dir, (i * 7919) % 10000);
+        test_write_file(path, "x", 1);
+    }
+    for (int d = 0; d < subfolders; ++d) {
+        snprintf(path, sizeof(path), "%s/Folder %02d", dir, d);
+        mkdir(path, 0755);
+        for (int i = 0; i < files / 10; ++i) {
+            char file[800];
+            snprintf(file, sizeof(file), "%s/Nested %03d.doc", path, i);
+            test_write_file(file, "x", 1);
+        }
+    }
+}
+
+// Menu of commands, separators and Power/Force Quit/Recent items around the folder submenus;
+// the first folder is also shown inline
+static void make_ini(const char* iniPath, const char* root, const BenchConfig* bc) {
+    size_t cap = 8192 + (size_t)bc->items * 256;
+    char* text = (char*)__real_malloc(cap);
+    size_t n = (size_t)snprintf(text, cap, "[General]\r\nMaxItems=%d\r\nShowIcons=true\r\n[Menu]\r\n", bc->maxItems);
+    int folder = 0;
+    for (int i = 1; i <= bc->items; ++i) {
+        if (folder < bc->folders && i % (bc->items / bc->folders) == 1) {
+            n += (size_t)snprintf(text + n, cap - n, "Item%d=Folder %d|FOLDER_SUBMENU|%s/folder%d\r\n", i, folder, root, folder);
+            folder++;
+        } else if (i == 2) {
+            n += (size_t)snprintf(text + n, cap - n, "Item%d=Inline|FOLDER|%s/folder0|inline\r\n", i, root);
+        } else if (i % 10 == 0) {
+            n += (size_t)snprintf(text + n, cap - n, "Item%d=---\r\n", i);
+        } else if (i % 10 == 3) {
+            n += (size_t)snprintf(text + n, cap - n, "Item%d=Power|POWER_MENU\r\n", i);
+        } else if (i % 10 == 5) {
+            n += (size_t)snprintf(text + n, cap - n, "Item%d=Force Quit|TASKKILL||8,true,Calculator,Settings\r\n", i);
+        } else if (i % 10 == 7) {
+            n += (size_t)snprintf(text + n, cap - n, "Item%d=Recent|RECENT\r\n", i);
+        } else {
+            n += (size_t)snprintf(text + n, cap - n, "Item%d=Tool %d|FILE|C:\\Tools\\tool%d.exe|--flag %d\r\n", i, i, i, i);
+        }
+    }
+    test_write_file(iniPath, text, n);
+    free(text);
+}
+
+// ---- Measurement ----
+
+typedef struct Phase { const char* name; double ms; double allocs; } Phase;
+
+enum { PH_PARSE, PH_COMPILE_COLD, PH_COMPILE_WARM, PH_POPUP_COLD, PH_POPUP_WARM, PH_COUNT };
+static const char* k_phaseNames[PH_COUNT] = { "parse", "compile-cold", "compile-warm", "popup-cold", "popup-warm" };
+
+typedef struct Result {
+    Phase phases[PH_COUNT];
+    int records;
+    DWORD shape;
+} Result;
+
+static void run_config(const BenchConfig* bc, const char* root, int reps, Result* res) {
+    char iniPath[700];
+    snprintf(iniPath, sizeof(iniPath), "%s/menu.ini", root);
+    make_ini(iniPath, root, bc);
+    for (int f = 0; f < bc->folders; ++f) {
+        char dir[700];
+        snprintf(dir, sizeof(dir), "%s/folder%d", root, f);
+        make_tree(dir, bc->files, bc->subfolders);
+    }
+    WCHAR wini[700];
+    shim_from_utf8(iniPath, wini, ARRAYSIZE(wini));
+    Config* cfg = (Config*)__real_calloc(1, sizeof(Config));
+    MenuModel* model = (MenuModel*)__real_calloc(1, sizeof(MenuModel));
+    Recorder rec = {0};
+    for (int p = 0; p < PH_COUNT; ++p) res->phases[p].name = k_phaseNames[p];
+
+    for (int i = 0; i < reps; ++i) {
+        long a0 = g_allocs;
+        double t0 = test_now_ms();
+        IniFile* ini = ini_open(wini);
+        config_parse(cfg, ini);
+        ini_free(ini);
+        res->phases[PH_PARSE].ms += test_now_ms() - t0;
+        res->phases[PH_PARSE].allocs += g_allocs - a0;
+
+        menumodel_free(model);
+        a0 = g_allocs; t0 = test_now_ms();
+        menumodel_update(model, cfg, FALSE);
+        res->phases[PH_COMPILE_COLD].ms += test_now_ms() - t0;
+        res->phases[PH_COMPILE_COLD].allocs += g_allocs - a0;
+
+        a0 = g_allocs; t0 = test_now_ms();
+        menumodel_update(model, cfg, FALSE);
+        res->phases[PH_COMPILE_WARM].ms += test_now_ms() - t0;
+        res->phases[PH_COMPILE_WARM].allocs += g_allocs - a0;
+
+        dircache_flush();
+        a0 = g_allocs; t0 = test_now_ms();
+        popup(&rec, model, cfg);
+        res->phases[PH_POPUP_COLD].ms += test_now_ms() - t0;
+        res->phases[PH_POPUP_COLD].allocs += g_allocs - a0;
+        DWORD coldShape = rec.shape;
+
+        a0 = g_allocs; t0 = test_now_ms();
+        popup(&rec, model, cfg);
+        res->phases[PH_POPUP_WARM].ms += test_now_ms() - t0;
+        res->phases[PH_POPUP_WARM].allocs += g_allocs - a0;
+        if (rec.shape != coldShape) res->shape = 0; // cached and fresh listings must render the same
+        else res->shape = rec.shape;
+        res->records = rec.count;
+    }
+    for (int p = 0; p < PH_COUNT; ++p) { res->phases[p].ms /= reps; res->phases[p].allocs /= reps; }
+    dircache_flush();
+    menumodel_free(model);
+    free(model);
+    free(cfg);
+    free(rec.recs);
+}
+
+// Baseline lines: "<config> shape <hash> records <n>" and "<config> <phase> <allocs>"
+static int check_baseline(const char* path, const BenchConfig* bc, const Result* res) {
+    FILE* f = fopen(path, "r");
+    if (!f) { fprintf(stderr, "cannot read baseline %s\n", path); return 1; }
+    char line[256], name[64], what[64];
+    int failures = 0;
+    while (fgets(line, sizeof(line), f)) {
+        double value = 0, extra = 0;
+        unsigned shape = 0;
+        if (sscanf(line, "%63s shape %x records %lf", name, &shape, &extra) == 3) {
+            if (strcmp(name, bc->name)) continue;
+            if (shape != res->shape || (int)extra != res->records) {
+                fprintf(stderr, "%s: menu shape %08x/%d records, baseline %08x/%d\n", bc->name,
+                        (unsigned)res->shape, res->records, shape, (int)extra);
+                failures++;
+            }
+        } else if (sscanf(line, "%63s %63s %lf", name, what, &value) == 3 && !strcmp(name, bc->name)) {
+            for (int p = 0; p < PH_COUNT; ++p) {
+                if (strcmp(what, res->phases[p].name)) continue;
+                if (res->phases[p].allocs > value * 1.10 + 2) {
+                    fprintf(stderr, "%s %s: %.0f allocations, baseline %.0f\n", bc->name, what, res->phases[p].allocs, value);
+                    failures++;
+                }
+            }
+        }
+    }
+    fclose(f);
+    return failures;
+}
+
+int main(int argc, char** argv) {
+    int quick = bench_quick(argc, argv);
+    const char* baseline = NULL;
+    const char* writeBaseline = NULL;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (!strcmp(argv[i], "--baseline")) baseline = argv[++i];
+        else if (!strcmp(argv[i], "--write-baseline")) writeBaseline = argv[++i];
+    }
+    const char* tmp = test_temp_dir("bench_menu");
+    if (!tmp) return 1;
+    char base[512];
+    snprintf(base, sizeof(base), "%s", tmp);
+    FILE* out = writeBaseline ? fopen(writeBaseline, "w") : NULL;
+    int failures = 0;
+    for (int c = 0; c < (int)ARRAYSIZE(k_configs); ++c) {
+        const BenchConfig* bc = &k_configs[c];
+        char root[600];
+        snprintf(root, sizeof(root), "%s/%s", base, bc->name);
+        mkdir(root, 0755);
+        Result res = {0};
+        run_config(bc, root, quick ? 1 : 20, &res);
+        printf("%-7s items=%-3d folders=%d x %d files: %d records, shape %08x\n", bc->name, bc->items, bc->folders,
+               bc->files, res.records, (unsigned)res.shape);
+        for (int p = 0; p < PH_COUNT; ++p) {
+            printf("  %-13s %10.3f ms %10.1f allocs\n", res.phases[p].name, res.phases[p].ms, res.phases[p].allocs);
+        }
+        if (!res.shape) { fprintf(stderr, "%s: cached popup differs from the cold one\n", bc->name); failures++; }
+        if (out) {
+            fprintf(out, "%s shape %08x records %d\n", bc->name, (unsigned)res.shape, res.records);
+            for (int p = 0; p < PH_COUNT; ++p) fprintf(out, "%s %s %.0f\n", bc->name, res.phases[p].name, res.phases[p].allocs);
+        }
+        if (baseline) failures += check_baseline(baseline, bc, &res);
+    }
+    if (out) fclose(out);
+    test_remove_dir(base);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,70 @@
+// Force Quit filtering at 1k window records: 32 excluded titles and label dedupe (about 300
+// distinct applications), strset against the linear lstrcmpiW scans it replaced. The shim's
+// lstrcmpiW is an ASCII-only loop, so the linear numbers flatter the old code.
+#include "test.h"
+#include "strset.h"
+
+#define RECORDS 1000
+#define EXCLUDES 32
+
+static WCHAR g_titles[RECORDS][64], g_labels[RECORDS][64], g_excludes[EXCLUDES][64];
+
+static int run_linear(void) {
+    static WCHAR added[RECORDS][64];
+    int addedCount = 0, listed = 0;
+    for (int r = 0; r < RECORDS; ++r) {
+        BOOL skip = FALSE;
+        for (int i = 0; i < EXCLUDES && !skip; ++i) skip = !lstrcmpiW(g_titles[r], g_excludes[i]);
+        for (int i = 0; i < addedCount && !skip; ++i) skip = !lstrcmpiW(added[i], g_labels[r]);
+        if (skip) continue;
+        lstrcpynW(added[addedCount++], g_labels[r], 64);
+        listed++;
+    }
+    return listed;
+}
+
+static int run_strset(Arena* arena) {
+    StringSet excludes, added;
+    strset_init(&excludes, arena);
+    strset_init(&added, arena);
+    for (int i = 0; i < EXCLUDES; ++i) strset_add(&excludes, g_excludes[i]);
+    int listed = 0;
+    for (int r = 0; r < RECORDS; ++r) {
+        if (strset_contains(&excludes, g_titles[r])) continue;
+        if (strset_add(&added, g_labels[r])) listed++;
+    }
+    return listed;
+}
+
+int main(int argc, char** argv) {
+    int quick = bench_quick(argc, argv);
+    for (int r = 0; r < RECORDS; ++r) {
+        wsprintfW(g_titles[r], L"Document %d - Some Application Window", r);
+        wsprintfW(g_labels[r], (r & 1) ? L"APPLICATION NAME %d" : L"Application Name %d", (r * 7) % 300);
+    }
+    for (int i = 0; i < EXCLUDES; ++i) wsprintfW(g_excludes[i], L"document %d - some application window", i * 31);
+
+    int reps = quick ? 1 : 2000;
+    int linear = 0, hashed = 0;
+    double t0 = test_now_ms();
+    for (int i = 0; i < reps; ++i) linear = run_linear();
+    double linearUs = (test_now_ms() - t0) * 1000.0 / reps;
+
+    Arena arena = {0};
+    ShimAllocStats a0, a1;
+    shim_alloc_stats(&a0);
+    t0 = test_now_ms();
+    for (int i = 0; i < reps; ++i) {
+        hashed = run_strset(&arena);
+        arena_reset(&arena);
+    }
+    double setUs = (test_now_ms() - t0) * 1000.0 / reps;
+    shim_alloc_stats(&a1);
+    arena_free(&arena);
+
+    printf("records=%d excludes=%d listed=%d\n", RECORDS, EXCLUDES, hashed);
+    printf("  linear scans  %9.2f us\n", linearUs);
+    printf("  strset        %9.2f us  %.2f heap allocs/build\n", setUs, (double)(a1.allocs - a0.allocs) / reps);
+    if (linear != hashed) { fprintf(stderr, "results differ: %d vs %d\n", linear, hashed); return 1; }
+    return 0;
+}
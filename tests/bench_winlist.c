@@ -0,0 +1,79 @@
+// Force Quit window model under a synthetic shell-hook trace at 50, 200 and 1000 windows:
+// cost per event, cost of the per-popup snapshot, and the per-popup rebuild it replaced (the
+// list re-seeded from scratch; on Windows each seeded window also costs several window reads,
+// which the model only pays when a window appears)
+#include "test.h"
+#include "winmodel.h"
+#include "wintrace.h"
+
+static BOOL always_alive(HWND hwnd) {
+    (void)hwnd;
+    return TRUE;
+}
+
+// Steady-state mix: mostly activations and retitles, some cloak flips, windows opening and closing
+static int make_trace(WinTraceEvent* out, int n, int windows) {
+    unsigned seed = 42;
+    for (int i = 0; i < n; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        unsigned r = seed >> 8, pick = r % 100;
+        ULONG_PTR hwnd = 1 + (r >> 7) % (unsigned)windows;
+        WinTraceOp op = pick < 55 ? WT_ACTIVATE : pick < 80 ? WT_RENAME : pick < 88 ? WT_CLOAK : pick < 94 ? WT_DESTROY : WT_CREATE;
+        out[i].op = op;
+        out[i].hwnd = hwnd;
+        out[i].title = op == WT_RENAME ? ((r & 1) ? "Document - Editor" : "Document* - Editor") : NULL;
+        out[i].cloaked = (r >> 3) & 1;
+    }
+    return n;
+}
+
+int main(int argc, char** argv) {
+    int quick = bench_quick(argc, argv);
+    int events = quick ? 20000 : 2000000;
+    int popups = quick ? 10 : 2000;
+    static const int sizes[] = { 50, 200, 1000 };
+    WinTraceEvent* trace = (WinTraceEvent*)malloc((size_t)events * sizeof(WinTraceEvent));
+    int failed = 0;
+    for (int s = 0; s < (int)ARRAYSIZE(sizes); ++s) {
+        int windows = sizes[s];
+        make_trace(trace, events, windows);
+        WinModel m = {0};
+        for (int h = 1; h <= windows; ++h) {
+            WinTraceEvent seed = { WT_SEED, (ULONG_PTR)h, NULL, 0 };
+            wintrace_apply(&m, &seed);
+        }
+        double t0 = test_now_ms();
+        wintrace_replay(&m, trace, events);
+        double perEventNs = (test_now_ms() - t0) * 1e6 / events;
+
+        t0 = test_now_ms();
+        int listed = 0;
+        for (int p = 0; p < popups; ++p) {
+            int n = winmodel_prune(&m, always_alive);
+            WinListEntry* copy = (WinListEntry*)LocalAlloc(LMEM_FIXED, (n ? n : 1) * sizeof(WinListEntry));
+            memcpy(copy, m.wins, n * sizeof(WinListEntry));
+            listed += n;
+            LocalFree(copy);
+        }
+        double snapshotUs = (test_now_ms() - t0) * 1000.0 / popups;
+
+        WinModel rebuilt = {0};
+        t0 = test_now_ms();
+        for (int p = 0; p < popups; ++p) {
+            winmodel_clear(&rebuilt);
+            for (int h = 1; h <= windows; ++h) {
+                WinTraceEvent seed = { WT_SEED, (ULONG_PTR)h, NULL, 0 };
+                wintrace_apply(&rebuilt, &seed);
+            }
+        }
+        double rebuildUs = (test_now_ms() - t0) * 1000.0 / popups;
+        printf("windows=%-5d tracked=%-5d %8.1f ns/event  snapshot %8.2f us/popup  rebuild %8.2f us/popup\n",
+               windows, m.count, perEventNs, snapshotUs, rebuildUs);
+        if (m.count <= 0 || m.count > windows || listed != m.count * popups) failed = 1;
+        winmodel_free(&rebuilt);
+        winmodel_free(&m);
+    }
+    free(trace);
+    if (failed) fprintf(stderr, "model size out of range\n");
+    return failed;
+}
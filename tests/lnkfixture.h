@@ -0,0 +1,98 @@
+#pragma once
+// Writer for Shell Link (MS-SHLLINK) test files: the header plus the structures lnk.c reads
+// (ID list, LinkInfo with local or network target, NAME and RELATIVE_PATH strings).
+// Strings are ASCII; Unicode variants are widened byte by byte.
+#include <windows.h>
+#include <string.h>
+
+typedef struct LnkFixture {
+    const char* localBasePath;  // LinkInfo LocalBasePath, or NULL
+    const char* netName;        // LinkInfo CommonNetworkRelativeLink NetName, or NULL
+    const char* commonSuffix;   // LinkInfo CommonPathSuffix, or NULL
+    BOOL unicodeLinkInfo;       // LinkInfo header 0x24 with Unicode copies of the strings
+    const char* name;           // StringData NAME_STRING (Unicode), or NULL
+    const char* relativePath;   // StringData RELATIVE_PATH (Unicode), or NULL
+    size_t idListSize;          // bytes of opaque LinkTargetIDList (0 = none)
+    DWORD attributes;           // target attributes stored in the header
+} LnkFixture;
+
+static inline void lnkfx_put16(BYTE* p, size_t off, DWORD v) { p[off] = (BYTE)v; p[off + 1] = (BYTE)(v >> 8); }
+static inline void lnkfx_put32(BYTE* p, size_t off, DWORD v) { lnkfx_put16(p, off, v & 0xFFFF); lnkfx_put16(p, off + 2, v >> 16); }
+
+static inline size_t lnkfx_sz(BYTE* out, size_t pos, const char* s, BOOL unicode) {
+    size_t n = strlen(s) + 1;
+    for (size_t i = 0; i < n; ++i) {
+        if (unicode) { out[pos + 2 * i] = (BYTE)s[i]; out[pos + 2 * i + 1] = 0; }
+        else out[pos + i] = (BYTE)s[i];
+    }
+    return pos + (unicode ? 2 * n : n);
+}
+
+// Builds the link into out (at least 4 KB); returns its size
+static inline size_t lnk_fixture_build(const LnkFixture* f, BYTE* out) {
+    static const BYTE clsid[16] = { 0x01,0x14,0x02,0x00, 0x00,0x00, 0x00,0x00, 0xC0,0x00,0x00,0x00,0x00,0x00,0x00,0x46 };
+    BOOL hasInfo = f->localBasePath || f->netName;
+    DWORD flags = 0x80; // IsUnicode
+    if (f->idListSize) flags |= 0x01;
+    if (hasInfo) flags |= 0x02;
+    if (f->name) flags |= 0x04;
+    if (f->relativePath) flags |= 0x08;
+    memset(out, 0, 0x4C);
+    lnkfx_put32(out, 0, 0x4C);
+    memcpy(out + 4, clsid, sizeof(clsid));
+    lnkfx_put32(out, 20, flags);
+    lnkfx_put32(out, 24, f->attributes);
+    size_t pos = 0x4C;
+    if (f->idListSize) {
+        lnkfx_put16(out, pos, (DWORD)f->idListSize);
+        memset(out + pos + 2, 0x5A, f->idListSize);
+        pos += 2 + f->idListSize;
+    }
+    if (hasInfo) {
+        size_t info = pos, hdr = f->unicodeLinkInfo ? 0x24 : 0x1C, p = info + hdr;
+        memset(out + info, 0, hdr);
+        lnkfx_put32(out, info + 4, (DWORD)hdr);
+        const char* suffix = f->commonSuffix ? f->commonSuffix : "";
+        if (f->localBasePath) {
+            lnkfx_put32(out, info + 8, 1); // VolumeIDAndLocalBasePath
+            lnkfx_put32(out, info + 12, (DWORD)(p - info));
+            memset(out + p, 0, 0x11); // VolumeID: size, drive type, serial, label offset, empty label
+            lnkfx_put32(out, p, 0x11);
+            lnkfx_put32(out, p + 4, 3);
+            lnkfx_put32(out, p + 12, 0x10);
+            p += 0x11;
+            lnkfx_put32(out, info + 16, (DWORD)(p - info));
+            p = lnkfx_sz(out, p, f->localBasePath, FALSE);
+        } else {
+            lnkfx_put32(out, info + 8, 2); // CommonNetworkRelativeLink
+            lnkfx_put32(out, info + 20, (DWORD)(p - info));
+            size_t cn = p;
+            memset(out + cn, 0, 0x14);
+            lnkfx_put32(out, cn + 8, 0x14);
+            p = lnkfx_sz(out, cn + 0x14, f->netName, FALSE);
+            lnkfx_put32(out, cn, (DWORD)(p - cn));
+        }
+        lnkfx_put32(out, info + 24, (DWORD)(p - info));
+        p = lnkfx_sz(out, p, suffix, FALSE);
+        if (f->unicodeLinkInfo) {
+            if (f->localBasePath) {
+                lnkfx_put32(out, info + 28, (DWORD)(p - info));
+                p = lnkfx_sz(out, p, f->localBasePath, TRUE);
+            }
+            lnkfx_put32(out, info + 32, (DWORD)(p - info));
+            p = lnkfx_sz(out, p, suffix, TRUE);
+        }
+        lnkfx_put32(out, info, (DWORD)(p - info));
+        pos = p;
+    }
+    const char* strings[2] = { f->name, f->relativePath };
+    for (int s = 0; s < 2; ++s) {
+        if (!strings[s]) continue;
+        size_t n = strlen(strings[s]);
+        lnkfx_put16(out, pos, (DWORD)n);
+        for (size_t i = 0; i < n; ++i) { out[pos + 2 + 2 * i] = (BYTE)strings[s][i]; out[pos + 3 + 2 * i] = 0; }
+        pos += 2 + 2 * n;
+    }
+    lnkfx_put32(out, pos, 0); // TerminalBlock
+    return pos + 4;
+}
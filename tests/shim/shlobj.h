@@ -0,0 +1,3 @@
+#pragma once
+// Shell folder helpers used by the portable modules are declared in the host windows.h shim
+#include <windows.h>
@@ -0,0 +1,3 @@
+#pragma once
+// Path helpers are declared in the host windows.h shim
+#include <windows.h>
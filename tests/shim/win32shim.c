@@ -0,0 +1,1024 @@
+// Host implementations of the Win32 calls made by the portable modules. Only what the sources
+// use is implemented, with the Windows semantics they rely on; see windows.h in this folder.
+#define _GNU_SOURCE
+#include <windows.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// ---- Memory ----
+
+typedef struct AllocHeader {
+    SIZE_T size;
+    SIZE_T pad; // keeps the payload 16-byte aligned
+} AllocHeader;
+
+static ShimAllocStats g_alloc;
+static pthread_mutex_t g_allocLock = PTHREAD_MUTEX_INITIALIZER;
+
+HLOCAL LocalAlloc(UINT flags, SIZE_T bytes) {
+    AllocHeader* h = (AllocHeader*)((flags & LMEM_ZEROINIT) ? calloc(1, sizeof(AllocHeader) + bytes)
+                                                            : malloc(sizeof(AllocHeader) + bytes));
+    if (!h) return NULL;
+    h->size = bytes;
+    pthread_mutex_lock(&g_allocLock);
+    g_alloc.allocs++;
+    g_alloc.liveBytes += bytes;
+    if (g_alloc.liveBytes > g_alloc.peakBytes) g_alloc.peakBytes = g_alloc.liveBytes;
+    pthread_mutex_unlock(&g_allocLock);
+    return h + 1;
+}
+
+HLOCAL LocalFree(HLOCAL mem) {
+    if (!mem) return NULL;
+    AllocHeader* h = (AllocHeader*)mem - 1;
+    pthread_mutex_lock(&g_allocLock);
+    g_alloc.frees++;
+    g_alloc.liveBytes -= h->size;
+    pthread_mutex_unlock(&g_allocLock);
+    free(h);
+    return NULL;
+}
+
+void shim_alloc_stats(ShimAllocStats* out) {
+    pthread_mutex_lock(&g_allocLock);
+    *out = g_alloc;
+    pthread_mutex_unlock(&g_allocLock);
+}
+
+// ---- Strings ----
+
+static WCHAR fold(WCHAR c) {
+    if (c < 0x80) return (c >= L'A' && c <= L'Z') ? (WCHAR)(c + 32) : c;
+    if ((c >= 0xC0 && c <= 0xDE && c != 0xD7) || (c >= 0x391 && c <= 0x3AB) || (c >= 0x410 && c <= 0x42F)) return (WCHAR)(c + 32);
+    if (c >= 0x400 && c <= 0x40F) return (WCHAR)(c + 80);
+    if (c >= 0x100 && c <= 0x17F) {
+        // Pairs are even/odd, except 0x139-0x148 and 0x179-0x17E which are odd/even
+        if ((c >= 0x139 && c <= 0x148) || (c >= 0x179 && c <= 0x17E)) return (c & 1) ? (WCHAR)(c + 1) : c;
+        if (c == 0x178) return 0xFF;
+        if (c == 0x130 || c == 0x131 || c == 0x138 || c == 0x149 || c == 0x17F) return c;
+        return (c & 1) ? c : (WCHAR)(c + 1);
+    }
+    return c;
+}
+
+size_t shim_wcslen(const WCHAR* s) {
+    const WCHAR* p = s;
+    while (*p) ++p;
+    return (size_t)(p - s);
+}
+
+WCHAR* shim_wcschr(const WCHAR* s, WCHAR c) {
+    for (;; ++s) {
+        if (*s == c) return (WCHAR*)s;
+        if (!*s) return NULL;
+    }
+}
+
+WCHAR* shim_wcsrchr(const WCHAR* s, WCHAR c) {
+    const WCHAR* last = NULL;
+    for (;; ++s) {
+        if (*s == c) last = s;
+        if (!*s) return (WCHAR*)last;
+    }
+}
+
+WCHAR* shim_wcsstr(const WCHAR* s, const WCHAR* sub) {
+    size_t n = shim_wcslen(sub);
+    for (; *s; ++s) {
+        if (shim_wcsncmp(s, sub, n) == 0) return (WCHAR*)s;
+    }
+    return n == 0 ? (WCHAR*)s : NULL;
+}
+
+int shim_wcscmp(const WCHAR* a, const WCHAR* b) {
+    while (*a && *a == *b) { ++a; ++b; }
+    return (int)*a - (int)*b;
+}
+
+int shim_wcsncmp(const WCHAR* a, const WCHAR* b, size_t n) {
+    for (; n; --n, ++a, ++b) {
+        if (*a != *b) return (int)*a - (int)*b;
+        if (!*a) return 0;
+    }
+    return 0;
+}
+
+int shim_wcsicmp(const WCHAR* a, const WCHAR* b) {
+    return shim_wcsnicmp(a, b, (size_t)-1);
+}
+
+int shim_wcsnicmp(const WCHAR* a, const WCHAR* b, size_t n) {
+    for (; n; --n, ++a, ++b) {
+        WCHAR x = fold(*a), y = fold(*b);
+        if (x != y) return (int)x - (int)y;
+        if (!x) return 0;
+    }
+    return 0;
+}
+
+int shim_wtoi(const WCHAR* s) {
+    while (*s == L' ' || *s == L'\t') ++s;
+    int neg = 0;
+    if (*s == L'-' || *s == L'+') neg = (*s++ == L'-');
+    int n = 0;
+    for (; *s >= L'0' && *s <= L'9'; ++s) n = n * 10 + (*s - L'0');
+    return neg ? -n : n;
+}
+
+int lstrlenW(LPCWSTR s) { return s ? (int)shim_wcslen(s) : 0; }
+int lstrlenA(LPCSTR s) { return s ? (int)strlen(s) : 0; }
+
+LPWSTR lstrcpyW(LPWSTR d, LPCWSTR s) {
+    memcpy(d, s, (shim_wcslen(s) + 1) * sizeof(WCHAR));
+    return d;
+}
+
+LPWSTR lstrcpynW(LPWSTR d, LPCWSTR s, int cch) {
+    if (cch <= 0) return d;
+    int i = 0;
+    for (; i < cch - 1 && s[i]; ++i) d[i] = s[i];
+    d[i] = 0;
+    return d;
+}
+
+LPWSTR lstrcatW(LPWSTR d, LPCWSTR s) {
+    lstrcpyW(d + shim_wcslen(d), s);
+    return d;
+}
+
+int lstrcmpW(LPCWSTR a, LPCWSTR b) {
+    int r = shim_wcscmp(a, b);
+    return r < 0 ? -1 : r > 0;
+}
+
+int lstrcmpiW(LPCWSTR a, LPCWSTR b) {
+    int r = shim_wcsicmp(a, b);
+    return r < 0 ? -1 : r > 0;
+}
+
+LPWSTR CharLowerW(LPWSTR s) {
+    if (((ULONG_PTR)s >> 16) == 0) return (LPWSTR)(ULONG_PTR)fold((WCHAR)(ULONG_PTR)s);
+    for (WCHAR* p = s; *p; ++p) *p = fold(*p);
+    return s;
+}
+
+// %[-][0][width][l]{d,u,x,X,s,c,%}; %s takes a wide string as in wsprintfW
+int wsprintfW(LPWSTR out, LPCWSTR fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int n = 0;
+    for (const WCHAR* f = fmt; *f; ++f) {
+        if (*f != L'%') { out[n++] = *f; continue; }
+        ++f;
+        if (*f == L'%') { out[n++] = L'%'; continue; }
+        BOOL left = FALSE, zero = FALSE;
+        int width = 0;
+        if (*f == L'-') { left = TRUE; ++f; }
+        if (*f == L'0') { zero = TRUE; ++f; }
+        while (*f >= L'0' && *f <= L'9') width = width * 10 + (*f++ - L'0');
+        if (*f == L'l') ++f;
+        WCHAR tmp[32];
+        const WCHAR* s = tmp;
+        int len = 0;
+        if (*f == L's') {
+            s = va_arg(ap, const WCHAR*);
+            if (!s) s = L"(null)";
+            len = (int)shim_wcslen(s);
+        } else if (*f == L'c') {
+            tmp[0] = (WCHAR)va_arg(ap, int);
+            len = 1;
+        } else {
+            char num[32];
+            if (*f == L'd' || *f == L'i') snprintf(num, sizeof(num), "%d", va_arg(ap, int));
+            else if (*f == L'u') snprintf(num, sizeof(num), "%u", va_arg(ap, unsigned));
+            else if (*f == L'x') snprintf(num, sizeof(num), "%x", va_arg(ap, unsigned));
+            else if (*f == L'X') snprintf(num, sizeof(num), "%X", va_arg(ap, unsigned));
+            else num[0] = 0;
+            for (len = 0; num[len]; ++len) tmp[len] = (WCHAR)num[len];
+            if (zero && !left && num[0] == '-' && width > len) {
+                out[n++] = L'-';
+                ++s; --len; --width;
+            }
+        }
+        if (!left) for (; width > len; --width) out[n++] = zero ? L'0' : L' ';
+        for (int i = 0; i < len; ++i) out[n++] = s[i];
+        if (left) for (; width > len; --width) out[n++] = L' ';
+        if (!*f) break;
+    }
+    out[n] = 0;
+    va_end(ap);
+    return n;
+}
+
+// UTF-8 decoder; returns the code point count in UTF-16 units or -1 on invalid input
+static int utf8_decode(const unsigned char* s, int cb, WCHAR* dst, int cch, BOOL strict) {
+    int n = 0;
+    for (int i = 0; i < cb;) {
+        unsigned c = s[i], cp, need;
+        if (c < 0x80) { cp = c; need = 0; }
+        else if ((c & 0xE0) == 0xC0) { cp = c & 0x1F; need = 1; }
+        else if ((c & 0xF0) == 0xE0) { cp = c & 0x0F; need = 2; }
+        else if ((c & 0xF8) == 0xF0) { cp = c & 0x07; need = 3; }
+        else { if (strict) return -1; cp = 0xFFFD; need = 0; }
+        BOOL bad = FALSE;
+        if (i + (int)need >= cb) { // truncated sequence at the end
+            if (strict) return -1;
+            cp = 0xFFFD;
+            need = (unsigned)(cb - i - 1);
+            bad = TRUE;
+        }
+        for (unsigned k = 1; !bad && k <= need; ++k) {
+            if ((s[i + k] & 0xC0) != 0x80) { bad = TRUE; break; }
+            cp = (cp << 6) | (s[i + k] & 0x3F);
+        }
+        if (!bad && ((need == 1 && cp < 0x80) || (need == 2 && cp < 0x800) || (need == 3 && cp < 0x10000) ||
+                     cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF))) bad = TRUE;
+        if (bad) { if (strict) return -1; cp = 0xFFFD; need = 0; }
+        i += (int)need + 1;
+        int units = cp >= 0x10000 ? 2 : 1;
+        if (dst) {
+            if (n + units > cch) return -2;
+            if (units == 2) {
+                dst[n] = (WCHAR)(0xD800 + ((cp - 0x10000) >> 10));
+                dst[n + 1] = (WCHAR)(0xDC00 + ((cp - 0x10000) & 0x3FF));
+            } else {
+                dst[n] = (WCHAR)cp;
+            }
+        }
+        n += units;
+    }
+    return n;
+}
+
+int MultiByteToWideChar(UINT cp, DWORD flags, LPCSTR src, int cb, LPWSTR dst, int cch) {
+    if (cb < 0) cb = (int)strlen(src) + 1;
+    if (cp == CP_UTF8) {
+        int n = utf8_decode((const unsigned char*)src, cb, cch ? dst : NULL, cch, (flags & MB_ERR_INVALID_CHARS) != 0);
+        return n < 0 ? 0 : n;
+    }
+    if (!cch) return cb;
+    if (cb > cch) return 0;
+    for (int i = 0; i < cb; ++i) dst[i] = (WCHAR)(unsigned char)src[i];
+    return cb;
+}
+
+int WideCharToMultiByte(UINT cp, DWORD flags, LPCWSTR src, int cch, LPSTR dst, int cb, LPCSTR defChar, BOOL* usedDef) {
+    (void)flags; (void)defChar;
+    if (usedDef) *usedDef = FALSE;
+    if (cch < 0) cch = (int)shim_wcslen(src) + 1;
+    int n = 0;
+    for (int i = 0; i < cch; ++i) {
+        unsigned c = src[i];
+        if (cp == CP_UTF8 && c >= 0xD800 && c <= 0xDBFF && i + 1 < cch && src[i + 1] >= 0xDC00 && src[i + 1] <= 0xDFFF) {
+            c = 0x10000 + ((c - 0xD800) << 10) + (src[++i] - 0xDC00);
+        }
+        unsigned char buf[4];
+        int k;
+        if (cp != CP_UTF8) { buf[0] = c < 0x100 ? (unsigned char)c : '?'; k = 1; }
+        else if (c < 0x80) { buf[0] = (unsigned char)c; k = 1; }
+        else if (c < 0x800) { buf[0] = (unsigned char)(0xC0 | (c >> 6)); buf[1] = (unsigned char)(0x80 | (c & 0x3F)); k = 2; }
+        else if (c < 0x10000) { buf[0] = (unsigned char)(0xE0 | (c >> 12)); buf[1] = (unsigned char)(0x80 | ((c >> 6) & 0x3F)); buf[2] = (unsigned char)(0x80 | (c & 0x3F)); k = 3; }
+        else { buf[0] = (unsigned char)(0xF0 | (c >> 18)); buf[1] = (unsigned char)(0x80 | ((c >> 12) & 0x3F)); buf[2] = (unsigned char)(0x80 | ((c >> 6) & 0x3F)); buf[3] = (unsigned char)(0x80 | (c & 0x3F)); k = 4; }
+        if (cb) {
+            if (n + k > cb) return 0;
+            memcpy(dst + n, buf, (size_t)k);
+        }
+        n += k;
+    }
+    return n;
+}
+
+void shim_to_utf8(const WCHAR* s, char* out, size_t cb) {
+    int n = WideCharToMultiByte(CP_UTF8, 0, s, -1, out, (int)cb, NULL, NULL);
+    if (n <= 0) { out[0] = 0; return; }
+    for (char* p = out; *p; ++p) if (*p == '\\') *p = '/';
+}
+
+void shim_from_utf8(const char* s, WCHAR* out, size_t cch) {
+    if (MultiByteToWideChar(CP_UTF8, 0, s, -1, out, (int)cch) <= 0) out[0] = 0;
+}
+
+DWORD ExpandEnvironmentStringsW(LPCWSTR src, LPWSTR dst, DWORD cch) {
+    WCHAR buf[8192];
+    size_t n = 0;
+    for (const WCHAR* p = src; *p && n < ARRAYSIZE(buf) - 1;) {
+        const WCHAR* close = *p == L'%' ? shim_wcschr(p + 1, L'%') : NULL;
+        if (close && close > p + 1) {
+            char name[256];
+            WCHAR wname[256];
+            size_t len = (size_t)(close - p - 1);
+            if (len < ARRAYSIZE(wname)) {
+                memcpy(wname, p + 1, len * sizeof(WCHAR));
+                wname[len] = 0;
+                shim_to_utf8(wname, name, sizeof(name));
+                const char* value = getenv(name);
+                if (value) {
+                    WCHAR wvalue[4096];
+                    shim_from_utf8(value, wvalue, ARRAYSIZE(wvalue));
+                    for (const WCHAR* v = wvalue; *v && n < ARRAYSIZE(buf) - 1; ++v) buf[n++] = *v;
+                    p = close + 1;
+                    continue;
+                }
+            }
+        }
+        buf[n++] = *p++;
+    }
+    buf[n] = 0;
+    if (dst && cch > n) memcpy(dst, buf, (n + 1) * sizeof(WCHAR));
+    return (DWORD)(n + 1);
+}
+
+// Sort key: big-endian folded code units (+1, so no unit encodes as 00 00); with
+// SORT_DIGITSASNUMBERS a digit run becomes 00 31, its significant digit count, then the digits
+static int sort_key(DWORD flags, LPCWSTR s, int len, BYTE* out, int cap) {
+    int n = 0;
+#define PUT(b) do { if (out && n < cap) out[n] = (BYTE)(b); n++; } while (0)
+    for (int i = 0; i < len;) {
+        WCHAR c = s[i];
+        if ((flags & SORT_DIGITSASNUMBERS) && c >= L'0' && c <= L'9') {
+            int start = i;
+            while (i < len && s[i] >= L'0' && s[i] <= L'9') ++i;
+            int sig = start;
+            while (sig < i - 1 && s[sig] == L'0') ++sig;
+            PUT(0x00); PUT(0x31); PUT(i - sig);
+            for (int k = sig; k < i; ++k) PUT(s[k]);
+            continue;
+        }
+        if (flags & NORM_IGNORECASE) c = fold(c);
+        unsigned v = (unsigned)c + 1;
+        PUT(v >> 8); PUT(v & 0xFF);
+        ++i;
+    }
+#undef PUT
+    return n;
+}
+
+int LCMapStringEx(LPCWSTR locale, DWORD flags, LPCWSTR src, int cchSrc, LPWSTR dst, int cchDst, void* ver, void* res, LPARAM sortHandle) {
+    (void)locale; (void)ver; (void)res; (void)sortHandle;
+    if (!(flags & LCMAP_SORTKEY)) return 0;
+    if (cchSrc < 0) cchSrc = (int)shim_wcslen(src);
+    int need = sort_key(flags, src, cchSrc, NULL, 0);
+    if (!cchDst) return need;
+    if (need > cchDst) return 0;
+    return sort_key(flags, src, cchSrc, (BYTE*)dst, cchDst);
+}
+
+int CompareStringEx(LPCWSTR locale, DWORD flags, LPCWSTR a, int cchA, LPCWSTR b, int cchB, void* ver, void* res, LPARAM sortHandle) {
+    (void)locale; (void)ver; (void)res; (void)sortHandle;
+    if (cchA < 0) cchA = (int)shim_wcslen(a);
+    if (cchB < 0) cchB = (int)shim_wcslen(b);
+    int la = sort_key(flags, a, cchA, NULL, 0), lb = sort_key(flags, b, cchB, NULL, 0);
+    BYTE* ka = (BYTE*)malloc((size_t)la + 1);
+    BYTE* kb = (BYTE*)malloc((size_t)lb + 1);
+    sort_key(flags, a, cchA, ka, la);
+    sort_key(flags, b, cchB, kb, lb);
+    int r = memcmp(ka, kb, (size_t)(la < lb ? la : lb));
+    if (!r) r = la - lb;
+    free(ka);
+    free(kb);
+    return r < 0 ? CSTR_LESS_THAN : r > 0 ? CSTR_GREATER_THAN : CSTR_EQUAL;
+}
+
+// ---- Time ----
+
+LONG CompareFileTime(const FILETIME* a, const FILETIME* b) {
+    ULONGLONG x = ((ULONGLONG)a->dwHighDateTime << 32) | a->dwLowDateTime;
+    ULONGLONG y = ((ULONGLONG)b->dwHighDateTime << 32) | b->dwLowDateTime;
+    return x < y ? -1 : x > y;
+}
+
+static ULONGLONG mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ULONGLONG)ts.tv_sec * 1000000000ull + (ULONGLONG)ts.tv_nsec;
+}
+
+ULONGLONG GetTickCount64(void) { return mono_ns() / 1000000ull; }
+DWORD GetTickCount(void) { return (DWORD)GetTickCount64(); }
+
+BOOL QueryPerformanceCounter(LARGE_INTEGER* out) {
+    out->QuadPart = (LONGLONG)mono_ns();
+    return TRUE;
+}
+
+BOOL QueryPerformanceFrequency(LARGE_INTEGER* out) {
+    out->QuadPart = 1000000000ll;
+    return TRUE;
+}
+
+void Sleep(DWORD ms) {
+    struct timespec ts = { (time_t)(ms / 1000), (long)(ms % 1000) * 1000000L };
+    while (nanosleep(&ts, &ts) && errno == EINTR) {}
+}
+
+void GetLocalTime(SYSTEMTIME* st) {
+    struct timespec ts;
+    struct tm tm;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    localtime_r(&ts.tv_sec, &tm);
+    st->wYear = (WORD)(tm.tm_year + 1900);
+    st->wMonth = (WORD)(tm.tm_mon + 1);
+    st->wDayOfWeek = (WORD)tm.tm_wday;
+    st->wDay = (WORD)tm.tm_mday;
+    st->wHour = (WORD)tm.tm_hour;
+    st->wMinute = (WORD)tm.tm_min;
+    st->wSecond = (WORD)tm.tm_sec;
+    st->wMilliseconds = (WORD)(ts.tv_nsec / 1000000);
+}
+
+static FILETIME to_filetime(struct timespec ts) {
+    ULONGLONG t = (ULONGLONG)ts.tv_sec * 10000000ull + (ULONGLONG)ts.tv_nsec / 100 + 116444736000000000ull;
+    FILETIME ft = { (DWORD)t, (DWORD)(t >> 32) };
+    return ft;
+}
+
+// ---- Handles ----
+
+enum { H_FILE = 1, H_MAPPING, H_FIND, H_WATCH, H_EVENT };
+
+typedef struct ShimHandle {
+    int type;
+    int fd;              // file, mapping (dup of the file), watch (inotify)
+    // H_FIND
+    DIR* dir;
+    char dirPath[PATH_MAX];
+    char pattern[PATH_MAX];
+    // H_EVENT (and H_WATCH once signaled)
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    BOOL manual;
+    BOOL signaled;
+} ShimHandle;
+
+static ShimHandle* new_handle(int type) {
+    ShimHandle* h = (ShimHandle*)calloc(1, sizeof(ShimHandle));
+    if (!h) return NULL;
+    h->type = type;
+    h->fd = -1;
+    return h;
+}
+
+#define SHIM_MAX_SLOW_RULES 8
+static struct { char fragment[128]; DWORD ms; } g_slowRules[SHIM_MAX_SLOW_RULES];
+static int g_slowRuleCount = 0;
+static pthread_mutex_t g_slowLock = PTHREAD_MUTEX_INITIALIZER;
+
+void shim_set_slow_path(const char* fragment, DWORD ms) {
+    pthread_mutex_lock(&g_slowLock);
+    if (!fragment) g_slowRuleCount = 0;
+    else if (g_slowRuleCount < SHIM_MAX_SLOW_RULES) {
+        snprintf(g_slowRules[g_slowRuleCount].fragment, sizeof(g_slowRules[0].fragment), "%s", fragment);
+        g_slowRules[g_slowRuleCount++].ms = ms;
+    }
+    pthread_mutex_unlock(&g_slowLock);
+}
+
+#define SHIM_MAX_DRIVE_RULES 8
+static struct { char fragment[128]; UINT type; } g_driveRules[SHIM_MAX_DRIVE_RULES];
+static int g_driveRuleCount = 0;
+
+void shim_set_drive_type(const char* fragment, UINT type) {
+    pthread_mutex_lock(&g_slowLock);
+    if (!fragment) g_driveRuleCount = 0;
+    else if (g_driveRuleCount < SHIM_MAX_DRIVE_RULES) {
+        snprintf(g_driveRules[g_driveRuleCount].fragment, sizeof(g_driveRules[0].fragment), "%s", fragment);
+        g_driveRules[g_driveRuleCount++].type = type;
+    }
+    pthread_mutex_unlock(&g_slowLock);
+}
+
+UINT GetDriveTypeW(LPCWSTR root) {
+    char path[PATH_MAX];
+    shim_to_utf8(root ? root : L".", path, sizeof(path));
+    UINT type = DRIVE_FIXED;
+    pthread_mutex_lock(&g_slowLock);
+    for (int i = 0; i < g_driveRuleCount && i < SHIM_MAX_DRIVE_RULES; ++i) {
+        if (strstr(path, g_driveRules[i].fragment)) type = g_driveRules[i].type;
+    }
+    pthread_mutex_unlock(&g_slowLock);
+    return type;
+}
+
+// Every file API converts its path here, so this is where the slow-path rules apply
+static void path_to_host(LPCWSTR path, char* out) {
+    shim_to_utf8(path, out, PATH_MAX);
+    DWORD delay = 0;
+    pthread_mutex_lock(&g_slowLock);
+    for (int i = 0; i < g_slowRuleCount && i < SHIM_MAX_SLOW_RULES; ++i) {
+        if (strstr(out, g_slowRules[i].fragment) && g_slowRules[i].ms > delay) delay = g_slowRules[i].ms;
+    }
+    pthread_mutex_unlock(&g_slowLock);
+    if (delay) Sleep(delay);
+}
+
+HANDLE CreateFileW(LPCWSTR path, DWORD access, DWORD share, void* sa, DWORD disposition, DWORD attrs, HANDLE tmpl) {
+    (void)share; (void)sa; (void)attrs; (void)tmpl;
+    char p[PATH_MAX];
+    path_to_host(path, p);
+    int mode = (access & GENERIC_WRITE) ? ((access & GENERIC_READ) ? O_RDWR : O_WRONLY) : O_RDONLY;
+    if (disposition == CREATE_ALWAYS) mode |= O_CREAT | O_TRUNC;
+    int fd = open(p, mode | O_CLOEXEC, 0644);
+    if (fd < 0) return INVALID_HANDLE_VALUE;
+    ShimHandle* h = new_handle(H_FILE);
+    if (!h) { close(fd); return INVALID_HANDLE_VALUE; }
+    h->fd = fd;
+    return h;
+}
+
+BOOL ReadFile(HANDLE f, void* buf, DWORD cb, DWORD* bytesRead, void* ov) {
+    (void)ov;
+    ShimHandle* h = (ShimHandle*)f;
+    DWORD got = 0;
+    while (got < cb) {
+        ssize_t r = read(h->fd, (char*)buf + got, cb - got);
+        if (r < 0 && errno == EINTR) continue;
+        if (r < 0) return FALSE;
+        if (r == 0) break;
+        got += (DWORD)r;
+    }
+    if (bytesRead) *bytesRead = got;
+    return TRUE;
+}
+
+BOOL WriteFile(HANDLE f, const void* buf, DWORD cb, DWORD* written, void* ov) {
+    (void)ov;
+    ShimHandle* h = (ShimHandle*)f;
+    DWORD put = 0;
+    while (put < cb) {
+        ssize_t r = write(h->fd, (const char*)buf + put, cb - put);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return FALSE;
+        put += (DWORD)r;
+    }
+    if (written) *written = put;
+    return TRUE;
+}
+
+DWORD GetFileSize(HANDLE f, DWORD* high) {
+    struct stat st;
+    if (fstat(((ShimHandle*)f)->fd, &st)) return INVALID_FILE_SIZE;
+    if (high) *high = (DWORD)((ULONGLONG)st.st_size >> 32);
+    return (DWORD)st.st_size;
+}
+
+DWORD SetFilePointer(HANDLE f, LONG distance, LONG* distanceHigh, DWORD method) {
+    off_t off = distanceHigh ? (off_t)(((ULONGLONG)(DWORD)*distanceHigh << 32) | (DWORD)distance) : distance;
+    off_t r = lseek(((ShimHandle*)f)->fd, off, method == FILE_END ? SEEK_END : method == FILE_CURRENT ? SEEK_CUR : SEEK_SET);
+    if (r < 0) return INVALID_FILE_SIZE;
+    if (distanceHigh) *distanceHigh = (LONG)((ULONGLONG)r >> 32);
+    return (DWORD)r;
+}
+
+BOOL GetFileSizeEx(HANDLE f, LARGE_INTEGER* size) {
+    struct stat st;
+    if (fstat(((ShimHandle*)f)->fd, &st)) return FALSE;
+    size->QuadPart = st.st_size;
+    return TRUE;
+}
+
+BOOL GetFileTime(HANDLE f, FILETIME* creation, FILETIME* access, FILETIME* write) {
+    struct stat st;
+    if (fstat(((ShimHandle*)f)->fd, &st)) return FALSE;
+    if (creation) *creation = to_filetime(st.st_ctim);
+    if (access) *access = to_filetime(st.st_atim);
+    if (write) *write = to_filetime(st.st_mtim);
+    return TRUE;
+}
+
+BOOL CloseHandle(HANDLE handle) {
+    ShimHandle* h = (ShimHandle*)handle;
+    if (!h || handle == INVALID_HANDLE_VALUE) return FALSE;
+    if (h->fd >= 0) close(h->fd);
+    if (h->dir) closedir(h->dir);
+    if (h->type == H_EVENT) {
+        pthread_mutex_destroy(&h->lock);
+        pthread_cond_destroy(&h->cond);
+    }
+    free(h);
+    return TRUE;
+}
+
+HANDLE CreateFileMappingW(HANDLE f, void* sa, DWORD protect, DWORD sizeHigh, DWORD sizeLow, LPCWSTR name) {
+    (void)sa; (void)protect; (void)sizeHigh; (void)sizeLow; (void)name;
+    ShimHandle* h = new_handle(H_MAPPING);
+    if (!h) return NULL;
+    h->fd = dup(((ShimHandle*)f)->fd);
+    if (h->fd < 0) { free(h); return NULL; }
+    return h;
+}
+
+// Views are tracked so UnmapViewOfFile knows their length
+typedef struct ShimView {
+    const void* base;
+    size_t len;
+    struct ShimView* next;
+} ShimView;
+static ShimView* g_views = NULL;
+static pthread_mutex_t g_viewLock = PTHREAD_MUTEX_INITIALIZER;
+
+LPVOID MapViewOfFile(HANDLE map, DWORD access, DWORD offHigh, DWORD offLow, SIZE_T bytes) {
+    (void)access;
+    ShimHandle* h = (ShimHandle*)map;
+    struct stat st;
+    if (fstat(h->fd, &st)) return NULL;
+    off_t off = (off_t)(((ULONGLONG)offHigh << 32) | offLow);
+    size_t len = bytes ? bytes : (size_t)(st.st_size - off);
+    if (len == 0) return NULL;
+    void* p = mmap(NULL, len, PROT_READ, MAP_SHARED, h->fd, off);
+    if (p == MAP_FAILED) return NULL;
+    ShimView* v = (ShimView*)malloc(sizeof(ShimView));
+    if (!v) { munmap(p, len); return NULL; }
+    v->base = p;
+    v->len = len;
+    pthread_mutex_lock(&g_viewLock);
+    v->next = g_views;
+    g_views = v;
+    pthread_mutex_unlock(&g_viewLock);
+    return p;
+}
+
+BOOL UnmapViewOfFile(const void* view) {
+    pthread_mutex_lock(&g_viewLock);
+    for (ShimView** pv = &g_views; *pv; pv = &(*pv)->next) {
+        ShimView* v = *pv;
+        if (v->base != view) continue;
+        *pv = v->next;
+        pthread_mutex_unlock(&g_viewLock);
+        munmap((void*)v->base, v->len);
+        free(v);
+        return TRUE;
+    }
+    pthread_mutex_unlock(&g_viewLock);
+    return FALSE;
+}
+
+BOOL MoveFileExW(LPCWSTR from, LPCWSTR to, DWORD flags) {
+    (void)flags;
+    char a[PATH_MAX], b[PATH_MAX];
+    path_to_host(from, a);
+    path_to_host(to, b);
+    return rename(a, b) == 0;
+}
+
+BOOL DeleteFileW(LPCWSTR path) {
+    char p[PATH_MAX];
+    path_to_host(path, p);
+    return unlink(p) == 0;
+}
+
+static void fill_attributes(const struct stat* st, const char* name, DWORD* attrs, FILETIME* create, FILETIME* access,
+                            FILETIME* write, DWORD* sizeHigh, DWORD* sizeLow) {
+    BOOL dir = S_ISDIR(st->st_mode);
+    *attrs = dir ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_ARCHIVE;
+    if (!(st->st_mode & S_IWUSR)) *attrs |= FILE_ATTRIBUTE_READONLY;
+    (void)name;
+    *create = to_filetime(st->st_ctim);
+    *access = to_filetime(st->st_atim);
+    *write = to_filetime(st->st_mtim);
+    ULONGLONG size = dir ? 0 : (ULONGLONG)st->st_size;
+    *sizeHigh = (DWORD)(size >> 32);
+    *sizeLow = (DWORD)size;
+}
+
+BOOL GetFileAttributesExW(LPCWSTR path, GET_FILEEX_INFO_LEVELS level, void* out) {
+    (void)level;
+    char p[PATH_MAX];
+    struct stat st;
+    path_to_host(path, p);
+    if (stat(p, &st)) return FALSE;
+    WIN32_FILE_ATTRIBUTE_DATA* fad = (WIN32_FILE_ATTRIBUTE_DATA*)out;
+    fill_attributes(&st, p, &fad->dwFileAttributes, &fad->ftCreationTime, &fad->ftLastAccessTime,
+                    &fad->ftLastWriteTime, &fad->nFileSizeHigh, &fad->nFileSizeLow);
+    return TRUE;
+}
+
+DWORD GetFileAttributesW(LPCWSTR path) {
+    WIN32_FILE_ATTRIBUTE_DATA fad;
+    return GetFileAttributesExW(path, GetFileExInfoStandard, &fad) ? fad.dwFileAttributes : INVALID_FILE_ATTRIBUTES;
+}
+
+// Next directory entry matching the pattern, with its stat data
+static BOOL find_next(ShimHandle* h, WIN32_FIND_DATAW* fd) {
+    struct dirent* de;
+    while ((de = readdir(h->dir)) != NULL) {
+        if (fnmatch(h->pattern, de->d_name, 0) != 0) continue;
+        char full[PATH_MAX + NAME_MAX + 2];
+        struct stat st;
+        snprintf(full, sizeof(full), "%s/%s", h->dirPath, de->d_name);
+        if (stat(full, &st)) continue;
+        memset(fd, 0, sizeof(*fd));
+        fill_attributes(&st, de->d_name, &fd->dwFileAttributes, &fd->ftCreationTime, &fd->ftLastAccessTime,
+                        &fd->ftLastWriteTime, &fd->nFileSizeHigh, &fd->nFileSizeLow);
+        shim_from_utf8(de->d_name, fd->cFileName, ARRAYSIZE(fd->cFileName));
+        return TRUE;
+    }
+    return FALSE;
+}
+
+HANDLE FindFirstFileExW(LPCWSTR pattern, FINDEX_INFO_LEVELS level, void* data, FINDEX_SEARCH_OPS op, void* filter, DWORD flags) {
+    (void)level; (void)op; (void)filter; (void)flags;
+    char p[PATH_MAX];
+    path_to_host(pattern, p);
+    char* slash = strrchr(p, '/');
+    ShimHandle* h = new_handle(H_FIND);
+    if (!h) return INVALID_HANDLE_VALUE;
+    if (slash) {
+        *slash = 0;
+        snprintf(h->dirPath, sizeof(h->dirPath), "%s", p[0] ? p : "/");
+        snprintf(h->pattern, sizeof(h->pattern), "%s", slash + 1);
+    } else {
+        snprintf(h->dirPath, sizeof(h->dirPath), ".");
+        snprintf(h->pattern, sizeof(h->pattern), "%s", p);
+    }
+    h->dir = opendir(h->dirPath);
+    if (!h->dir || !find_next(h, (WIN32_FIND_DATAW*)data)) {
+        CloseHandle(h);
+        return INVALID_HANDLE_VALUE;
+    }
+    return h;
+}
+
+HANDLE FindFirstFileW(LPCWSTR pattern, WIN32_FIND_DATAW* data) {
+    return FindFirstFileExW(pattern, FindExInfoStandard, data, FindExSearchNameMatch, NULL, 0);
+}
+
+BOOL FindNextFileW(HANDLE h, WIN32_FIND_DATAW* data) {
+    return find_next((ShimHandle*)h, data);
+}
+
+BOOL FindClose(HANDLE h) {
+    return CloseHandle(h);
+}
+
+HANDLE FindFirstChangeNotificationW(LPCWSTR dir, BOOL subtree, DWORD filter) {
+    (void)subtree; (void)filter;
+    char p[PATH_MAX];
+    path_to_host(dir, p);
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) return INVALID_HANDLE_VALUE;
+    if (inotify_add_watch(fd, p, IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE) < 0) {
+        close(fd);
+        return INVALID_HANDLE_VALUE;
+    }
+    ShimHandle* h = new_handle(H_WATCH);
+    if (!h) { close(fd); return INVALID_HANDLE_VALUE; }
+    h->fd = fd;
+    return h;
+}
+
+// Re-arms the watch: pending events are consumed
+BOOL FindNextChangeNotification(HANDLE handle) {
+    ShimHandle* h = (ShimHandle*)handle;
+    char buf[4096];
+    while (read(h->fd, buf, sizeof(buf)) > 0) {}
+    return TRUE;
+}
+
+BOOL FindCloseChangeNotification(HANDLE h) {
+    return CloseHandle(h);
+}
+
+// ---- Synchronization ----
+
+HANDLE CreateEventW(void* sa, BOOL manualReset, BOOL initialState, LPCWSTR name) {
+    (void)sa; (void)name;
+    ShimHandle* h = new_handle(H_EVENT);
+    if (!h) return NULL;
+    pthread_mutex_init(&h->lock, NULL);
+    pthread_cond_init(&h->cond, NULL);
+    h->manual = manualReset;
+    h->signaled = initialState;
+    return h;
+}
+
+BOOL SetEvent(HANDLE handle) {
+    ShimHandle* h = (ShimHandle*)handle;
+    pthread_mutex_lock(&h->lock);
+    h->signaled = TRUE;
+    pthread_cond_broadcast(&h->cond);
+    pthread_mutex_unlock(&h->lock);
+    return TRUE;
+}
+
+BOOL ResetEvent(HANDLE handle) {
+    ShimHandle* h = (ShimHandle*)handle;
+    pthread_mutex_lock(&h->lock);
+    h->signaled = FALSE;
+    pthread_mutex_unlock(&h->lock);
+    return TRUE;
+}
+
+DWORD WaitForSingleObject(HANDLE handle, DWORD ms) {
+    ShimHandle* h = (ShimHandle*)handle;
+    if (h->type == H_WATCH) {
+        // Signaled once an event is pending; stays signaled until FindNextChangeNotification
+        struct pollfd pfd = { h->fd, POLLIN, 0 };
+        int r = poll(&pfd, 1, ms == INFINITE ? -1 : (int)ms);
+        return r > 0 ? WAIT_OBJECT_0 : WAIT_TIMEOUT;
+    }
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    if (ms != INFINITE) {
+        deadline.tv_sec += ms / 1000;
+        deadline.tv_nsec += (long)(ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) { deadline.tv_sec++; deadline.tv_nsec -= 1000000000L; }
+    }
+    DWORD result = WAIT_OBJECT_0;
+    pthread_mutex_lock(&h->lock);
+    while (!h->signaled) {
+        int r = ms == INFINITE ? pthread_cond_wait(&h->cond, &h->lock) : pthread_cond_timedwait(&h->cond, &h->lock, &deadline);
+        if (r == ETIMEDOUT) { result = WAIT_TIMEOUT; break; }
+    }
+    if (result == WAIT_OBJECT_0 && !h->manual) h->signaled = FALSE;
+    pthread_mutex_unlock(&h->lock);
+    return result;
+}
+
+LONG InterlockedCompareExchange(volatile LONG* p, LONG exchange, LONG comparand) {
+    __atomic_compare_exchange_n(p, &comparand, exchange, FALSE, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    return comparand;
+}
+
+void InitializeSListHead(PSLIST_HEADER h) {
+    h->head = NULL;
+}
+
+PSLIST_ENTRY InterlockedPushEntrySList(PSLIST_HEADER h, PSLIST_ENTRY e) {
+    PSLIST_ENTRY old = __atomic_load_n(&h->head, __ATOMIC_SEQ_CST);
+    do {
+        e->Next = old;
+    } while (!__atomic_compare_exchange_n(&h->head, &old, e, FALSE, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST));
+    return old;
+}
+
+PSLIST_ENTRY InterlockedFlushSList(PSLIST_HEADER h) {
+    return __atomic_exchange_n(&h->head, NULL, __ATOMIC_SEQ_CST);
+}
+
+typedef struct ShimWork {
+    PTP_SIMPLE_CALLBACK cb;
+    PVOID context;
+} ShimWork;
+
+static void* work_thread(void* arg) {
+    ShimWork w = *(ShimWork*)arg;
+    free(arg);
+    w.cb(NULL, w.context);
+    return NULL;
+}
+
+BOOL TrySubmitThreadpoolCallback(PTP_SIMPLE_CALLBACK cb, PVOID context, PTP_CALLBACK_ENVIRON env) {
+    (void)env;
+    ShimWork* w = (ShimWork*)malloc(sizeof(ShimWork));
+    if (!w) return FALSE;
+    w->cb = cb;
+    w->context = context;
+    pthread_t t;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int r = pthread_create(&t, &attr, work_thread, w);
+    pthread_attr_destroy(&attr);
+    if (r) { free(w); return FALSE; }
+    return TRUE;
+}
+
+BOOL CallbackMayRunLong(PTP_CALLBACK_INSTANCE instance) { (void)instance; return TRUE; }
+PTP_POOL CreateThreadpool(PVOID reserved) { (void)reserved; static int pool; return (PTP_POOL)&pool; }
+void SetThreadpoolThreadMaximum(PTP_POOL pool, DWORD max) { (void)pool; (void)max; }
+void InitializeThreadpoolEnvironment(PTP_CALLBACK_ENVIRON env) { env->pool = NULL; }
+void SetThreadpoolCallbackPool(PTP_CALLBACK_ENVIRON env, PTP_POOL pool) { env->pool = pool; }
+
+// ---- Process ----
+
+DWORD GetModuleFileNameW(HMODULE module, LPWSTR out, DWORD cch) {
+    (void)module;
+    char p[PATH_MAX];
+    ssize_t n = readlink("/proc/self/exe", p, sizeof(p) - 1);
+    if (n <= 0 || !cch) return 0;
+    p[n] = 0;
+    shim_from_utf8(p, out, cch);
+    return (DWORD)shim_wcslen(out);
+}
+
+extern char** environ;
+
+LPWSTR GetEnvironmentStringsW(void) {
+    size_t cch = 1;
+    for (char** e = environ; *e; ++e) cch += strlen(*e) + 1;
+    WCHAR* block = (WCHAR*)malloc(cch * sizeof(WCHAR));
+    if (!block) return NULL;
+    WCHAR* p = block;
+    for (char** e = environ; *e; ++e) {
+        shim_from_utf8(*e, p, strlen(*e) + 1);
+        p += shim_wcslen(p) + 1;
+    }
+    *p = 0;
+    return block;
+}
+
+BOOL FreeEnvironmentStringsW(LPWSTR env) {
+    free(env);
+    return TRUE;
+}
+
+void OutputDebugStringW(LPCWSTR s) {
+    (void)s;
+}
+
+HRESULT SHGetFolderPathW(HWND hwnd, int csidl, HANDLE token, DWORD flags, LPWSTR path) {
+    (void)hwnd; (void)token; (void)flags;
+    const char* dir = csidl == CSIDL_LOCAL_APPDATA ? getenv("LOCALAPPDATA") : NULL;
+    if (!dir || !dir[0]) return E_FAIL;
+    shim_from_utf8(dir, path, MAX_PATH);
+    return S_OK;
+}
+
+int SHCreateDirectoryExW(HWND hwnd, LPCWSTR path, void* sa) {
+    (void)hwnd; (void)sa;
+    char p[PATH_MAX];
+    path_to_host(path, p);
+    struct stat st;
+    if (!stat(p, &st)) return S_ISDIR(st.st_mode) ? ERROR_ALREADY_EXISTS : -1;
+    for (char* q = p + 1; *q; ++q) {
+        if (*q != '/') continue;
+        *q = 0;
+        mkdir(p, 0755);
+        *q = '/';
+    }
+    return mkdir(p, 0755) == 0 ? 0 : -1;
+}
+
+// ---- shlwapi (both separators are accepted; new ones are written as '\') ----
+
+static BOOL is_sep(WCHAR c) { return c == L'\\' || c == L'/'; }
+
+LPWSTR PathCombineW(LPWSTR out, LPCWSTR dir, LPCWSTR file) {
+    WCHAR tmp[MAX_PATH * 2];
+    if (!file || !file[0]) lstrcpynW(tmp, dir ? dir : L"", MAX_PATH * 2);
+    else if (is_sep(file[0]) || !dir || !dir[0]) lstrcpynW(tmp, file, MAX_PATH * 2);
+    else {
+        lstrcpynW(tmp, dir, MAX_PATH * 2);
+        size_t n = shim_wcslen(tmp);
+        if (n && !is_sep(tmp[n - 1])) { tmp[n++] = L'\\'; tmp[n] = 0; }
+        lstrcpynW(tmp + n, file, (int)(MAX_PATH * 2 - n));
+    }
+    if (shim_wcslen(tmp) >= MAX_PATH) { out[0] = 0; return NULL; }
+    lstrcpyW(out, tmp);
+    return out;
+}
+
+BOOL PathAppendW(LPWSTR path, LPCWSTR more) {
+    while (is_sep(*more)) ++more;
+    return PathCombineW(path, path, more) != NULL;
+}
+
+BOOL PathRemoveFileSpecW(LPWSTR path) {
+    WCHAR* last = NULL;
+    for (WCHAR* p = path; *p; ++p) if (is_sep(*p)) last = p;
+    if (!last) {
+        BOOL changed = path[0] != 0;
+        path[0] = 0;
+        return changed;
+    }
+    if (last == path) last[1] = 0; // keep the root
+    else *last = 0;
+    return TRUE;
+}
+
+LPWSTR PathFindFileNameW(LPCWSTR path) {
+    LPCWSTR name = path;
+    for (LPCWSTR p = path; *p; ++p) if (is_sep(*p) && p[1]) name = p + 1;
+    return (LPWSTR)name;
+}
+
+BOOL PathFileExistsW(LPCWSTR path) {
+    return GetFileAttributesW(path) != INVALID_FILE_ATTRIBUTES;
+}
+
+BOOL PathStripToRootW(LPWSTR path) {
+    if (!path[0]) return FALSE;
+    if (path[1] == L':') {
+        path[is_sep(path[2]) ? 3 : 2] = 0;
+        return TRUE;
+    }
+    if (is_sep(path[0]) && is_sep(path[1])) {
+        int seps = 0;
+        for (WCHAR* p = path + 2; *p; ++p) {
+            if (is_sep(*p) && ++seps == 2) { *p = 0; break; }
+        }
+    }
+    return TRUE;
+}
@@ -0,0 +1,319 @@
+#pragma once
+// Minimal Win32 surface for building the portable modules on a POSIX host (tests and benchmarks
+// only; the application itself is built against the Windows SDK). Compile with -fshort-wchar so
+// WCHAR and L"" literals are UTF-16 code units as on Windows. Wide libc functions assume a 4-byte
+// wchar_t, so the ones the sources use are redirected to UTF-16 implementations below.
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+#include <wctype.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef unsigned char BYTE;
+typedef unsigned short WORD;
+typedef uint32_t DWORD;
+typedef int32_t LONG;
+typedef uint32_t ULONG;
+typedef int BOOL;
+typedef unsigned int UINT;
+typedef int INT;
+typedef int64_t LONGLONG;
+typedef uint64_t ULONGLONG;
+typedef size_t SIZE_T;
+typedef uintptr_t ULONG_PTR, DWORD_PTR, UINT_PTR;
+typedef intptr_t LONG_PTR, INT_PTR;
+typedef wchar_t WCHAR;
+typedef char CHAR;
+typedef void VOID;
+typedef void *PVOID, *LPVOID, *HANDLE;
+typedef HANDLE HLOCAL, HWND, HMENU, HICON, HBITMAP, HMODULE, HINSTANCE, HKEY, HDC, HMONITOR;
+typedef const WCHAR *LPCWSTR, *PCWSTR;
+typedef WCHAR *LPWSTR, *PWSTR;
+typedef const char *LPCSTR;
+typedef char *LPSTR;
+typedef BYTE *LPBYTE;
+typedef DWORD *LPDWORD;
+typedef LONG HRESULT;
+typedef DWORD COLORREF;
+#define RGB(r, g, b) ((COLORREF)((BYTE)(r) | ((WORD)(BYTE)(g) << 8) | ((DWORD)(BYTE)(b) << 16)))
+#define GetRValue(c) ((BYTE)(c))
+#define GetGValue(c) ((BYTE)((c) >> 8))
+#define GetBValue(c) ((BYTE)((c) >> 16))
+typedef ULONG_PTR WPARAM;
+typedef LONG_PTR LPARAM;
+
+#define TRUE 1
+#define FALSE 0
+#define WINAPI
+#define CALLBACK
+#define MAX_PATH 260
+#define INFINITE 0xFFFFFFFFu
+#define MAXLONG 0x7FFFFFFF
+#define UNREFERENCED_PARAMETER(p) ((void)(p))
+#define ARRAYSIZE(a) (sizeof(a) / sizeof((a)[0]))
+#define ZeroMemory(p, n) memset((p), 0, (n))
+#define CopyMemory(d, s, n) memcpy((d), (s), (n))
+#define MoveMemory(d, s, n) memmove((d), (s), (n))
+#define FillMemory(p, n, v) memset((p), (v), (n))
+#define CONTAINING_RECORD(addr, type, field) ((type*)((char*)(addr) - offsetof(type, field)))
+#define SUCCEEDED(hr) ((HRESULT)(hr) >= 0)
+#define FAILED(hr) ((HRESULT)(hr) < 0)
+#define S_OK ((HRESULT)0)
+#define MemoryBarrier() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+typedef struct FILETIME {
+    DWORD dwLowDateTime;
+    DWORD dwHighDateTime;
+} FILETIME;
+
+typedef union LARGE_INTEGER {
+    struct { DWORD LowPart; LONG HighPart; };
+    LONGLONG QuadPart;
+} LARGE_INTEGER;
+
+// ---- Memory (LocalAlloc family; counted so tests can check for leaks) ----
+#define LMEM_FIXED 0x0000
+#define LMEM_ZEROINIT 0x0040
+#define LPTR (LMEM_FIXED | LMEM_ZEROINIT)
+HLOCAL LocalAlloc(UINT flags, SIZE_T bytes);
+HLOCAL LocalFree(HLOCAL mem);
+
+typedef struct ShimAllocStats {
+    SIZE_T allocs;
+    SIZE_T frees;
+    SIZE_T liveBytes;
+    SIZE_T peakBytes;
+} ShimAllocStats;
+void shim_alloc_stats(ShimAllocStats* out);
+
+// ---- Strings ----
+int lstrlenW(LPCWSTR s);
+int lstrlenA(LPCSTR s);
+LPWSTR lstrcpyW(LPWSTR d, LPCWSTR s);
+LPWSTR lstrcpynW(LPWSTR d, LPCWSTR s, int cch);
+LPWSTR lstrcatW(LPWSTR d, LPCWSTR s);
+int lstrcmpW(LPCWSTR a, LPCWSTR b);
+int lstrcmpiW(LPCWSTR a, LPCWSTR b);
+// A pointer whose high bits are zero is a single character, lowered and returned in the low word
+LPWSTR CharLowerW(LPWSTR s);
+int wsprintfW(LPWSTR out, LPCWSTR fmt, ...);
+
+size_t shim_wcslen(const WCHAR* s);
+WCHAR* shim_wcschr(const WCHAR* s, WCHAR c);
+WCHAR* shim_wcsrchr(const WCHAR* s, WCHAR c);
+WCHAR* shim_wcsstr(const WCHAR* s, const WCHAR* sub);
+int shim_wcscmp(const WCHAR* a, const WCHAR* b);
+int shim_wcsncmp(const WCHAR* a, const WCHAR* b, size_t n);
+int shim_wcsicmp(const WCHAR* a, const WCHAR* b);
+int shim_wcsnicmp(const WCHAR* a, const WCHAR* b, size_t n);
+int shim_wtoi(const WCHAR* s);
+#define wcslen shim_wcslen
+#define wcschr shim_wcschr
+#define wcsrchr shim_wcsrchr
+#define wcsstr shim_wcsstr
+#define wcscmp shim_wcscmp
+#define wcsncmp shim_wcsncmp
+#define _wcsicmp shim_wcsicmp
+#define _wcsnicmp shim_wcsnicmp
+#define _wtoi shim_wtoi
+
+// Host test helpers: UTF-8 <-> UTF-16 for paths and fixtures (backslashes become slashes)
+void shim_to_utf8(const WCHAR* s, char* out, size_t cb);
+void shim_from_utf8(const char* s, WCHAR* out, size_t cch);
+
+#define CP_ACP 0    // ISO-8859-1 on the host
+#define CP_UTF8 65001
+#define MB_ERR_INVALID_CHARS 0x08
+int MultiByteToWideChar(UINT cp, DWORD flags, LPCSTR src, int cb, LPWSTR dst, int cch);
+int WideCharToMultiByte(UINT cp, DWORD flags, LPCWSTR src, int cch, LPSTR dst, int cb, LPCSTR defChar, BOOL* usedDef);
+DWORD ExpandEnvironmentStringsW(LPCWSTR src, LPWSTR dst, DWORD cch);
+
+// Collation: case-folded UTF-16 order; SORT_DIGITSASNUMBERS compares digit runs by value
+#define LOCALE_NAME_USER_DEFAULT NULL
+#define NORM_IGNORECASE 0x00000001
+#define SORT_DIGITSASNUMBERS 0x00000008
+#define LCMAP_SORTKEY 0x00000400
+#define CSTR_LESS_THAN 1
+#define CSTR_EQUAL 2
+#define CSTR_GREATER_THAN 3
+int LCMapStringEx(LPCWSTR locale, DWORD flags, LPCWSTR src, int cchSrc, LPWSTR dst, int cchDst, void* ver, void* res, LPARAM sortHandle);
+int CompareStringEx(LPCWSTR locale, DWORD flags, LPCWSTR a, int cchA, LPCWSTR b, int cchB, void* ver, void* res, LPARAM sortHandle);
+
+// ---- Time ----
+LONG CompareFileTime(const FILETIME* a, const FILETIME* b);
+ULONGLONG GetTickCount64(void);
+DWORD GetTickCount(void);
+BOOL QueryPerformanceCounter(LARGE_INTEGER* out);
+BOOL QueryPerformanceFrequency(LARGE_INTEGER* out);
+void Sleep(DWORD ms);
+
+typedef struct SYSTEMTIME {
+    WORD wYear, wMonth, wDayOfWeek, wDay, wHour, wMinute, wSecond, wMilliseconds;
+} SYSTEMTIME;
+void GetLocalTime(SYSTEMTIME* st);
+
+// ---- Files ----
+// Slow-filesystem stub: every file API call on a path containing fragment sleeps ms first
+// (a stalled network share). fragment NULL removes all rules.
+void shim_set_slow_path(const char* fragment, DWORD ms);
+// Drive types: DRIVE_FIXED unless a rule's fragment occurs in the root (NULL removes all rules)
+#define DRIVE_UNKNOWN 0
+#define DRIVE_REMOVABLE 2
+#define DRIVE_FIXED 3
+#define DRIVE_REMOTE 4
+#define DRIVE_CDROM 5
+void shim_set_drive_type(const char* fragment, UINT type);
+UINT GetDriveTypeW(LPCWSTR root);
+#define INVALID_HANDLE_VALUE ((HANDLE)(LONG_PTR)-1)
+#define INVALID_FILE_SIZE ((DWORD)0xFFFFFFFF)
+#define INVALID_FILE_ATTRIBUTES ((DWORD)-1)
+#define FILE_ATTRIBUTE_READONLY 0x00000001
+#define FILE_ATTRIBUTE_HIDDEN 0x00000002
+#define FILE_ATTRIBUTE_SYSTEM 0x00000004
+#define FILE_ATTRIBUTE_DIRECTORY 0x00000010
+#define FILE_ATTRIBUTE_ARCHIVE 0x00000020
+#define FILE_ATTRIBUTE_NORMAL 0x00000080
+#define GENERIC_READ 0x80000000u
+#define GENERIC_WRITE 0x40000000u
+#define FILE_SHARE_READ 0x1
+#define FILE_SHARE_WRITE 0x2
+#define FILE_SHARE_DELETE 0x4
+#define CREATE_ALWAYS 2
+#define OPEN_EXISTING 3
+#define OPEN_ALWAYS 4
+#define FILE_BEGIN 0
+#define FILE_CURRENT 1
+#define FILE_END 2
+#define PAGE_READONLY 0x02
+#define FILE_MAP_READ 0x0004
+#define MOVEFILE_REPLACE_EXISTING 0x1
+
+HANDLE CreateFileW(LPCWSTR path, DWORD access, DWORD share, void* sa, DWORD disposition, DWORD attrs, HANDLE tmpl);
+BOOL ReadFile(HANDLE f, void* buf, DWORD cb, DWORD* read, void* ov);
+BOOL WriteFile(HANDLE f, const void* buf, DWORD cb, DWORD* written, void* ov);
+DWORD GetFileSize(HANDLE f, DWORD* high);
+DWORD SetFilePointer(HANDLE f, LONG distance, LONG* distanceHigh, DWORD method);
+BOOL GetFileSizeEx(HANDLE f, LARGE_INTEGER* size);
+BOOL GetFileTime(HANDLE f, FILETIME* creation, FILETIME* access, FILETIME* write);
+BOOL CloseHandle(HANDLE h);
+HANDLE CreateFileMappingW(HANDLE f, void* sa, DWORD protect, DWORD sizeHigh, DWORD sizeLow, LPCWSTR name);
+LPVOID MapViewOfFile(HANDLE map, DWORD access, DWORD offHigh, DWORD offLow, SIZE_T bytes);
+BOOL UnmapViewOfFile(const void* view);
+BOOL MoveFileExW(LPCWSTR from, LPCWSTR to, DWORD flags);
+BOOL DeleteFileW(LPCWSTR path);
+
+typedef enum { GetFileExInfoStandard = 0 } GET_FILEEX_INFO_LEVELS;
+typedef struct WIN32_FILE_ATTRIBUTE_DATA {
+    DWORD dwFileAttributes;
+    FILETIME ftCreationTime;
+    FILETIME ftLastAccessTime;
+    FILETIME ftLastWriteTime;
+    DWORD nFileSizeHigh;
+    DWORD nFileSizeLow;
+} WIN32_FILE_ATTRIBUTE_DATA;
+BOOL GetFileAttributesExW(LPCWSTR path, GET_FILEEX_INFO_LEVELS level, void* out);
+DWORD GetFileAttributesW(LPCWSTR path);
+
+typedef struct WIN32_FIND_DATAW {
+    DWORD dwFileAttributes;
+    FILETIME ftCreationTime;
+    FILETIME ftLastAccessTime;
+    FILETIME ftLastWriteTime;
+    DWORD nFileSizeHigh;
+    DWORD nFileSizeLow;
+    DWORD dwReserved0;
+    DWORD dwReserved1;
+    WCHAR cFileName[MAX_PATH];
+    WCHAR cAlternateFileName[14];
+} WIN32_FIND_DATAW;
+typedef enum { FindExInfoStandard = 0, FindExInfoBasic } FINDEX_INFO_LEVELS;
+typedef enum { FindExSearchNameMatch = 0 } FINDEX_SEARCH_OPS;
+#define FIND_FIRST_EX_LARGE_FETCH 0x2
+// Directory enumeration over opendir/readdir; the last path component is an fnmatch pattern
+HANDLE FindFirstFileExW(LPCWSTR pattern, FINDEX_INFO_LEVELS level, void* data, FINDEX_SEARCH_OPS op, void* filter, DWORD flags);
+HANDLE FindFirstFileW(LPCWSTR pattern, WIN32_FIND_DATAW* data);
+BOOL FindNextFileW(HANDLE h, WIN32_FIND_DATAW* data);
+BOOL FindClose(HANDLE h);
+
+// Change notifications over inotify: the handle is signaled once anything in the folder changed
+#define FILE_NOTIFY_CHANGE_FILE_NAME 0x001
+#define FILE_NOTIFY_CHANGE_DIR_NAME 0x002
+#define FILE_NOTIFY_CHANGE_ATTRIBUTES 0x004
+#define FILE_NOTIFY_CHANGE_SIZE 0x008
+#define FILE_NOTIFY_CHANGE_LAST_WRITE 0x010
+#define FILE_NOTIFY_CHANGE_CREATION 0x040
+HANDLE FindFirstChangeNotificationW(LPCWSTR dir, BOOL subtree, DWORD filter);
+BOOL FindNextChangeNotification(HANDLE h);
+BOOL FindCloseChangeNotification(HANDLE h);
+
+// ---- Synchronization and threads ----
+#define WAIT_OBJECT_0 0
+#define WAIT_TIMEOUT 258
+HANDLE CreateEventW(void* sa, BOOL manualReset, BOOL initialState, LPCWSTR name);
+BOOL SetEvent(HANDLE h);
+BOOL ResetEvent(HANDLE h);
+DWORD WaitForSingleObject(HANDLE h, DWORD ms);
+
+#define InterlockedIncrement(p) __atomic_add_fetch((p), 1, __ATOMIC_SEQ_CST)
+#define InterlockedDecrement(p) __atomic_sub_fetch((p), 1, __ATOMIC_SEQ_CST)
+#define InterlockedExchange(p, v) __atomic_exchange_n((p), (v), __ATOMIC_SEQ_CST)
+#define InterlockedExchangeAdd64(p, v) __atomic_fetch_add((p), (v), __ATOMIC_SEQ_CST)
+LONG InterlockedCompareExchange(volatile LONG* p, LONG exchange, LONG comparand);
+
+typedef struct SLIST_ENTRY {
+    struct SLIST_ENTRY* Next;
+} SLIST_ENTRY, *PSLIST_ENTRY;
+typedef struct SLIST_HEADER {
+    PSLIST_ENTRY head;
+} SLIST_HEADER, *PSLIST_HEADER;
+void InitializeSListHead(PSLIST_HEADER h);
+PSLIST_ENTRY InterlockedPushEntrySList(PSLIST_HEADER h, PSLIST_ENTRY e);
+PSLIST_ENTRY InterlockedFlushSList(PSLIST_HEADER h);
+
+// Thread pool: every submitted callback runs on its own detached thread
+typedef struct TP_CALLBACK_INSTANCE* PTP_CALLBACK_INSTANCE;
+typedef struct TP_POOL* PTP_POOL;
+typedef struct TP_CALLBACK_ENVIRON { PTP_POOL pool; } TP_CALLBACK_ENVIRON, *PTP_CALLBACK_ENVIRON;
+typedef VOID (CALLBACK *PTP_SIMPLE_CALLBACK)(PTP_CALLBACK_INSTANCE instance, PVOID context);
+BOOL TrySubmitThreadpoolCallback(PTP_SIMPLE_CALLBACK cb, PVOID context, PTP_CALLBACK_ENVIRON env);
+BOOL CallbackMayRunLong(PTP_CALLBACK_INSTANCE instance);
+PTP_POOL CreateThreadpool(PVOID reserved);
+void SetThreadpoolThreadMaximum(PTP_POOL pool, DWORD max);
+void InitializeThreadpoolEnvironment(PTP_CALLBACK_ENVIRON env);
+void SetThreadpoolCallbackPool(PTP_CALLBACK_ENVIRON env, PTP_POOL pool);
+
+// ---- Process ----
+DWORD GetModuleFileNameW(HMODULE module, LPWSTR out, DWORD cch);
+// Double-NUL terminated NAME=value block of the process environment
+LPWSTR GetEnvironmentStringsW(void);
+BOOL FreeEnvironmentStringsW(LPWSTR env);
+void OutputDebugStringW(LPCWSTR s);
+
+// ---- shlobj ----
+#define ERROR_SUCCESS 0
+#define ERROR_ALREADY_EXISTS 183
+int SHCreateDirectoryExW(HWND hwnd, LPCWSTR path, void* sa);
+// CSIDL_LOCAL_APPDATA only, taken from $LOCALAPPDATA; fails when it is not set
+#define CSIDL_LOCAL_APPDATA 0x001c
+#define SHGFP_TYPE_CURRENT 0
+#define E_FAIL ((HRESULT)0x80004005L)
+HRESULT SHGetFolderPathW(HWND hwnd, int csidl, HANDLE token, DWORD flags, LPWSTR path);
+
+// ---- shlwapi ----
+LPWSTR PathCombineW(LPWSTR out, LPCWSTR dir, LPCWSTR file);
+BOOL PathAppendW(LPWSTR path, LPCWSTR more);
+BOOL PathRemoveFileSpecW(LPWSTR path);
+LPWSTR PathFindFileNameW(LPCWSTR path);
+BOOL PathFileExistsW(LPCWSTR path);
+// X:\ and \\server\share roots; host paths have no drive, so they are left whole (drive-type
+// rules can then target a test folder)
+BOOL PathStripToRootW(LPWSTR path);
+
+#ifdef __cplusplus
+}
+#endif
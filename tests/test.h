@@ -0,0 +1,71 @@
+#pragma once
+// Minimal test and benchmark helpers for the host build (see tests/CMakeLists.txt)
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static int g_testFailures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); g_testFailures++; } \
+} while (0)
+
+#define CHECK_EQ_INT(a, b) do { \
+    long long _a = (long long)(a), _b = (long long)(b); \
+    if (_a != _b) { fprintf(stderr, "%s:%d: %s == %s failed: %lld != %lld\n", __FILE__, __LINE__, #a, #b, _a, _b); g_testFailures++; } \
+} while (0)
+
+#define CHECK_EQ_WSTR(a, b) do { \
+    const WCHAR* _a = (a); const WCHAR* _b = (b); \
+    if (!_a || !_b || lstrcmpW(_a, _b) != 0) { \
+        char _sa[512], _sb[512]; \
+        shim_to_utf8(_a ? _a : L"(null)", _sa, sizeof(_sa)); shim_to_utf8(_b ? _b : L"(null)", _sb, sizeof(_sb)); \
+        fprintf(stderr, "%s:%d: %s == %s failed: \"%s\" != \"%s\"\n", __FILE__, __LINE__, #a, #b, _sa, _sb); g_testFailures++; \
+    } \
+} while (0)
+
+#define RUN_TEST(fn) do { int _before = g_testFailures; fn(); printf("%s %s\n", _before == g_testFailures ? "ok  " : "FAIL", #fn); } while (0)
+
+static inline int test_summary(void) {
+    if (g_testFailures) fprintf(stderr, "%d check(s) failed\n", g_testFailures);
+    return g_testFailures ? 1 : 0;
+}
+
+static inline double test_now_ms(void) {
+    LARGE_INTEGER t, f;
+    QueryPerformanceCounter(&t);
+    QueryPerformanceFrequency(&f);
+    return (double)t.QuadPart * 1000.0 / (double)f.QuadPart;
+}
+
+// Benchmarks take --quick (used by ctest) to run a single short iteration per configuration
+static inline int bench_quick(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) if (!strcmp(argv[i], "--quick")) return 1;
+    return 0;
+}
+
+// Fresh scratch directory under the build tree's temp folder; returns its path
+static inline const char* test_temp_dir(const char* name) {
+    static char path[512];
+    const char* base = getenv("TMPDIR");
+    snprintf(path, sizeof(path), "%s/winmac_%s_%d", base && base[0] ? base : "/tmp", name, (int)getpid());
+    char cmd[600];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s' && mkdir -p '%s'", path, path);
+    if (system(cmd) != 0) return NULL;
+    return path;
+}
+
+static inline void test_remove_dir(const char* path) {
+    char cmd[600];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", path);
+    if (system(cmd) != 0) fprintf(stderr, "could not remove %s\n", path);
+}
+
+static inline BOOL test_write_file(const char* path, const void* data, size_t len) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return FALSE;
+    BOOL ok = fwrite(data, 1, len, f) == len;
+    return fclose(f) == 0 && ok;
+}
@@ -0,0 +1,111 @@
+// Command dispatch table: registration, replacement, growth, session reset and rolling back to a mark
+#include "test.h"
+#include "actions.h"
+
+static void test_empty_and_disabled(void) {
+    actions_reset(NULL);
+    CHECK(actions_find(1) == NULL);
+    CHECK(actions_add(1, MA_OPEN_FILE, L"x") == NULL); // no arena: registration disabled
+    CHECK(actions_find(1) == NULL);
+}
+
+static void test_add_find_replace(void) {
+    Arena arena = {0};
+    actions_reset(&arena);
+    WCHAR path[] = L"C:\\Tools\\a.exe";
+    MenuAction* a = actions_add(100, MA_OPEN_FILE, path);
+    CHECK(a != NULL);
+    a->params = L"--flag";
+    a->hwnd = (HWND)(ULONG_PTR)0x1234;
+    path[0] = L'D'; // the path is copied into the arena
+    const MenuAction* f = actions_find(100);
+    CHECK(f == a);
+    CHECK_EQ_INT(f->kind, MA_OPEN_FILE);
+    CHECK_EQ_WSTR(f->path, L"C:\\Tools\\a.exe");
+    CHECK_EQ_WSTR(f->params, L"--flag");
+
+    MenuAction* b = actions_add(100, MA_TASKKILL, NULL); // same id: replaced in place, payload cleared
+    CHECK(b == a);
+    CHECK_EQ_INT(b->kind, MA_TASKKILL);
+    CHECK_EQ_WSTR(b->path, L"");
+    CHECK(b->params == NULL);
+    CHECK_EQ_INT(b->arg, 0);
+    CHECK(b->hwnd == NULL);
+    CHECK(actions_find(101) == NULL);
+
+    actions_reset(&arena);
+    CHECK(actions_find(100) == NULL);
+    actions_reset(NULL);
+    arena_free(&arena);
+}
+
+// Ids that share low bits (a stride of the table size) still resolve once the index has grown
+static void test_growth_and_collisions(void) {
+    Arena arena = {0};
+    actions_reset(&arena);
+    const UINT n = 20000;
+    for (UINT i = 0; i < n; ++i) {
+        MenuAction* a = actions_add(i * 256, MA_POWER, NULL);
+        CHECK(a != NULL);
+        if (a) a->arg = i;
+    }
+    UINT found = 0;
+    for (UINT i = 0; i < n; ++i) {
+        const MenuAction* a = actions_find(i * 256);
+        if (a && a->arg == i && a->id == i * 256) found++;
+        if (actions_find(i * 256 + 1)) found = 0;
+    }
+    CHECK_EQ_INT(found, n);
+    actions_reset(NULL);
+    arena_free(&arena);
+}
+
+// A warm menu regenerates its Recent and Force Quit popups over and over: each round rolls the
+// table and the arena back to the mark, so memory stays flat and the built menu's actions survive
+static void test_mark_rollback(void) {
+    Arena arena = {0};
+    actions_reset(&arena);
+    WCHAR path[32];
+    for (UINT id = 1; id <= 100; ++id) {
+        wsprintfW(path, L"p%u", id);
+        actions_add(id, MA_OPEN_ITEM, path);
+    }
+    ArenaMark mark = arena_mark(&arena);
+    actions_mark();
+    ShimAllocStats a0 = {0}, a1;
+    for (int round = 0; round < 20; ++round) {
+        actions_rollback();
+        arena_reset_to(&arena, mark);
+        for (UINT id = 50; id <= 60; ++id) actions_add(id, MA_RECENT_OPEN, L"recent");
+        for (UINT id = 1000; id <= 1200; ++id) actions_add(id, MA_TASKKILL, NULL); // grows the index
+        if (round == 1) shim_alloc_stats(&a0);
+    }
+    shim_alloc_stats(&a1);
+    CHECK_EQ_INT(a1.liveBytes, a0.liveBytes);
+    const MenuAction* a = actions_find(55);
+    CHECK(a && a->kind == MA_RECENT_OPEN);
+    CHECK(actions_find(1200) != NULL);
+    CHECK_EQ_WSTR(actions_find(20)->path, L"p20");
+
+    actions_rollback();
+    arena_reset_to(&arena, mark);
+    UINT intact = 0;
+    for (UINT id = 1; id <= 100; ++id) {
+        wsprintfW(path, L"p%u", id);
+        a = actions_find(id);
+        if (a && a->kind == MA_OPEN_ITEM && !lstrcmpW(a->path, path)) intact++;
+    }
+    CHECK_EQ_INT(intact, 100);
+    CHECK(actions_find(1000) == NULL);
+    CHECK(actions_find(1200) == NULL);
+    actions_reset(NULL);
+    arena_free(&arena);
+}
+
+int main(void) {
+    RUN_TEST(test_empty_and_disabled);
+    RUN_TEST(test_add_find_replace);
+    RUN_TEST(test_growth_and_collisions);
+    RUN_TEST(test_mark_rollback);
+    return test_summary();
+}
@@ -0,0 +1,154 @@
+// Session arena: alignment, chunking, growable tables, reset/free, marks, and a 100k-entry menu stress run
+#include "test.h"
+#include "arena.h"
+#include "actions.h"
+#include <stdint.h>
+
+static void test_alloc_alignment_and_zeroing(void) {
+    Arena a = {0};
+    a.chunkSize = 256;
+    for (int i = 1; i < 100; ++i) {
+        BYTE* p = (BYTE*)arena_alloc(&a, (SIZE_T)i);
+        CHECK(p != NULL && ((uintptr_t)p & 15) == 0);
+        BOOL zero = TRUE;
+        for (int k = 0; k < i; ++k) if (p[k]) zero = FALSE;
+        CHECK(zero);
+        memset(p, 0xAB, (size_t)i);
+    }
+    // Larger than a chunk: gets a dedicated chunk of its own size
+    BYTE* big = (BYTE*)arena_alloc(&a, 10000);
+    CHECK(big != NULL);
+    CHECK(a.bytesReserved >= 10000);
+    CHECK(arena_alloc(NULL, 16) == NULL);
+    CHECK_EQ_WSTR(arena_wcsdup(&a, L"path"), L"path");
+    CHECK_EQ_WSTR(arena_wcsdup(&a, NULL), L"");
+    arena_free(&a);
+    CHECK(a.head == NULL);
+    CHECK_EQ_INT(a.bytesReserved, 0);
+}
+
+static void test_grow_keeps_contents(void) {
+    Arena a = {0};
+    UINT* table = NULL;
+    UINT count = 0, cap = 0;
+    for (UINT i = 0; i < 1000; ++i) {
+        if (count == cap) {
+            UINT* grown = (UINT*)arena_grow(&a, table, count, &cap, sizeof(UINT));
+            CHECK(grown != NULL);
+            table = grown;
+        }
+        table[count++] = i * 7;
+    }
+    CHECK_EQ_INT(cap, 1024); // 64 doubling
+    BOOL intact = TRUE;
+    for (UINT i = 0; i < count; ++i) if (table[i] != i * 7) intact = FALSE;
+    CHECK(intact);
+    arena_free(&a);
+}
+
+static void test_reset_keeps_first_chunk(void) {
+    Arena a = {0};
+    a.chunkSize = 1024;
+    ShimAllocStats s0, s1, s2;
+    shim_alloc_stats(&s0);
+    for (int i = 0; i < 100; ++i) arena_alloc(&a, 100);
+    shim_alloc_stats(&s1);
+    CHECK(s1.allocs - s0.allocs > 1);
+    arena_reset(&a);
+    CHECK_EQ_INT(a.bytesUsed, 0);
+    CHECK_EQ_INT(a.bytesReserved, 1024);
+    // The kept chunk serves the next session without new heap calls
+    arena_alloc(&a, 512);
+    shim_alloc_stats(&s2);
+    CHECK_EQ_INT(s2.allocs - s1.allocs, 0);
+    arena_free(&a);
+    shim_alloc_stats(&s2);
+    CHECK_EQ_INT(s2.liveBytes, s0.liveBytes);
+}
+
+static void test_reset_to_mark(void) {
+    Arena a = {0};
+    a.chunkSize = 1024;
+    ArenaMark empty = arena_mark(&a);
+    BYTE* keep = (BYTE*)arena_alloc(&a, 100);
+    memset(keep, 0x5A, 100);
+    ArenaMark m = arena_mark(&a);
+    SIZE_T used = a.bytesUsed, reserved = a.bytesReserved;
+    ShimAllocStats s0, s1;
+    shim_alloc_stats(&s0);
+    for (int round = 0; round < 10; ++round) {
+        arena_reset_to(&a, m);
+        CHECK_EQ_INT(a.bytesUsed, used);
+        BYTE* p = (BYTE*)arena_alloc(&a, 64);
+        CHECK(p == keep + 112); // the same memory again, right after the kept block
+        for (int i = 0; i < 40; ++i) arena_alloc(&a, 100); // spills into new chunks
+    }
+    arena_reset_to(&a, m);
+    shim_alloc_stats(&s1);
+    CHECK_EQ_INT(a.bytesReserved, reserved);
+    CHECK_EQ_INT(s1.liveBytes, s0.liveBytes);
+    BOOL intact = TRUE;
+    for (int i = 0; i < 100; ++i) if (keep[i] != 0x5A) intact = FALSE;
+    CHECK(intact);
+    arena_reset_to(&a, empty); // a mark of the empty arena resets it
+    CHECK_EQ_INT(a.bytesUsed, 0);
+    arena_free(&a);
+}
+
+// One menu session over 100k synthetic folder entries, as fill_menu_with_folder records them:
+// item data path, dispatch action, icon and bitmap table rows. Nothing may be dropped and
+// the whole session must go back to the heap in one release.
+typedef struct { UINT id; void* h; } Row;
+
+static void test_stress_100k(void) {
+    const UINT n = 100000;
+    Arena session = {0};
+    ShimAllocStats s0, s1, s2;
+    shim_alloc_stats(&s0);
+    for (int round = 0; round < 2; ++round) { // the second round reuses the chunk kept by arena_reset
+        double t0 = test_now_ms();
+        actions_reset(&session);
+        Row* icons = NULL; Row* bmps = NULL;
+        UINT iconCount = 0, iconCap = 0, bmpCount = 0, bmpCap = 0, dropped = 0;
+        for (UINT i = 0; i < n; ++i) {
+            WCHAR path[64];
+            wsprintfW(path, L"C:\\Stress\\Folder%u\\file%u.txt", i / 1000, i);
+            UINT id = 5000 + i;
+            const WCHAR* data = arena_wcsdup(&session, path);
+            if (!data || !actions_add(id, MA_OPEN_ITEM, path)) dropped++;
+            if (iconCount == iconCap) icons = (Row*)arena_grow(&session, icons, iconCount, &iconCap, sizeof(Row));
+            if (bmpCount == bmpCap) bmps = (Row*)arena_grow(&session, bmps, bmpCount, &bmpCap, sizeof(Row));
+            if (!icons || !bmps) { dropped++; break; }
+            icons[iconCount++] = (Row){ id, (void*)data };
+            bmps[bmpCount++] = (Row){ id, NULL };
+        }
+        double buildMs = test_now_ms() - t0;
+        shim_alloc_stats(&s1);
+        CHECK_EQ_INT(dropped, 0);
+        CHECK_EQ_INT(iconCount, n);
+        CHECK_EQ_INT(bmpCount, n);
+        UINT found = 0;
+        for (UINT i = 0; i < n; i += 7) {
+            const MenuAction* act = actions_find(5000 + i);
+            if (act && !lstrcmpW(act->path, (const WCHAR*)icons[i].h)) found++;
+        }
+        CHECK_EQ_INT(found, (n + 6) / 7);
+        printf("  round %d: %u entries in %.1f ms, %.1f MB used / %.1f MB reserved, %lu heap allocs\n", round, n, buildMs,
+               session.bytesUsed / 1048576.0, session.bytesReserved / 1048576.0, (unsigned long)(s1.allocs - s0.allocs));
+        actions_reset(NULL);
+        arena_reset(&session);
+        shim_alloc_stats(&s0);
+    }
+    arena_free(&session);
+    shim_alloc_stats(&s2);
+    CHECK_EQ_INT(s2.allocs - s2.frees, 0);
+}
+
+int main(void) {
+    RUN_TEST(test_alloc_alignment_and_zeroing);
+    RUN_TEST(test_grow_keeps_contents);
+    RUN_TEST(test_reset_keeps_first_chunk);
+    RUN_TEST(test_reset_to_mark);
+    RUN_TEST(test_stress_100k);
+    return test_summary();
+}
@@ -0,0 +1,106 @@
+// Config snapshot: config_load_cached re-parses only when the INI actually changed
+#include "test.h"
+#include "config.h"
+#include "ini_win32.h"
+#include <sys/stat.h>
+#include <sys/time.h>
+
+static const char k_ini[] =
+    "[General]\r\n"
+    "RunInBackground=false\r\n"
+    "ShowHidden=true\r\n"
+    "[RecentItems]\r\n"
+    "RecentMax=7\r\n"
+    "[Menu]\r\n"
+    "Item1=Settings|URI|ms-settings:\r\n"
+    "Item2=---\r\n"
+    "Item3=Docs|FOLDER|C:\\Docs|submenu\r\n";
+
+static char g_iniPath[512];
+
+static void write_ini(const char* text) {
+    CHECK(test_write_file(g_iniPath, text, strlen(text)));
+}
+
+// Moves the INI's write time by seconds so "touched" is visible at any timestamp granularity
+static void shift_mtime(int seconds) {
+    struct stat st;
+    CHECK(stat(g_iniPath, &st) == 0);
+    struct timeval tv[2] = { { st.st_atime, 0 }, { st.st_mtime + seconds, 0 } };
+    CHECK(utimes(g_iniPath, tv) == 0);
+}
+
+static void test_parse_defaults(void) {
+    IniFile* ini = ini_parse(NULL, 0);
+    Config* cfg = (Config*)calloc(1, sizeof(Config));
+    config_parse(cfg, ini);
+    CHECK(cfg->runInBackground);
+    CHECK_EQ_INT(cfg->recentMax, 12);
+    CHECK_EQ_INT(cfg->folderMaxDepth, 4);
+    CHECK_EQ_INT(cfg->maxItems, 40);
+    CHECK_EQ_INT(cfg->sortField, SORT_NAME);
+    CHECK(cfg->sortFoldersFirst);
+    CHECK_EQ_INT(cfg->count, 0);
+    ini_free(ini);
+    free(cfg);
+}
+
+static void test_parse_items(void) {
+    IniFile* ini = ini_parse((const BYTE*)k_ini, (DWORD)strlen(k_ini));
+    Config* cfg = (Config*)calloc(1, sizeof(Config));
+    config_parse(cfg, ini);
+    CHECK(!cfg->runInBackground);
+    CHECK(cfg->showHidden);
+    CHECK_EQ_INT(cfg->recentMax, 7);
+    CHECK_EQ_INT(cfg->count, 3);
+    CHECK_EQ_INT(cfg->items[0].type, CI_URI);
+    CHECK_EQ_WSTR(cfg->items[0].label, L"Settings");
+    CHECK_EQ_WSTR(cfg->items[0].path, L"ms-settings:");
+    CHECK_EQ_INT(cfg->items[1].type, CI_SEPARATOR);
+    CHECK_EQ_INT(cfg->items[2].type, CI_FOLDER);
+    CHECK(cfg->items[2].submenu);
+    ini_free(ini);
+    free(cfg);
+}
+
+static void test_load_cached(void) {
+    Config* cfg = (Config*)calloc(1, sizeof(Config));
+    write_ini(k_ini);
+    CHECK(config_load_cached(cfg));              // first load builds the snapshot
+    CHECK_EQ_INT(cfg->recentMax, 7);
+    CHECK(!config_load_cached(cfg));             // nothing changed
+    CHECK(!config_load_cached(cfg));
+
+    write_ini(k_ini);                            // rewritten with identical bytes
+    shift_mtime(10);
+    CHECK(!config_load_cached(cfg));
+    CHECK_EQ_INT(cfg->recentMax, 7);
+
+    char changed[sizeof(k_ini) + 16];
+    strcpy(changed, k_ini);
+    changed[strstr(changed, "RecentMax=7") - changed + 10] = '9';
+    write_ini(changed);
+    shift_mtime(20);
+    CHECK(config_load_cached(cfg));              // same size, different content
+    CHECK_EQ_INT(cfg->recentMax, 9);
+    CHECK(!config_load_cached(cfg));
+    free(cfg);
+}
+
+int main(void) {
+    const char* dir = test_temp_dir("config");
+    CHECK(dir != NULL);
+    if (!dir) return test_summary();
+    char keep[512];
+    snprintf(keep, sizeof(keep), "%s", dir);
+    snprintf(g_iniPath, sizeof(g_iniPath), "%s/config.ini", keep);
+    WCHAR wpath[512];
+    shim_from_utf8(g_iniPath, wpath, ARRAYSIZE(wpath));
+    config_set_default_path(wpath);
+
+    RUN_TEST(test_parse_defaults);
+    RUN_TEST(test_parse_items);
+    RUN_TEST(test_load_cached);
+    test_remove_dir(keep);
+    return test_summary();
+}
@@ -0,0 +1,213 @@
+// Compiled config sidecar: parse -> write image -> load image equals the direct parse, stale or
+// damaged images are refused, and config_load takes a current image without reading the INI
+#include "test.h"
+#include "config.h"
+#include "configbin.h"
+#include "ini_win32.h"
+#include <sys/stat.h>
+#include <sys/time.h>
+
+static const char k_ini[] =
+    "[General]\r\n"
+    "RunInBackground=true\r\n"
+    "ShowHidden=true\r\n"
+    "MaxItems=25\r\n"
+    "DefaultIcon=C:\\Icons\\default.ico\r\n"
+    "[RecentItems]\r\n"
+    "RecentMax=7\r\n"
+    "[TaskKill]\r\n"
+    "TaskKillExcludes=Calculator,Settings\r\n"
+    "[Menu]\r\n"
+    "Item1=Settings|URI|ms-settings:\r\n"
+    "Item2=---\r\n"
+    "Item3=Docs|FOLDER|C:\\Docs|submenu\r\n"
+    "Item4=Tools|FOLDER|C:\\Tools|inline,noheader\r\n"
+    "Item5=Power|POWER_MENU\r\n"
+    "Item6=Force Quit|TASKKILL||5,true\r\n"
+    "Item7=Notepad|FILE|notepad.exe|--flag\r\n";
+
+static char g_dir[512];
+
+static Config* parse_text(const char* text) {
+    IniFile* ini = ini_parse((const BYTE*)text, (DWORD)strlen(text));
+    Config* cfg = (Config*)calloc(1, sizeof(Config));
+    config_parse(cfg, ini);
+    ini_free(ini);
+    cfg->iniSize = strlen(text);
+    cfg->iniWriteTime.dwLowDateTime = 0x12345678;
+    cfg->iniWriteTime.dwHighDateTime = 0x01DA0000;
+    cfg->iniHash = 0xCAFEF00D;
+    return cfg;
+}
+
+static void test_round_trip(void) {
+    Config* parsed = parse_text(k_ini);
+    CHECK_EQ_INT(parsed->count, 7);
+    char bin[600];
+    snprintf(bin, sizeof(bin), "%s/roundtrip.bin", g_dir);
+    WCHAR wbin[600];
+    shim_from_utf8(bin, wbin, ARRAYSIZE(wbin));
+    CHECK(configbin_write(wbin, parsed, 42));
+
+    Config* loaded = (Config*)calloc(1, sizeof(Config));
+    CHECK(configbin_read(wbin, parsed->iniSize, &parsed->iniWriteTime, 42, loaded));
+    CHECK(memcmp(parsed, loaded, sizeof(Config)) == 0);
+    CHECK_EQ_INT(loaded->count, 7);
+    CHECK_EQ_WSTR(loaded->items[6].params, L"--flag");
+    CHECK_EQ_WSTR(loaded->taskKillExcludes, L"Calculator,Settings");
+    CHECK_EQ_INT(loaded->iniHash, 0xCAFEF00D);
+
+    // An empty menu round-trips too
+    Config* empty = parse_text("[General]\r\nRecentMax=3\r\n");
+    CHECK(configbin_write(wbin, empty, 42));
+    Config* back = (Config*)calloc(1, sizeof(Config));
+    CHECK(configbin_read(wbin, empty->iniSize, &empty->iniWriteTime, 42, back));
+    CHECK(memcmp(empty, back, sizeof(Config)) == 0);
+    free(back);
+    free(empty);
+    free(loaded);
+    free(parsed);
+}
+
+static BYTE* read_all(const char* path, size_t* len) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    *len = (size_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    BYTE* data = (BYTE*)malloc(*len + 16);
+    *len = fread(data, 1, *len, f);
+    fclose(f);
+    return data;
+}
+
+// Refused images leave cfg exactly as it was
+static BOOL refused(const WCHAR* wbin, ULONGLONG size, const FILETIME* ft, DWORD context) {
+    Config* cfg = (Config*)malloc(sizeof(Config));
+    memset(cfg, 0x5A, sizeof(Config));
+    BOOL ok = configbin_read(wbin, size, ft, context, cfg);
+    BOOL untouched = TRUE;
+    for (size_t i = 0; i < sizeof(Config); ++i) if (((BYTE*)cfg)[i] != 0x5A) { untouched = FALSE; break; }
+    free(cfg);
+    return !ok && untouched;
+}
+
+static void test_rejects(void) {
+    Config* parsed = parse_text(k_ini);
+    char bin[600], bad[600];
+    snprintf(bin, sizeof(bin), "%s/stamp.bin", g_dir);
+    snprintf(bad, sizeof(bad), "%s/bad.bin", g_dir);
+    WCHAR wbin[600], wbad[600];
+    shim_from_utf8(bin, wbin, ARRAYSIZE(wbin));
+    shim_from_utf8(bad, wbad, ARRAYSIZE(wbad));
+    CHECK(configbin_write(wbin, parsed, 42));
+
+    FILETIME later = parsed->iniWriteTime;
+    later.dwLowDateTime++;
+    CHECK(refused(wbin, parsed->iniSize + 1, &parsed->iniWriteTime, 42));
+    CHECK(refused(wbin, parsed->iniSize, &later, 42));
+    CHECK(refused(wbin, parsed->iniSize, &parsed->iniWriteTime, 43));
+    CHECK(refused(wbad, parsed->iniSize, &parsed->iniWriteTime, 42)); // missing
+
+    size_t len = 0;
+    BYTE* image = read_all(bin, &len);
+    CHECK(image != NULL && len > sizeof(ConfigBinHeader));
+    test_write_file(bad, image, len - 1);                     // truncated
+    CHECK(refused(wbad, parsed->iniSize, &parsed->iniWriteTime, 42));
+    image[len] = 0;
+    test_write_file(bad, image, len + 1);                     // trailing bytes
+    CHECK(refused(wbad, parsed->iniSize, &parsed->iniWriteTime, 42));
+    test_write_file(bad, image, sizeof(ConfigBinHeader) - 1); // shorter than a header
+    CHECK(refused(wbad, parsed->iniSize, &parsed->iniWriteTime, 42));
+    ConfigBinHeader* h = (ConfigBinHeader*)image;
+    h->version = CONFIGBIN_VERSION - 1;
+    test_write_file(bad, image, len);
+    CHECK(refused(wbad, parsed->iniSize, &parsed->iniWriteTime, 42));
+    h->version = CONFIGBIN_VERSION;
+    h->itemCount = 65;
+    test_write_file(bad, image, len);
+    CHECK(refused(wbad, parsed->iniSize, &parsed->iniWriteTime, 42));
+    free(image);
+    free(parsed);
+}
+
+static int count_entries(const char* dir) {
+    char cmd[700];
+    snprintf(cmd, sizeof(cmd), "ls -A '%s' | wc -l", dir);
+    FILE* p = popen(cmd, "r");
+    int n = -1;
+    if (p) { if (fscanf(p, "%d", &n) != 1) n = -1; pclose(p); }
+    return n;
+}
+
+// config_load end to end: the image lives under %LOCALAPPDATA%, a current one is taken without
+// opening the INI (no allocation at all), and any change to the INI's stamp goes back to parsing
+static void test_config_load(void) {
+    char iniDir[600], ini[700], appdata[600];
+    snprintf(iniDir, sizeof(iniDir), "%s/inidir", g_dir);
+    snprintf(ini, sizeof(ini), "%s/config.ini", iniDir);
+    snprintf(appdata, sizeof(appdata), "%s/appdata", g_dir);
+    mkdir(iniDir, 0755);
+    mkdir(appdata, 0755);
+    setenv("LOCALAPPDATA", appdata, 1);
+    test_write_file(ini, k_ini, strlen(k_ini));
+    WCHAR wini[700];
+    shim_from_utf8(ini, wini, ARRAYSIZE(wini));
+    config_set_default_path(wini);
+
+    Config* parsed = (Config*)calloc(1, sizeof(Config));
+    CHECK(config_load(parsed));
+    CHECK_EQ_INT(parsed->count, 7);
+    CHECK_EQ_INT(count_entries(iniDir), 1); // nothing written next to the INI
+    char sidecarDir[700];
+    snprintf(sidecarDir, sizeof(sidecarDir), "%s/WinMacMenu", appdata);
+    CHECK_EQ_INT(count_entries(sidecarDir), 1);
+
+    Config* loaded = (Config*)calloc(1, sizeof(Config));
+    ShimAllocStats a0, a1;
+    shim_alloc_stats(&a0);
+    CHECK(config_load(loaded));
+    shim_alloc_stats(&a1);
+    CHECK_EQ_INT(a1.allocs - a0.allocs, 0);
+    // Same snapshot, including the watch generation: writing the image did not signal the INI folder
+    CHECK(memcmp(parsed, loaded, sizeof(Config)) == 0);
+    CHECK(!config_load_cached(loaded));
+
+    // Edited INI: new stamp, so the image is stale and the INI is parsed again
+    char edited[sizeof(k_ini) + 64];
+    snprintf(edited, sizeof(edited), "%sItem8=Extra|URI|https://example.com\r\n", k_ini);
+    test_write_file(ini, edited, strlen(edited));
+    struct timeval tv[2] = { { 1700000000, 0 }, { 1700000000, 0 } };
+    utimes(ini, tv);
+    Config* fresh = (Config*)calloc(1, sizeof(Config));
+    shim_alloc_stats(&a0);
+    CHECK(config_load(fresh));
+    shim_alloc_stats(&a1);
+    CHECK(a1.allocs > a0.allocs);
+    CHECK_EQ_INT(fresh->count, 8);
+
+    // Touched only (same size, new write time): parsed again, then the refreshed image is used
+    tv[0].tv_sec = tv[1].tv_sec = 1700000100;
+    utimes(ini, tv);
+    CHECK(config_load(fresh));
+    shim_alloc_stats(&a0);
+    CHECK(config_load(loaded));
+    shim_alloc_stats(&a1);
+    CHECK_EQ_INT(a1.allocs - a0.allocs, 0);
+    CHECK_EQ_INT(loaded->count, 8);
+    unsetenv("LOCALAPPDATA");
+    free(fresh);
+    free(loaded);
+    free(parsed);
+}
+
+int main(void) {
+    const char* dir = test_temp_dir("configbin");
+    if (!dir) return 1;
+    snprintf(g_dir, sizeof(g_dir), "%s", dir);
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_rejects);
+    RUN_TEST(test_config_load);
+    test_remove_dir(g_dir);
+    return test_summary();
+}
@@ -0,0 +1,141 @@
+// Folder listing cache: hits, invalidation by the change watch, changes racing the enumeration,
+// LRU bounds, the no-watch fallback and folders on removable or network volumes
+#include "test.h"
+#include "dircache.h"
+#include <sys/stat.h>
+
+static char g_root[512];
+
+static void add_file(const char* dir, const char* name) {
+    char path[800];
+    snprintf(path, sizeof(path), "%s/%s/%s", g_root, dir, name);
+    test_write_file(path, "x", 1);
+}
+
+static void make_dir(const char* dir, WCHAR* wide, int cch) {
+    char path[700];
+    snprintf(path, sizeof(path), "%s/%s", g_root, dir);
+    mkdir(path, 0755);
+    shim_from_utf8(path, wide, cch);
+}
+
+static void test_hit_and_invalidate(void) {
+    ListingOptions opt = {0};
+    WCHAR dir[700];
+    make_dir("docs", dir, ARRAYSIZE(dir));
+    add_file("docs", "a.txt");
+    DirCacheStats s0, s1;
+    dircache_get_stats(&s0);
+    CHECK(dircache_lookup(dir, &opt) == NULL);
+    FolderListing* lst = listing_enumerate(dir, &opt);
+    CHECK(lst != NULL && lst->watch != INVALID_HANDLE_VALUE);
+    CHECK(dircache_insert(lst));
+    CHECK(lst->watch == INVALID_HANDLE_VALUE); // taken over by the cache entry
+    CHECK(dircache_lookup(dir, &opt) == lst);
+    ListingOptions other = opt;
+    other.sortDescending = TRUE;
+    CHECK(!dircache_contains(dir, &other)); // keyed by options too
+
+    add_file("docs", "b.txt");
+    CHECK(dircache_lookup(dir, &opt) == NULL);
+    dircache_get_stats(&s1);
+    CHECK_EQ_INT(s1.hits - s0.hits, 1);
+    CHECK_EQ_INT(s1.misses - s0.misses, 2);
+    CHECK_EQ_INT(s1.invalidations - s0.invalidations, 1);
+    CHECK_EQ_INT(lst->count, 1); // retired, still valid until the session ends
+    dircache_end_session();
+}
+
+// A change after the watch was opened but before the insert must keep the listing out of the cache
+static void test_change_during_enumeration(void) {
+    ListingOptions opt = {0};
+    WCHAR dir[700];
+    make_dir("racy", dir, ARRAYSIZE(dir));
+    add_file("racy", "a.txt");
+    FolderListing* lst = listing_enumerate(dir, &opt);
+    CHECK(lst != NULL);
+    add_file("racy", "late.txt"); // lands after the enumeration, within the same mtime tick
+    CHECK(!dircache_insert(lst));
+    CHECK(!dircache_contains(dir, &opt));
+    listing_free(lst);
+}
+
+static void test_without_watch(void) {
+    ListingOptions opt = {0};
+    FolderListing* lst = listing_begin(L"C:\\NotOnThisHost", &opt);
+    CHECK(listing_finish(lst));
+    CHECK(lst->watch == INVALID_HANDLE_VALUE);
+    CHECK(!dircache_insert(lst)); // no watch and no stamp: never cached
+    listing_free(lst);
+}
+
+// Removable, optical and network folders are enumerated without a watch and never cached
+static void test_removable_not_watched(void) {
+    ListingOptions opt = {0};
+    WCHAR usb[700], share[700], local[700];
+    make_dir("usbstick", usb, ARRAYSIZE(usb));
+    make_dir("netshare", share, ARRAYSIZE(share));
+    make_dir("localdisk", local, ARRAYSIZE(local));
+    add_file("usbstick", "a.txt");
+    shim_set_drive_type("usbstick", DRIVE_REMOVABLE);
+    shim_set_drive_type("netshare", DRIVE_REMOTE);
+    CHECK(!listing_is_cacheable(usb));
+    CHECK(!listing_is_cacheable(share));
+    CHECK(listing_is_cacheable(local));
+    CHECK(!listing_is_cacheable(L"\\\\server\\netshare\\docs"));
+
+    FolderListing* lst = listing_enumerate(usb, &opt);
+    CHECK(lst != NULL && lst->count == 1);
+    CHECK(lst->watch == INVALID_HANDLE_VALUE);
+    CHECK(!dircache_insert(lst));
+    CHECK(!dircache_contains(usb, &opt));
+    listing_free(lst);
+    lst = listing_enumerate(share, &opt);
+    CHECK(lst != NULL && lst->watch == INVALID_HANDLE_VALUE);
+    CHECK(!dircache_insert(lst));
+    listing_free(lst);
+    shim_set_drive_type(NULL, 0);
+}
+
+static void test_lru_bound(void) {
+    ListingOptions opt = {0};
+    dircache_flush();
+    dircache_end_session();
+    WCHAR first[700];
+    char name[32];
+    for (int i = 0; i < 70; ++i) {
+        WCHAR dir[700];
+        snprintf(name, sizeof(name), "lru%02d", i);
+        make_dir(name, dir, ARRAYSIZE(dir));
+        if (i == 0) lstrcpynW(first, dir, ARRAYSIZE(first));
+        FolderListing* lst = listing_enumerate(dir, &opt);
+        if (!dircache_insert(lst)) listing_free(lst);
+        dircache_end_session(); // entries handed out in the open session are never evicted
+    }
+    DirCacheStats s;
+    dircache_get_stats(&s);
+    CHECK_EQ_INT(s.entries, 64);
+    CHECK(s.evictions >= 6);
+    CHECK(!dircache_contains(first, &opt)); // least recently used went first
+    dircache_flush();
+    dircache_end_session();
+}
+
+int main(void) {
+    const char* root = test_temp_dir("dircache");
+    if (!root) return 1;
+    snprintf(g_root, sizeof(g_root), "%s", root);
+    ShimAllocStats before, after;
+    shim_alloc_stats(&before);
+    RUN_TEST(test_hit_and_invalidate);
+    RUN_TEST(test_change_during_enumeration);
+    RUN_TEST(test_without_watch);
+    RUN_TEST(test_removable_not_watched);
+    RUN_TEST(test_lru_bound);
+    dircache_flush();
+    dircache_end_session();
+    shim_alloc_stats(&after);
+    CHECK_EQ_INT(after.liveBytes, before.liveBytes);
+    test_remove_dir(g_root);
+    return test_summary();
+}
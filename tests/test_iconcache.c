@@ -0,0 +1,387 @@
+// Icon cache: LRU eviction that spares icons on screen, the pack written and mapped again across
+// resets, damaged pack files, when pending images are written (threshold, idle, exit), and the
+// menu bitmap pool (reuse across popups, flat memory, theme changes), through a stub renderer
+// whose icons and bitmaps are counted
+#include "test.h"
+#include "iconcache.h"
+
+typedef struct FakeImage { DWORD color; } FakeImage;
+static int g_extracts, g_liveIcons, g_liveBitmaps, g_bitmapsMade;
+static ULONGLONG g_writeTime = 1;
+static char g_appdata[512];
+
+static FakeImage* fake_new(DWORD color) {
+    FakeImage* f = (FakeImage*)malloc(sizeof(FakeImage));
+    f->color = color;
+    return f;
+}
+
+// Each source draws in its own color, so an image read back from the pack can be told apart
+static DWORD color_of(BYTE kind, const WCHAR* source, int size) {
+    return 0xFF000000u | (iconpack_hash(kind, size, FALSE, source) & 0xFFFFFF);
+}
+
+static HICON stub_extract(BYTE kind, const WCHAR* source, int size) {
+    g_extracts++;
+    if (!lstrcmpW(source, L"missing.ico")) return NULL;
+    g_liveIcons++;
+    return (HICON)fake_new(color_of(kind, source, size));
+}
+
+static ULONGLONG stub_write_time(BYTE kind, const WCHAR* source) {
+    (void)source;
+    return kind == IK_FILE ? g_writeTime : 0;
+}
+
+static DWORD* stub_rasterize(HICON icon, int size) {
+    DWORD* px = (DWORD*)LocalAlloc(LMEM_FIXED, (SIZE_T)size * size * sizeof(DWORD));
+    for (int i = 0; px && i < size * size; ++i) px[i] = ((FakeImage*)icon)->color;
+    return px;
+}
+
+static HICON stub_icon_from_pixels(const DWORD* px, int size) {
+    (void)size;
+    g_liveIcons++;
+    return (HICON)fake_new(px[0]);
+}
+
+static HBITMAP stub_bitmap_from_pixels(const DWORD* px, int size) {
+    (void)size;
+    g_liveBitmaps++;
+    g_bitmapsMade++;
+    return (HBITMAP)fake_new(px[0]);
+}
+
+static void stub_destroy_icon(HICON icon) {
+    g_liveIcons--;
+    free(icon);
+}
+
+static void stub_delete_bitmap(HBITMAP bmp) {
+    g_liveBitmaps--;
+    free(bmp);
+}
+
+static const IconRenderer g_stub = {
+    stub_extract, stub_write_time, stub_rasterize, stub_icon_from_pixels, stub_bitmap_from_pixels,
+    stub_destroy_icon, stub_delete_bitmap
+};
+
+static void pack_file(char* out, size_t cch) {
+    snprintf(out, cch, "%s/WinMacMenu/icons.bin", g_appdata);
+}
+
+static BOOL pack_exists(void) {
+    char path[600];
+    pack_file(path, sizeof(path));
+    return access(path, F_OK) == 0;
+}
+
+// Empty cache and no pack file
+static void fresh_cache(void) {
+    iconcache_reset(&g_stub);
+    char path[600];
+    pack_file(path, sizeof(path));
+    unlink(path);
+    g_extracts = 0;
+}
+
+static HICON spec(int i) {
+    WCHAR name[32];
+    wsprintfW(name, L"icon%d.ico", i);
+    return iconcache_lookup(&g_stub, IK_SPEC, name, 16, FALSE);
+}
+
+static void test_hits(void) {
+    fresh_cache();
+    IconCacheStats s0, s1;
+    iconcache_get_stats(&s0);
+    iconcache_session_begin(&g_stub, 1);
+    HICON a = iconcache_lookup(&g_stub, IK_SPEC, L"shell32.dll,3", 16, FALSE);
+    CHECK(a != NULL);
+    CHECK(iconcache_lookup(&g_stub, IK_SPEC, L"SHELL32.DLL,3", 16, FALSE) == a);
+    CHECK(iconcache_lookup(&g_stub, IK_SPEC, L"shell32.dll,3", 16, TRUE) != a); // other theme
+    CHECK(iconcache_lookup(&g_stub, IK_SPEC, L"shell32.dll,3", 24, FALSE) != a); // other size
+    CHECK(iconcache_lookup(&g_stub, IK_SPEC, L"missing.ico", 16, FALSE) == NULL);
+    CHECK(iconcache_lookup(&g_stub, IK_SPEC, L"missing.ico", 16, FALSE) == NULL); // not retried
+    CHECK(iconcache_lookup(&g_stub, IK_SPEC, L"", 16, FALSE) == NULL);
+    CHECK(iconcache_lookup(&g_stub, IK_SPEC, L"a.ico", ICON_MAX_SIZE + 1, FALSE) == NULL);
+    iconcache_session_end(&g_stub);
+    iconcache_get_stats(&s1);
+    CHECK_EQ_INT(g_extracts, 4);
+    CHECK_EQ_INT(s1.hits - s0.hits, 2);
+    CHECK_EQ_INT(s1.misses - s0.misses, 4);
+    CHECK_EQ_INT(s1.entries, 4);
+    CHECK_EQ_INT(s1.pending, 3); // the missing icon has no image
+}
+
+// Shell icons of files follow the file's write time
+static void test_file_changed(void) {
+    fresh_cache();
+    iconcache_session_begin(&g_stub, 1);
+    g_writeTime = 1;
+    HICON a = iconcache_lookup(&g_stub, IK_FILE, L"C:\\Tools\\app.exe", 16, FALSE);
+    CHECK(iconcache_lookup(&g_stub, IK_FILE, L"C:\\Tools\\app.exe", 16, FALSE) == a);
+    g_writeTime = 2;
+    HICON b = iconcache_lookup(&g_stub, IK_FILE, L"C:\\Tools\\app.exe", 16, FALSE);
+    CHECK(b != NULL);
+    CHECK_EQ_INT(g_extracts, 2);
+    iconcache_session_end(&g_stub);
+    IconCacheStats s;
+    iconcache_get_stats(&s);
+    CHECK_EQ_INT(s.entries, 1);
+    CHECK_EQ_INT(g_liveIcons, 1); // the replaced icon was retired until the session ended
+}
+
+static void test_lru_eviction(void) {
+    fresh_cache();
+    iconcache_session_begin(&g_stub, 1);
+    for (int i = 0; i < ICONCACHE_MAX_ENTRIES; ++i) spec(i);
+    iconcache_session_end(&g_stub);
+    IconCacheStats s;
+    iconcache_get_stats(&s);
+    CHECK_EQ_INT(s.entries, ICONCACHE_MAX_ENTRIES);
+
+    iconcache_session_begin(&g_stub, 1);
+    spec(0); // most recently used now; icon1 is the oldest
+    iconcache_session_end(&g_stub);
+    iconcache_session_begin(&g_stub, 1);
+    int before = g_extracts;
+    spec(ICONCACHE_MAX_ENTRIES); // evicts icon1
+    spec(0);
+    CHECK_EQ_INT(g_extracts - before, 1);
+    iconcache_session_end(&g_stub);
+    iconcache_session_begin(&g_stub, 1);
+    iconcache_flush(); // icon1 comes back from the pack, not from memory
+    IconCacheStats s0, s1;
+    iconcache_get_stats(&s0);
+    spec(1);
+    iconcache_get_stats(&s1);
+    CHECK_EQ_INT(s1.hits - s0.hits, 0);
+    CHECK_EQ_INT(s1.entries, ICONCACHE_MAX_ENTRIES);
+    iconcache_session_end(&g_stub);
+}
+
+// Icons on screen are never evicted: past the table size they are handed out uncached and
+// destroyed when the menu closes
+static void test_in_use_not_evicted(void) {
+    fresh_cache();
+    iconcache_session_begin(&g_stub, 1);
+    HICON first = spec(0);
+    for (int i = 1; i < ICONCACHE_MAX_ENTRIES + 10; ++i) CHECK(spec(i) != NULL);
+    CHECK(spec(0) == first);
+    CHECK_EQ_INT(g_liveIcons, ICONCACHE_MAX_ENTRIES + 10);
+    iconcache_session_end(&g_stub);
+    CHECK_EQ_INT(g_liveIcons, ICONCACHE_MAX_ENTRIES);
+}
+
+// Images rasterized in one process are read back from the pack by the next one
+static void test_pack_round_trip(void) {
+    fresh_cache();
+    iconcache_session_begin(&g_stub, 1);
+    spec(1);
+    spec(2);
+    iconcache_lookup(&g_stub, IK_FILE, L"C:\\Tools\\app.exe", 16, TRUE);
+    iconcache_session_end(&g_stub);
+    CHECK(!pack_exists()); // below the threshold nothing is written at session end
+    IconCacheStats s0, s1;
+    iconcache_get_stats(&s0);
+    iconcache_flush();
+    iconcache_get_stats(&s1);
+    CHECK(pack_exists());
+    CHECK_EQ_INT(s1.packWrites - s0.packWrites, 1);
+    CHECK_EQ_INT(s1.pending, 0);
+
+    iconcache_reset(&g_stub); // a new process
+    g_extracts = 0;
+    iconcache_get_stats(&s0);
+    iconcache_session_begin(&g_stub, 1);
+    HICON a = spec(2);
+    HICON b = iconcache_lookup(&g_stub, IK_FILE, L"C:\\Tools\\app.exe", 16, TRUE);
+    iconcache_get_stats(&s1);
+    CHECK_EQ_INT(g_extracts, 0);
+    CHECK_EQ_INT(s1.packHits - s0.packHits, 2);
+    CHECK_EQ_INT(s1.packEntries, 3);
+    CHECK(a && ((FakeImage*)a)->color == color_of(IK_SPEC, L"icon2.ico", 16));
+    CHECK(b && ((FakeImage*)b)->color == color_of(IK_FILE, L"C:\\Tools\\app.exe", 16));
+    CHECK_EQ_INT(s1.pending, 0); // pack images are not written again
+
+    // A file that changed since it was rasterized is extracted again
+    g_writeTime = 7;
+    iconcache_lookup(&g_stub, IK_FILE, L"C:\\Tools\\app.exe", 16, TRUE);
+    CHECK_EQ_INT(g_extracts, 1);
+    iconcache_session_end(&g_stub);
+    g_writeTime = 1;
+}
+
+static void write_pack_bytes(const void* data, size_t len) {
+    char path[600];
+    snprintf(path, sizeof(path), "mkdir -p '%s/WinMacMenu'", g_appdata);
+    if (system(path) != 0) return;
+    pack_file(path, sizeof(path));
+    test_write_file(path, data, len);
+}
+
+// A damaged pack is ignored and replaced by the next write
+static void test_corrupted_pack(void) {
+    static const char* garbage[] = { "", "MIP", "MIPKxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx" };
+    for (int g = 0; g < 3; ++g) {
+        fresh_cache();
+        write_pack_bytes(garbage[g], strlen(garbage[g]));
+        iconcache_session_begin(&g_stub, 1);
+        CHECK(spec(5) != NULL);
+        CHECK_EQ_INT(g_extracts, 1);
+        iconcache_session_end(&g_stub);
+        iconcache_flush();
+        iconcache_reset(&g_stub);
+        g_extracts = 0;
+        iconcache_session_begin(&g_stub, 1);
+        CHECK(spec(5) != NULL);
+        CHECK_EQ_INT(g_extracts, 0);
+        iconcache_session_end(&g_stub);
+    }
+
+    // Valid header, entry table pointing past the end of the file
+    IconPackHeader h = { ICONPACK_MAGIC, ICONPACK_VERSION, 1, 0 };
+    IconPackEntry e = {0};
+    e.hash = iconpack_hash(IK_SPEC, 16, FALSE, L"icon5.ico");
+    e.size = 16;
+    e.nameOffset = 0x1000;
+    e.nameLen = 9;
+    e.pixelOffset = 0x2000;
+    BYTE buf[sizeof(h) + sizeof(e)];
+    memcpy(buf, &h, sizeof(h));
+    memcpy(buf + sizeof(h), &e, sizeof(e));
+    fresh_cache();
+    write_pack_bytes(buf, sizeof(buf));
+    iconcache_session_begin(&g_stub, 1);
+    CHECK(spec(5) != NULL);
+    CHECK_EQ_INT(g_extracts, 1);
+    iconcache_session_end(&g_stub);
+}
+
+// Pending images are written past the threshold at session end, when idle at most every
+// ICONCACHE_WRITE_IDLE_MS, and on exit
+static void test_write_batching(void) {
+    fresh_cache();
+    IconCacheStats s0, s1;
+    iconcache_session_begin(&g_stub, 1);
+    spec(1);
+    iconcache_session_end(&g_stub);
+    iconcache_flush(); // exit
+    iconcache_get_stats(&s0);
+    CHECK_EQ_INT(s0.pending, 0);
+
+    iconcache_session_begin(&g_stub, 1);
+    spec(2);
+    iconcache_session_end(&g_stub);
+    iconcache_idle(GetTickCount64()); // a write just happened
+    iconcache_flush();
+    iconcache_get_stats(&s1);
+    CHECK_EQ_INT(s1.packWrites - s0.packWrites, 1); // only the flush wrote
+
+    iconcache_session_begin(&g_stub, 1);
+    spec(3);
+    iconcache_session_end(&g_stub);
+    iconcache_get_stats(&s0);
+    iconcache_idle(GetTickCount64() + ICONCACHE_WRITE_IDLE_MS);
+    iconcache_get_stats(&s1);
+    CHECK_EQ_INT(s1.pending, 0); // handed to the worker
+    iconcache_flush(); // waits for it and installs the new pack
+    iconcache_get_stats(&s1);
+    CHECK_EQ_INT(s1.packWrites - s0.packWrites, 1);
+
+    iconcache_session_begin(&g_stub, 1);
+    for (int i = 10; i < 10 + ICONCACHE_WRITE_PENDING - 1; ++i) spec(i);
+    iconcache_session_end(&g_stub);
+    iconcache_get_stats(&s0);
+    CHECK_EQ_INT(s0.pending, ICONCACHE_WRITE_PENDING - 1);
+    iconcache_session_begin(&g_stub, 1);
+    spec(100);
+    iconcache_session_end(&g_stub);
+    iconcache_get_stats(&s1);
+    CHECK_EQ_INT(s1.pending, 0);
+    iconcache_flush();
+    spec(200); // maps the new pack
+    iconcache_get_stats(&s1);
+    CHECK_EQ_INT(s1.packWrites - s0.packWrites, 1);
+    CHECK_EQ_INT(s1.packEntries, 3 + ICONCACHE_WRITE_PENDING);
+}
+
+// A menu shown over and over makes its bitmaps once; after the first popup neither GDI objects
+// nor heap grow
+static void test_bitmap_pool(void) {
+    fresh_cache();
+    g_bitmapsMade = 0;
+    ShimAllocStats a0 = {0}, a1;
+    for (int popup = 0; popup < 50; ++popup) {
+        iconcache_session_begin(&g_stub, 1);
+        for (int i = 0; i < 20; ++i) {
+            HICON icon = spec(i);
+            HBITMAP bmp = iconcache_lookup_bitmap(&g_stub, icon);
+            CHECK(bmp != NULL);
+            CHECK(iconcache_lookup_bitmap(&g_stub, icon) == bmp);
+        }
+        iconcache_session_end(&g_stub);
+        if (popup == 1) shim_alloc_stats(&a0);
+    }
+    shim_alloc_stats(&a1);
+    IconCacheStats s;
+    iconcache_get_stats(&s);
+    CHECK_EQ_INT(g_bitmapsMade, 20);
+    CHECK_EQ_INT(s.bitmaps, 20);
+    CHECK_EQ_INT(g_liveBitmaps, 20);
+    CHECK_EQ_INT(g_liveIcons, 20);
+    CHECK_EQ_INT(a1.liveBytes, a0.liveBytes);
+    CHECK_EQ_INT(a1.allocs - a0.allocs, 0);
+    CHECK(iconcache_lookup_bitmap(&g_stub, (HICON)&s) == NULL); // not a cache icon
+}
+
+// A new theme generation is seen only when a build starts: icons and bitmaps handed out during
+// a build stay valid for all of it, and the previous theme's are dropped when the next build starts
+static void test_theme_change(void) {
+    fresh_cache();
+    g_bitmapsMade = 0;
+    iconcache_session_begin(&g_stub, 1);
+    HICON old = spec(1);
+    CHECK(iconcache_lookup_bitmap(&g_stub, old) != NULL);
+    iconcache_session_end(&g_stub);
+
+    iconcache_session_begin(&g_stub, 2);
+    HICON icon = spec(1);
+    HBITMAP bmp = iconcache_lookup_bitmap(&g_stub, icon);
+    CHECK(bmp != NULL);
+    for (int i = 2; i < 10; ++i) spec(i);
+    CHECK(iconcache_lookup_bitmap(&g_stub, icon) == bmp);
+    CHECK_EQ_INT(g_bitmapsMade, 2);
+    iconcache_session_end(&g_stub);
+    CHECK_EQ_INT(g_liveBitmaps, 1);
+    CHECK_EQ_INT(g_liveIcons, 9);
+
+    // The same generation again keeps everything
+    iconcache_session_begin(&g_stub, 2);
+    CHECK(spec(1) == icon);
+    CHECK(iconcache_lookup_bitmap(&g_stub, icon) == bmp);
+    iconcache_session_end(&g_stub);
+}
+
+int main(void) {
+    const char* dir = test_temp_dir("iconcache");
+    if (!dir) return 1;
+    snprintf(g_appdata, sizeof(g_appdata), "%s", dir);
+    setenv("LOCALAPPDATA", g_appdata, 1);
+    RUN_TEST(test_hits);
+    RUN_TEST(test_file_changed);
+    RUN_TEST(test_lru_eviction);
+    RUN_TEST(test_in_use_not_evicted);
+    RUN_TEST(test_pack_round_trip);
+    RUN_TEST(test_corrupted_pack);
+    RUN_TEST(test_write_batching);
+    RUN_TEST(test_bitmap_pool);
+    RUN_TEST(test_theme_change);
+    iconcache_reset(&g_stub);
+    CHECK_EQ_INT(g_liveIcons, 0);
+    CHECK_EQ_INT(g_liveBitmaps, 0);
+    test_remove_dir(g_appdata);
+    return test_summary();
+}
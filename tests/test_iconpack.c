@@ -0,0 +1,231 @@
+// Icon pack format: build/parse round trip, merging fresh images into an old pack, trimming to
+// ICONPACK_MAX_ENTRIES, and damaged packs (bad header, truncation, out-of-range offsets)
+#include "test.h"
+#include "iconpack.h"
+
+static DWORD g_px[4][16 * 16];
+
+static void item(IconPackItem* it, BYTE kind, int size, BOOL dark, const WCHAR* name, const DWORD* px) {
+    ZeroMemory(it, sizeof(*it));
+    it->e.hash = iconpack_hash(kind, size, dark, name);
+    it->e.size = (WORD)size;
+    it->e.kind = kind;
+    it->e.dark = dark ? 1 : 0;
+    it->e.srcWrite = 1234;
+    it->e.nameLen = (DWORD)lstrlenW(name);
+    it->name = name;
+    it->pixels = px;
+}
+
+static BOOL pixels_equal(const DWORD* a, DWORD b, int n) {
+    for (int i = 0; i < n; ++i) if (a[i] != b) return FALSE;
+    return TRUE;
+}
+
+// Three images of different kinds, sizes and themes
+static BYTE* build_sample(SIZE_T* len) {
+    IconPackItem items[3];
+    item(&items[0], IK_SPEC, 16, FALSE, L"shell32.dll,3", g_px[0]);
+    item(&items[1], IK_FILE, 16, TRUE, L"C:\\Tools\\App.exe", g_px[1]);
+    item(&items[2], IK_SPEC, 8, FALSE, L"C:\\icons\\a.ico", g_px[2]);
+    return iconpack_build(items, 3, len);
+}
+
+static void test_round_trip(void) {
+    SIZE_T len = 0;
+    BYTE* buf = build_sample(&len);
+    CHECK(buf != NULL && len > sizeof(IconPackHeader));
+    IconPackView v;
+    CHECK(iconpack_parse(&v, buf, len));
+    CHECK_EQ_INT(v.count, 3);
+    for (DWORD i = 1; i < v.count; ++i) CHECK(v.entries[i - 1].hash <= v.entries[i].hash);
+
+    // Found case-insensitively, like the paths they come from
+    int i = iconpack_find(&v, iconpack_hash(IK_FILE, 16, TRUE, L"c:\\tools\\app.EXE"), 16, IK_FILE, TRUE, L"c:\\tools\\app.EXE");
+    CHECK(i >= 0);
+    if (i >= 0) {
+        CHECK_EQ_WSTR(iconpack_name(&v, &v.entries[i]), L"C:\\Tools\\App.exe");
+        CHECK(pixels_equal(iconpack_pixels(&v, &v.entries[i]), 0xFF000002, 16 * 16));
+        CHECK_EQ_INT(v.entries[i].srcWrite, 1234);
+    }
+    i = iconpack_find(&v, iconpack_hash(IK_SPEC, 8, FALSE, L"C:\\icons\\a.ico"), 8, IK_SPEC, FALSE, L"C:\\icons\\a.ico");
+    CHECK(i >= 0 && pixels_equal(iconpack_pixels(&v, &v.entries[i]), 0xFF000003, 8 * 8));
+    CHECK(((ULONG_PTR)iconpack_pixels(&v, &v.entries[i]) & 3) == 0);
+
+    // Same source under another size, kind or theme is another image
+    CHECK_EQ_INT(iconpack_find(&v, iconpack_hash(IK_FILE, 16, FALSE, L"C:\\Tools\\App.exe"), 16, IK_FILE, FALSE, L"C:\\Tools\\App.exe"), -1);
+    CHECK_EQ_INT(iconpack_find(&v, iconpack_hash(IK_SPEC, 24, FALSE, L"shell32.dll,3"), 24, IK_SPEC, FALSE, L"shell32.dll,3"), -1);
+    CHECK_EQ_INT(iconpack_find(&v, iconpack_hash(IK_FILE, 16, FALSE, L"shell32.dll,3"), 16, IK_FILE, FALSE, L"shell32.dll,3"), -1);
+    LocalFree(buf);
+}
+
+static void test_merge(void) {
+    SIZE_T len = 0;
+    BYTE* old = build_sample(&len);
+    IconPackView v;
+    CHECK(iconpack_parse(&v, old, len));
+    IconPackItem items[2 + 3];
+    item(&items[0], IK_SPEC, 16, FALSE, L"SHELL32.dll,3", g_px[3]); // replaces the old image
+    item(&items[1], IK_SPEC, 16, FALSE, L"imageres.dll,-3", g_px[3]);
+    BYTE used[3] = {0};
+    int a = iconpack_find(&v, iconpack_hash(IK_SPEC, 8, FALSE, L"C:\\icons\\a.ico"), 8, IK_SPEC, FALSE, L"C:\\icons\\a.ico");
+    CHECK(a >= 0);
+    if (a >= 0) used[a] = 1;
+    int n = iconpack_merge(items, 2, &v, used);
+    CHECK_EQ_INT(n, 4);
+    CHECK_EQ_WSTR(items[2].name, L"C:\\icons\\a.ico"); // served this process: kept first
+    CHECK_EQ_WSTR(items[3].name, L"C:\\Tools\\App.exe");
+
+    SIZE_T len2 = 0;
+    BYTE* merged = iconpack_build(items, n, &len2);
+    IconPackView m;
+    CHECK(merged && iconpack_parse(&m, merged, len2));
+    int s = iconpack_find(&m, iconpack_hash(IK_SPEC, 16, FALSE, L"shell32.dll,3"), 16, IK_SPEC, FALSE, L"shell32.dll,3");
+    CHECK(s >= 0 && pixels_equal(iconpack_pixels(&m, &m.entries[s]), 0xFF000004, 16 * 16));
+    LocalFree(merged);
+    LocalFree(old);
+}
+
+// A full pack keeps the fresh images and the ones served this process; the rest are trimmed
+static void test_merge_trims(void) {
+    static IconPackItem items[ICONPACK_MAX_ENTRIES + 1];
+    static WCHAR names[ICONPACK_MAX_ENTRIES][16];
+    for (int i = 0; i < ICONPACK_MAX_ENTRIES; ++i) {
+        wsprintfW(names[i], L"icon%d.ico", i);
+        item(&items[i], IK_SPEC, 1, FALSE, names[i], g_px[0]);
+    }
+    SIZE_T len = 0;
+    BYTE* old = iconpack_build(items, ICONPACK_MAX_ENTRIES, &len);
+    IconPackView v;
+    CHECK(old && iconpack_parse(&v, old, len));
+    if (!old) return;
+    static BYTE used[ICONPACK_MAX_ENTRIES];
+    ZeroMemory(used, sizeof(used));
+    used[v.count - 1] = 1;
+    const WCHAR* kept = iconpack_name(&v, &v.entries[v.count - 1]);
+    item(&items[0], IK_SPEC, 1, FALSE, L"new.ico", g_px[1]);
+    int n = iconpack_merge(items, 1, &v, used);
+    CHECK_EQ_INT(n, ICONPACK_MAX_ENTRIES);
+    CHECK_EQ_WSTR(items[0].name, L"new.ico");
+    CHECK_EQ_WSTR(items[1].name, kept);
+    LocalFree(old);
+}
+
+static void test_build_limits(void) {
+    static DWORD big[ICON_MAX_SIZE * ICON_MAX_SIZE];
+    static IconPackItem items[ICONPACK_MAX_BYTES / sizeof(big) + 1];
+    int n = ARRAYSIZE(items);
+    for (int i = 0; i < n; ++i) item(&items[i], IK_SPEC, ICON_MAX_SIZE, FALSE, L"big.ico", big);
+    SIZE_T len = 1;
+    CHECK(iconpack_build(items, n, &len) == NULL);
+    CHECK_EQ_INT(len, 0);
+    item(&items[0], IK_SPEC, ICON_MAX_SIZE + 1, FALSE, L"huge.ico", big);
+    CHECK(iconpack_build(items, 1, &len) == NULL);
+}
+
+static void test_bad_header(void) {
+    SIZE_T len = 0;
+    BYTE* buf = build_sample(&len);
+    IconPackHeader* h = (IconPackHeader*)buf;
+    IconPackView v;
+    CHECK(!iconpack_parse(&v, NULL, len));
+    CHECK(!iconpack_parse(&v, buf, sizeof(IconPackHeader) - 1));
+    CHECK(!iconpack_parse(&v, buf, sizeof(IconPackHeader) + 2 * sizeof(IconPackEntry))); // table cut short
+    h->magic ^= 1;
+    CHECK(!iconpack_parse(&v, buf, len));
+    h->magic ^= 1;
+    h->version = ICONPACK_VERSION - 1;
+    CHECK(!iconpack_parse(&v, buf, len));
+    h->version = ICONPACK_VERSION;
+    h->count = ICONPACK_MAX_ENTRIES + 1;
+    CHECK(!iconpack_parse(&v, buf, len));
+    h->count = 0xFFFFFFFFu;
+    CHECK(!iconpack_parse(&v, buf, len));
+    h->count = 3;
+    CHECK(iconpack_parse(&v, buf, len));
+    CHECK(v.count == 3);
+    LocalFree(buf);
+}
+
+static void test_bad_offsets(void) {
+    SIZE_T len = 0;
+    BYTE* buf = build_sample(&len);
+    IconPackView v;
+    CHECK(iconpack_parse(&v, buf, len));
+    IconPackEntry* pe = (IconPackEntry*)v.entries;
+    IconPackEntry saved = pe[0];
+
+    pe[0].nameOffset |= 1;
+    CHECK(iconpack_name(&v, &pe[0]) == NULL);
+    pe[0] = saved;
+    pe[0].nameOffset = (DWORD)len - 2; // terminator would lie past the end
+    CHECK(iconpack_name(&v, &pe[0]) == NULL);
+    pe[0] = saved;
+    pe[0].nameLen = 0xFFFFFFF0u;
+    CHECK(iconpack_name(&v, &pe[0]) == NULL);
+    pe[0] = saved;
+    pe[0].nameLen -= 1; // no NUL where the length says
+    CHECK(iconpack_name(&v, &pe[0]) == NULL);
+    pe[0] = saved;
+    pe[0].pixelOffset += 2;
+    CHECK(iconpack_pixels(&v, &pe[0]) == NULL);
+    pe[0] = saved;
+    pe[0].pixelOffset = 0xFFFFFFFCu;
+    CHECK(iconpack_pixels(&v, &pe[0]) == NULL);
+    pe[0] = saved;
+    pe[0].size = 0;
+    CHECK(iconpack_pixels(&v, &pe[0]) == NULL);
+    pe[0].size = ICON_MAX_SIZE + 1;
+    CHECK(iconpack_pixels(&v, &pe[0]) == NULL);
+    pe[0] = saved;
+
+    // A damaged entry is neither found nor merged; the others still are
+    pe[0].nameOffset = 0xFFFFFFF0u;
+    for (DWORD i = 1; i < v.count; ++i) {
+        const WCHAR* name = iconpack_name(&v, &pe[i]);
+        CHECK(name && iconpack_find(&v, pe[i].hash, pe[i].size, pe[i].kind, pe[i].dark, name) == (int)i);
+    }
+    IconPackItem items[3];
+    CHECK_EQ_INT(iconpack_merge(items, 0, &v, NULL), 2);
+    LocalFree(buf);
+}
+
+// Every prefix of a pack either fails to parse or yields only names and pixels inside it
+static void test_truncated(void) {
+    SIZE_T len = 0;
+    BYTE* buf = build_sample(&len);
+    int parsed = 0, readable = 0;
+    for (SIZE_T cut = 0; cut <= len; ++cut) {
+        BYTE* copy = (BYTE*)LocalAlloc(LMEM_FIXED, cut ? cut : 1);
+        CopyMemory(copy, buf, cut);
+        IconPackView v;
+        if (iconpack_parse(&v, copy, cut)) {
+            parsed++;
+            for (DWORD i = 0; i < v.count; ++i) {
+                const WCHAR* name = iconpack_name(&v, &v.entries[i]);
+                const DWORD* px = iconpack_pixels(&v, &v.entries[i]);
+                if (name) CHECK((const BYTE*)(name + v.entries[i].nameLen + 1) <= copy + cut);
+                if (px) CHECK((const BYTE*)(px + v.entries[i].size * v.entries[i].size) <= copy + cut);
+                if (name && px) readable++;
+            }
+        }
+        LocalFree(copy);
+    }
+    CHECK(parsed > 1);
+    CHECK(readable >= 3); // at least the whole pack
+    LocalFree(buf);
+}
+
+int main(void) {
+    for (int i = 0; i < 4; ++i) {
+        for (int p = 0; p < 16 * 16; ++p) g_px[i][p] = 0xFF000001u + i;
+    }
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_merge);
+    RUN_TEST(test_merge_trims);
+    RUN_TEST(test_build_limits);
+    RUN_TEST(test_bad_header);
+    RUN_TEST(test_bad_offsets);
+    RUN_TEST(test_truncated);
+    return test_summary();
+}
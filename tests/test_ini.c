@@ -0,0 +1,170 @@
+// INI reader: profile API conformance fixtures (tests/fixtures/ini) and core behaviour
+#include "test.h"
+#include "ini_win32.h"
+
+static BYTE* read_all(const char* path, size_t* len) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    BYTE* data = (BYTE*)malloc((size_t)n + 1);
+    *len = fread(data, 1, (size_t)n, f);
+    data[*len] = 0;
+    fclose(f);
+    return data;
+}
+
+// Splits s at '|' in place into at most max fields (the last field keeps the rest of the line)
+static int split_fields(char* s, char** fields, int max) {
+    int n = 0;
+    fields[n++] = s;
+    while (n < max && (s = strchr(s, '|')) != NULL) {
+        *s++ = 0;
+        fields[n++] = s;
+    }
+    return n;
+}
+
+// Each .expect line is "section|key|value" ("(missing)" = not found) or "int|section|key|default|value"
+static void run_fixture(const char* name) {
+    char path[512];
+    size_t len = 0, elen = 0;
+    snprintf(path, sizeof(path), "%s/ini/%s.ini", FIXTURE_DIR, name);
+    BYTE* data = read_all(path, &len);
+    snprintf(path, sizeof(path), "%s/ini/%s.expect", FIXTURE_DIR, name);
+    char* expect = (char*)read_all(path, &elen);
+    CHECK(data != NULL && expect != NULL);
+    if (!data || !expect) { free(data); free(expect); return; }
+    IniFile* ini = ini_parse(data, (DWORD)len);
+    CHECK(ini != NULL);
+
+    int checks = 0;
+    for (char* line = strtok(expect, "\n"); line; line = strtok(NULL, "\n")) {
+        if (line[0] == '#' || !line[0]) continue;
+        char* f[5];
+        WCHAR sec[256], key[256], want[256], got[256];
+        if (!strncmp(line, "int|", 4)) {
+            if (split_fields(line + 4, f, 4) != 4) { CHECK(!"bad int line"); continue; }
+            shim_from_utf8(f[0], sec, ARRAYSIZE(sec));
+            shim_from_utf8(f[1], key, ARRAYSIZE(key));
+            int value = ini_get_int(ini, sec, key, atoi(f[2]));
+            if (value != atoi(f[3])) fprintf(stderr, "  %s: [%s] %s\n", name, f[0], f[1]);
+            CHECK_EQ_INT(value, atoi(f[3]));
+        } else {
+            if (split_fields(line, f, 3) != 3) { CHECK(!"bad line"); continue; }
+            shim_from_utf8(f[0], sec, ARRAYSIZE(sec));
+            shim_from_utf8(f[1], key, ARRAYSIZE(key));
+            const WCHAR* value = ini_get(ini, sec, key);
+            if (!strcmp(f[2], "(missing)")) {
+                if (value) fprintf(stderr, "  %s: [%s] %s\n", name, f[0], f[1]);
+                CHECK(value == NULL);
+                ini_get_string(ini, sec, key, L"dflt", got, ARRAYSIZE(got));
+                CHECK_EQ_WSTR(got, L"dflt");
+            } else {
+                shim_from_utf8(f[2], want, ARRAYSIZE(want));
+                if (!value) fprintf(stderr, "  %s: [%s] %s\n", name, f[0], f[1]);
+                CHECK_EQ_WSTR(value, want);
+            }
+        }
+        checks++;
+    }
+    CHECK(checks > 0);
+    ini_free(ini);
+    free(data);
+    free(expect);
+}
+
+static void test_fixtures(void) {
+    static const char* names[] = {
+        "basic", "outside", "duplicates", "comments", "quotes", "line_endings", "ints",
+        "utf16le", "utf16be", "utf8_bom", "ansi", "empty", "bom_only"
+    };
+    for (int i = 0; i < (int)ARRAYSIZE(names); ++i) run_fixture(names[i]);
+}
+
+// Stand-in for a code page where 0x80 is the euro sign (Windows-1252)
+static int g_decoderCalls = 0;
+static size_t cp1252_euro(const uint8_t* data, size_t len, IniChar* out, size_t cch) {
+    g_decoderCalls++;
+    if (!out) return len;
+    if (len > cch) len = cch;
+    for (size_t i = 0; i < len; ++i) out[i] = data[i] == 0x80 ? 0x20AC : data[i];
+    return len;
+}
+
+static void test_ansi_decoder(void) {
+    static const uint8_t ansi[] = "[S]\nK=\x80 5\n";
+    IniFile* ini = ini_parse_bytes(ansi, sizeof(ansi) - 1, cp1252_euro);
+    CHECK(g_decoderCalls > 0);
+    CHECK_EQ_WSTR(ini_get(ini, L"S", L"K"), L"\x20AC 5");
+    ini_free(ini);
+
+    ini = ini_parse_bytes(ansi, sizeof(ansi) - 1, NULL); // default: ISO-8859-1
+    CHECK_EQ_WSTR(ini_get(ini, L"S", L"K"), L"\x0080 5");
+    ini_free(ini);
+
+    // A BOM selects the encoding; the ANSI decoder is not consulted
+    static const uint8_t utf8[] = "\xEF\xBB\xBF[S]\nK=\xE2\x82\xAC\n";
+    g_decoderCalls = 0;
+    ini = ini_parse_bytes(utf8, sizeof(utf8) - 1, cp1252_euro);
+    CHECK_EQ_INT(g_decoderCalls, 0);
+    CHECK_EQ_WSTR(ini_get(ini, L"S", L"K"), L"\x20AC");
+    ini_free(ini);
+
+    // Malformed UTF-8 after a BOM decodes to U+FFFD instead of failing
+    static const uint8_t bad[] = "\xEF\xBB\xBF[S]\nK=a\xC3(b\xE2\x82\n";
+    ini = ini_parse_bytes(bad, sizeof(bad) - 1, NULL);
+    CHECK_EQ_WSTR(ini_get(ini, L"S", L"K"), L"a\xFFFD(b\xFFFD");
+    ini_free(ini);
+}
+
+static void test_case_folding(void) {
+    static const uint8_t text[] = "\xEF\xBB\xBF[\xC3\x84PFEL]\n\xC5\x81\xC3\x93" "D\xC5\xB9=1\n\xCE\xA3\xCE\x99\xCE\x93\xCE\x9C\xCE\x91=2\n";
+    IniFile* ini = ini_parse_bytes(text, sizeof(text) - 1, NULL);
+    CHECK_EQ_WSTR(ini_get(ini, L"\x00E4pfel", L"\x0142\x00F3" L"d\x017A"), L"1");     // Äpfel / Łódź
+    CHECK_EQ_WSTR(ini_get(ini, L"\x00C4PFEL", L"\x03C3\x03B9\x03B3\x03BC\x03B1"), L"2"); // ΣΙΓΜΑ / σιγμα
+    ini_free(ini);
+}
+
+static void test_get_string_bounds(void) {
+    static const uint8_t text[] = "[S]\nK=Value\n";
+    IniFile* ini = ini_parse_bytes(text, sizeof(text) - 1, NULL);
+    WCHAR out[8];
+    CHECK_EQ_INT(ini_get_string(ini, L"S", L"K", L"", out, 4), 3);
+    CHECK_EQ_WSTR(out, L"Val");
+    CHECK_EQ_INT(ini_get_string(ini, L"S", L"K", L"", out, 0), 0);
+    CHECK_EQ_INT(ini_get_string(ini, L"S", L"Nope", L"def", out, ARRAYSIZE(out)), 3);
+    CHECK_EQ_WSTR(out, L"def");
+    CHECK_EQ_INT(ini_get_string(ini, L"S", L"Nope", NULL, out, ARRAYSIZE(out)), 0);
+    CHECK_EQ_WSTR(out, L"");
+    CHECK_EQ_INT(ini_get_string(NULL, L"S", L"K", L"def", out, ARRAYSIZE(out)), 3);
+    ini_free(ini);
+}
+
+// Every key of a large file stays reachable (the index is sized from the line count)
+static void test_many_keys(void) {
+    const int n = 10000;
+    char* text = (char*)malloc((size_t)n * 32 + 64);
+    size_t len = (size_t)sprintf(text, "[Big]\r");
+    for (int i = 0; i < n; ++i) len += (size_t)sprintf(text + len, "Key%d=%d\r", i, i * 3); // CR-only lines
+    IniFile* ini = ini_parse_bytes((const uint8_t*)text, len, NULL);
+    int found = 0;
+    for (int i = 0; i < n; ++i) {
+        WCHAR key[32];
+        wsprintfW(key, L"KEY%d", i);
+        if (ini_get_int(ini, L"big", key, -1) == i * 3) found++;
+    }
+    CHECK_EQ_INT(found, n);
+    ini_free(ini);
+    free(text);
+}
+
+int main(void) {
+    RUN_TEST(test_fixtures);
+    RUN_TEST(test_ansi_decoder);
+    RUN_TEST(test_case_folding);
+    RUN_TEST(test_get_string_bounds);
+    RUN_TEST(test_many_keys);
+    return test_summary();
+}
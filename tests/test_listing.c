@@ -0,0 +1,226 @@
+// Folder listings: filters, incremental top-k ordering against a full sort, enumeration
+#include "test.h"
+#include "listing.h"
+#include "config.h"
+#include <sys/stat.h>
+
+static WIN32_FIND_DATAW find_data(const WCHAR* name, DWORD attrs, ULONGLONG size, ULONGLONG written, ULONGLONG created) {
+    WIN32_FIND_DATAW fd;
+    ZeroMemory(&fd, sizeof(fd));
+    lstrcpynW(fd.cFileName, name, ARRAYSIZE(fd.cFileName));
+    fd.dwFileAttributes = attrs;
+    fd.nFileSizeHigh = (DWORD)(size >> 32); fd.nFileSizeLow = (DWORD)size;
+    fd.ftLastWriteTime.dwHighDateTime = (DWORD)(written >> 32); fd.ftLastWriteTime.dwLowDateTime = (DWORD)written;
+    fd.ftCreationTime.dwHighDateTime = (DWORD)(created >> 32); fd.ftCreationTime.dwLowDateTime = (DWORD)created;
+    return fd;
+}
+
+// n pseudo-random entries with repeated sizes/times so ties fall through to the name. Names are
+// unique even ignoring case, as in a real folder, so the order is total.
+static FolderListing* synthetic(const ListingOptions* opt, int n) {
+    static const WCHAR* exts[] = { L".txt", L".exe", L".png", L"", L".tar.gz" };
+    FolderListing* lst = listing_begin(L"C:\\Synthetic", opt);
+    UINT seed = 7;
+    for (int i = 0; i < n; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        WCHAR name[64];
+        wsprintfW(name, L"%s%05u_%d%s", (seed >> 20) & 1 ? L"Item" : L"item", (seed >> 8) % 50000, i, exts[(seed >> 4) % 5]);
+        WIN32_FIND_DATAW fd = find_data(name, (seed >> 12) % 9 == 0 ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_NORMAL,
+                                        (seed >> 10) % 300, (seed >> 9) % 500, (seed >> 11) % 400);
+        CHECK(listing_add(lst, &fd));
+    }
+    CHECK(listing_finish(lst));
+    return lst;
+}
+
+static void test_filters(void) {
+    ListingOptions opt = {0};
+    static const struct { const WCHAR* name; DWORD attrs; } items[] = {
+        { L".", FILE_ATTRIBUTE_DIRECTORY }, { L"..", FILE_ATTRIBUTE_DIRECTORY },
+        { L"visible.txt", FILE_ATTRIBUTE_NORMAL }, { L"hidden.txt", FILE_ATTRIBUTE_HIDDEN },
+        { L".dotfile", FILE_ATTRIBUTE_NORMAL }, { L".dotdir", FILE_ATTRIBUTE_DIRECTORY },
+        { L".hiddendot", FILE_ATTRIBUTE_HIDDEN },
+    };
+    // dotMode: 0 = no dot entries, 1 = dot files only, 2 = dot folders only, 3 = both
+    static const int expected[2][4] = { { 1, 3, 2, 4 }, { 2, 4, 3, 5 } };
+    for (int hidden = 0; hidden < 2; ++hidden) {
+        for (int dot = 0; dot < 4; ++dot) {
+            opt.showHidden = hidden;
+            opt.dotMode = dot;
+            FolderListing* lst = listing_begin(L"C:\\F", &opt);
+            for (int i = 0; i < (int)ARRAYSIZE(items); ++i) {
+                WIN32_FIND_DATAW fd = find_data(items[i].name, items[i].attrs, 0, 0, 0);
+                listing_add(lst, &fd);
+            }
+            CHECK(listing_finish(lst));
+            if (lst->count != expected[hidden][dot]) fprintf(stderr, "  showHidden=%d dotMode=%d\n", hidden, dot);
+            CHECK_EQ_INT(lst->count, expected[hidden][dot]);
+            listing_free(lst);
+        }
+    }
+}
+
+// Paging (top-k, then extending the prefix) must give exactly the order of a one-shot full sort
+static void test_top_k_matches_full_sort(void) {
+    const int n = 3000;
+    for (int field = SORT_NAME; field <= SORT_SIZE; ++field) {
+        for (int variant = 0; variant < 4; ++variant) {
+            ListingOptions opt = {0};
+            opt.sortField = field;
+            opt.sortDescending = variant & 1;
+            opt.sortFoldersFirst = (variant & 2) != 0;
+            FolderListing* full = synthetic(&opt, n);
+            FolderListing* paged = synthetic(&opt, n);
+            listing_sort_prefix(full, n);
+            listing_sort_prefix(paged, 40);
+            CHECK_EQ_INT(paged->sorted, 40);
+            listing_sort_prefix(paged, 20); // never shrinks
+            CHECK_EQ_INT(paged->sorted, 40);
+            listing_sort_prefix(paged, 80);
+            listing_sort_prefix(paged, n + 100);
+            CHECK_EQ_INT(paged->sorted, n);
+            int same = 0;
+            for (int i = 0; i < n; ++i) same += listing_at(full, i) - full->entries == listing_at(paged, i) - paged->entries;
+            if (same != n) fprintf(stderr, "  field=%d variant=%d\n", field, variant);
+            CHECK_EQ_INT(same, n);
+            listing_free(full);
+            listing_free(paged);
+        }
+    }
+}
+
+static void test_field_order(void) {
+    ListingOptions opt = {0};
+    opt.sortField = SORT_SIZE;
+    opt.sortFoldersFirst = TRUE;
+    FolderListing* lst = synthetic(&opt, 2000);
+    listing_sort_prefix(lst, lst->count);
+    BOOL ordered = TRUE, seenFile = FALSE;
+    for (int i = 0; i < lst->count; ++i) {
+        const ListEntry* e = listing_at(lst, i);
+        if (!(e->flags & LE_DIR)) seenFile = TRUE;
+        else if (seenFile) ordered = FALSE; // a folder after a file
+        if (i > 0) {
+            const ListEntry* p = listing_at(lst, i - 1);
+            if ((p->flags & LE_DIR) == (e->flags & LE_DIR) && p->size > e->size) ordered = FALSE;
+        }
+    }
+    CHECK(ordered);
+    listing_free(lst);
+
+    opt.sortField = SORT_DATE_MODIFIED;
+    opt.sortDescending = TRUE;
+    opt.sortFoldersFirst = FALSE;
+    lst = synthetic(&opt, 2000);
+    listing_sort_prefix(lst, 100);
+    for (int i = 1; i < 100; ++i) {
+        if (CompareFileTime(&listing_at(lst, i - 1)->ftLastWrite, &listing_at(lst, i)->ftLastWrite) < 0) ordered = FALSE;
+    }
+    CHECK(ordered);
+    listing_free(lst);
+}
+
+static FolderListing* named(const ListingOptions* opt, const WCHAR** names, int n) {
+    FolderListing* lst = listing_begin(L"C:\\F", opt);
+    for (int i = 0; i < n; ++i) {
+        WIN32_FIND_DATAW fd = find_data(names[i], FILE_ATTRIBUTE_NORMAL, 0, 0, 0);
+        listing_add(lst, &fd);
+    }
+    listing_finish(lst);
+    listing_sort_prefix(lst, n);
+    return lst;
+}
+
+static void check_order(const FolderListing* lst, const WCHAR** want, int n) {
+    for (int i = 0; i < n; ++i) CHECK_EQ_WSTR(listing_name(lst, listing_at(lst, i)), want[i]);
+}
+
+// On the host LCMapStringEx is the shim's key (folded code units, digit runs as numbers), so this
+// pins how listing keys are built and compared, not the Windows collation itself
+static void test_collation_keys(void) {
+    static const WCHAR* names[] = { L"file10.txt", L"File2.txt", L"file1.txt", L"FILE20.txt" };
+    ListingOptions opt = {0};
+    FolderListing* lst = named(&opt, names, 4);
+    CHECK(lst->keys != NULL);
+    static const WCHAR* plain[] = { L"file1.txt", L"file10.txt", L"File2.txt", L"FILE20.txt" };
+    check_order(lst, plain, 4);
+    listing_free(lst);
+
+    opt.sortNatural = TRUE;
+    lst = named(&opt, names, 4);
+    static const WCHAR* natural[] = { L"file1.txt", L"File2.txt", L"file10.txt", L"FILE20.txt" };
+    check_order(lst, natural, 4);
+    listing_free(lst);
+
+    // Type: extension key first (no extension sorts first), then the name
+    static const WCHAR* typed[] = { L"b.zip", L"c.TXT", L"a.txt", L"noext", L"archive.tar.GZ" };
+    opt.sortNatural = FALSE;
+    opt.sortField = SORT_TYPE;
+    lst = named(&opt, typed, 5);
+    static const WCHAR* byType[] = { L"noext", L"archive.tar.GZ", L"a.txt", L"c.TXT", L"b.zip" };
+    check_order(lst, byType, 5);
+    listing_free(lst);
+}
+
+// Key order (memcmp) agrees with CompareStringEx on the source names
+static void test_keys_match_compare_string(void) {
+    ListingOptions opt = {0};
+    opt.sortNatural = TRUE;
+    FolderListing* lst = synthetic(&opt, 2000);
+    listing_sort_prefix(lst, lst->count);
+    CHECK(lst->keys != NULL);
+    int bad = 0;
+    for (int i = 1; i < lst->count; ++i) {
+        const WCHAR* a = listing_name(lst, listing_at(lst, i - 1));
+        const WCHAR* b = listing_name(lst, listing_at(lst, i));
+        if (CompareStringEx(LOCALE_NAME_USER_DEFAULT, NORM_IGNORECASE | SORT_DIGITSASNUMBERS, a, -1, b, -1, NULL, NULL, 0) == CSTR_GREATER_THAN) bad++;
+    }
+    CHECK_EQ_INT(bad, 0);
+    listing_free(lst);
+}
+
+static void test_enumerate_directory(void) {
+    const char* dir = test_temp_dir("listing");
+    char path[600];
+    static const char* names[] = { "b.txt", "a.txt", "c.bin" };
+    for (int i = 0; i < 3; ++i) {
+        snprintf(path, sizeof(path), "%s/%s", dir, names[i]);
+        test_write_file(path, "12345", (size_t)(i + 1));
+    }
+    snprintf(path, sizeof(path), "%s/sub", dir);
+    mkdir(path, 0755);
+    WCHAR wdir[600];
+    shim_from_utf8(dir, wdir, ARRAYSIZE(wdir));
+    ListingOptions opt = {0};
+    opt.sortFoldersFirst = TRUE;
+    FolderListing* lst = listing_enumerate(wdir, &opt);
+    CHECK(lst != NULL);
+    if (lst) {
+        CHECK_EQ_INT(lst->count, 4);
+        CHECK(lst->dirWriteTime.dwLowDateTime || lst->dirWriteTime.dwHighDateTime);
+        listing_sort_prefix(lst, lst->count);
+        CHECK_EQ_WSTR(listing_name(lst, listing_at(lst, 0)), L"sub");
+        CHECK_EQ_WSTR(listing_name(lst, listing_at(lst, 1)), L"a.txt");
+        CHECK_EQ_INT(listing_at(lst, 1)->size, 2);
+        WCHAR full[MAX_PATH], want[MAX_PATH];
+        listing_full_path(lst, listing_at(lst, 3), full, ARRAYSIZE(full));
+        PathCombineW(want, wdir, L"c.bin");
+        CHECK_EQ_WSTR(full, want);
+        CHECK(listing_memory(lst) < sizeof(FolderListing) + 4 * 64 + 4096);
+        listing_free(lst);
+    }
+    snprintf(path, sizeof(path), "%s/missing", dir);
+    shim_from_utf8(path, wdir, ARRAYSIZE(wdir));
+    CHECK(listing_enumerate(wdir, &opt) == NULL);
+    test_remove_dir(dir);
+}
+
+int main(void) {
+    RUN_TEST(test_filters);
+    RUN_TEST(test_top_k_matches_full_sort);
+    RUN_TEST(test_field_order);
+    RUN_TEST(test_collation_keys);
+    RUN_TEST(test_keys_match_compare_string);
+    RUN_TEST(test_enumerate_directory);
+    return test_summary();
+}
@@ -0,0 +1,166 @@
+// Shell link reader: fixture links (tests/fixtures/lnk, written to MS-SHLLINK with lnkfixture.h)
+// for local, Unicode LinkInfo, UNC, relative and ID-list-only targets, plus truncation and
+// mutation fuzzing with every buffer ending at an inaccessible guard page
+#include "test.h"
+#include "lnk.h"
+#include "lnkfixture.h"
+#include <sys/mman.h>
+
+static size_t read_fixture(const char* name, BYTE* out, size_t cap) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/lnk/%s.lnk", FIXTURE_DIR, name);
+    FILE* f = fopen(path, "rb");
+    if (!f) return 0;
+    size_t n = fread(out, 1, cap, f);
+    fclose(f);
+    return n;
+}
+
+static void test_fixtures(void) {
+    static const struct { const char* name; const WCHAR* path; DWORD attrs; } cases[] = {
+        { "local", L"C:\\Users\\me\\Documents\\report.docx", FILE_ATTRIBUTE_ARCHIVE },   // LinkInfo wins over RELATIVE_PATH
+        { "local_unicode_folder", L"C:\\Projects\\WinMac", FILE_ATTRIBUTE_DIRECTORY },
+        { "unc", L"\\\\fileserver\\share\\Reports\\q3.xlsx", FILE_ATTRIBUTE_ARCHIVE },
+    };
+    BYTE buf[4096];
+    for (int i = 0; i < (int)ARRAYSIZE(cases); ++i) {
+        size_t n = read_fixture(cases[i].name, buf, sizeof(buf));
+        CHECK(n > 0);
+        LnkTarget t;
+        CHECK(lnk_parse(buf, n, &t));
+        CHECK_EQ_WSTR(t.path, cases[i].path);
+        CHECK(!t.relative);
+        CHECK_EQ_INT(t.attributes, cases[i].attrs);
+    }
+    LnkTarget t;
+    size_t n = read_fixture("relative", buf, sizeof(buf));
+    CHECK(lnk_parse(buf, n, &t));
+    CHECK(t.relative);
+    CHECK_EQ_WSTR(t.path, L"sub\\notes.txt");
+    n = read_fixture("idlist_only", buf, sizeof(buf));
+    CHECK(n > 0);
+    CHECK(!lnk_parse(buf, n, &t)); // shell namespace item: left to IShellLink
+}
+
+// lnk_read maps the file and resolves relative targets against the link's folder
+static void test_read_relative(void) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/lnk/relative.lnk", FIXTURE_DIR);
+    WCHAR lnk[512], want[512], dir[512];
+    shim_from_utf8(path, lnk, ARRAYSIZE(lnk));
+    lstrcpynW(dir, lnk, ARRAYSIZE(dir));
+    PathRemoveFileSpecW(dir);
+    PathCombineW(want, dir, L"sub\\notes.txt");
+    LnkTarget t;
+    CHECK(lnk_read(lnk, &t));
+    CHECK(!t.relative);
+    CHECK_EQ_WSTR(t.path, want);
+    CHECK(!lnk_read(L"/nonexistent/missing.lnk", &t));
+}
+
+// Buffer whose last byte sits right before a PROT_NONE page, so any read past len faults
+typedef struct { BYTE* base; size_t mapped; } Guarded;
+
+static BYTE* guarded_copy(Guarded* g, const BYTE* data, size_t len) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t body = (len + page - 1) / page * page;
+    if (body == 0) body = page;
+    g->mapped = body + page;
+    g->base = (BYTE*)mmap(NULL, g->mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    mprotect(g->base + body, page, PROT_NONE);
+    BYTE* p = g->base + body - len;
+    memcpy(p, data, len);
+    return p;
+}
+
+static void guarded_free(Guarded* g) { munmap(g->base, g->mapped); }
+
+static BOOL parse_guarded(const BYTE* data, size_t len, LnkTarget* t) {
+    Guarded g;
+    BYTE* p = guarded_copy(&g, data, len);
+    BOOL ok = lnk_parse(p, len, t);
+    guarded_free(&g);
+    return ok;
+}
+
+static BOOL path_sane(const LnkTarget* t) {
+    for (int i = 0; i < MAX_PATH; ++i) if (!t->path[i]) return TRUE;
+    return FALSE;
+}
+
+static void test_truncations(void) {
+    static const char* names[] = { "local", "local_unicode_folder", "unc", "relative", "idlist_only" };
+    BYTE buf[4096];
+    int insane = 0;
+    for (int i = 0; i < (int)ARRAYSIZE(names); ++i) {
+        size_t n = read_fixture(names[i], buf, sizeof(buf));
+        for (size_t len = 0; len <= n; ++len) {
+            LnkTarget t;
+            if (parse_guarded(buf, len, &t) && !path_sane(&t)) insane++;
+        }
+    }
+    CHECK_EQ_INT(insane, 0);
+}
+
+// Random byte flips and hostile 16/32-bit values at random offsets, seeded for reproducibility
+static void test_mutations(void) {
+    static const char* names[] = { "local", "local_unicode_folder", "unc", "relative" };
+    BYTE orig[4096], buf[4096];
+    UINT seed = 12345;
+    int insane = 0, parsed = 0;
+    for (int i = 0; i < (int)ARRAYSIZE(names); ++i) {
+        size_t n = read_fixture(names[i], orig, sizeof(orig));
+        for (int iter = 0; iter < 5000; ++iter) {
+            memcpy(buf, orig, n);
+            int edits = 1 + iter % 4;
+            for (int e = 0; e < edits; ++e) {
+                seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+                size_t off = seed % n;
+                switch ((seed >> 24) % 4) {
+                case 0: buf[off] ^= (BYTE)(1 << ((seed >> 8) % 8)); break;
+                case 1: buf[off] = (BYTE)(seed >> 16); break;
+                case 2: if (off + 2 <= n) lnkfx_put16(buf, off, 0xFFFF); break;
+                case 3: if (off + 4 <= n) lnkfx_put32(buf, off, (seed & 1) ? 0xFFFFFFF0u : (DWORD)n - 1); break;
+                }
+            }
+            LnkTarget t;
+            if (parse_guarded(buf, n, &t)) {
+                parsed++;
+                if (!path_sane(&t)) insane++;
+            }
+        }
+    }
+    CHECK_EQ_INT(insane, 0);
+    CHECK(parsed > 0);
+}
+
+// Paths longer than MAX_PATH are rejected rather than truncated or overflowed
+static void test_long_paths(void) {
+    char longPath[600];
+    memset(longPath, 'a', sizeof(longPath) - 1);
+    longPath[0] = 'C'; longPath[1] = ':'; longPath[2] = '\\';
+    longPath[sizeof(longPath) - 1] = 0;
+    BYTE buf[4096];
+    LnkFixture f = {0};
+    f.localBasePath = longPath;
+    LnkTarget t;
+    CHECK(!parse_guarded(buf, lnk_fixture_build(&f, buf), &t));
+    f.unicodeLinkInfo = TRUE;
+    CHECK(!parse_guarded(buf, lnk_fixture_build(&f, buf), &t));
+    LnkFixture r = {0};
+    r.relativePath = longPath;
+    CHECK(!parse_guarded(buf, lnk_fixture_build(&r, buf), &t));
+    LnkFixture u = {0};
+    u.netName = "\\\\server\\share";
+    u.commonSuffix = longPath + 3;
+    CHECK(!parse_guarded(buf, lnk_fixture_build(&u, buf), &t));
+}
+
+int main(void) {
+    RUN_TEST(test_fixtures);
+    RUN_TEST(test_read_relative);
+    RUN_TEST(test_truncations);
+    RUN_TEST(test_mutations);
+    RUN_TEST(test_long_paths);
+    return test_summary();
+}
@@ -0,0 +1,192 @@
+// Compiled menu model: node output per item type, segment reuse, and that a segment whose key
+// matches is still recompiled when its item or settings differ
+#include "test.h"
+#include "menumodel.h"
+
+static Config* new_config(void) {
+    Config* cfg = (Config*)calloc(1, sizeof(Config));
+    cfg->taskKillMax = 10;
+    return cfg;
+}
+
+static ConfigItem* add_item(Config* cfg, ConfigItemType type, const WCHAR* label, const WCHAR* path) {
+    ConfigItem* it = &cfg->items[cfg->count++];
+    it->type = type;
+    lstrcpyW(it->label, label);
+    lstrcpyW(it->path, path);
+    return it;
+}
+
+static void test_compile(void) {
+    Config* cfg = new_config();
+    lstrcpyW(cfg->defaultIconPath, L"default.ico");
+    cfg->excludeHibernate = TRUE;
+    add_item(cfg, CI_URI, L"Site", L"https://example.com");
+    add_item(cfg, CI_SEPARATOR, L"", L"");
+    add_item(cfg, CI_POWER_MENU, L"", L"");
+    ConfigItem* tk = add_item(cfg, CI_TASKKILL, L"Force Quit", L"");
+    lstrcpyW(tk->params, L"5,true,false,Calculator,Settings");
+    ConfigItem* f = add_item(cfg, CI_FOLDER, L"Docs", L"C:\\Docs");
+    f->inlineExpand = TRUE;
+
+    MenuModel* m = (MenuModel*)calloc(1, sizeof(MenuModel));
+    CHECK_EQ_INT(menumodel_update(m, cfg, FALSE), 5);
+    CHECK_EQ_INT(m->count, 5);
+
+    const MenuNode* n = m->segs[0].nodes;
+    CHECK_EQ_INT(n->kind, MN_COMMAND);
+    CHECK_EQ_INT(n->action, MA_OPEN_URI);
+    CHECK_EQ_WSTR(n->path, L"https://example.com");
+    CHECK_EQ_WSTR(n->icon, L"default.ico");
+    CHECK_EQ_INT(m->segs[1].nodes->kind, MN_SEPARATOR);
+
+    // Power: Sleep, Shut down, Restart | Lock, Log off (Hibernate excluded)
+    const MenuSegment* p = &m->segs[2];
+    CHECK_EQ_INT(p->count, 8);
+    CHECK_EQ_INT(p->nodes[0].kind, MN_POPUP_BEGIN);
+    CHECK_EQ_WSTR(p->nodes[0].label, L"Power");
+    CHECK_EQ_WSTR(p->nodes[2].label, L"Shut down");
+    CHECK_EQ_INT(p->nodes[4].kind, MN_SEPARATOR);
+    CHECK_EQ_INT(p->nodes[7].kind, MN_POPUP_END);
+
+    n = m->segs[3].nodes;
+    CHECK_EQ_INT(n->kind, MN_TASKKILL);
+    CHECK_EQ_INT(n->max, 5);
+    CHECK(n->ignoreSystem);
+    CHECK(!n->showIcons);
+    CHECK_EQ_WSTR(n->excludes, L"Calculator");
+    CHECK_EQ_WSTR(n->excludes + 11, L"Settings");
+
+    const MenuSegment* d = &m->segs[4];
+    CHECK_EQ_INT(d->count, 2);
+    CHECK_EQ_INT(d->nodes[0].kind, MN_HEADER);
+    CHECK_EQ_INT(d->nodes[1].kind, MN_FOLDER_INLINE);
+
+    // Strings are copies: the config can be reloaded under the model
+    lstrcpyW(cfg->items[0].path, L"changed");
+    CHECK_EQ_WSTR(m->segs[0].nodes->path, L"https://example.com");
+    menumodel_free(m);
+    free(m);
+    free(cfg);
+}
+
+static void test_reuse(void) {
+    Config* cfg = new_config();
+    for (int i = 0; i < 10; ++i) {
+        WCHAR label[32];
+        wsprintfW(label, L"Item %d", i);
+        add_item(cfg, CI_FILE, label, L"C:\\file.txt");
+    }
+    MenuModel* m = (MenuModel*)calloc(1, sizeof(MenuModel));
+    CHECK_EQ_INT(menumodel_update(m, cfg, FALSE), 10);
+    CHECK_EQ_INT(menumodel_update(m, cfg, FALSE), 0);
+    CHECK_EQ_INT(m->reused, 10);
+
+    lstrcpyW(cfg->items[3].label, L"Renamed");
+    CHECK_EQ_INT(menumodel_update(m, cfg, FALSE), 1);
+    CHECK_EQ_WSTR(m->segs[3].nodes->label, L"Renamed");
+
+    lstrcpyW(cfg->defaultIconPathDark, L"dark.ico"); // a setting every item depends on
+    CHECK_EQ_INT(menumodel_update(m, cfg, TRUE), 10);
+    CHECK_EQ_WSTR(m->segs[0].nodes->icon, L"dark.ico");
+
+    cfg->count = 4;
+    CHECK_EQ_INT(menumodel_update(m, cfg, TRUE), 0);
+    CHECK_EQ_INT(m->count, 4);
+    cfg->count = 10;
+    CHECK_EQ_INT(menumodel_update(m, cfg, TRUE), 6);
+    CHECK_EQ_INT(m->collisions, 0);
+    menumodel_free(m);
+    free(m);
+    free(cfg);
+}
+
+// Stands in for a 32-bit key collision: the stored source no longer matches the item although
+// the key does, which must force a recompile instead of serving the stale nodes
+static void test_key_collision(void) {
+    Config* cfg = new_config();
+    add_item(cfg, CI_FILE, L"Notes", L"C:\\notes.txt");
+    add_item(cfg, CI_POWER_MENU, L"Power", L"");
+    MenuModel* m = (MenuModel*)calloc(1, sizeof(MenuModel));
+    menumodel_update(m, cfg, FALSE);
+
+    m->segs[0].src.label = L"Other";
+    m->segs[0].nodes->label = L"Other";
+    CHECK_EQ_INT(menumodel_update(m, cfg, FALSE), 1);
+    CHECK_EQ_INT(m->collisions, 1);
+    CHECK_EQ_WSTR(m->segs[0].nodes->label, L"Notes");
+
+    m->segs[1].src.excludeLock = TRUE; // settings are compared too
+    CHECK_EQ_INT(menumodel_update(m, cfg, FALSE), 1);
+    CHECK_EQ_INT(m->collisions, 2);
+    CHECK_EQ_INT(menumodel_update(m, cfg, FALSE), 0);
+    menumodel_free(m);
+    free(m);
+    free(cfg);
+}
+
+// Emission: ids per range, balanced popups, and popups past the depth limit left out whole
+typedef struct Emitted { char trace[128]; int len; UINT ids[16]; int idCount; } Emitted;
+
+static void em_put(Emitted* e, char c) { if (e->len < (int)sizeof(e->trace) - 1) e->trace[e->len++] = c; }
+static void em_item(void* ctx, const MenuNode* n, UINT id) {
+    Emitted* e = (Emitted*)ctx;
+    em_put(e, n->kind == MN_COMMAND ? 'c' : n->kind == MN_SEPARATOR ? '-' : 'h');
+    if (id && e->idCount < 16) e->ids[e->idCount++] = id;
+}
+static void em_begin(void* ctx, const MenuNode* n) { (void)n; em_put((Emitted*)ctx, '('); }
+static void em_end(void* ctx, const MenuNode* n) { (void)n; em_put((Emitted*)ctx, ')'); }
+static void em_generated(void* ctx, const MenuNode* n) { (void)n; em_put((Emitted*)ctx, 'g'); }
+
+static void test_emit(void) {
+    static const MenuSink sink = { em_item, em_begin, em_end, em_generated };
+    Config* cfg = new_config();
+    add_item(cfg, CI_FILE, L"A", L"a.txt");
+    ConfigItem* f = add_item(cfg, CI_FOLDER, L"Docs", L"C:\\Docs");
+    f->inlineExpand = TRUE;
+    f->inlineOpen = TRUE; // clickable header takes a folder-range id
+    add_item(cfg, CI_POWER_MENU, L"", L"");
+    add_item(cfg, CI_RECENT_SUBMENU, L"", L"");
+    cfg->excludeLock = cfg->excludeLogoff = TRUE;
+    MenuModel* m = (MenuModel*)calloc(1, sizeof(MenuModel));
+    menumodel_update(m, cfg, FALSE);
+    Emitted e = {0};
+    UINT id = 100, folderId = 500;
+    menumodel_emit(m, &sink, &e, &id, &folderId);
+    CHECK(!strcmp(e.trace, "ccg(cccc)g"));
+    CHECK_EQ_INT(e.idCount, 6);
+    CHECK_EQ_INT(e.ids[0], 100);
+    CHECK_EQ_INT(e.ids[1], 500);
+    CHECK_EQ_INT(e.ids[2], 101);
+    CHECK_EQ_INT(id, 105);
+    CHECK_EQ_INT(folderId, 501);
+
+    // Hand-built nesting one level past the limit: the innermost popup is skipped with its contents
+    MenuNode nodes[2 * MENUMODEL_MAX_DEPTH + 5];
+    int count = 0;
+    ZeroMemory(nodes, sizeof(nodes));
+    for (int d = 0; d <= MENUMODEL_MAX_DEPTH; ++d) nodes[count++].kind = MN_POPUP_BEGIN;
+    nodes[count++].kind = MN_COMMAND;
+    for (int d = 0; d <= MENUMODEL_MAX_DEPTH; ++d) nodes[count++].kind = MN_POPUP_END;
+    nodes[count++].kind = MN_SEPARATOR;
+    nodes[count++].kind = MN_POPUP_BEGIN; // never closed: the walk closes it
+    MenuModel* h = (MenuModel*)calloc(1, sizeof(MenuModel));
+    h->count = 1;
+    h->segs[0].nodes = nodes;
+    h->segs[0].count = count;
+    ZeroMemory(&e, sizeof(e));
+    menumodel_emit(h, &sink, &e, &id, &folderId);
+    CHECK(!strcmp(e.trace, "(((())))-()"));
+    free(h);
+    menumodel_free(m);
+    free(m);
+    free(cfg);
+}
+
+int main(void) {
+    RUN_TEST(test_compile);
+    RUN_TEST(test_reuse);
+    RUN_TEST(test_key_collision);
+    RUN_TEST(test_emit);
+    return test_summary();
+}
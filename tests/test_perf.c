@@ -0,0 +1,88 @@
+// Popup latency histogram: quarter-octave bucket edges, the top bucket, nearest-rank percentiles
+// and the clamp to the largest recorded value
+#include "test.h"
+#include "perfhist.h"
+
+static void test_small_values(void) {
+    for (ULONG us = 0; us < 4; ++us) {
+        CHECK_EQ_INT(perf_bucket_of(us), (int)us);
+        CHECK_EQ_INT(perf_bucket_upper((int)us), (int)us);
+    }
+    // 4 us starts the quarter-octave buckets at 4*log2(4); 4..7 are never used
+    CHECK_EQ_INT(perf_bucket_of(4), 8);
+    CHECK_EQ_INT(perf_bucket_of(5), 9);
+    CHECK_EQ_INT(perf_bucket_of(7), 11);
+    CHECK_EQ_INT(perf_bucket_of(8), 12);
+    CHECK_EQ_INT(perf_bucket_of(9), 12);
+    CHECK_EQ_INT(perf_bucket_of(10), 13);
+    for (int b = 4; b < 8; ++b) CHECK_EQ_INT(perf_bucket_upper(b), 3);
+}
+
+// Every bucket from 8 up holds [upper(b-1)+1, upper(b)] with nothing skipped or shared
+static void test_bucket_edges(void) {
+    int bad = 0;
+    for (int b = 8; b < PERF_BUCKETS; ++b) {
+        ULONG upper = perf_bucket_upper(b);
+        ULONG lower = b == 8 ? 4 : perf_bucket_upper(b - 1) + 1;
+        if (lower > upper) bad++;
+        if (perf_bucket_of(lower) != b || perf_bucket_of(upper) != b) bad++;
+        if (upper != 0xFFFFFFFF && perf_bucket_of(upper + 1) != b + 1) bad++;
+    }
+    CHECK_EQ_INT(bad, 0);
+    CHECK_EQ_INT(perf_bucket_of(1000), 39);           // 512..1023, last quarter: 896..1023
+    CHECK_EQ_INT(perf_bucket_upper(39), 1023);
+    CHECK_EQ_INT(perf_bucket_of(MAXLONG), 123);        // largest value perf_end records
+    CHECK_EQ_INT(perf_bucket_of(0xFFFFFFFF), PERF_BUCKETS - 1);
+    CHECK(perf_bucket_upper(PERF_BUCKETS - 1) == 0xFFFFFFFF);
+}
+
+static void test_record(void) {
+    PerfHistogram h;
+    ZeroMemory(&h, sizeof(h));
+    perf_hist_record(&h, 0);
+    perf_hist_record(&h, 120);
+    perf_hist_record(&h, 7);
+    CHECK_EQ_INT(h.count, 3);
+    CHECK_EQ_INT(h.maxUs, 120);
+    CHECK_EQ_INT((int)h.totalUs, 127);
+    CHECK_EQ_INT(h.buckets[0], 1);
+    CHECK_EQ_INT(h.buckets[11], 1);
+    CHECK_EQ_INT(h.buckets[perf_bucket_of(120)], 1);
+}
+
+static void test_percentiles(void) {
+    PerfHistogram h;
+    ZeroMemory(&h, sizeof(h));
+    CHECK_EQ_INT(perf_percentile(&h, 50), 0); // empty
+
+    perf_hist_record(&h, 1000);
+    CHECK_EQ_INT(perf_percentile(&h, 50), 1000); // bucket bound 1023, clamped to the max seen
+    CHECK_EQ_INT(perf_percentile(&h, 0), 1000);
+
+    ZeroMemory(&h, sizeof(h));
+    for (ULONG us = 1; us <= 100; ++us) perf_hist_record(&h, us);
+    CHECK_EQ_INT(perf_percentile(&h, 0), 1);    // rank 1
+    CHECK_EQ_INT(perf_percentile(&h, 3), 3);    // exact below 4 us
+    CHECK_EQ_INT(perf_percentile(&h, 50), 55);  // 50 lies in 48..55
+    CHECK_EQ_INT(perf_percentile(&h, 90), 95);  // 90 lies in 80..95
+    CHECK_EQ_INT(perf_percentile(&h, 99), 100); // 99 lies in 96..111: clamped to the max
+    CHECK_EQ_INT(perf_percentile(&h, 100), 100);
+
+    // Nearest rank rounds up: with four samples p25 is the first, p26 the second
+    ZeroMemory(&h, sizeof(h));
+    perf_hist_record(&h, 0);
+    perf_hist_record(&h, 2);
+    perf_hist_record(&h, 3);
+    perf_hist_record(&h, 3);
+    CHECK_EQ_INT(perf_percentile(&h, 25), 0);
+    CHECK_EQ_INT(perf_percentile(&h, 26), 2);
+    CHECK_EQ_INT(perf_percentile(&h, 75), 3);
+}
+
+int main(void) {
+    RUN_TEST(test_small_values);
+    RUN_TEST(test_bucket_edges);
+    RUN_TEST(test_record);
+    RUN_TEST(test_percentiles);
+    return test_summary();
+}
@@ -0,0 +1,175 @@
+// This PC and Home cache: drives read once and again after a mask change or a volume event, Home
+// read again when its watch fires or the hidden setting changes, failed reads not cached and
+// watches closed, through a counting stub reader
+#include "test.h"
+#include "places.h"
+
+static DWORD g_mask;
+static const WCHAR* g_labels[4];
+static int g_driveReads, g_homeReads;
+static BOOL g_failReads;
+static BOOL g_fired[16];
+static int g_nextWatch, g_watchesOpen;
+static BOOL g_unwatchable;
+static BOOL g_lastHidden;
+
+static DWORD stub_mask(void) {
+    return g_mask;
+}
+
+static BOOL stub_drives(PlacesSink* sink) {
+    g_driveReads++;
+    if (g_failReads) return FALSE;
+    for (int i = 0; i < 4; ++i) {
+        if (!(g_mask & (1u << i))) continue;
+        WCHAR root[4] = { (WCHAR)(L'C' + i), L':', L'\\', 0 };
+        if (!places_add(sink, g_labels[i], root, NULL, 0, TRUE)) return FALSE;
+    }
+    return TRUE;
+}
+
+static BOOL stub_home(PlacesSink* sink, BOOL showHidden, HANDLE* watch) {
+    g_homeReads++;
+    g_lastHidden = showHidden;
+    *watch = INVALID_HANDLE_VALUE;
+    if (!g_unwatchable) {
+        int w = ++g_nextWatch;
+        g_fired[w] = FALSE;
+        g_watchesOpen++;
+        *watch = (HANDLE)(ULONG_PTR)w;
+    }
+    if (g_failReads) return FALSE;
+    BYTE idl[6] = { 4, 0, 'D', 'k', 0, 0 };
+    if (!places_add(sink, L"Documents", L"C:\\Users\\me\\Documents", idl, sizeof(idl), TRUE)) return FALSE;
+    if (showHidden && !places_add(sink, L"AppData", L"C:\\Users\\me\\AppData", NULL, 0, TRUE)) return FALSE;
+    return places_add(sink, L"Virtual", L"", NULL, 0, FALSE);
+}
+
+static BOOL stub_fired(HANDLE watch) {
+    return g_fired[(ULONG_PTR)watch];
+}
+
+static void stub_close(HANDLE watch) {
+    (void)watch;
+    g_watchesOpen--;
+}
+
+static const PlacesReader g_reader = { stub_mask, stub_drives, stub_home, stub_fired, stub_close };
+
+static void reset(void) {
+    places_reset(&g_reader);
+    g_mask = 0x1; // C:
+    g_labels[0] = L"System (C:)"; g_labels[1] = L"Data (D:)"; g_labels[2] = L"USB (E:)"; g_labels[3] = L"CD Drive (F:)";
+    g_driveReads = g_homeReads = 0;
+    g_failReads = g_unwatchable = FALSE;
+    CHECK_EQ_INT(g_watchesOpen, 0);
+}
+
+static void test_drives_cached(void) {
+    reset();
+    const PlaceItem* items;
+    int count;
+    CHECK(places_drives(&g_reader, &items, &count));
+    CHECK_EQ_INT(count, 1);
+    CHECK_EQ_WSTR(items[0].label, L"System (C:)");
+    CHECK_EQ_WSTR(items[0].path, L"C:\\");
+    CHECK(items[0].idl == NULL);
+    for (int i = 0; i < 5; ++i) CHECK(places_drives(&g_reader, &items, &count));
+    CHECK_EQ_INT(g_driveReads, 1);
+    PlacesStats st;
+    places_get_stats(&st);
+    CHECK_EQ_INT(st.hits, 5);
+    CHECK_EQ_INT(st.reads, 1);
+
+    // A new drive letter shows up in the mask
+    g_mask = 0x5;
+    CHECK(!places_drives_current(&g_reader));
+    CHECK(places_drives(&g_reader, &items, &count));
+    CHECK_EQ_INT(count, 2);
+    CHECK_EQ_WSTR(items[1].label, L"USB (E:)");
+    CHECK_EQ_INT(g_driveReads, 2);
+
+    // Media or a label changes under the same letter: only the volume event tells
+    g_labels[2] = L"Backup (E:)";
+    CHECK(places_drives_current(&g_reader));
+    places_invalidate_drives();
+    CHECK(!places_drives_current(&g_reader));
+    CHECK(places_drives(&g_reader, &items, &count));
+    CHECK_EQ_WSTR(items[1].label, L"Backup (E:)");
+    CHECK_EQ_INT(g_driveReads, 3);
+    CHECK(places_drives_current(&g_reader));
+}
+
+static void test_failed_read_not_cached(void) {
+    reset();
+    const PlaceItem* items;
+    int count;
+    g_failReads = TRUE;
+    CHECK(!places_drives(&g_reader, &items, &count));
+    CHECK_EQ_INT(count, 0);
+    CHECK(!places_home(&g_reader, FALSE, &items, &count));
+    CHECK_EQ_INT(g_watchesOpen, 0);
+    g_failReads = FALSE;
+    CHECK(places_drives(&g_reader, &items, &count));
+    CHECK(places_home(&g_reader, FALSE, &items, &count));
+    CHECK_EQ_INT(g_driveReads, 2);
+    CHECK_EQ_INT(g_homeReads, 2);
+    CHECK_EQ_INT(g_watchesOpen, 1);
+}
+
+static void test_home_watch(void) {
+    reset();
+    const PlaceItem* items;
+    int count;
+    CHECK(places_home(&g_reader, FALSE, &items, &count));
+    CHECK_EQ_INT(count, 2);
+    CHECK_EQ_WSTR(items[0].label, L"Documents");
+    CHECK(items[0].isFolder);
+    CHECK_EQ_INT(items[0].idlSize, 6);
+    CHECK(items[0].idl && ((const BYTE*)items[0].idl)[2] == 'D');
+    CHECK_EQ_WSTR(items[1].path, L"");
+    CHECK(!items[1].isFolder);
+    for (int i = 0; i < 3; ++i) CHECK(places_home(&g_reader, FALSE, &items, &count));
+    CHECK_EQ_INT(g_homeReads, 1);
+
+    // Something changed in the profile folder: read again under a new watch
+    g_fired[g_nextWatch] = TRUE;
+    CHECK(!places_home_current(&g_reader, FALSE));
+    CHECK(places_home(&g_reader, FALSE, &items, &count));
+    CHECK_EQ_INT(g_homeReads, 2);
+    CHECK_EQ_INT(g_watchesOpen, 1);
+    CHECK(places_home_current(&g_reader, FALSE));
+
+    // Hidden items switched on
+    CHECK(!places_home_current(&g_reader, TRUE));
+    CHECK(places_home(&g_reader, TRUE, &items, &count));
+    CHECK_EQ_INT(count, 3);
+    CHECK(g_lastHidden);
+    CHECK_EQ_INT(g_homeReads, 3);
+    CHECK_EQ_INT(g_watchesOpen, 1);
+
+    places_reset(&g_reader);
+    CHECK_EQ_INT(g_watchesOpen, 0);
+}
+
+static void test_home_unwatchable(void) {
+    reset();
+    g_unwatchable = TRUE;
+    const PlaceItem* items;
+    int count;
+    for (int i = 0; i < 3; ++i) {
+        CHECK(places_home(&g_reader, FALSE, &items, &count));
+        CHECK_EQ_INT(count, 2);
+    }
+    CHECK_EQ_INT(g_homeReads, 3);
+    CHECK(!places_home_current(&g_reader, FALSE));
+}
+
+int main(void) {
+    RUN_TEST(test_drives_cached);
+    RUN_TEST(test_failed_read_not_cached);
+    RUN_TEST(test_home_watch);
+    RUN_TEST(test_home_unwatchable);
+    places_reset(&g_reader);
+    return test_summary();
+}
@@ -0,0 +1,124 @@
+// Background folder prefetch over the POSIX readdir backend: results match a direct enumeration,
+// a slow folder does not block prefetch_take, and unclaimed results end up in the folder cache
+#include "test.h"
+#include "prefetch.h"
+#include "dircache.h"
+#include <sys/stat.h>
+
+static char g_root[512];
+
+static void make_dir(const char* name, int files) {
+    char path[700];
+    snprintf(path, sizeof(path), "%s/%s", g_root, name);
+    mkdir(path, 0755);
+    for (int i = 0; i < files; ++i) {
+        snprintf(path, sizeof(path), "%s/%s/file%03d.txt", g_root, name, i);
+        test_write_file(path, "x", 1);
+    }
+}
+
+static void wide_path(const char* name, WCHAR* out, int cch) {
+    char path[700];
+    snprintf(path, sizeof(path), "%s/%s", g_root, name);
+    shim_from_utf8(path, out, cch);
+}
+
+// Many sessions of submit / take / cancel; every listing taken equals a direct enumeration
+static void test_stress_sessions(void) {
+    ListingOptions opt = {0};
+    char name[32];
+    for (int d = 0; d < 24; ++d) {
+        snprintf(name, sizeof(name), "dir%02d", d);
+        make_dir(name, d * 7);
+    }
+    int taken = 0, mismatched = 0;
+    for (int session = 0; session < 20; ++session) {
+        for (int d = 0; d < 24; ++d) {
+            WCHAR dir[700];
+            snprintf(name, sizeof(name), "dir%02d", d);
+            wide_path(name, dir, ARRAYSIZE(dir));
+            prefetch_submit(dir, &opt, 10);
+        }
+        // Take a varying subset, some immediately, some after the workers had time
+        if (session % 3 == 0) Sleep(2);
+        for (int d = session % 4; d < 24; d += 3) {
+            WCHAR dir[700];
+            snprintf(name, sizeof(name), "dir%02d", d);
+            wide_path(name, dir, ARRAYSIZE(dir));
+            FolderListing* lst = prefetch_take(dir, &opt);
+            if (!lst) continue; // cancelled while queued: the caller would enumerate itself
+            taken++;
+            if (lst->count != d * 7 || lst->sorted < (lst->count < 10 ? lst->count : 10)) mismatched++;
+            listing_free(lst);
+        }
+        prefetch_cancel_all();
+        dircache_flush(); // closing inotify watches is slow on Linux, keep the session count modest
+        dircache_end_session();
+    }
+    CHECK(taken > 0);
+    CHECK_EQ_INT(mismatched, 0);
+}
+
+static void test_slow_folder_does_not_block(void) {
+    ListingOptions opt = {0};
+    make_dir("slowshare", 5);
+    WCHAR dir[700];
+    wide_path("slowshare", dir, ARRAYSIZE(dir));
+    shim_set_slow_path("slowshare", 150); // per file API call: the stamp and the enumeration take ~300 ms
+    prefetch_submit(dir, &opt, 10);
+    Sleep(20); // the worker is now stuck in the slow enumeration
+    double t0 = test_now_ms();
+    FolderListing* lst = prefetch_take(dir, &opt);
+    double waited = test_now_ms() - t0;
+    CHECK(lst == NULL);
+    CHECK(waited < 250);
+    // The job kept running; once it finishes, ending the session hands its listing to the cache
+    Sleep(500);
+    prefetch_cancel_all();
+    shim_set_slow_path(NULL, 0);
+    FolderListing* cached = dircache_lookup(dir, &opt);
+    CHECK(cached != NULL);
+    if (cached) CHECK_EQ_INT(cached->count, 5);
+    dircache_end_session();
+    dircache_flush();
+}
+
+static void test_unclaimed_result_goes_to_cache(void) {
+    ListingOptions opt = {0};
+    opt.sortField = 0;
+    make_dir("unclaimed", 12);
+    WCHAR dir[700];
+    wide_path("unclaimed", dir, ARRAYSIZE(dir));
+    prefetch_submit(dir, &opt, 5);
+    Sleep(100);
+    prefetch_cancel_all();
+    CHECK(dircache_contains(dir, &opt));
+    FolderListing* lst = dircache_lookup(dir, &opt);
+    CHECK(lst != NULL);
+    if (lst) {
+        CHECK_EQ_INT(lst->count, 12);
+        CHECK(lst->sorted >= 5); // presorted on the worker
+    }
+    dircache_end_session();
+    dircache_flush();
+}
+
+int main(void) {
+    const char* root = test_temp_dir("prefetch");
+    if (!root) return 1;
+    snprintf(g_root, sizeof(g_root), "%s", root);
+    ShimAllocStats before, after;
+    shim_alloc_stats(&before);
+    RUN_TEST(test_stress_sessions);
+    RUN_TEST(test_slow_folder_does_not_block);
+    RUN_TEST(test_unclaimed_result_goes_to_cache);
+    // Detached jobs are freed (or cached) by the next drain once their workers are done
+    Sleep(200);
+    prefetch_cancel_all();
+    dircache_flush();
+    dircache_end_session();
+    shim_alloc_stats(&after);
+    CHECK_EQ_INT(after.liveBytes, before.liveBytes);
+    test_remove_dir(g_root);
+    return test_summary();
+}
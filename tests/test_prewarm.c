@@ -0,0 +1,168 @@
+// Pre-warm policy driven by a fake clock: settle after closes and change bursts, in-place refresh
+// of the volatile sections as they age, and dropping the menu once it goes unused
+#include "test.h"
+#include "prewarm.h"
+
+static PrewarmPolicy g_policy;
+static PrewarmState g_state;
+static ULONGLONG g_now;
+
+// Plays what menu.c does on each timer tick; returns the action taken, *due the next wake-up
+static PrewarmAction tick(DWORD* due) {
+    PrewarmAction a = prewarm_decide(&g_policy, &g_state, g_now, due);
+    if (a == PREWARM_WAIT) return a;
+    if (a == PREWARM_BUILD) prewarm_note_built(&g_state, g_now);
+    else if (a == PREWARM_REFRESH) prewarm_note_refreshed(&g_state, g_now);
+    else prewarm_note_dropped(&g_state);
+    prewarm_decide(&g_policy, &g_state, g_now, due);
+    return a;
+}
+
+static void start(void) {
+    prewarm_default_policy(&g_policy);
+    g_now = 1000000;
+    prewarm_note_start(&g_state, g_now);
+}
+
+static void test_settle_then_build(void) {
+    start();
+    DWORD due;
+    CHECK_EQ_INT(tick(&due), PREWARM_WAIT);
+    CHECK_EQ_INT(due, g_policy.settleMs);
+    CHECK(!prewarm_usable(&g_policy, &g_state, g_now));
+
+    // A change notification waits longer than a close
+    g_now += 200;
+    prewarm_note_dirty(&g_state, g_now);
+    CHECK_EQ_INT(tick(&due), PREWARM_WAIT);
+    CHECK_EQ_INT(due, g_policy.changeSettleMs);
+    g_now += g_policy.changeSettleMs;
+    CHECK_EQ_INT(tick(&due), PREWARM_BUILD);
+    CHECK(prewarm_usable(&g_policy, &g_state, g_now));
+    CHECK_EQ_INT(tick(&due), PREWARM_WAIT);
+    CHECK_EQ_INT(due, g_policy.maxAgeMs);
+}
+
+// Age alone never rebuilds the whole menu: only Recent and Force Quit are regenerated
+static void test_age_refreshes_volatile_only(void) {
+    start();
+    DWORD due;
+    g_now += g_policy.settleMs;
+    CHECK_EQ_INT(tick(&due), PREWARM_BUILD);
+    ULONGLONG built = g_state.builtAt;
+    int builds = 0, refreshes = 0;
+    // One popup-free minute, ticking whenever the timer would fire
+    ULONGLONG end = g_now + 60 * 1000;
+    while (g_now < end) {
+        g_now += due;
+        PrewarmAction a = tick(&due);
+        builds += a == PREWARM_BUILD;
+        refreshes += a == PREWARM_REFRESH;
+        CHECK(prewarm_usable(&g_policy, &g_state, g_now));
+    }
+    CHECK_EQ_INT(builds, 0);
+    CHECK_EQ_INT(refreshes, (int)(60 * 1000 / g_policy.maxAgeMs));
+    CHECK(g_state.builtAt == built);
+
+    // Snapshots past the cap make the menu unusable until refreshed
+    g_now += g_policy.maxAgeMs + 1;
+    CHECK(!prewarm_usable(&g_policy, &g_state, g_now));
+    CHECK_EQ_INT(tick(&due), PREWARM_REFRESH);
+    CHECK(prewarm_usable(&g_policy, &g_state, g_now));
+}
+
+// A change while warm wins over a pending refresh and rebuilds after the settle delay
+static void test_dirty_while_warm(void) {
+    start();
+    DWORD due;
+    g_now += g_policy.settleMs;
+    tick(&due);
+    g_now += g_policy.maxAgeMs - 100;
+    prewarm_note_dirty(&g_state, g_now);
+    CHECK(!prewarm_usable(&g_policy, &g_state, g_now));
+    CHECK_EQ_INT(tick(&due), PREWARM_WAIT);
+    CHECK_EQ_INT(due, g_policy.changeSettleMs);
+    g_now += due;
+    CHECK_EQ_INT(tick(&due), PREWARM_BUILD);
+}
+
+// Device and setting broadcasts come in bursts with gaps longer than the close settle delay
+// (DBT_DEVNODES_CHANGED while a USB hub enumerates): the whole burst ends in one build
+static void test_change_burst_builds_once(void) {
+    start();
+    DWORD due;
+    g_now += g_policy.settleMs;
+    CHECK_EQ_INT(tick(&due), PREWARM_BUILD);
+    static const DWORD gaps[] = { 0, 400, 50, 900, 1500, 20, 700, 1200, 300 };
+    int builds = 0;
+    for (int i = 0; i < (int)ARRAYSIZE(gaps); ++i) {
+        ULONGLONG next = g_now + gaps[i];
+        while (due != INFINITE && g_now + due < next) { // timer wake-ups between notifications
+            g_now += due;
+            builds += tick(&due) == PREWARM_BUILD;
+        }
+        g_now = next;
+        prewarm_note_dirty(&g_state, g_now);
+        builds += tick(&due) == PREWARM_BUILD;
+    }
+    CHECK_EQ_INT(builds, 0);
+    ULONGLONG last = g_now;
+    g_now += due;
+    CHECK_EQ_INT(tick(&due), PREWARM_BUILD);
+    CHECK_EQ_INT(g_now - last, g_policy.changeSettleMs);
+
+    // A close right after a change does not cut the change's wait short
+    prewarm_note_dirty(&g_state, g_now);
+    prewarm_note_shown(&g_state, g_now + 100);
+    CHECK_EQ_INT(tick(&due), PREWARM_WAIT);
+    g_now += 100 + g_policy.settleMs;
+    CHECK_EQ_INT(tick(&due), PREWARM_WAIT);
+    CHECK_EQ_INT(due, g_policy.changeSettleMs - 100 - g_policy.settleMs);
+}
+
+static void test_idle_drop_and_popup(void) {
+    start();
+    DWORD due;
+    g_now += g_policy.settleMs;
+    tick(&due);
+    int drops = 0;
+    ULONGLONG end = g_state.usedAt + g_policy.keepWarmMs + g_policy.maxAgeMs;
+    while (g_now < end && due != INFINITE) {
+        g_now += due;
+        drops += tick(&due) == PREWARM_DROP;
+    }
+    CHECK_EQ_INT(drops, 1);
+    CHECK(!g_state.warm);
+    CHECK_EQ_INT(due, INFINITE);
+    CHECK_EQ_INT(tick(&due), PREWARM_WAIT); // stays idle
+
+    // A popup brings it back: the next menu follows after the settle delay
+    prewarm_note_shown(&g_state, g_now);
+    CHECK_EQ_INT(tick(&due), PREWARM_WAIT);
+    g_now += due;
+    CHECK_EQ_INT(tick(&due), PREWARM_BUILD);
+}
+
+// Wake-ups never overshoot the idle point, so the drop happens on time
+static void test_due_capped_at_idle(void) {
+    start();
+    DWORD due;
+    g_policy.keepWarmMs = 12000; // before the first refresh would be due
+    g_now += g_policy.settleMs;
+    tick(&due);
+    g_now += 5000;
+    tick(&due);
+    CHECK_EQ_INT(due, 12000 - 5000 - g_policy.settleMs);
+    g_now += due;
+    CHECK_EQ_INT(tick(&due), PREWARM_DROP);
+}
+
+int main(void) {
+    RUN_TEST(test_settle_then_build);
+    RUN_TEST(test_age_refreshes_volatile_only);
+    RUN_TEST(test_dirty_while_warm);
+    RUN_TEST(test_change_burst_builds_once);
+    RUN_TEST(test_idle_drop_and_popup);
+    RUN_TEST(test_due_capped_at_idle);
+    return test_summary();
+}
@@ -0,0 +1,165 @@
+// Force Quit metadata cache: hits, revalidation on size and write time, LRU eviction at 256
+// entries, uncached long paths and icon ownership, through a counting stub reader
+#include "test.h"
+#include "procinfo.h"
+#include <sys/stat.h>
+#include <sys/time.h>
+
+static char g_dir[512];
+static int g_labelReads, g_iconReads, g_iconFrees;
+static ULONG_PTR g_nextIcon = 0x1000;
+
+static BOOL stub_label(const WCHAR* path, WCHAR* out, int cch) {
+    g_labelReads++;
+    const WCHAR* name = PathFindFileNameW(path);
+    if (name[0] == L'n') return FALSE; // "n..." images have no FileDescription
+    wsprintfW(out, L"Desc %s #%d", name, g_labelReads);
+    (void)cch;
+    return TRUE;
+}
+
+static HICON stub_icon(const WCHAR* path) {
+    (void)path;
+    g_iconReads++;
+    return (HICON)(g_nextIcon++);
+}
+
+static void stub_free(HICON icon) {
+    (void)icon;
+    g_iconFrees++;
+}
+
+static const ProcInfoReader g_reader = { stub_label, stub_icon, stub_free };
+
+static void image(const char* name, const char* content, long mtime, WCHAR* wide, int cch) {
+    char path[700];
+    snprintf(path, sizeof(path), "%s/%s", g_dir, name);
+    test_write_file(path, content, strlen(content));
+    struct timeval tv[2] = { { mtime, 0 }, { mtime, 0 } };
+    utimes(path, tv);
+    shim_from_utf8(path, wide, cch);
+}
+
+static void test_hit_and_revalidate(void) {
+    procinfo_reset(&g_reader);
+    g_labelReads = g_iconReads = g_iconFrees = 0;
+    WCHAR app[700], label[256];
+    image("app.exe", "MZ-one", 1700000000, app, ARRAYSIZE(app));
+    ProcInfoStats s0, s1;
+    procinfo_get_stats(&s0);
+    CHECK(procinfo_lookup_label(&g_reader, app, label, ARRAYSIZE(label)));
+    CHECK_EQ_WSTR(label, L"Desc app.exe #1");
+    CHECK(procinfo_lookup_label(&g_reader, app, label, ARRAYSIZE(label)));
+    CHECK_EQ_WSTR(label, L"Desc app.exe #1");
+    HICON icon = procinfo_lookup_icon(&g_reader, app);
+    CHECK(icon != NULL);
+    CHECK(procinfo_lookup_icon(&g_reader, app) == icon);
+    CHECK_EQ_INT(g_labelReads, 1);
+    CHECK_EQ_INT(g_iconReads, 1);
+    procinfo_get_stats(&s1);
+    CHECK_EQ_INT(s1.misses - s0.misses, 1);
+    CHECK_EQ_INT(s1.hits - s0.hits, 3);
+    CHECK_EQ_INT(s1.entries, 1);
+
+    // Updated in place with a new size: re-read, old icon freed
+    image("app.exe", "MZ-longer", 1700000000, app, ARRAYSIZE(app));
+    CHECK(procinfo_lookup_label(&g_reader, app, label, ARRAYSIZE(label)));
+    CHECK_EQ_WSTR(label, L"Desc app.exe #2");
+    CHECK_EQ_INT(g_iconFrees, 1);
+    CHECK(procinfo_lookup_icon(&g_reader, app) != icon);
+    // Same size, new write time: re-read too
+    image("app.exe", "MZ-LONGER", 1700000060, app, ARRAYSIZE(app));
+    CHECK(procinfo_lookup_label(&g_reader, app, label, ARRAYSIZE(label)));
+    CHECK_EQ_WSTR(label, L"Desc app.exe #3");
+    procinfo_get_stats(&s1);
+    CHECK_EQ_INT(s1.misses - s0.misses, 3);
+    CHECK_EQ_INT(s1.entries, 1);
+
+    // No FileDescription: the file name; an image that cannot be stat'ed: file name and FALSE
+    WCHAR plain[700];
+    image("notepad.exe", "MZ", 1700000000, plain, ARRAYSIZE(plain));
+    CHECK(procinfo_lookup_label(&g_reader, plain, label, ARRAYSIZE(label)));
+    CHECK_EQ_WSTR(label, L"notepad.exe");
+    CHECK(!procinfo_lookup_label(&g_reader, L"C:\\Gone\\missing.exe", label, ARRAYSIZE(label)));
+    CHECK_EQ_WSTR(label, L"missing.exe");
+    CHECK(procinfo_lookup_icon(&g_reader, L"C:\\Gone\\missing.exe") == NULL);
+
+    procinfo_reset(&g_reader);
+    CHECK_EQ_INT(g_iconFrees, 2);
+    procinfo_get_stats(&s1);
+    CHECK_EQ_INT(s1.entries, 0);
+}
+
+static void test_lru_eviction(void) {
+    procinfo_reset(&g_reader);
+    g_labelReads = g_iconReads = g_iconFrees = 0;
+    static WCHAR paths[257][700];
+    WCHAR label[256];
+    char name[32];
+    for (int i = 0; i < 257; ++i) {
+        snprintf(name, sizeof(name), "img%03d.exe", i);
+        image(name, "MZ", 1700000000, paths[i], ARRAYSIZE(paths[i]));
+    }
+    for (int i = 0; i < 256; ++i) {
+        procinfo_lookup_label(&g_reader, paths[i], label, ARRAYSIZE(label));
+        procinfo_lookup_icon(&g_reader, paths[i]);
+    }
+    procinfo_lookup_label(&g_reader, paths[0], label, ARRAYSIZE(label)); // 0 is now the most recent
+    ProcInfoStats s0, s1;
+    procinfo_get_stats(&s0);
+    CHECK_EQ_INT(s0.entries, 256);
+    CHECK_EQ_INT(g_labelReads, 256);
+
+    procinfo_lookup_label(&g_reader, paths[256], label, ARRAYSIZE(label));
+    procinfo_get_stats(&s1);
+    CHECK_EQ_INT(s1.entries, 256);
+    CHECK_EQ_INT(g_iconFrees, 1); // img001's icon went with it
+    procinfo_lookup_label(&g_reader, paths[0], label, ARRAYSIZE(label));
+    CHECK_EQ_INT(g_labelReads, 257);
+    procinfo_lookup_label(&g_reader, paths[1], label, ARRAYSIZE(label)); // evicted: read again
+    CHECK_EQ_INT(g_labelReads, 258);
+    procinfo_get_stats(&s1);
+    CHECK_EQ_INT(s1.hits - s0.hits, 1);
+    CHECK_EQ_INT(s1.misses - s0.misses, 2);
+    procinfo_reset(&g_reader);
+    CHECK_EQ_INT(g_iconFrees, 256); // every icon freed exactly once
+}
+
+// A path of MAX_PATH or more would be truncated in an entry and never match again: not cached
+static void test_long_path(void) {
+    procinfo_reset(&g_reader);
+    g_labelReads = 0;
+    char rel[400] = "";
+    while (strlen(g_dir) + strlen(rel) < 300) {
+        strcat(rel, "a_long_directory_name/");
+        char dir[800];
+        snprintf(dir, sizeof(dir), "%s/%s", g_dir, rel);
+        mkdir(dir, 0755);
+    }
+    strcat(rel, "tool.exe");
+    WCHAR path[700], label[256];
+    image(rel, "MZ", 1700000000, path, ARRAYSIZE(path));
+    CHECK(lstrlenW(path) >= MAX_PATH);
+    ProcInfoStats s0, s1;
+    procinfo_get_stats(&s0);
+    for (int i = 0; i < 3; ++i) {
+        CHECK(procinfo_lookup_label(&g_reader, path, label, ARRAYSIZE(label)));
+        CHECK(label[0] == L'D');
+    }
+    CHECK(procinfo_lookup_icon(&g_reader, path) == NULL);
+    procinfo_get_stats(&s1);
+    CHECK_EQ_INT(s1.entries, 0);
+    CHECK_EQ_INT(s1.misses - s0.misses, 4);
+    CHECK_EQ_INT(g_labelReads, 3);
+}
+
+int main(void) {
+    const char* dir = test_temp_dir("procinfo");
+    if (!dir) return 1;
+    snprintf(g_dir, sizeof(g_dir), "%s", dir);
+    RUN_TEST(test_hit_and_revalidate);
+    RUN_TEST(test_lru_eviction);
+    RUN_TEST(test_long_path);
+    test_remove_dir(g_dir);
+    return test_summary();
+}
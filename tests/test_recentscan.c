@@ -0,0 +1,184 @@
+// Recent engine against a stub slow file system: targets under a "slowshare" folder take far longer
+// than the deadline to answer (shim_set_slow_path), like a disconnected share. The popup must
+// still return on time, with slow targets shown only when showSlow is set and they are indexed.
+#include "test.h"
+#include "recentscan.h"
+#include "lnkfixture.h"
+#include <sys/stat.h>
+#include <sys/time.h>
+
+#define SLOW_MS 1000
+
+static char g_recent[600];
+static WCHAR g_wrecent[600];
+static char g_targets[600], g_slow[600];
+
+// Link i is the i-th most recent
+static void add_link(int i, const char* target) {
+    BYTE buf[4096];
+    char path[800];
+    LnkFixture f = {0};
+    f.localBasePath = target;
+    size_t len = lnk_fixture_build(&f, buf);
+    snprintf(path, sizeof(path), "%s/link%02d.lnk", g_recent, 50 - i); // name order opposite to recency
+    test_write_file(path, buf, len);
+    struct timeval tv[2] = { { 1700000000 - i * 60, 0 }, { 1700000000 - i * 60, 0 } };
+    utimes(path, tv);
+}
+
+// Ten links: 0-1 and 5 on the slow share, 3 and 7 pointing at deleted files, the rest fast
+static void setup(const char* root) {
+    snprintf(g_recent, sizeof(g_recent), "%s/Recent", root);
+    snprintf(g_targets, sizeof(g_targets), "%s/targets", root);
+    snprintf(g_slow, sizeof(g_slow), "%s/slowshare", root);
+    mkdir(g_recent, 0755);
+    mkdir(g_targets, 0755);
+    mkdir(g_slow, 0755);
+    for (int i = 0; i < 10; ++i) {
+        char target[700];
+        BOOL slow = i <= 1 || i == 5;
+        snprintf(target, sizeof(target), "%s/doc%d.txt", slow ? g_slow : g_targets, i);
+        if (i != 3 && i != 7) test_write_file(target, "x", 1);
+        add_link(i, target);
+    }
+    shim_from_utf8(g_recent, g_wrecent, ARRAYSIZE(g_wrecent));
+}
+
+static BOOL is_doc(const RecentItem* it, const char* dir, int i) {
+    char want[700];
+    WCHAR wwant[700];
+    snprintf(want, sizeof(want), "%s/doc%d.txt", dir, i);
+    shim_from_utf8(want, wwant, ARRAYSIZE(wwant));
+    return !lstrcmpW(it->path, wwant);
+}
+
+// Lets abandoned workers finish so they do not slow the next test's checks
+static void drain(void) {
+    shim_set_slow_path(NULL, 0);
+    Sleep(SLOW_MS + 100);
+}
+
+static void test_order_and_missing(void) {
+    RecentItem items[10];
+    RecentScanStats st;
+    int n = recentscan_collect(g_wrecent, items, 10, FALSE, NULL);
+    recentscan_get_stats(&st);
+    CHECK_EQ_INT(n, 8);
+    static const int order[] = { 0, 1, 2, 4, 5, 6, 8, 9 };
+    for (int i = 0; i < n && i < 8; ++i) {
+        BOOL slow = order[i] <= 1 || order[i] == 5;
+        CHECK(is_doc(&items[i], slow ? g_slow : g_targets, order[i]));
+    }
+    CHECK_EQ_INT(st.late, 0);
+    CHECK_EQ_INT(st.resolved, 10);
+
+    // Three visible with two missing among the first six: the second pass finds the rest
+    recentscan_reset_index();
+    n = recentscan_collect(g_wrecent, items, 3, FALSE, NULL);
+    recentscan_get_stats(&st);
+    CHECK_EQ_INT(n, 3);
+    CHECK(is_doc(&items[2], g_targets, 2));
+    CHECK_EQ_INT(st.passes, 1);
+    n = recentscan_collect(g_wrecent, items, 10, FALSE, NULL);
+    recentscan_get_stats(&st);
+    CHECK_EQ_INT(st.fromIndex, 6); // the first call indexed its whole 6-candidate batch
+}
+
+// Cold index: slow targets cannot even be resolved in time, so they are dropped either way
+static void test_deadline_cold(void) {
+    recentscan_reset_index();
+    shim_set_slow_path("slowshare", SLOW_MS);
+    RecentItem items[10];
+    RecentScanStats st;
+    double t0 = test_now_ms();
+    int n = recentscan_collect(g_wrecent, items, 10, TRUE, NULL);
+    double ms = test_now_ms() - t0;
+    recentscan_get_stats(&st);
+    CHECK(ms < 250 + 200);
+    CHECK_EQ_INT(st.late, 3);
+    CHECK_EQ_INT(n, 5);
+    for (int i = 0; i < n; ++i) CHECK(is_doc(&items[i], g_targets, (int[]){ 2, 4, 6, 8, 9 }[i]));
+    drain();
+}
+
+// Warm index: only the existence check is slow, so showSlow keeps the known targets in place
+static void test_deadline_warm(void) {
+    recentscan_reset_index();
+    RecentItem items[10];
+    RecentScanStats st;
+    recentscan_collect(g_wrecent, items, 10, FALSE, NULL);
+    shim_set_slow_path("slowshare", SLOW_MS);
+
+    double t0 = test_now_ms();
+    int n = recentscan_collect(g_wrecent, items, 10, TRUE, NULL);
+    double ms = test_now_ms() - t0;
+    recentscan_get_stats(&st);
+    CHECK(ms < 250 + 200);
+    CHECK_EQ_INT(st.fromIndex, 10);
+    CHECK_EQ_INT(st.late, 3);
+    CHECK_EQ_INT(n, 8);
+    CHECK(is_doc(&items[0], g_slow, 0));
+    CHECK(is_doc(&items[4], g_slow, 5));
+
+    t0 = test_now_ms();
+    n = recentscan_collect(g_wrecent, items, 10, FALSE, NULL);
+    ms = test_now_ms() - t0;
+    recentscan_get_stats(&st);
+    CHECK(ms < 250 + 200);
+    CHECK_EQ_INT(st.late, 3);
+    CHECK_EQ_INT(n, 5);
+    CHECK(is_doc(&items[0], g_targets, 2));
+    drain();
+}
+
+// A slow shell resolver (ID-list-only link) is bounded by the same deadline
+static BOOL g_shellCalled = FALSE;
+static BOOL slow_shell(const WCHAR* lnkPath, WCHAR* target, BOOL* isFolder) {
+    (void)lnkPath;
+    g_shellCalled = TRUE;
+    Sleep(SLOW_MS);
+    lstrcpyW(target, L"/nowhere");
+    *isFolder = FALSE;
+    return TRUE;
+}
+
+static void test_slow_shell(void) {
+    recentscan_reset_index();
+    BYTE buf[4096];
+    char path[800];
+    LnkFixture f = {0};
+    f.idListSize = 200;
+    size_t len = lnk_fixture_build(&f, buf);
+    snprintf(path, sizeof(path), "%s/zz_namespace.lnk", g_recent);
+    test_write_file(path, buf, len);
+    struct timeval tv[2] = { { 1700000100, 0 }, { 1700000100, 0 } }; // newest of all
+    utimes(path, tv);
+
+    RecentItem items[10];
+    RecentScanStats st;
+    double t0 = test_now_ms();
+    int n = recentscan_collect(g_wrecent, items, 10, TRUE, slow_shell);
+    double ms = test_now_ms() - t0;
+    recentscan_get_stats(&st);
+    CHECK(g_shellCalled);
+    CHECK(ms < 250 + 200);
+    CHECK_EQ_INT(st.late, 1);
+    CHECK_EQ_INT(n, 8);
+    unlink(path);
+    drain();
+}
+
+int main(void) {
+    const char* tmp = test_temp_dir("recentscan");
+    if (!tmp) return 1;
+    char root[512];
+    snprintf(root, sizeof(root), "%s", tmp);
+    setup(root);
+    RUN_TEST(test_order_and_missing);
+    RUN_TEST(test_deadline_cold);
+    RUN_TEST(test_deadline_warm);
+    RUN_TEST(test_slow_shell);
+    recentscan_reset_index();
+    test_remove_dir(root);
+    return test_summary();
+}
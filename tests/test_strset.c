@@ -0,0 +1,93 @@
+// Case-insensitive string set: folding, duplicates, growth past the first index and arena reuse
+#include "test.h"
+#include "strset.h"
+
+static void test_add_contains(void) {
+    Arena arena = {0};
+    StringSet set;
+    strset_init(&set, &arena);
+    CHECK(!strset_contains(&set, L"anything")); // no index yet
+    CHECK(strset_add(&set, L"Notepad"));
+    CHECK(!strset_add(&set, L"NOTEPAD"));
+    CHECK(!strset_add(&set, L"notepad"));
+    CHECK(strset_add(&set, L"Notepad++"));
+    CHECK(strset_add(&set, L""));
+    CHECK(!strset_add(&set, L""));
+    CHECK(strset_contains(&set, L"nOtEpAd"));
+    CHECK(strset_contains(&set, L""));
+    CHECK(!strset_contains(&set, L"Note"));
+    CHECK(!strset_add(&set, NULL));
+    CHECK(!strset_contains(&set, NULL));
+    CHECK_EQ_INT(set.count, 3);
+    arena_free(&arena);
+}
+
+// Labels longer than the old 64-character buffer must not collide on a shared prefix
+static void test_long_and_unicode(void) {
+    Arena arena = {0};
+    StringSet set;
+    strset_init(&set, &arena);
+    WCHAR a[300], b[300];
+    for (int i = 0; i < 299; ++i) a[i] = b[i] = L'x';
+    a[299] = b[299] = 0;
+    b[298] = L'y';
+    CHECK(strset_add(&set, a));
+    CHECK(strset_add(&set, b));
+    CHECK(strset_add(&set, L"\x00C4pfel"));                        // Äpfel
+    CHECK(!strset_add(&set, L"\x00E4PFEL"));                       // äPFEL
+    CHECK(strset_add(&set, L"\x0141\x00D3" L"D\x0179"));              // ŁÓDŹ
+    CHECK(strset_contains(&set, L"\x0142\x00F3" L"d\x017A"));         // łódź
+    CHECK(!strset_contains(&set, L"\x03A3\x0399\x0393\x039C\x0391")); // ΣΙΓΜΑ was never added
+    arena_free(&arena);
+}
+
+static void test_growth(void) {
+    Arena arena = {0};
+    StringSet set;
+    strset_init(&set, &arena);
+    const int n = 5000;
+    WCHAR s[32];
+    for (int i = 0; i < n; ++i) {
+        wsprintfW(s, L"Window %d", i);
+        CHECK(strset_add(&set, s));
+    }
+    CHECK_EQ_INT(set.count, n);
+    CHECK(set.slotCount >= (UINT)n * 2);
+    int found = 0, dup = 0;
+    for (int i = 0; i < n; ++i) {
+        wsprintfW(s, L"WINDOW %d", i);
+        found += strset_contains(&set, s);
+        dup += !strset_add(&set, s);
+    }
+    CHECK_EQ_INT(found, n);
+    CHECK_EQ_INT(dup, n);
+    wsprintfW(s, L"Window %d", n);
+    CHECK(!strset_contains(&set, s));
+    arena_free(&arena);
+}
+
+// Strings are copies: the caller's buffer can change, and a reset arena starts an empty set
+static void test_copies_and_reset(void) {
+    Arena arena = {0};
+    StringSet set;
+    strset_init(&set, &arena);
+    WCHAR buf[16];
+    lstrcpyW(buf, L"first");
+    strset_add(&set, buf);
+    lstrcpyW(buf, L"second");
+    CHECK(strset_contains(&set, L"first"));
+    CHECK(!strset_contains(&set, L"second"));
+    arena_reset(&arena);
+    strset_init(&set, &arena);
+    CHECK(!strset_contains(&set, L"first"));
+    CHECK(strset_add(&set, L"first"));
+    arena_free(&arena);
+}
+
+int main(void) {
+    RUN_TEST(test_add_contains);
+    RUN_TEST(test_long_and_unicode);
+    RUN_TEST(test_growth);
+    RUN_TEST(test_copies_and_reset);
+    return test_summary();
+}
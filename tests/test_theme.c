@@ -0,0 +1,103 @@
+// Theme snapshot: defaults when settings are missing, and a new generation only when dark mode,
+// the accent color or the DPI really changed
+#include "test.h"
+#include "theme.h"
+
+static BOOL g_haveLight, g_haveColor;
+static DWORD g_light, g_color;
+static int g_dpi, g_reads;
+
+static BOOL fake_light(DWORD* value) {
+    g_reads++;
+    if (g_haveLight) *value = g_light;
+    return g_haveLight;
+}
+
+static BOOL fake_color(DWORD* argb) {
+    if (g_haveColor) *argb = g_color;
+    return g_haveColor;
+}
+
+static int fake_dpi(void) {
+    return g_dpi;
+}
+
+static const ThemeProvider g_fake = { fake_light, fake_color, fake_dpi };
+
+static void set_system(BOOL haveLight, DWORD light, BOOL haveColor, DWORD color, int dpi) {
+    g_haveLight = haveLight; g_light = light;
+    g_haveColor = haveColor; g_color = color;
+    g_dpi = dpi;
+}
+
+static void test_defaults(void) {
+    theme_reset();
+    set_system(FALSE, 0, FALSE, 0, 0);
+    const ThemeState* st = theme_state_from(&g_fake);
+    CHECK(!st->dark);
+    CHECK(!st->hasAccent);
+    CHECK_EQ_INT(st->dpi, 96);
+    CHECK_EQ_INT(st->generation, 1);
+
+    ThemeProvider none = { NULL, NULL, NULL };
+    theme_reset();
+    st = theme_state_from(&none);
+    CHECK(!st->dark && !st->hasAccent);
+    CHECK_EQ_INT(st->dpi, 96);
+}
+
+static void test_read_once(void) {
+    theme_reset();
+    g_reads = 0;
+    set_system(TRUE, 0, TRUE, 0xC40078D4, 144); // alpha in the top byte is dropped
+    const ThemeState* st = theme_state_from(&g_fake);
+    theme_state_from(&g_fake);
+    theme_state_from(&g_fake);
+    CHECK_EQ_INT(g_reads, 1);
+    CHECK(st->dark);
+    CHECK(st->hasAccent);
+    CHECK(st->accent == RGB(0xD4, 0x78, 0x00));
+    CHECK_EQ_INT(st->dpi, 144);
+}
+
+static void test_generation(void) {
+    theme_reset();
+    set_system(TRUE, 1, TRUE, 0xFF112233, 96);
+    CHECK(!theme_refresh_from(&g_fake)); // first refresh only loads
+    const ThemeState* st = theme_state_from(&g_fake);
+    CHECK_EQ_INT(st->generation, 1);
+
+    CHECK(!theme_refresh_from(&g_fake)); // nothing changed
+    g_color = 0x80112233;                // alpha only: same accent
+    CHECK(!theme_refresh_from(&g_fake));
+    CHECK_EQ_INT(st->generation, 1);
+
+    g_light = 0; // dark
+    CHECK(theme_refresh_from(&g_fake));
+    CHECK(st->dark);
+    CHECK_EQ_INT(st->generation, 2);
+    g_color = 0xFF445566; // accent
+    CHECK(theme_refresh_from(&g_fake));
+    CHECK_EQ_INT(st->generation, 3);
+    g_haveColor = FALSE; // accent no longer available
+    CHECK(theme_refresh_from(&g_fake));
+    CHECK(!st->hasAccent);
+    CHECK_EQ_INT(st->generation, 4);
+    g_dpi = 120; // DPI
+    CHECK(theme_refresh_from(&g_fake));
+    CHECK_EQ_INT(st->dpi, 120);
+    CHECK_EQ_INT(st->generation, 5);
+    g_haveLight = FALSE; // value removed: back to light
+    CHECK(theme_refresh_from(&g_fake));
+    CHECK(!st->dark);
+    CHECK_EQ_INT(st->generation, 6);
+    CHECK(!theme_refresh_from(&g_fake));
+    CHECK_EQ_INT(st->generation, 6);
+}
+
+int main(void) {
+    RUN_TEST(test_defaults);
+    RUN_TEST(test_read_once);
+    RUN_TEST(test_generation);
+    return test_summary();
+}
@@ -0,0 +1,144 @@
+// Force Quit window model: list operations, and replay of a shell-hook trace (seed, create,
+// activate, retitle, cloak, destroy) checked against the expected order and contents
+#include "test.h"
+#include "winmodel.h"
+#include "wintrace.h"
+
+static void check_order(const WinModel* m, const ULONG_PTR* want, int n) {
+    CHECK_EQ_INT(m->count, n);
+    for (int i = 0; i < n && i < m->count; ++i) CHECK_EQ_INT((ULONG_PTR)m->wins[i].hwnd, want[i]);
+}
+
+static void test_operations(void) {
+    WinModel m = {0};
+    WinListEntry e = {0};
+    for (ULONG_PTR h = 1; h <= 3; ++h) {
+        e.hwnd = (HWND)h;
+        CHECK_EQ_INT(winmodel_insert(&m, &e, FALSE), (int)h - 1);
+    }
+    e.hwnd = (HWND)4;
+    CHECK_EQ_INT(winmodel_insert(&m, &e, TRUE), 0);
+    e.hwnd = (HWND)2;
+    CHECK_EQ_INT(winmodel_insert(&m, &e, TRUE), 2); // already tracked: stays where it is
+    static const ULONG_PTR a[] = { 4, 1, 2, 3 };
+    check_order(&m, a, 4);
+
+    CHECK(winmodel_activate(&m, (HWND)3));
+    CHECK(winmodel_activate(&m, (HWND)3)); // already in front
+    static const ULONG_PTR b[] = { 3, 4, 1, 2 };
+    check_order(&m, b, 4);
+    CHECK(!winmodel_activate(&m, (HWND)9));
+
+    CHECK(winmodel_rename(&m, (HWND)1, L"Renamed"));
+    CHECK_EQ_WSTR(m.wins[2].title, L"Renamed");
+    CHECK(winmodel_rename(&m, (HWND)1, NULL));
+    CHECK_EQ_WSTR(m.wins[2].title, L"");
+    CHECK(!winmodel_rename(&m, (HWND)9, L"x"));
+    CHECK(winmodel_cloak(&m, (HWND)4, 2));
+    CHECK_EQ_INT(m.wins[1].cloaked, 2);
+
+    CHECK(winmodel_remove(&m, (HWND)3)); // front
+    CHECK(winmodel_remove(&m, (HWND)2)); // back
+    CHECK(!winmodel_remove(&m, (HWND)2));
+    static const ULONG_PTR c[] = { 4, 1 };
+    check_order(&m, c, 2);
+    winmodel_free(&m);
+    CHECK(m.wins == NULL && m.count == 0);
+}
+
+static BOOL odd_alive(HWND hwnd) {
+    return ((ULONG_PTR)hwnd & 1) != 0;
+}
+
+static void test_prune_and_growth(void) {
+    WinModel m = {0};
+    WinListEntry e = {0};
+    for (ULONG_PTR h = 1; h <= 1000; ++h) {
+        e.hwnd = (HWND)h;
+        winmodel_insert(&m, &e, TRUE);
+    }
+    CHECK_EQ_INT(m.count, 1000);
+    CHECK_EQ_INT((ULONG_PTR)m.wins[0].hwnd, 1000);
+    CHECK_EQ_INT(winmodel_prune(&m, odd_alive), 500);
+    int ordered = 1;
+    for (int i = 0; i < m.count; ++i) ordered &= (ULONG_PTR)m.wins[i].hwnd == (ULONG_PTR)(999 - 2 * i);
+    CHECK(ordered);
+    winmodel_clear(&m);
+    CHECK_EQ_INT(m.count, 0);
+    winmodel_free(&m);
+}
+
+// A session: three windows at start, an editor opened and retitled, a desktop switch cloaking
+// the browser, alt-tabbing, a window that was never seen activating, and two windows closing
+static const WinTraceEvent k_trace[] = {
+    { WT_SEED, 0x10, "Explorer", 0 },
+    { WT_SEED, 0x20, "Browser", 0 },
+    { WT_SEED, 0x30, "Terminal", 0 },
+    { WT_CREATE, 0x40, "Untitled - Editor", 0 },
+    { WT_RENAME, 0x40, "notes.txt - Editor", 0 },
+    { WT_CREATE, 0x40, "ignored: known window", 0 },
+    { WT_CLOAK, 0x20, NULL, 2 },
+    { WT_ACTIVATE, 0x30, NULL, 0 },
+    { WT_ACTIVATE, 0x50, "Settings", 0 },
+    { WT_ACTIVATE, 0x20, NULL, 0 },
+    { WT_CLOAK, 0x20, NULL, 0 },
+    { WT_DESTROY, 0x10, NULL, 0 },
+    { WT_DESTROY, 0x99, NULL, 0 },   // never tracked
+    { WT_RENAME, 0x99, "nobody", 0 },
+    { WT_CLOAK, 0x40, NULL, 1 },
+    { WT_DESTROY, 0x30, NULL, 0 },
+};
+
+static void test_trace_replay(void) {
+    WinModel m = {0};
+    wintrace_replay(&m, k_trace, (int)ARRAYSIZE(k_trace));
+    static const ULONG_PTR order[] = { 0x20, 0x50, 0x40 };
+    check_order(&m, order, 3);
+    CHECK_EQ_WSTR(m.wins[0].title, L"Browser");
+    CHECK_EQ_INT(m.wins[0].cloaked, 0);
+    CHECK_EQ_WSTR(m.wins[1].title, L"Settings");
+    CHECK_EQ_WSTR(m.wins[2].title, L"notes.txt - Editor");
+    CHECK_EQ_INT(m.wins[2].cloaked, 1);
+    winmodel_free(&m);
+}
+
+// Long random trace: the model never holds a window twice and always matches the set of live
+// windows, and the window activated last is in front
+static void test_random_trace(void) {
+    WinModel m = {0};
+    BOOL live[256] = {0};
+    int liveCount = 0;
+    unsigned seed = 12345;
+    int dupes = 0, mismatched = 0, notFront = 0;
+    for (int step = 0; step < 50000; ++step) {
+        seed = seed * 1103515245u + 12345u;
+        unsigned r = seed >> 8;
+        WinTraceEvent ev = { (WinTraceOp)(1 + r % 5), 1 + (r >> 4) % 255, NULL, (r >> 12) & 1 };
+        wintrace_apply(&m, &ev);
+        if (ev.op == WT_CREATE || ev.op == WT_ACTIVATE) { if (!live[ev.hwnd]) liveCount++; live[ev.hwnd] = TRUE; }
+        if (ev.op == WT_DESTROY) { if (live[ev.hwnd]) liveCount--; live[ev.hwnd] = FALSE; }
+        if (ev.op == WT_ACTIVATE && (ULONG_PTR)m.wins[0].hwnd != ev.hwnd) notFront++;
+        if ((step & 1023) == 0) {
+            BOOL seen[256] = {0};
+            for (int i = 0; i < m.count; ++i) {
+                ULONG_PTR h = (ULONG_PTR)m.wins[i].hwnd;
+                if (seen[h]) dupes++;
+                seen[h] = TRUE;
+                if (!live[h]) mismatched++;
+            }
+            if (m.count != liveCount) mismatched++;
+        }
+    }
+    CHECK_EQ_INT(dupes, 0);
+    CHECK_EQ_INT(mismatched, 0);
+    CHECK_EQ_INT(notFront, 0);
+    winmodel_free(&m);
+}
+
+int main(void) {
+    RUN_TEST(test_operations);
+    RUN_TEST(test_prune_and_growth);
+    RUN_TEST(test_trace_replay);
+    RUN_TEST(test_random_trace);
+    return test_summary();
+}
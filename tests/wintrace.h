@@ -0,0 +1,67 @@
+#pragma once
+// Replays recorded shell-hook / WinEvent traces into a WinModel, making the same calls winlist.c
+// makes for each notification (the window data a real event would read comes from the trace).
+#include <windows.h>
+#include <stdio.h>
+#include "winmodel.h"
+
+typedef enum {
+    WT_SEED,      // EnumWindows at start: appended in z-order
+    WT_CREATE,    // HSHELL_WINDOWCREATED / EVENT_OBJECT_SHOW
+    WT_DESTROY,   // HSHELL_WINDOWDESTROYED
+    WT_ACTIVATE,  // HSHELL_WINDOWACTIVATED (tracks an unseen top-level window)
+    WT_RENAME,    // HSHELL_REDRAW with the new title
+    WT_CLOAK,     // EVENT_OBJECT_CLOAKED / UNCLOAKED with the DWMWA_CLOAKED value
+} WinTraceOp;
+
+typedef struct WinTraceEvent {
+    WinTraceOp op;
+    ULONG_PTR hwnd;
+    const char* title;  // WT_RENAME, or the title of a new window (NULL: "Window <hwnd>")
+    DWORD cloaked;      // WT_CLOAK
+} WinTraceEvent;
+
+static inline void wintrace_entry(const WinTraceEvent* ev, WinListEntry* e) {
+    ZeroMemory(e, sizeof(*e));
+    e->hwnd = (HWND)ev->hwnd;
+    e->pid = (DWORD)(ev->hwnd >> 4);
+    char title[64];
+    if (ev->title) snprintf(title, sizeof(title), "%s", ev->title);
+    else snprintf(title, sizeof(title), "Window %lu", (unsigned long)ev->hwnd);
+    shim_from_utf8(title, e->title, ARRAYSIZE(e->title));
+    lstrcpyW(e->cls, L"TraceWindow");
+}
+
+static inline void wintrace_apply(WinModel* m, const WinTraceEvent* ev) {
+    WinListEntry e;
+    HWND hwnd = (HWND)ev->hwnd;
+    WCHAR title[256];
+    switch (ev->op) {
+    case WT_SEED:
+    case WT_CREATE:
+        if (winmodel_find(m, hwnd) >= 0) break; // a known window is not read again
+        wintrace_entry(ev, &e);
+        winmodel_insert(m, &e, ev->op == WT_CREATE);
+        break;
+    case WT_DESTROY:
+        winmodel_remove(m, hwnd);
+        break;
+    case WT_ACTIVATE:
+        if (!winmodel_activate(m, hwnd)) {
+            wintrace_entry(ev, &e);
+            winmodel_insert(m, &e, TRUE);
+        }
+        break;
+    case WT_RENAME:
+        shim_from_utf8(ev->title ? ev->title : "", title, ARRAYSIZE(title));
+        winmodel_rename(m, hwnd, title);
+        break;
+    case WT_CLOAK:
+        winmodel_cloak(m, hwnd, ev->cloaked);
+        break;
+    }
+}
+
+static inline void wintrace_replay(WinModel* m, const WinTraceEvent* events, int n) {
+    for (int i = 0; i < n; ++i) wintrace_apply(m, &events[i]);
+}